@@ -0,0 +1,383 @@
+/*****************************************************************************
+ * File name: acquisition_cm0p.c
+ *
+ * Description: This file contains the acquisition running on the CM0+
+ * core when RADAR_ACQUISITION_CM0P is set for the CM4 application. It takes
+ * the sensor interrupt, reads the FIFO over SPI, keeps the frame sequence
+ * and hands each frame to the CM4 through the frame ring. The CM4 only
+ * processes frames, so network and crypto load there cannot delay a FIFO
+ * read. This file is part of the CM0+ application of this folder, the CM4
+ * build ignores it; main.c calls acquisition_cm0p_run after enabling the CM4.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Header file includes */
+#include "cybsp.h"
+#include "cyhal.h"
+
+/* Header file for library */
+#include "xensiv_bgt60trxx_mtb.h"
+
+/* Header file for local task */
+#include "acquisition_cm0p.h"
+#include "frame_ring.h"
+#include "frame_ring_ipc.h"
+#include "frame_sequence.h"
+#include "resource_map.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* RADAR sensor SPI frequency */
+#define XENSIV_BGT60TRXX_SPI_FREQUENCY      (25000000UL)
+
+/* The FIFO fill status counts 24 bit words holding two samples each */
+#define FIFO_FILL_SAMPLES(fstat)            (((((fstat) & XENSIV_BGT60TRXX_REG_FSTAT_FILL_STATUS_MSK) >>\
+                                               XENSIV_BGT60TRXX_REG_FSTAT_FILL_STATUS_POS)) * 2u)
+
+/* Frequency of the timer used for interrupt timestamps */
+#define STAMP_TIMER_FREQUENCY               (1000000UL)
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static cyhal_spi_t spi_obj;
+static xensiv_bgt60trxx_mtb_t bgt60_obj;
+static cyhal_timer_t stamp_timer;
+static frame_sequence_t sequence;
+
+/* Samples of the current frame read so far */
+static uint32_t frame_samples;
+
+/*******************************************************************************
+ * Function Name: fifo_interrupt_handler
+ *******************************************************************************
+ * Summary:
+ *   Records the timestamp of a FIFO interrupt, the acquisition loop polls
+ *   for it.
+ *
+ * Parameters:
+ *   args: unused
+ *   event: unused
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+#if defined(CYHAL_API_VERSION) && (CYHAL_API_VERSION >= 2)
+static void fifo_interrupt_handler(void *args, cyhal_gpio_event_t event)
+#else
+static void fifo_interrupt_handler(void *args, cyhal_gpio_irq_event_t event)
+#endif
+{
+    CY_UNUSED_PARAMETER(args);
+    CY_UNUSED_PARAMETER(event);
+
+    frame_sequence_irq(&sequence, cyhal_timer_read(&stamp_timer));
+}
+
+/*******************************************************************************
+ * Function Name: init_sensor
+ *******************************************************************************
+ * Summary:
+ *   Configures the SPI interface, the timestamp timer, the sensor with the
+ *   register list of the CM4 application and the FIFO interrupt.
+ *
+ * Parameters:
+ *   setup: acquisition set up by the CM4
+ *
+ * Return:
+ *   0 on success
+ ******************************************************************************/
+static int32_t init_sensor(const frame_ring_setup_t* setup)
+{
+    const cyhal_timer_cfg_t timer_cfg =
+    {
+        .compare_value = 0,
+        .period        = 0xFFFFFFFFUL,
+        .direction     = CYHAL_TIMER_DIR_UP,
+        .is_compare    = false,
+        .is_continuous = true,
+        .value         = 0
+    };
+
+    if (cyhal_spi_init(&spi_obj,
+                       PIN_XENSIV_BGT60TRXX_SPI_MOSI,
+                       PIN_XENSIV_BGT60TRXX_SPI_MISO,
+                       PIN_XENSIV_BGT60TRXX_SPI_SCLK,
+                       NC,
+                       NULL,
+                       8,
+                       CYHAL_SPI_MODE_00_MSB,
+                       false) != CY_RSLT_SUCCESS)
+    {
+        return -1;
+    }
+
+    /* Reduce drive strength to improve EMI */
+    Cy_GPIO_SetSlewRate(CYHAL_GET_PORTADDR(PIN_XENSIV_BGT60TRXX_SPI_MOSI), CYHAL_GET_PIN(PIN_XENSIV_BGT60TRXX_SPI_MOSI), CY_GPIO_SLEW_FAST);
+    Cy_GPIO_SetDriveSel(CYHAL_GET_PORTADDR(PIN_XENSIV_BGT60TRXX_SPI_MOSI), CYHAL_GET_PIN(PIN_XENSIV_BGT60TRXX_SPI_MOSI), CY_GPIO_DRIVE_1_8);
+    Cy_GPIO_SetSlewRate(CYHAL_GET_PORTADDR(PIN_XENSIV_BGT60TRXX_SPI_SCLK), CYHAL_GET_PIN(PIN_XENSIV_BGT60TRXX_SPI_SCLK), CY_GPIO_SLEW_FAST);
+    Cy_GPIO_SetDriveSel(CYHAL_GET_PORTADDR(PIN_XENSIV_BGT60TRXX_SPI_SCLK), CYHAL_GET_PIN(PIN_XENSIV_BGT60TRXX_SPI_SCLK), CY_GPIO_DRIVE_1_8);
+
+    if ((cyhal_spi_set_frequency(&spi_obj, XENSIV_BGT60TRXX_SPI_FREQUENCY) != CY_RSLT_SUCCESS) ||
+        (cyhal_gpio_init(PIN_XENSIV_BGT60TRXX_LDO_EN, CYHAL_GPIO_DIR_OUTPUT, CYHAL_GPIO_DRIVE_STRONG, true) != CY_RSLT_SUCCESS))
+    {
+        return -1;
+    }
+
+    /* Wait LDO stable */
+    Cy_SysLib_Delay(5u);
+
+    if (xensiv_bgt60trxx_mtb_init(&bgt60_obj,
+                                  &spi_obj,
+                                  PIN_XENSIV_BGT60TRXX_SPI_CSN,
+                                  PIN_XENSIV_BGT60TRXX_RSTN,
+                                  setup->registers,
+                                  setup->num_registers) != CY_RSLT_SUCCESS)
+    {
+        return -1;
+    }
+
+    if ((cyhal_timer_init(&stamp_timer, NC, NULL) != CY_RSLT_SUCCESS) ||
+        (cyhal_timer_configure(&stamp_timer, &timer_cfg) != CY_RSLT_SUCCESS) ||
+        (cyhal_timer_set_frequency(&stamp_timer, STAMP_TIMER_FREQUENCY) != CY_RSLT_SUCCESS) ||
+        (cyhal_timer_start(&stamp_timer) != CY_RSLT_SUCCESS))
+    {
+        return -1;
+    }
+
+    if (xensiv_bgt60trxx_mtb_interrupt_init(&bgt60_obj,
+                                            setup->samples_per_irq,
+                                            PIN_XENSIV_BGT60TRXX_IRQ,
+                                            ACQUISITION_CM0P_IRQ_PRIORITY,
+                                            fifo_interrupt_handler,
+                                            NULL) != CY_RSLT_SUCCESS)
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: read_frame_counter
+ *******************************************************************************
+ * Summary:
+ *   Reads the number of frames started by the sensor.
+ *
+ * Parameters:
+ *   counter: FRAME_CNT field of the STAT1 register
+ *
+ * Return:
+ *   true on success
+ ******************************************************************************/
+static bool read_frame_counter(uint32_t* counter)
+{
+    uint32_t stat1;
+
+    if (xensiv_bgt60trxx_get_reg(&bgt60_obj.dev, XENSIV_BGT60TRXX_REG_STAT1, &stat1) != XENSIV_BGT60TRXX_STATUS_OK)
+    {
+        return false;
+    }
+
+    *counter = (stat1 & XENSIV_BGT60TRXX_REG_STAT1_FRAME_CNT_MSK) >> XENSIV_BGT60TRXX_REG_STAT1_FRAME_CNT_POS;
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: restart_acquisition
+ *******************************************************************************
+ * Summary:
+ *   Stops frame generation, flushes the FIFO and restarts. All frames not
+ *   read so far are accounted as dropped, the CM4 sees them in the frame
+ *   statistics of the next published frame.
+ *
+ * Parameters:
+ *   overflow: the FIFO overflowed
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void restart_acquisition(bool overflow)
+{
+    uint32_t counter = sequence.last_counter;
+
+    (void)read_frame_counter(&counter);
+    (void)frame_sequence_drop(&sequence, counter, overflow);
+
+    xensiv_bgt60trxx_start_frame(&bgt60_obj.dev, false);
+    (void)xensiv_bgt60trxx_soft_reset(&bgt60_obj.dev, XENSIV_BGT60TRXX_RESET_FIFO);
+
+    frame_sequence_restart(&sequence);
+    frame_samples = 0;
+    ++sequence.stats.recoveries;
+
+    (void)xensiv_bgt60trxx_start_frame(&bgt60_obj.dev, true);
+}
+
+/*******************************************************************************
+ * Function Name: acquisition_cm0p_run
+ *******************************************************************************
+ * Summary:
+ *   Waits for the ring offered by the CM4, initializes the sensor with its
+ *   setup and acquires frames for as long as the CM4 wants them. A frame is
+ *   read block by block into a reserved slot and published once complete.
+ *   If the CM4 falls behind and the ring is full, the FIFO is flushed rather
+ *   than overflowing. Does not return.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void acquisition_cm0p_run(void)
+{
+    frame_ring_t* ring;
+    const frame_ring_setup_t* setup;
+    frame_ring_header_t header = {0};
+    uint16_t* frame = NULL;
+    uint32_t block_stamp_us = 0;
+    uint32_t latency_us = 0;
+    uint32_t wait_start_us;
+    bool running = false;
+
+    while ((ring = frame_ring_ipc_attach()) == NULL)
+    {
+        Cy_SysLib_DelayUs(ACQUISITION_CM0P_POLL_US);
+    }
+    setup = &ring->setup;
+
+    if (init_sensor(setup) != 0)
+    {
+        CY_ASSERT(0);
+        for (;;)
+        {
+        }
+    }
+
+    frame_sequence_init(&sequence, 0, cyhal_timer_read(&stamp_timer));
+    wait_start_us = cyhal_timer_read(&stamp_timer);
+
+    for (;;)
+    {
+        uint32_t fstat;
+        uint32_t fill_samples;
+        uint32_t counter;
+        uint32_t backlog_frames;
+
+        if (frame_ring_running(ring) != running)
+        {
+            /* Starting and stopping resets the sensor FSM and FIFO */
+            running = !running;
+            (void)xensiv_bgt60trxx_start_frame(&bgt60_obj.dev, running);
+            frame_sequence_restart(&sequence);
+            frame_samples = 0;
+            wait_start_us = cyhal_timer_read(&stamp_timer);
+        }
+
+        if (!running)
+        {
+            Cy_SysLib_DelayUs(ACQUISITION_CM0P_POLL_US);
+            continue;
+        }
+
+        if (xensiv_bgt60trxx_get_reg(&bgt60_obj.dev, XENSIV_BGT60TRXX_REG_FSTAT, &fstat) != XENSIV_BGT60TRXX_STATUS_OK)
+        {
+            restart_acquisition(false);
+            continue;
+        }
+
+        if ((fstat & XENSIV_BGT60TRXX_REG_FSTAT_FOF_ERR_MSK) != 0u)
+        {
+            restart_acquisition(true);
+            continue;
+        }
+
+        fill_samples = FIFO_FILL_SAMPLES(fstat);
+        if (fill_samples < setup->samples_per_irq)
+        {
+            if ((cyhal_timer_read(&stamp_timer) - wait_start_us) > (ACQUISITION_CM0P_STALL_PERIODS * setup->irq_period_us))
+            {
+                restart_acquisition(false);
+                wait_start_us = cyhal_timer_read(&stamp_timer);
+            }
+            Cy_SysLib_DelayUs(ACQUISITION_CM0P_POLL_US);
+            continue;
+        }
+
+        /* Data that was already waiting did not raise an interrupt */
+        if (!frame_sequence_next_stamp(&sequence, &block_stamp_us))
+        {
+            block_stamp_us += setup->irq_period_us;
+        }
+
+        if (frame_samples == 0u)
+        {
+            frame = frame_ring_reserve(ring);
+            if (frame == NULL)
+            {
+                /* The CM4 is behind, drop what the FIFO holds instead of overflowing */
+                restart_acquisition(false);
+                continue;
+            }
+            header.stamp_us = block_stamp_us;
+        }
+
+        if (xensiv_bgt60trxx_get_fifo_data(&bgt60_obj.dev, &frame[frame_samples], setup->samples_per_irq) !=
+            XENSIV_BGT60TRXX_STATUS_OK)
+        {
+            restart_acquisition(false);
+            continue;
+        }
+        wait_start_us = cyhal_timer_read(&stamp_timer);
+        latency_us = wait_start_us - block_stamp_us;
+
+        frame_samples += setup->samples_per_irq;
+        if (frame_samples < setup->samples_per_frame)
+        {
+            continue;
+        }
+        frame_samples = 0;
+
+        if (!read_frame_counter(&counter))
+        {
+            restart_acquisition(false);
+            continue;
+        }
+
+        /* A following frame completed before this one was read */
+        backlog_frames = (fill_samples - setup->samples_per_irq) / setup->samples_per_frame;
+        header.sequence = frame_sequence_frame(&sequence, counter, backlog_frames, (backlog_frames > 0u), latency_us);
+        header.num_samples = setup->samples_per_frame;
+        header.stats = sequence.stats;
+
+        frame_ring_publish(ring, &header);
+        frame_ring_ipc_notify();
+    }
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,51 @@
+/******************************************************************************
+ * File Name:   acquisition_cm0p.h
+ *
+ * Description: This file contains the function prototypes and constants used
+ *   in acquisition_cm0p.c.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+
+#pragma once
+
+/* Header file from system */
+#include <stdint.h>
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Interval of the checks for the FIFO interrupt and the run request */
+#define ACQUISITION_CM0P_POLL_US            (50u)
+
+/* FIFO interrupt periods without interrupt before the acquisition is restarted */
+#define ACQUISITION_CM0P_STALL_PERIODS      (10u)
+
+/* Priority of the FIFO interrupt on the CM0+ core */
+#define ACQUISITION_CM0P_IRQ_PRIORITY       (2u)
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+void acquisition_cm0p_run(void);
+
+/* [] END OF FILE */
@@ -0,0 +1,80 @@
+/******************************************************************************
+ * File Name:   main.c
+ *
+ * Description: This is the source code of the CM0+ application used with
+ *   RADAR_ACQUISITION_CM0P. It starts the CM4 application and then runs the
+ *   acquisition of the radar sensor.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file includes */
+#include "cybsp.h"
+#include "cyhal.h"
+
+/* Header file for local task */
+#include "acquisition_cm0p.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Start of the CM4 application, the flash origin of cy8c6xxa_cm4_dual.ld */
+#define CM4_APP_ADDR                        (0x10180000UL)
+
+/*******************************************************************************
+ * Function Name: main
+ *******************************************************************************
+ * Summary:
+ *   System entrance point. This function initializes the board support
+ *   package, enables the CM4 and runs the acquisition, which waits for the
+ *   frame ring of the CM4 application.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  int
+ *
+ ******************************************************************************/
+int main(void)
+{
+    cy_rslt_t result;
+
+    /* Initialize the board support package. */
+    result = cybsp_init();
+    CY_ASSERT(CY_RSLT_SUCCESS == result);
+
+    /* To avoid compiler warnings. */
+    (void) result;
+
+    /* Enable global interrupts. */
+    __enable_irq();
+
+    /* Enable the CM4, it offers the frame ring when its radar task starts */
+    Cy_SysEnableCM4(CM4_APP_ADDR);
+
+    /* Does not return */
+    acquisition_cm0p_run();
+
+    return 0;
+}
+
+/* [] END OF FILE */
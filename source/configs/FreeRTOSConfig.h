@@ -274,4 +274,19 @@ extern void vApplicationSleep( uint32_t xExpectedIdleTime );
  */
 #define configUSE_NEWLIB_REENTRANT              1
 
+/* Set to 1 to split the time of every cy_mqtt_publish call into the time the
+ * calling task runs, the time of the IPC to the CM0+ and the rest, see
+ * net_batch.c. The task switch hooks then run in every context switch.
+ */
+#ifndef NET_TRACE_ENABLED
+#define NET_TRACE_ENABLED                       0
+#endif
+
+#if ( NET_TRACE_ENABLED != 0 )
+extern void net_batch_switched_in( void* task );
+extern void net_batch_switched_out( void* task );
+#define traceTASK_SWITCHED_IN()                 net_batch_switched_in( ( void* ) pxCurrentTCB )
+#define traceTASK_SWITCHED_OUT()                net_batch_switched_out( ( void* ) pxCurrentTCB )
+#endif
+
 #endif /* FREERTOS_CONFIG_H */
@@ -785,4 +785,39 @@
  */
 #define MBEDTLS_DEPRECATED_REMOVED
 
+/**
+ * \def TLS_CRYPTO_HW
+ *
+ * Run AES, SHA-256 and the ECDSA signatures on the PSoC 6 crypto block with
+ * the MBEDTLS_*_ALT implementations of the cy-mbedtls-acceleration library.
+ * The ECDH key exchange, RSA and the other algorithms stay in software.
+ *
+ * Set to 0 to use the software implementations of mbed TLS, e.g. for a
+ * build on a host or to compare both, see tls_crypto.h.
+ */
+#ifndef TLS_CRYPTO_HW
+#define TLS_CRYPTO_HW                       (1)
+#endif
+
+#if (TLS_CRYPTO_HW != 0)
+#define MBEDTLS_AES_ALT
+#define MBEDTLS_SHA256_ALT
+#define MBEDTLS_ECDSA_SIGN_ALT
+#define MBEDTLS_ECDSA_VERIFY_ALT
+#endif
+
+/**
+ * \def TLS_CRYPTO_SELF_TEST
+ *
+ * Set to 1 to run the mbed TLS self tests of the algorithms above at boot,
+ * see tls_crypto_self_test(). They need MBEDTLS_SELF_TEST.
+ */
+#ifndef TLS_CRYPTO_SELF_TEST
+#define TLS_CRYPTO_SELF_TEST                (0)
+#endif
+
+#if (TLS_CRYPTO_SELF_TEST != 0)
+#define MBEDTLS_SELF_TEST
+#endif
+
 #endif /* MBEDTLS_USER_CONFIG_HEADER */
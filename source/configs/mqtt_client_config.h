@@ -60,6 +60,11 @@
  */
 #define MQTT_MESSAGES_QOS                 ( 0 )
 
+/* QoS of the telemetry and device shadow publishes, 0 or 1. QoS 1 publishes
+ * are acknowledged by the broker and kept until then, see net_writer.c.
+ */
+#define MQTT_PUBLISH_QOS                  ( 1 )
+
 /******************* OTHER MQTT CLIENT CONFIGURATION MACROS *******************/
 
 /* The timeout in milliseconds for MQTT operations in this example. */
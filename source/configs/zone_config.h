@@ -0,0 +1,57 @@
+/****************************************************************************** 
+* File Name:   zone_config.h
+*
+* Description: This file contains the zones observed by the sensor with the
+*              3 RX profile, see RADAR_PROFILE_3RX.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2020-2021, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef ZONE_CONFIG_H_
+#define ZONE_CONFIG_H_
+
+/* Zones reported in RDR_SENSOR_ZONES, at most ZONE_OCCUPANCY_MAX_ZONES. Every
+ * zone is { name, min azimuth, max azimuth, min distance, max distance }, the
+ * azimuth in degrees positive towards RX1 and the distance in meters. Adapt
+ * them to the room and the mounting of the sensor.
+ */
+#define ZONE_CONFIG_ZONES                                   \
+{                                                           \
+    { "desk_a", -60.0f, -5.0f,   0.3f, 3.0f },              \
+    { "desk_b",   5.0f, 60.0f,   0.3f, 3.0f },              \
+}
+
+#endif /* ZONE_CONFIG_H_ */
@@ -0,0 +1,74 @@
+#!/bin/bash
+# Lists the hot path of the radar processing in a linked image: the code and
+# tables copied to RAM (see the .data section of the GCC linker script), the
+# grouped frame buffers and where the main kernels of a frame live.
+#
+# Usage: hot_path_report.sh <elf> [report]
+# The report is printed if no file is given. Set NM to use another nm.
+
+ELF=$1
+REPORT=${2:-/dev/stdout}
+NM=${NM:-arm-none-eabi-nm}
+
+# Kernels and buffers of every frame
+CHECKED="frame_preprocess_add_chunk range_fft_process target_detect_process \
+xensiv_radar_presence_process_frame arm_rfft_fast_f32 arm_cfft_f32 arm_cmplx_mag_f32 \
+twiddleCoef_rfft_128 twiddleCoef_64 armBitRevIndexTable64 realCoefAQ15 realCoefAQ31 \
+bgt60_buffer frame avg_chirp"
+
+if [ ! -f "$ELF" ]; then
+    echo "usage: $0 <elf> [report]" >&2
+    exit 1
+fi
+
+"$NM" -S -n "$ELF" | awk -v checked="$CHECKED" -v elf="$ELF" '
+function region(addr,    a) {
+    a = hex(addr);
+    if (a >= hex("08000000") && a < hex("08100000")) return "RAM";
+    if (a >= hex("10000000") && a < hex("10200000")) return "flash";
+    return "other";
+}
+function hex(s,    i, n, c) {
+    n = 0;
+    for (i = 1; i <= length(s); i++) {
+        c = index("0123456789abcdef", tolower(substr(s, i, 1))) - 1;
+        n = (n * 16) + c;
+    }
+    return n;
+}
+{
+    if (NF == 4) { addr[NR] = $1; size[NR] = $2; name[NR] = $4; }
+    else if (NF == 3) { addr[NR] = $1; size[NR] = ""; name[NR] = $3; }
+    else next;
+    where[name[NR]] = addr[NR];
+}
+END {
+    split(checked, list, " ");
+    print "Hot path of " elf;
+    sections["__hot_path_start__"] = "__hot_path_end__";
+    sections["__hot_path_bss_start__"] = "__hot_path_bss_end__";
+    title["__hot_path_start__"] = "Code and tables copied to RAM";
+    title["__hot_path_bss_start__"] = "Frame buffers";
+    order[1] = "__hot_path_start__";
+    order[2] = "__hot_path_bss_start__";
+    for (o = 1; o <= 2; o++) {
+        start = order[o];
+        stop = sections[start];
+        if (!(start in where) || !(stop in where)) {
+            print "\n" title[start] ": not placed by the linker script";
+            continue;
+        }
+        printf "\n%s: %d bytes at 0x%s (%s)\n", title[start], hex(where[stop]) - hex(where[start]),
+               where[start], region(where[start]);
+        for (i = 1; i <= NR; i++) {
+            if ((i in addr) && (size[i] != "") && (hex(addr[i]) >= hex(where[start])) && (hex(addr[i]) < hex(where[stop]))) {
+                printf "  0x%s %8d  %s\n", addr[i], hex(size[i]), name[i];
+            }
+        }
+    }
+    print "\nKernels and buffers of a frame:";
+    for (i = 1; i in list; i++) {
+        if (list[i] in where) printf "  %-40s %-6s 0x%s\n", list[i], region(where[list[i]]), where[list[i]];
+        else printf "  %-40s not linked\n", list[i];
+    }
+}' > "$REPORT"
@@ -0,0 +1,682 @@
+/*****************************************************************************
+ * File name: adaptive_rate.c
+ *
+ * Description: This file switches the radar acquisition between a full rate
+ * profile and a slow scan profile depending on the presence state. While the
+ * room is confirmed empty the sensor is triggered once per slow scan period
+ * only, the presence library runs macro detection only and the timing fields
+ * of its configuration are adjusted accordingly.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Header file for local task */
+#include "adaptive_rate.h"
+#include "micro_sdft.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Minimum number of slow scan frames inside one macro compare interval */
+#define SLOW_MACRO_COMPARE_FRAMES           (2)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+/* Configuration fields owned by the active profile and the overload level.
+ * The user values are kept here while they are overridden in the library.
+ */
+typedef struct
+{
+    xensiv_radar_presence_mode_t mode;
+    int32_t macro_compare_interval_ms;
+    bool micro_fft_decimation_enabled;
+    int32_t micro_fft_size;
+} profile_fields_t;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static adaptive_rate_profile_id_t profile = ADAPTIVE_RATE_PROFILE_FULL;
+static bool wake_pending = false;
+static uint32_t wake_request_ms;
+
+/* The wake up latency runs from the first slow scan frame with motion to the
+ * presence confirmed by the library at full rate
+ */
+static bool motion_onset_valid = false;
+static uint32_t motion_onset_ms;
+static bool wake_unconfirmed = false;
+static uint32_t wake_onset_ms;
+
+static profile_fields_t user_fields;
+static uint32_t full_period_ms;
+static overload_level_t overload_level = OVERLOAD_LEVEL_NONE;
+
+static xensiv_radar_presence_state_t last_state = XENSIV_RADAR_PRESENCE_STATE_ABSENCE;
+static uint32_t last_state_change_ms;
+
+static bool confirm_armed = false;
+static uint32_t confirm_deadline_ms;
+
+static uint32_t last_update_ms;
+static adaptive_rate_stats_t stats;
+
+/* Keeps the full rate profile, e.g. while the thresholds are calibrated */
+static bool hold_full = false;
+
+/* Mode run instead of the user mode, the user mode is kept in user_fields */
+static bool mode_forced = false;
+static xensiv_radar_presence_mode_t forced_mode;
+
+/*******************************************************************************
+ * Function Name: apply_profile_fields
+ *******************************************************************************
+ * Summary:
+ *   Writes the profile owned fields of the given profile and the degradations
+ *   of the active overload level into a configuration.
+ *
+ * Parameters:
+ *   config: configuration to be modified
+ *   id: profile whose fields are applied
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void apply_profile_fields(xensiv_radar_presence_config_t* config, adaptive_rate_profile_id_t id)
+{
+    if (id == ADAPTIVE_RATE_PROFILE_SLOW)
+    {
+        const int32_t min_interval_ms = SLOW_MACRO_COMPARE_FRAMES * ADAPTIVE_RATE_SLOW_FRAME_PERIOD_MS;
+
+        /* Micro detection needs micro_fft_size frames at full rate */
+        config->mode = XENSIV_RADAR_PRESENCE_MODE_MACRO_ONLY;
+        config->macro_compare_interval_ms = (user_fields.macro_compare_interval_ms > min_interval_ms) ?
+                                            user_fields.macro_compare_interval_ms : min_interval_ms;
+    }
+    else
+    {
+        config->mode = mode_forced ? forced_mode : user_fields.mode;
+        config->macro_compare_interval_ms = user_fields.macro_compare_interval_ms;
+
+#if (MICRO_SDFT_ENABLED != 0)
+        /* The sliding DFT takes over the micro detection */
+        if (config->mode == XENSIV_RADAR_PRESENCE_MODE_MICRO_IF_MACRO)
+        {
+            config->mode = XENSIV_RADAR_PRESENCE_MODE_MACRO_ONLY;
+        }
+#endif
+    }
+
+    config->micro_fft_decimation_enabled = user_fields.micro_fft_decimation_enabled;
+    config->micro_fft_size = user_fields.micro_fft_size;
+    overload_governor_apply_config(overload_level, config);
+}
+
+/*******************************************************************************
+ * Function Name: user_fields_from_config
+ *******************************************************************************
+ * Summary:
+ *   Stores the owned fields of a user configuration.
+ *
+ * Parameters:
+ *   config: user configuration
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void user_fields_from_config(const xensiv_radar_presence_config_t* config)
+{
+    user_fields.mode = config->mode;
+    user_fields.macro_compare_interval_ms = config->macro_compare_interval_ms;
+    user_fields.micro_fft_decimation_enabled = config->micro_fft_decimation_enabled;
+    user_fields.micro_fft_size = config->micro_fft_size;
+}
+
+/*******************************************************************************
+ * Function Name: apply_config
+ *******************************************************************************
+ * Summary:
+ *   Reconfigures the presence library for the given profile and the active
+ *   overload level. Must be called between two frames with
+ *   sem_radar_sensing_context taken.
+ *
+ * Parameters:
+ *   handle: presence library handle
+ *   id: profile to be applied
+ *
+ * Return:
+ *   true on success
+ ******************************************************************************/
+static bool apply_config(xensiv_radar_presence_handle_t handle, adaptive_rate_profile_id_t id)
+{
+    xensiv_radar_presence_config_t config;
+
+    if (xensiv_radar_presence_get_config(handle, &config) != XENSIV_RADAR_PRESENCE_OK)
+    {
+        printf("[WARN] adaptive rate: reading presence config failed\n");
+        return false;
+    }
+
+    apply_profile_fields(&config, id);
+
+    if (xensiv_radar_presence_set_config(handle, &config) != XENSIV_RADAR_PRESENCE_OK)
+    {
+        printf("[WARN] adaptive rate: setting presence config failed\n");
+        return false;
+    }
+    xensiv_radar_presence_reset(handle);
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: arm_confirmation
+ *******************************************************************************
+ * Summary:
+ *   After a library reset the presence has to be detected again. Arms the
+ *   deadline after which an absence is reported if it is not.
+ *
+ * Parameters:
+ *   handle: presence library handle
+ *   time_ms: time of the reset
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void arm_confirmation(xensiv_radar_presence_handle_t handle, uint32_t time_ms)
+{
+    xensiv_radar_presence_config_t config;
+
+    (void)xensiv_radar_presence_get_config(handle, &config);
+    confirm_deadline_ms = time_ms + (uint32_t)config.macro_movement_validity_ms +
+                          (uint32_t)config.micro_movement_validity_ms;
+    confirm_armed = true;
+}
+
+/*******************************************************************************
+ * Function Name: print_stats
+ *******************************************************************************
+ * Summary:
+ *   Prints frame rate per profile and the frames saved by the slow scan.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void print_stats(void)
+{
+    uint32_t full_rate_frames = stats.time_ms[ADAPTIVE_RATE_PROFILE_SLOW] / full_period_ms;
+    uint32_t saved_frames = (full_rate_frames > stats.frames[ADAPTIVE_RATE_PROFILE_SLOW]) ?
+                            (full_rate_frames - stats.frames[ADAPTIVE_RATE_PROFILE_SLOW]) : 0;
+
+    uint32_t avg_latency_ms = (stats.wakeups > 0u) ? (stats.wake_latency_ms_total / stats.wakeups) : 0u;
+
+    printf("[INFO] adaptive rate: full %" PRIu32 " frames/%" PRIu32 " ms, slow %" PRIu32 " frames/%" PRIu32 " ms, "
+           "saved %" PRIu32 " frames, %" PRIu32 " wake ups, latency last %" PRIu32 " avg %" PRIu32 " max %" PRIu32 " ms\n",
+           stats.frames[ADAPTIVE_RATE_PROFILE_FULL], stats.time_ms[ADAPTIVE_RATE_PROFILE_FULL],
+           stats.frames[ADAPTIVE_RATE_PROFILE_SLOW], stats.time_ms[ADAPTIVE_RATE_PROFILE_SLOW],
+           saved_frames, stats.wakeups, stats.wake_latency_ms_last, avg_latency_ms, stats.wake_latency_ms_max);
+}
+
+/*******************************************************************************
+ * Function Name: switch_profile
+ *******************************************************************************
+ * Summary:
+ *   Reconfigures the presence library for the given profile. Must be called
+ *   between two frames with sem_radar_sensing_context taken.
+ *
+ * Parameters:
+ *   handle: presence library handle
+ *   id: new profile
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void switch_profile(xensiv_radar_presence_handle_t handle, adaptive_rate_profile_id_t id)
+{
+    if (!apply_config(handle, id))
+    {
+        return;
+    }
+
+    profile = id;
+    ++stats.switches;
+    if ((stats.switches % ADAPTIVE_RATE_STATS_PRINT_INTERVAL) == 0)
+    {
+        print_stats();
+    }
+}
+
+/*******************************************************************************
+ * Function Name: adaptive_rate_init
+ *******************************************************************************
+ * Summary:
+ *   Takes over the user configuration of the presence library and starts in
+ *   the full rate profile.
+ *
+ * Parameters:
+ *   handle: presence library handle
+ *   full_frame_period_ms: frame period programmed by register_list
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void adaptive_rate_init(xensiv_radar_presence_handle_t handle, uint32_t full_frame_period_ms)
+{
+    xensiv_radar_presence_config_t config;
+
+    (void)xensiv_radar_presence_get_config(handle, &config);
+    user_fields_from_config(&config);
+
+    overload_level = OVERLOAD_LEVEL_NONE;
+    full_period_ms = (full_frame_period_ms > 0u) ? full_frame_period_ms : 1u;
+    profile = ADAPTIVE_RATE_PROFILE_FULL;
+    wake_pending = false;
+    motion_onset_valid = false;
+    wake_unconfirmed = false;
+    confirm_armed = false;
+    last_state = XENSIV_RADAR_PRESENCE_STATE_ABSENCE;
+    last_state_change_ms = 0;
+    last_update_ms = 0;
+    hold_full = false;
+    mode_forced = false;
+    memset(&stats, 0, sizeof(stats));
+}
+
+/*******************************************************************************
+ * Function Name: adaptive_rate_filter_event
+ *******************************************************************************
+ * Summary:
+ *   Tracks the reported presence state and drops repeated states caused by
+ *   the library reset of a profile switch. A macro presence during slow scan
+ *   requests the switch to the full rate profile, the first presence after
+ *   the switch ends the wake up.
+ *
+ * Parameters:
+ *   event: event reported by the presence library
+ *
+ * Return:
+ *   true if the event shall be reported, false if it is a duplicate
+ ******************************************************************************/
+bool adaptive_rate_filter_event(const xensiv_radar_presence_event_t* event)
+{
+    /* Any event after a wake up confirms the state of the library */
+    confirm_armed = false;
+
+    if (wake_unconfirmed && (profile == ADAPTIVE_RATE_PROFILE_FULL))
+    {
+        wake_unconfirmed = false;
+        if (event->state != XENSIV_RADAR_PRESENCE_STATE_ABSENCE)
+        {
+            stats.wake_latency_ms_last = event->timestamp - wake_onset_ms;
+            stats.wake_latency_ms_total += stats.wake_latency_ms_last;
+            if (stats.wake_latency_ms_last > stats.wake_latency_ms_max)
+            {
+                stats.wake_latency_ms_max = stats.wake_latency_ms_last;
+            }
+            ++stats.wakeups;
+        }
+    }
+
+    if ((profile == ADAPTIVE_RATE_PROFILE_SLOW) &&
+        (event->state == XENSIV_RADAR_PRESENCE_STATE_MACRO_PRESENCE))
+    {
+        wake_pending = true;
+        wake_request_ms = event->timestamp;
+    }
+
+    if (event->state == last_state)
+    {
+        return false;
+    }
+
+    last_state = event->state;
+    last_state_change_ms = event->timestamp;
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: adaptive_rate_update
+ *******************************************************************************
+ * Summary:
+ *   Called after every processed frame. Applies pending profile switches and
+ *   issues an absence if the library did not confirm the presence after a
+ *   wake up within its validity windows.
+ *
+ * Parameters:
+ *   handle: presence library handle
+ *   time_ms: timestamp of the processed frame
+ *   motion: the frame shows motion energy, e.g. a target in the clutter free
+ *           range profile; starts the wake up latency during slow scan
+ *   synthesized_event: filled in if an event needs to be reported
+ *
+ * Return:
+ *   true if synthesized_event has been filled in
+ ******************************************************************************/
+bool adaptive_rate_update(xensiv_radar_presence_handle_t handle, uint32_t time_ms, bool motion,
+                          xensiv_radar_presence_event_t* synthesized_event)
+{
+    bool synthesized = false;
+
+    if (profile == ADAPTIVE_RATE_PROFILE_SLOW)
+    {
+        if (!motion)
+        {
+            motion_onset_valid = false;
+        }
+        else if (!motion_onset_valid)
+        {
+            motion_onset_valid = true;
+            motion_onset_ms = time_ms;
+        }
+        else
+        {
+            /* Motion goes on since motion_onset_ms */
+        }
+    }
+
+    if (last_update_ms != 0u)
+    {
+        stats.time_ms[profile] += time_ms - last_update_ms;
+    }
+    last_update_ms = time_ms;
+    ++stats.frames[profile];
+
+    if (wake_pending)
+    {
+        wake_pending = false;
+        switch_profile(handle, ADAPTIVE_RATE_PROFILE_FULL);
+
+        /* Without a motion frame before, e.g. with the target detection
+         * disabled, the latency starts at the macro presence of the slow scan
+         */
+        wake_onset_ms = (motion_onset_valid && ((int32_t)(wake_request_ms - motion_onset_ms) >= 0)) ?
+                        motion_onset_ms : wake_request_ms;
+        wake_unconfirmed = true;
+        motion_onset_valid = false;
+
+        /* The reset dropped the macro presence, it has to be detected again */
+        arm_confirmation(handle, time_ms);
+    }
+    else if (confirm_armed && ((int32_t)(time_ms - confirm_deadline_ms) >= 0))
+    {
+        confirm_armed = false;
+        wake_unconfirmed = false;
+        ++stats.synthesized_absences;
+
+        synthesized_event->state = XENSIV_RADAR_PRESENCE_STATE_ABSENCE;
+        synthesized_event->range_bin = 0;
+        synthesized_event->timestamp = time_ms;
+        synthesized = true;
+    }
+    else if ((ADAPTIVE_RATE_ENABLED != 0) && !hold_full &&
+             (profile == ADAPTIVE_RATE_PROFILE_FULL) &&
+             (last_state == XENSIV_RADAR_PRESENCE_STATE_ABSENCE) &&
+             ((time_ms - last_state_change_ms) >= ADAPTIVE_RATE_ABSENCE_DWELL_MS))
+    {
+        switch_profile(handle, ADAPTIVE_RATE_PROFILE_SLOW);
+    }
+    else
+    {
+        /* Stay in the current profile */
+    }
+
+    return synthesized;
+}
+
+/*******************************************************************************
+ * Function Name: adaptive_rate_get_profile
+ *******************************************************************************
+ * Summary:
+ *   Returns the active acquisition profile
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   active profile
+ ******************************************************************************/
+adaptive_rate_profile_id_t adaptive_rate_get_profile(void)
+{
+    return profile;
+}
+
+/*******************************************************************************
+ * Function Name: adaptive_rate_get_frame_period_ms
+ *******************************************************************************
+ * Summary:
+ *   Returns the frame period of the active acquisition profile
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   frame period in ms
+ ******************************************************************************/
+uint32_t adaptive_rate_get_frame_period_ms(void)
+{
+    return (profile == ADAPTIVE_RATE_PROFILE_SLOW) ? ADAPTIVE_RATE_SLOW_FRAME_PERIOD_MS : full_period_ms;
+}
+
+/*******************************************************************************
+ * Function Name: adaptive_rate_get_config
+ *******************************************************************************
+ * Summary:
+ *   Reads the presence configuration as set by the user, i.e. without the
+ *   overrides of the active profile and overload level.
+ *
+ * Parameters:
+ *   handle: presence library handle
+ *   config: configuration read
+ *
+ * Return:
+ *   XENSIV_RADAR_PRESENCE_OK on success
+ ******************************************************************************/
+int32_t adaptive_rate_get_config(xensiv_radar_presence_handle_t handle, xensiv_radar_presence_config_t* config)
+{
+    int32_t result = xensiv_radar_presence_get_config(handle, config);
+
+    config->mode = user_fields.mode;
+    config->macro_compare_interval_ms = user_fields.macro_compare_interval_ms;
+    config->micro_fft_decimation_enabled = user_fields.micro_fft_decimation_enabled;
+    config->micro_fft_size = user_fields.micro_fft_size;
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: adaptive_rate_set_config
+ *******************************************************************************
+ * Summary:
+ *   Sets a user configuration. The owned fields are stored and overridden
+ *   again by the active profile and overload level.
+ *
+ * Parameters:
+ *   handle: presence library handle
+ *   config: user configuration
+ *
+ * Return:
+ *   XENSIV_RADAR_PRESENCE_OK on success
+ ******************************************************************************/
+int32_t adaptive_rate_set_config(xensiv_radar_presence_handle_t handle, const xensiv_radar_presence_config_t* config)
+{
+    xensiv_radar_presence_config_t profile_config = *config;
+
+    user_fields_from_config(config);
+    apply_profile_fields(&profile_config, profile);
+
+    return xensiv_radar_presence_set_config(handle, &profile_config);
+}
+
+/*******************************************************************************
+ * Function Name: adaptive_rate_set_overload_level
+ *******************************************************************************
+ * Summary:
+ *   Applies the degradations of a new overload level to the presence library.
+ *   Must be called between two frames with sem_radar_sensing_context taken.
+ *
+ * Parameters:
+ *   handle: presence library handle
+ *   level: new overload level
+ *   time_ms: current time
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void adaptive_rate_set_overload_level(xensiv_radar_presence_handle_t handle, overload_level_t level,
+                                      uint32_t time_ms)
+{
+    bool reconfigure = ((level >= OVERLOAD_LEVEL_MICRO_DECIMATION) != (overload_level >= OVERLOAD_LEVEL_MICRO_DECIMATION)) ||
+                       ((level >= OVERLOAD_LEVEL_MICRO_FFT_SHRINK) != (overload_level >= OVERLOAD_LEVEL_MICRO_FFT_SHRINK));
+
+    overload_level = level;
+
+    /* Frame skipping alone does not touch the library configuration */
+    if (reconfigure && apply_config(handle, profile) &&
+        (last_state != XENSIV_RADAR_PRESENCE_STATE_ABSENCE))
+    {
+        arm_confirmation(handle, time_ms);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: adaptive_rate_hold_full
+ *******************************************************************************
+ * Summary:
+ *   Keeps the full rate profile until released, a running slow scan is left
+ *   at once. Must be called between two frames with sem_radar_sensing_context
+ *   taken.
+ *
+ * Parameters:
+ *   handle: presence library handle
+ *   hold: true to keep the full rate profile, false to release it
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void adaptive_rate_hold_full(xensiv_radar_presence_handle_t handle, bool hold)
+{
+    hold_full = hold;
+
+    /* The slow scan only runs in absence, there is no presence to confirm */
+    if (hold && (profile == ADAPTIVE_RATE_PROFILE_SLOW))
+    {
+        switch_profile(handle, ADAPTIVE_RATE_PROFILE_FULL);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: adaptive_rate_force_mode
+ *******************************************************************************
+ * Summary:
+ *   Runs the presence library in the given mode until released, without
+ *   touching the user configuration: adaptive_rate_get_config still returns
+ *   the user mode and a mode set meanwhile by adaptive_rate_set_config is
+ *   applied on release. Resets the library. Must be called between two
+ *   frames with sem_radar_sensing_context taken.
+ *
+ * Parameters:
+ *   handle: presence library handle
+ *   force: true to run mode, false to return to the user mode
+ *   mode: mode run while forced, ignored on release
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void adaptive_rate_force_mode(xensiv_radar_presence_handle_t handle, bool force, xensiv_radar_presence_mode_t mode)
+{
+    mode_forced = force;
+    forced_mode = mode;
+    (void)apply_config(handle, profile);
+}
+
+/*******************************************************************************
+ * Function Name: adaptive_rate_get_state
+ *******************************************************************************
+ * Summary:
+ *   Returns the last reported presence state.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   presence state
+ ******************************************************************************/
+xensiv_radar_presence_state_t adaptive_rate_get_state(void)
+{
+    return last_state;
+}
+
+/*******************************************************************************
+ * Function Name: adaptive_rate_restore_state
+ *******************************************************************************
+ * Summary:
+ *   Takes over the presence state reported before a reboot. The library
+ *   starts without presence, so a restored presence is not reported again
+ *   when the library detects it and is turned into an absence if the library
+ *   does not confirm it within its validity windows, as after a wake up.
+ *
+ * Parameters:
+ *   handle: presence library handle
+ *   state: presence state reported before the reboot
+ *   time_ms: current time
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void adaptive_rate_restore_state(xensiv_radar_presence_handle_t handle, xensiv_radar_presence_state_t state,
+                                 uint32_t time_ms)
+{
+    last_state = state;
+    last_state_change_ms = time_ms;
+
+    if (state != XENSIV_RADAR_PRESENCE_STATE_ABSENCE)
+    {
+        arm_confirmation(handle, time_ms);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: adaptive_rate_get_stats
+ *******************************************************************************
+ * Summary:
+ *   Returns the duty cycle and latency statistics
+ *
+ * Parameters:
+ *   stats_out: statistics copied
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void adaptive_rate_get_stats(adaptive_rate_stats_t* stats_out)
+{
+    *stats_out = stats;
+}
+
+/* [] END OF FILE */
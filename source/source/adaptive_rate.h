@@ -0,0 +1,102 @@
+/******************************************************************************
+ * File Name:   adaptive_rate.h
+ *
+ * Description: This file contains the function prototypes and constants used
+ *   in adaptive_rate.c.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#pragma once
+
+/* Header file from system */
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Header file for library */
+#include "xensiv_radar_presence.h"
+
+/* Header file for local task */
+#include "overload_governor.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Set to 0 to run the sensor at the full frame rate of register_list at all
+ * times, required with several sensors
+ */
+#ifndef ADAPTIVE_RATE_ENABLED
+#define ADAPTIVE_RATE_ENABLED                   (1)
+#endif
+
+/* Frame period used while the room is confirmed empty */
+#define ADAPTIVE_RATE_SLOW_FRAME_PERIOD_MS      (100u)
+
+/* Time the presence state must stay in absence before the slow scan starts */
+#define ADAPTIVE_RATE_ABSENCE_DWELL_MS          (30000u)
+
+/* Statistics are printed every time this many profile switches happened */
+#define ADAPTIVE_RATE_STATS_PRINT_INTERVAL      (10u)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef enum
+{
+    ADAPTIVE_RATE_PROFILE_FULL = 0,     /* register_list frame rate, user config */
+    ADAPTIVE_RATE_PROFILE_SLOW,         /* software triggered slow scan, macro only */
+    ADAPTIVE_RATE_PROFILE_COUNT
+} adaptive_rate_profile_id_t;
+
+typedef struct
+{
+    uint32_t frames[ADAPTIVE_RATE_PROFILE_COUNT];       /* frames processed per profile */
+    uint32_t time_ms[ADAPTIVE_RATE_PROFILE_COUNT];      /* time spent per profile */
+    uint32_t switches;                                  /* number of profile switches */
+    uint32_t synthesized_absences;                      /* absences issued after an unconfirmed wake up */
+    uint32_t wakeups;                                   /* wake ups confirmed at full rate */
+    uint32_t wake_latency_ms_last;                      /* first slow scan frame with motion -> presence
+                                                         * confirmed at full rate */
+    uint32_t wake_latency_ms_max;
+    uint32_t wake_latency_ms_total;
+} adaptive_rate_stats_t;
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+void adaptive_rate_init(xensiv_radar_presence_handle_t handle, uint32_t full_frame_period_ms);
+bool adaptive_rate_filter_event(const xensiv_radar_presence_event_t* event);
+bool adaptive_rate_update(xensiv_radar_presence_handle_t handle, uint32_t time_ms, bool motion,
+                          xensiv_radar_presence_event_t* synthesized_event);
+adaptive_rate_profile_id_t adaptive_rate_get_profile(void);
+uint32_t adaptive_rate_get_frame_period_ms(void);
+int32_t adaptive_rate_get_config(xensiv_radar_presence_handle_t handle, xensiv_radar_presence_config_t* config);
+int32_t adaptive_rate_set_config(xensiv_radar_presence_handle_t handle, const xensiv_radar_presence_config_t* config);
+void adaptive_rate_set_overload_level(xensiv_radar_presence_handle_t handle, overload_level_t level,
+                                      uint32_t time_ms);
+void adaptive_rate_hold_full(xensiv_radar_presence_handle_t handle, bool hold);
+void adaptive_rate_force_mode(xensiv_radar_presence_handle_t handle, bool force, xensiv_radar_presence_mode_t mode);
+xensiv_radar_presence_state_t adaptive_rate_get_state(void);
+void adaptive_rate_restore_state(xensiv_radar_presence_handle_t handle, xensiv_radar_presence_state_t state,
+                                 uint32_t time_ms);
+void adaptive_rate_get_stats(adaptive_rate_stats_t* stats);
+
+/* [] END OF FILE */
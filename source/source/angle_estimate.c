@@ -0,0 +1,185 @@
+/*****************************************************************************
+ * File name: angle_estimate.c
+ *
+ * Description: This file contains the angle of arrival estimation of the
+ * detected targets from the phase differences between the receive antennas.
+ * The clutter free spectra of an antenna pair are correlated over the range
+ * bins of the target cluster, the phase of the correlation gives the angle
+ * for the antenna spacing. All memory is part of the estimator state.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Header file for local task */
+#include "angle_estimate.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define RAD_TO_DEG                          (57.29578f)
+
+/*******************************************************************************
+ * Function Name: pair_angle
+ *******************************************************************************
+ * Summary:
+ *   Estimates the angle seen by an antenna pair. The cross spectrum is summed
+ *   over the bins of the target so that the stronger bins dominate the phase.
+ *   Only the phase is used, so the scale of the spectrum samples does not
+ *   matter.
+ *
+ * Parameters:
+ *   antenna: profile of the antenna
+ *   reference: profile of the reference antenna
+ *   target: target cluster
+ *   phase_offset: phase difference at boresight in radians
+ *
+ * Return:
+ *   angle in degrees, positive towards the antenna
+ ******************************************************************************/
+static float32_t pair_angle(const range_profile_t* antenna, const range_profile_t* reference,
+                            const target_t* target, float32_t phase_offset)
+{
+    float32_t cross_re = 0.0f;
+    float32_t cross_im = 0.0f;
+    float32_t phase;
+    float32_t sine;
+
+    for (uint32_t bin = target->first_bin; bin <= target->last_bin; ++bin)
+    {
+        float32_t a_re = antenna->residual[2u * bin];
+        float32_t a_im = antenna->residual[(2u * bin) + 1u];
+        float32_t r_re = reference->residual[2u * bin];
+        float32_t r_im = reference->residual[(2u * bin) + 1u];
+
+        /* a * conj(r) */
+        cross_re += (a_re * r_re) + (a_im * r_im);
+        cross_im += (a_im * r_re) - (a_re * r_im);
+    }
+
+    phase = atan2f(cross_im, cross_re) - phase_offset;
+    if (phase > PI)
+    {
+        phase -= 2.0f * PI;
+    }
+    else if (phase < -PI)
+    {
+        phase += 2.0f * PI;
+    }
+    else
+    {
+        /* In range */
+    }
+
+    sine = phase / (2.0f * PI * ANGLE_ESTIMATE_SPACING_WAVELENGTHS);
+    sine = (sine > 1.0f) ? 1.0f : ((sine < -1.0f) ? -1.0f : sine);
+
+    return asinf(sine) * RAD_TO_DEG;
+}
+
+/*******************************************************************************
+ * Function Name: angle_estimate_init
+ *******************************************************************************
+ * Summary:
+ *   Initializes the estimator with the phase offsets of the board.
+ *
+ * Parameters:
+ *   ae: estimator state
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void angle_estimate_init(angle_estimate_t* ae)
+{
+    memset(ae, 0, sizeof(*ae));
+    ae->azimuth_offset = ANGLE_ESTIMATE_AZIMUTH_PHASE_OFFSET;
+    ae->elevation_offset = ANGLE_ESTIMATE_ELEVATION_PHASE_OFFSET;
+}
+
+/*******************************************************************************
+ * Function Name: angle_estimate_process
+ *******************************************************************************
+ * Summary:
+ *   Sets azimuth and elevation of every target of the list.
+ *
+ * Parameters:
+ *   ae: estimator state
+ *   list: targets detected on the profile of the first antenna
+ *   profiles: range profiles of the frame per antenna
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void angle_estimate_process(const angle_estimate_t* ae, target_list_t* list,
+                            const range_profile_t* const profiles[ANGLE_ESTIMATE_NUM_ANTENNAS])
+{
+    const range_profile_t* reference = profiles[ANGLE_ESTIMATE_REFERENCE_RX];
+
+    for (uint32_t i = 0; i < list->count; ++i)
+    {
+        target_t* target = &list->targets[i];
+
+        target->azimuth = pair_angle(profiles[ANGLE_ESTIMATE_AZIMUTH_RX], reference, target, ae->azimuth_offset);
+        target->elevation = pair_angle(profiles[ANGLE_ESTIMATE_ELEVATION_RX], reference, target,
+                                       ae->elevation_offset);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: angle_estimate_account
+ *******************************************************************************
+ * Summary:
+ *   Records the cycles the caller measured for the range processing of the
+ *   additional antennas and the angle estimation of one frame and prints the
+ *   statistics periodically.
+ *
+ * Parameters:
+ *   ae: estimator state
+ *   cycles: measured cycles
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void angle_estimate_account(angle_estimate_t* ae, uint32_t cycles)
+{
+    angle_estimate_stats_t* stats = &ae->stats;
+
+    ++stats->frames;
+    stats->last_cycles = cycles;
+    stats->total_cycles += cycles;
+    if (cycles > stats->max_cycles)
+    {
+        stats->max_cycles = cycles;
+    }
+
+    if ((stats->frames % ANGLE_ESTIMATE_STATS_PRINT_INTERVAL) == 0u)
+    {
+        printf("[INFO] angle estimation %" PRIu32 " antennas: avg %" PRIu32 " max %" PRIu32 " cycles per frame\n",
+               ANGLE_ESTIMATE_NUM_ANTENNAS, (uint32_t)(stats->total_cycles / stats->frames), stats->max_cycles);
+    }
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,94 @@
+/******************************************************************************
+ * File Name:   angle_estimate.h
+ *
+ * Description: This file contains the function prototypes and constants used
+ *   in angle_estimate.c.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+
+#pragma once
+
+/* Header file from system */
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Header file for library */
+#include "arm_math.h"
+
+/* Header file for local task */
+#include "range_fft.h"
+#include "target_detect.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Set to 0 to skip the angle estimation when the acquisition profile has
+ * ANGLE_ESTIMATE_NUM_ANTENNAS receive antennas
+ */
+#define ANGLE_ESTIMATE_ENABLED              (1)
+
+/* Receive antennas of the BGT60TR13C. RX1 and RX3 form the horizontal pair,
+ * RX2 and RX3 the vertical pair, both spaced by half a wavelength.
+ */
+#define ANGLE_ESTIMATE_NUM_ANTENNAS         (3u)
+#define ANGLE_ESTIMATE_AZIMUTH_RX           (0u)
+#define ANGLE_ESTIMATE_ELEVATION_RX         (1u)
+#define ANGLE_ESTIMATE_REFERENCE_RX         (2u)
+#define ANGLE_ESTIMATE_SPACING_WAVELENGTHS  (0.5f)
+
+/* Phase differences in radians measured with a target at boresight, they
+ * compensate the routing of the antennas on the board
+ */
+#define ANGLE_ESTIMATE_AZIMUTH_PHASE_OFFSET   (0.0f)
+#define ANGLE_ESTIMATE_ELEVATION_PHASE_OFFSET (0.0f)
+
+/* Statistics are printed every time this many frames have been processed */
+#define ANGLE_ESTIMATE_STATS_PRINT_INTERVAL (2000u)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef struct
+{
+    uint32_t frames;
+    uint32_t last_cycles;
+    uint32_t max_cycles;
+    uint64_t total_cycles;
+} angle_estimate_stats_t;
+
+typedef struct
+{
+    float32_t azimuth_offset;
+    float32_t elevation_offset;
+    angle_estimate_stats_t stats;
+} angle_estimate_t;
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+void angle_estimate_init(angle_estimate_t* ae);
+void angle_estimate_process(const angle_estimate_t* ae, target_list_t* list,
+                            const range_profile_t* const profiles[ANGLE_ESTIMATE_NUM_ANTENNAS]);
+void angle_estimate_account(angle_estimate_t* ae, uint32_t cycles);
+
+/* [] END OF FILE */
@@ -0,0 +1,560 @@
+/*****************************************************************************
+ * File name: config_store.c
+ *
+ * Description: This file contains the persistent store of the presence
+ * configuration. Every record holds the whole configuration with a version,
+ * a sequence number and a CRC, and is written to the next of a few slots so
+ * the wear is spread over several flash pages. Changes are coalesced until
+ * the configuration has been stable for a while, and writes are spaced out
+ * to protect the flash endurance. The storage is a backend, the work flash
+ * on the target or a file for builds running on a host.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Header file for local task */
+#include "config_store.h"
+
+/* Header file for library, after config_store.h that selects the backend */
+#if (CONFIG_STORE_BACKEND_FILE == 0)
+#include "cyhal.h"
+#endif
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+#if (CONFIG_STORE_BACKEND_FILE == 0)
+/* Placed in the work flash by the linker scripts */
+CY_SECTION(".cy_em_eeprom") CY_ALIGN(CONFIG_STORE_FLASH_PAGE_SIZE)
+static const uint8_t flash_slots[CONFIG_STORE_SLOTS][CONFIG_STORE_FLASH_PAGE_SIZE] = {{0}};
+
+static cyhal_flash_t flash_obj;
+
+/* cyhal_flash_write takes a whole page */
+static uint32_t flash_page[CONFIG_STORE_FLASH_PAGE_SIZE / sizeof(uint32_t)];
+#endif
+
+/*******************************************************************************
+ * Function Name: config_store_crc32
+ *******************************************************************************
+ * Summary:
+ *   Computes the CRC-32 (IEEE 802.3) of a buffer bit by bit, the records are
+ *   only checked at boot and written rarely.
+ *
+ * Parameters:
+ *   data: buffer
+ *   size: bytes in the buffer
+ *
+ * Return:
+ *   CRC-32
+ ******************************************************************************/
+uint32_t config_store_crc32(const void* data, uint32_t size)
+{
+    const uint8_t* bytes = (const uint8_t*)data;
+    uint32_t crc = 0xFFFFFFFFu;
+
+    for (uint32_t i = 0; i < size; ++i)
+    {
+        crc ^= bytes[i];
+        for (uint32_t bit = 0; bit < 8u; ++bit)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+
+    return ~crc;
+}
+
+/*******************************************************************************
+ * Function Name: config_equal
+ *******************************************************************************
+ * Summary:
+ *   Compares two presence configurations field by field, the padding of the
+ *   structures is not defined.
+ *
+ * Parameters:
+ *   a: first configuration
+ *   b: second configuration
+ *
+ * Return:
+ *   true if all fields are equal
+ ******************************************************************************/
+static bool config_equal(const xensiv_radar_presence_config_t* a, const xensiv_radar_presence_config_t* b)
+{
+    return (a->bandwidth == b->bandwidth) &&
+           (a->num_samples_per_chirp == b->num_samples_per_chirp) &&
+           (a->micro_fft_decimation_enabled == b->micro_fft_decimation_enabled) &&
+           (a->micro_fft_size == b->micro_fft_size) &&
+           (a->macro_threshold == b->macro_threshold) &&
+           (a->micro_threshold == b->micro_threshold) &&
+           (a->min_range_bin == b->min_range_bin) &&
+           (a->max_range_bin == b->max_range_bin) &&
+           (a->macro_compare_interval_ms == b->macro_compare_interval_ms) &&
+           (a->macro_movement_validity_ms == b->macro_movement_validity_ms) &&
+           (a->micro_movement_validity_ms == b->micro_movement_validity_ms) &&
+           (a->macro_movement_confirmations == b->macro_movement_confirmations) &&
+           (a->macro_trigger_range == b->macro_trigger_range) &&
+           (a->mode == b->mode) &&
+           (a->macro_fft_bandpass_filter_enabled == b->macro_fft_bandpass_filter_enabled) &&
+           (a->micro_movement_compare_idx == b->micro_movement_compare_idx);
+}
+
+/*******************************************************************************
+ * Function Name: record_valid
+ *******************************************************************************
+ * Summary:
+ *   Checks the header and the CRC of a record read from a slot.
+ *
+ * Parameters:
+ *   record: record
+ *
+ * Return:
+ *   true if the record can be used
+ ******************************************************************************/
+static bool record_valid(const config_store_record_t* record)
+{
+    return (record->magic == CONFIG_STORE_MAGIC) &&
+           (record->version == CONFIG_STORE_VERSION) &&
+           (record->size == sizeof(config_store_record_t)) &&
+           (record->crc == config_store_crc32(record, offsetof(config_store_record_t, crc)));
+}
+
+#if (CONFIG_STORE_BACKEND_FILE != 0)
+/*******************************************************************************
+ * Function Name: file_open
+ *******************************************************************************
+ * Summary:
+ *   Creates the file of the file backend if it does not exist.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   number of slots, 0 on failure
+ ******************************************************************************/
+static uint32_t file_open(void)
+{
+    FILE* file = fopen(CONFIG_STORE_FILE_PATH, "ab");
+
+    if (file == NULL)
+    {
+        return 0;
+    }
+
+    fclose(file);
+    return CONFIG_STORE_SLOTS;
+}
+
+/*******************************************************************************
+ * Function Name: file_read
+ *******************************************************************************
+ * Summary:
+ *   Reads a slot of the file backend, a slot past the end of the file fails.
+ *
+ * Parameters:
+ *   slot: slot number
+ *   data: destination
+ *   size: bytes to read
+ *
+ * Return:
+ *   true if the bytes were read
+ ******************************************************************************/
+static bool file_read(uint32_t slot, void* data, uint32_t size)
+{
+    FILE* file = fopen(CONFIG_STORE_FILE_PATH, "rb");
+    bool result = false;
+
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    if (fseek(file, (long)(slot * CONFIG_STORE_FLASH_PAGE_SIZE), SEEK_SET) == 0)
+    {
+        result = (fread(data, 1, size, file) == size);
+    }
+
+    fclose(file);
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: file_write
+ *******************************************************************************
+ * Summary:
+ *   Writes a slot of the file backend.
+ *
+ * Parameters:
+ *   slot: slot number
+ *   data: source
+ *   size: bytes to write
+ *
+ * Return:
+ *   true if the bytes were written
+ ******************************************************************************/
+static bool file_write(uint32_t slot, const void* data, uint32_t size)
+{
+    FILE* file = fopen(CONFIG_STORE_FILE_PATH, "r+b");
+    bool result = false;
+
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    if (fseek(file, (long)(slot * CONFIG_STORE_FLASH_PAGE_SIZE), SEEK_SET) == 0)
+    {
+        result = (fwrite(data, 1, size, file) == size) && (fflush(file) == 0);
+    }
+
+    fclose(file);
+    return result;
+}
+
+const config_store_backend_t config_store_file_backend =
+{
+    .open = file_open,
+    .read = file_read,
+    .write = file_write
+};
+#else
+/*******************************************************************************
+ * Function Name: flash_open
+ *******************************************************************************
+ * Summary:
+ *   Initializes the flash driver and checks the page size of the work flash.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   number of slots, 0 on failure
+ ******************************************************************************/
+static uint32_t flash_open(void)
+{
+    cyhal_flash_info_t info;
+    uint32_t address = (uint32_t)(uintptr_t)&flash_slots[0][0];
+
+    if (cyhal_flash_init(&flash_obj) != CY_RSLT_SUCCESS)
+    {
+        return 0;
+    }
+
+    cyhal_flash_get_info(&flash_obj, &info);
+    for (uint32_t i = 0; i < info.block_count; ++i)
+    {
+        const cyhal_flash_block_info_t* block = &info.blocks[i];
+
+        if ((address >= block->start_address) && (address < (block->start_address + block->size)))
+        {
+            return (block->page_size == CONFIG_STORE_FLASH_PAGE_SIZE) ? CONFIG_STORE_SLOTS : 0u;
+        }
+    }
+
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: flash_read
+ *******************************************************************************
+ * Summary:
+ *   Reads the start of a flash slot.
+ *
+ * Parameters:
+ *   slot: slot number
+ *   data: destination
+ *   size: bytes to read
+ *
+ * Return:
+ *   true if the bytes were read
+ ******************************************************************************/
+static bool flash_read(uint32_t slot, void* data, uint32_t size)
+{
+    return cyhal_flash_read(&flash_obj, (uint32_t)(uintptr_t)&flash_slots[slot][0], (uint8_t*)data, size) == CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: flash_write
+ *******************************************************************************
+ * Summary:
+ *   Erases and programs a flash slot. The flash is not readable while the
+ *   page is written, which stalls the code running from flash for a few ms.
+ *
+ * Parameters:
+ *   slot: slot number
+ *   data: source
+ *   size: bytes to write, at most one page
+ *
+ * Return:
+ *   true if the page was written
+ ******************************************************************************/
+static bool flash_write(uint32_t slot, const void* data, uint32_t size)
+{
+    if (size > CONFIG_STORE_FLASH_PAGE_SIZE)
+    {
+        return false;
+    }
+
+    memset(flash_page, 0, sizeof(flash_page));
+    memcpy(flash_page, data, size);
+
+    return cyhal_flash_write(&flash_obj, (uint32_t)(uintptr_t)&flash_slots[slot][0], flash_page) == CY_RSLT_SUCCESS;
+}
+
+const config_store_backend_t config_store_flash_backend =
+{
+    .open = flash_open,
+    .read = flash_read,
+    .write = flash_write
+};
+#endif
+
+/*******************************************************************************
+ * Function Name: config_store_init
+ *******************************************************************************
+ * Summary:
+ *   Opens the backend of the store. A store whose backend cannot be opened
+ *   loads nothing and drops every change.
+ *
+ * Parameters:
+ *   store: store state
+ *   backend: storage, see CONFIG_STORE_BACKEND
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void config_store_init(config_store_t* store, const config_store_backend_t* backend)
+{
+    memset(store, 0, sizeof(*store));
+    store->backend = backend;
+    store->num_slots = backend->open();
+
+    if (store->num_slots == 0u)
+    {
+        printf("[WARN] config store: backend not available, the configuration is not persisted\n");
+    }
+}
+
+/*******************************************************************************
+ * Function Name: config_store_load
+ *******************************************************************************
+ * Summary:
+ *   Reads every slot and returns the configuration of the valid record with
+ *   the newest sequence, which wraps around. The next write goes to the slot
+ *   after it.
+ *
+ * Parameters:
+ *   store: store state
+ *   config: loaded configuration, unchanged if no record is valid
+ *
+ * Return:
+ *   true if a configuration was loaded
+ ******************************************************************************/
+bool config_store_load(config_store_t* store, xensiv_radar_presence_config_t* config)
+{
+    config_store_record_t record;
+
+    for (uint32_t slot = 0; slot < store->num_slots; ++slot)
+    {
+        if (!store->backend->read(slot, &record, sizeof(record)) || !record_valid(&record))
+        {
+            continue;
+        }
+
+        /* Compared modulo 2^32, the slots hold consecutive sequences */
+        if (!store->stored_valid || ((int32_t)(record.sequence - store->sequence) > 0))
+        {
+            store->stored_valid = true;
+            store->stored = record.config;
+            store->sequence = record.sequence;
+            store->next_slot = (slot + 1u) % store->num_slots;
+        }
+    }
+
+    if (!store->stored_valid)
+    {
+        return false;
+    }
+
+    *config = store->stored;
+    printf("[INFO] config store: loaded sequence %" PRIu32 ", next slot %" PRIu32 "\n", store->sequence,
+           store->next_slot);
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: config_store_save
+ *******************************************************************************
+ * Summary:
+ *   Records the configuration in use. Nothing is written here; a change is
+ *   written by config_store_poll once it has been stable for
+ *   CONFIG_STORE_COALESCE_MS, so a burst of changes costs one write and a
+ *   change that is undone costs none.
+ *
+ * Parameters:
+ *   store: store state
+ *   config: configuration in use
+ *   time_ms: current time
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void config_store_save(config_store_t* store, const xensiv_radar_presence_config_t* config, uint32_t time_ms)
+{
+    if (store->dirty && config_equal(config, &store->pending))
+    {
+        return;
+    }
+
+    if (store->stored_valid && config_equal(config, &store->stored))
+    {
+        if (store->dirty)
+        {
+            store->dirty = false;
+            ++store->stats.coalesced;
+        }
+        return;
+    }
+
+    if (store->dirty)
+    {
+        ++store->stats.coalesced;
+    }
+
+    store->pending = *config;
+    store->dirty = true;
+    store->change_ms = time_ms;
+}
+
+/*******************************************************************************
+ * Function Name: config_store_pending
+ *******************************************************************************
+ * Summary:
+ *   Tells if a change waits to be written.
+ *
+ * Parameters:
+ *   store: store state
+ *
+ * Return:
+ *   true if config_store_poll has to be called
+ ******************************************************************************/
+bool config_store_pending(const config_store_t* store)
+{
+    return store->dirty && (store->num_slots > 0u);
+}
+
+/*******************************************************************************
+ * Function Name: config_store_poll
+ *******************************************************************************
+ * Summary:
+ *   Writes the pending change once it has been stable for
+ *   CONFIG_STORE_COALESCE_MS and the last write is CONFIG_STORE_MIN_INTERVAL_MS
+ *   old.
+ *
+ * Parameters:
+ *   store: store state
+ *   time_ms: current time
+ *
+ * Return:
+ *   true if a record was written
+ ******************************************************************************/
+bool config_store_poll(config_store_t* store, uint32_t time_ms)
+{
+    if (!config_store_pending(store) || ((time_ms - store->change_ms) < CONFIG_STORE_COALESCE_MS))
+    {
+        return false;
+    }
+
+    if (store->written && ((time_ms - store->last_write_ms) < CONFIG_STORE_MIN_INTERVAL_MS))
+    {
+        return false;
+    }
+
+    return config_store_flush(store, time_ms);
+}
+
+/*******************************************************************************
+ * Function Name: config_store_flush
+ *******************************************************************************
+ * Summary:
+ *   Writes the pending change now, e.g. before a controlled shutdown. A
+ *   failed write leaves the change pending and moves on to the next slot.
+ *
+ * Parameters:
+ *   store: store state
+ *   time_ms: current time
+ *
+ * Return:
+ *   true if a record was written
+ ******************************************************************************/
+bool config_store_flush(config_store_t* store, uint32_t time_ms)
+{
+    config_store_record_t record;
+    uint32_t slot = store->next_slot;
+    bool result;
+
+    if (!config_store_pending(store))
+    {
+        return false;
+    }
+
+    memset(&record, 0, sizeof(record));
+    record.magic = CONFIG_STORE_MAGIC;
+    record.version = CONFIG_STORE_VERSION;
+    record.size = (uint16_t)sizeof(record);
+    record.sequence = store->sequence + 1u;
+    record.config = store->pending;
+    record.crc = config_store_crc32(&record, offsetof(config_store_record_t, crc));
+
+    result = store->backend->write(slot, &record, sizeof(record));
+
+    store->next_slot = (slot + 1u) % store->num_slots;
+    store->written = true;
+    store->last_write_ms = time_ms;
+
+    if (result)
+    {
+        store->stored = store->pending;
+        store->stored_valid = true;
+        store->sequence = record.sequence;
+        store->dirty = false;
+        ++store->stats.writes;
+    }
+    else
+    {
+        ++store->stats.failures;
+    }
+
+    printf("[%s] config store: slot %" PRIu32 " sequence %" PRIu32 ", %" PRIu32 " writes %" PRIu32
+           " coalesced %" PRIu32 " failures\n", result ? "INFO" : "WARN", slot, record.sequence,
+           store->stats.writes, store->stats.coalesced, store->stats.failures);
+
+    return result;
+}
+
+/* [] END OF FILE */
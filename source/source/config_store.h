@@ -0,0 +1,142 @@
+/******************************************************************************
+ * File Name:   config_store.h
+ *
+ * Description: This file contains the function prototypes and constants used
+ *   in config_store.c.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#pragma once
+
+/* Header file from system */
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Header file for library */
+#include "xensiv_radar_presence.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Set to 0 to always boot with the default configuration */
+#define CONFIG_STORE_ENABLED                (1)
+
+/* Set to 1 to keep the records in a file instead of the work flash, for
+ * builds running on a host
+ */
+#ifndef CONFIG_STORE_BACKEND_FILE
+#define CONFIG_STORE_BACKEND_FILE           (0)
+#endif
+
+/* File of the file backend */
+#ifndef CONFIG_STORE_FILE_PATH
+#define CONFIG_STORE_FILE_PATH              "radar_config.bin"
+#endif
+
+/* Layout of config_store_record_t, records of another version are ignored */
+#define CONFIG_STORE_VERSION                (1u)
+#define CONFIG_STORE_MAGIC                  (0x47464352u)   /* "RCFG" */
+
+/* Records are written round robin to this many slots, one flash page each */
+#define CONFIG_STORE_SLOTS                  (8u)
+
+/* Flash page of the work flash, erased and programmed at once */
+#define CONFIG_STORE_FLASH_PAGE_SIZE        (512u)
+
+/* A change is written once the configuration has not changed for this long */
+#define CONFIG_STORE_COALESCE_MS            (10000u)
+
+/* Shortest time between two writes */
+#define CONFIG_STORE_MIN_INTERVAL_MS        (60000u)
+
+/* radar_config_task compares the configuration in use with the store this often */
+#define CONFIG_STORE_POLL_MS                (1000u)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+/* Storage of the records, slots are numbered from 0 */
+typedef struct
+{
+    uint32_t (*open)(void);             /* returns the number of slots, 0 on failure */
+    bool (*read)(uint32_t slot, void* data, uint32_t size);
+    bool (*write)(uint32_t slot, const void* data, uint32_t size);
+} config_store_backend_t;
+
+typedef struct
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;                      /* of the record */
+    uint32_t sequence;                  /* the valid record with the newest sequence is current */
+    xensiv_radar_presence_config_t config;
+    uint32_t crc;                       /* CRC-32 of all previous bytes */
+} config_store_record_t;
+
+typedef struct
+{
+    uint32_t writes;
+    uint32_t coalesced;                 /* changes merged into a later write */
+    uint32_t failures;
+} config_store_stats_t;
+
+typedef struct
+{
+    const config_store_backend_t* backend;
+    uint32_t num_slots;                 /* 0 if the backend could not be opened */
+    uint32_t next_slot;
+    uint32_t sequence;
+
+    xensiv_radar_presence_config_t stored;
+    bool stored_valid;
+    xensiv_radar_presence_config_t pending;
+    bool dirty;
+    uint32_t change_ms;
+    bool written;
+    uint32_t last_write_ms;
+
+    config_store_stats_t stats;
+} config_store_t;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+#if (CONFIG_STORE_BACKEND_FILE != 0)
+extern const config_store_backend_t config_store_file_backend;
+#define CONFIG_STORE_BACKEND                (&config_store_file_backend)
+#else
+extern const config_store_backend_t config_store_flash_backend;
+#define CONFIG_STORE_BACKEND                (&config_store_flash_backend)
+#endif
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+void config_store_init(config_store_t* store, const config_store_backend_t* backend);
+bool config_store_load(config_store_t* store, xensiv_radar_presence_config_t* config);
+void config_store_save(config_store_t* store, const xensiv_radar_presence_config_t* config, uint32_t time_ms);
+bool config_store_pending(const config_store_t* store);
+bool config_store_poll(config_store_t* store, uint32_t time_ms);
+bool config_store_flush(config_store_t* store, uint32_t time_ms);
+uint32_t config_store_crc32(const void* data, uint32_t size);
+
+/* [] END OF FILE */
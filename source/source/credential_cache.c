@@ -0,0 +1,383 @@
+/*****************************************************************************
+ * File name: credential_cache.c
+ *
+ * Description: This file contains the cache of the TLS credentials. The
+ * client certificate, the private key and the root CA are provisioned as
+ * blobs of a fixed size in flash, and the MQTT library parses them on every
+ * connect. The cache finds their real lengths and parses and validates
+ * them once at boot. The root CA stays parsed as the global trusted CA of
+ * the TLS layer. The certificate and key are kept as DER with their exact
+ * lengths, which the library parses without the PEM decoding.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+
+/* Header file from system */
+#include <inttypes.h>
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Header file for library */
+#include "cy_tls.h"
+#include "mbedtls/pk.h"
+#include "mbedtls/platform_util.h"
+#include "mbedtls/x509_crt.h"
+
+/* Header file for local task */
+#include "credential_cache.h"
+#include "cycle_counter.h"
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static credential_cache_stats_t cache_stats;
+
+/* DER of the client certificate and private key, NULL if not cached */
+static uint8_t* client_cert_der = NULL;
+static uint8_t* private_key_der = NULL;
+static bool root_ca_loaded = false;
+
+/*******************************************************************************
+ * Function Name: blob_length
+ *******************************************************************************
+ * Summary:
+ *   Finds the length of a provisioned blob. A DER blob is a SEQUENCE whose
+ *   length is in its header. A PEM blob ends with a NUL, which mbed TLS
+ *   needs to tell it from DER.
+ *
+ * Parameters:
+ *   blob: provisioned blob
+ *   max_size: size of the blob in flash
+ *
+ * Return:
+ *   length, 0 if the blob is empty or does not fit
+ ******************************************************************************/
+static uint32_t blob_length(const uint8_t* blob, uint32_t max_size)
+{
+    uint32_t length;
+
+    if ((blob == NULL) || (max_size < 4u))
+    {
+        return 0u;
+    }
+
+    if (blob[0] == 0x30u)
+    {
+        if (blob[1] < 0x80u)
+        {
+            length = 2u + blob[1];
+        }
+        else if (blob[1] == 0x81u)
+        {
+            length = 3u + blob[2];
+        }
+        else if (blob[1] == 0x82u)
+        {
+            length = 4u + (((uint32_t)blob[2] << 8) | blob[3]);
+        }
+        else
+        {
+            return 0u;
+        }
+
+        return (length <= max_size) ? length : 0u;
+    }
+
+    length = (uint32_t)strnlen((const char*)blob, max_size);
+
+    return ((length > 0u) && (length < max_size)) ? (length + 1u) : 0u;
+}
+
+/*******************************************************************************
+ * Function Name: heap_in_use
+ *******************************************************************************
+ * Summary:
+ *   Returns the heap in use, mbed TLS and FreeRTOS (heap_3) both allocate
+ *   from the heap of the C library.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   bytes in use
+ ******************************************************************************/
+static int32_t heap_in_use(void)
+{
+    struct mallinfo info = mallinfo();
+
+    return (int32_t)info.uordblks;
+}
+
+/*******************************************************************************
+ * Function Name: parse_identity
+ *******************************************************************************
+ * Summary:
+ *   Parses a client certificate and its private key as the TLS layer does
+ *   on every connect.
+ *
+ * Parameters:
+ *   cert: parsed certificate, initialized by the caller
+ *   key: parsed key, initialized by the caller
+ *   cert_blob: certificate
+ *   cert_length: length of cert_blob
+ *   key_blob: private key
+ *   key_length: length of key_blob
+ *
+ * Return:
+ *   true if both were parsed and the key belongs to the certificate
+ ******************************************************************************/
+static bool parse_identity(mbedtls_x509_crt* cert, mbedtls_pk_context* key, const uint8_t* cert_blob,
+                           uint32_t cert_length, const uint8_t* key_blob, uint32_t key_length)
+{
+    return (mbedtls_x509_crt_parse(cert, cert_blob, cert_length) == 0) &&
+           (mbedtls_pk_parse_key(key, key_blob, key_length, NULL, 0) == 0) &&
+           (mbedtls_pk_check_pair(&cert->pk, key) == 0);
+}
+
+/*******************************************************************************
+ * Function Name: cache_identity
+ *******************************************************************************
+ * Summary:
+ *   Copies the DER of a parsed certificate and private key to the heap.
+ *
+ * Parameters:
+ *   cert: parsed certificate
+ *   key: parsed private key
+ *   max_size: largest DER of the key
+ *
+ * Return:
+ *   true if both were copied
+ ******************************************************************************/
+static bool cache_identity(const mbedtls_x509_crt* cert, mbedtls_pk_context* key, uint32_t max_size)
+{
+    uint8_t* buffer = malloc(max_size);
+    int length;
+
+    if (buffer == NULL)
+    {
+        return false;
+    }
+
+    /* mbedtls_pk_write_key_der writes at the end of the buffer */
+    length = mbedtls_pk_write_key_der(key, buffer, max_size);
+    if (length > 0)
+    {
+        client_cert_der = malloc(cert->raw.len);
+        private_key_der = malloc((size_t)length);
+    }
+
+    if ((client_cert_der != NULL) && (private_key_der != NULL))
+    {
+        memcpy(client_cert_der, cert->raw.p, cert->raw.len);
+        memcpy(private_key_der, &buffer[max_size - (uint32_t)length], (size_t)length);
+        /* From here on the lengths of the DER */
+        cache_stats.client_cert_size = (uint32_t)cert->raw.len;
+        cache_stats.private_key_size = (uint32_t)length;
+    }
+    else
+    {
+        free(client_cert_der);
+        free(private_key_der);
+        client_cert_der = NULL;
+        private_key_der = NULL;
+    }
+
+    mbedtls_platform_zeroize(buffer, max_size);
+    free(buffer);
+
+    return (client_cert_der != NULL);
+}
+
+/*******************************************************************************
+ * Function Name: release_cache
+ *******************************************************************************
+ * Summary:
+ *   Releases the global root CA and frees the cached DER, the key is erased
+ *   first.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void release_cache(void)
+{
+    if (root_ca_loaded)
+    {
+        (void)cy_tls_release_global_root_ca_certificates();
+        root_ca_loaded = false;
+    }
+
+    if (private_key_der != NULL)
+    {
+        mbedtls_platform_zeroize(private_key_der, cache_stats.private_key_size);
+    }
+    free(private_key_der);
+    free(client_cert_der);
+    private_key_der = NULL;
+    client_cert_der = NULL;
+}
+
+/*******************************************************************************
+ * Function Name: credential_cache_init
+ *******************************************************************************
+ * Summary:
+ *   Finds the real lengths of the provisioned blobs and, with
+ *   CREDENTIAL_CACHE_ENABLED, parses and validates them once: the private
+ *   key must belong to the client certificate. The root CA is loaded as the
+ *   global trusted CA of the TLS layer and removed from the credentials, and
+ *   the certificate and key are replaced by their DER. The time each connect
+ *   saves and the heap kept are printed. On failure the credentials point to
+ *   the blobs with their real lengths. Call after cy_mqtt_init and before
+ *   cy_mqtt_create.
+ *
+ * Parameters:
+ *   credentials: credentials of the MQTT connection
+ *   max_size: size of each blob in flash
+ *
+ * Return:
+ *   true if the credentials are cached
+ ******************************************************************************/
+bool credential_cache_init(cy_awsport_ssl_credentials_t* credentials, uint32_t max_size)
+{
+    const uint8_t* client_cert = (const uint8_t*)credentials->client_cert;
+    const uint8_t* private_key = (const uint8_t*)credentials->private_key;
+    const uint8_t* root_ca = (const uint8_t*)credentials->root_ca;
+    int32_t heap_start = heap_in_use();
+    mbedtls_x509_crt root;
+    mbedtls_x509_crt cert;
+    mbedtls_pk_context key;
+    uint32_t start;
+    bool result;
+
+    memset(&cache_stats, 0, sizeof(cache_stats));
+    cache_stats.client_cert_size = blob_length(client_cert, max_size);
+    cache_stats.private_key_size = blob_length(private_key, max_size);
+    cache_stats.root_ca_size = blob_length(root_ca, max_size);
+
+    /* An unrecognized blob is handed over as before */
+    credentials->client_cert_size = (cache_stats.client_cert_size > 0u) ? cache_stats.client_cert_size : max_size;
+    credentials->private_key_size = (cache_stats.private_key_size > 0u) ? cache_stats.private_key_size : max_size;
+    credentials->root_ca_size = (cache_stats.root_ca_size > 0u) ? cache_stats.root_ca_size : max_size;
+
+    printf("[INFO] credentials: certificate %" PRIu32 ", key %" PRIu32 ", root CA %" PRIu32 " of %" PRIu32
+           " bytes\n", cache_stats.client_cert_size, cache_stats.private_key_size, cache_stats.root_ca_size, max_size);
+
+#if (CREDENTIAL_CACHE_ENABLED == 0)
+    return false;
+#endif
+
+    if ((cache_stats.client_cert_size == 0u) || (cache_stats.private_key_size == 0u) ||
+        (cache_stats.root_ca_size == 0u))
+    {
+        printf("[WARN] credentials: unrecognized blob, not cached\n");
+        return false;
+    }
+
+    cycle_counter_init();
+    mbedtls_x509_crt_init(&root);
+    mbedtls_x509_crt_init(&cert);
+    mbedtls_pk_init(&key);
+
+    /* What every connect did so far */
+    start = cycle_counter_get();
+    result = (mbedtls_x509_crt_parse(&root, root_ca, cache_stats.root_ca_size) == 0);
+    cache_stats.root_ca_parse_us = cycle_counter_to_us(cycle_counter_elapsed(start));
+    result = result && parse_identity(&cert, &key, client_cert, cache_stats.client_cert_size, private_key,
+                                      cache_stats.private_key_size);
+    cache_stats.blob_parse_us = cycle_counter_to_us(cycle_counter_elapsed(start));
+
+    result = result && cache_identity(&cert, &key, max_size);
+
+    mbedtls_pk_free(&key);
+    mbedtls_x509_crt_free(&cert);
+    mbedtls_x509_crt_free(&root);
+
+    if (!result)
+    {
+        printf("[WARN] credentials: parsing or validation failed, not cached\n");
+        return false;
+    }
+
+    /* What every connect does now */
+    mbedtls_x509_crt_init(&cert);
+    mbedtls_pk_init(&key);
+    start = cycle_counter_get();
+    result = parse_identity(&cert, &key, client_cert_der, cache_stats.client_cert_size, private_key_der,
+                            cache_stats.private_key_size);
+    cache_stats.der_parse_us = cycle_counter_to_us(cycle_counter_elapsed(start));
+    mbedtls_pk_free(&key);
+    mbedtls_x509_crt_free(&cert);
+
+    root_ca_loaded = result && (cy_tls_load_global_root_ca_certificates(credentials->root_ca,
+                                                                        cache_stats.root_ca_size) == CY_RSLT_SUCCESS);
+    if (!root_ca_loaded)
+    {
+        printf("[WARN] credentials: global root CA failed, not cached\n");
+        release_cache();
+        return false;
+    }
+
+    credentials->client_cert = (const char*)client_cert_der;
+    credentials->client_cert_size = cache_stats.client_cert_size;
+    credentials->private_key = (const char*)private_key_der;
+    credentials->private_key_size = cache_stats.private_key_size;
+    credentials->root_ca = NULL;
+    credentials->root_ca_size = 0;
+
+    cache_stats.retained_bytes = heap_in_use() - heap_start;
+
+    printf("[INFO] credentials: cached, %" PRIu32 " us of parsing per connect instead of %" PRIu32
+           " us (root CA %" PRIu32 " us, parsed once), %" PRId32 " bytes of heap kept\n",
+           cache_stats.der_parse_us, cache_stats.blob_parse_us, cache_stats.root_ca_parse_us,
+           cache_stats.retained_bytes);
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: credential_cache_free
+ *******************************************************************************
+ * Summary:
+ *   Releases the cache and clears the credentials, which must not be used
+ *   afterwards.
+ *
+ * Parameters:
+ *   credentials: credentials of the MQTT connection
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void credential_cache_free(cy_awsport_ssl_credentials_t* credentials)
+{
+    release_cache();
+
+    credentials->client_cert = NULL;
+    credentials->client_cert_size = 0;
+    credentials->private_key = NULL;
+    credentials->private_key_size = 0;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,68 @@
+/******************************************************************************
+ * File Name:   credential_cache.h
+ *
+ * Description: This file contains the function prototypes and constants used
+ *   in credential_cache.c.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+
+#pragma once
+
+/* Header file from system */
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Header file for library */
+#include "cy_mqtt_api.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Set to 0 to hand the provisioned blobs to the MQTT library as they are */
+#ifndef CREDENTIAL_CACHE_ENABLED
+#define CREDENTIAL_CACHE_ENABLED            (1)
+#endif
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef struct
+{
+    /* Lengths of the provisioned blobs, including the NUL of PEM */
+    uint32_t client_cert_size;
+    uint32_t private_key_size;
+    uint32_t root_ca_size;
+
+    uint32_t blob_parse_us;             /* all three blobs, parsed by every connect before */
+    uint32_t der_parse_us;              /* the cached identity, parsed by every connect now */
+    uint32_t root_ca_parse_us;          /* part of blob_parse_us, now parsed once */
+    int32_t retained_bytes;             /* heap kept by the cache and the global root CA */
+} credential_cache_stats_t;
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+bool credential_cache_init(cy_awsport_ssl_credentials_t* credentials, uint32_t max_size);
+void credential_cache_free(cy_awsport_ssl_credentials_t* credentials);
+
+/* [] END OF FILE */
@@ -0,0 +1,60 @@
+/******************************************************************************
+ * File Name:   cycle_counter.h
+ *
+ * Description: This file contains inline helpers around the DWT cycle counter
+ *   of the Cortex-M4 used to measure processing time.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#pragma once
+
+/* Header file includes */
+#include <stdint.h>
+#include "cybsp.h"
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+/* Enables the free running cycle counter, safe to call more than once */
+static inline void cycle_counter_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static inline uint32_t cycle_counter_get(void)
+{
+    return DWT->CYCCNT;
+}
+
+/* Elapsed cycles since start, wraps correctly within 2^32 cycles */
+static inline uint32_t cycle_counter_elapsed(uint32_t start)
+{
+    return DWT->CYCCNT - start;
+}
+
+static inline uint32_t cycle_counter_to_us(uint32_t cycles)
+{
+    return cycles / (SystemCoreClock / 1000000UL);
+}
+
+/* [] END OF FILE */
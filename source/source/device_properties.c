@@ -62,6 +62,15 @@
 #define RDR_PRESENCE_MACRO_THRESHOLD          		"macro_threshold"
 #define RDR_PRESENCE_MICRO_THRESHOLD          		"micro_threshold"
 #define RDR_PRESENCE_MODE         					"mode"
+#define RDR_TRACK_REPORT_INTERVAL         			"track_report_interval"
+#define RDR_SHADOW_MACRO_THRESHOLD         			"shadow_macro_threshold"
+#define RDR_SHADOW_MICRO_THRESHOLD         			"shadow_micro_threshold"
+#define RDR_CALIBRATE         						"calibrate"
+#define RDR_CALIBRATION_DURATION         			"calibration_duration"
+#define RDR_CALIBRATION_FAR         				"calibration_far"
+#define RDR_RESTART         						"restart"
+#define RDR_ZONE_KEY_FORMAT         				"zone%lu_%s"
+#define RDR_ZONE_KEY_LEN							(32)
 
 /* Max range min - max */
 #define MAX_RANGE_MIN_LIMIT (0.66f)
@@ -75,16 +84,66 @@
 #define MICRO_THRESHOLD_MIN_LIMIT (0.2f)
 #define MICRO_THRESHOLD_MAX_LIMIT (99.0f)
 
+/* Track report interval min - max in ms */
+#define TRACK_REPORT_INTERVAL_MIN_LIMIT (100u)
+#define TRACK_REPORT_INTERVAL_MAX_LIMIT (60000u)
+
+/* Presence zone limits, ranges in m and validity times in ms */
+#define ZONE_RANGE_MAX_LIMIT (MAX_RANGE_MAX_LIMIT)
+#define ZONE_THRESHOLD_MAX_LIMIT (100.0f)
+#define ZONE_VALIDITY_MAX_LIMIT (60000.0f)
+
+/* Threshold calibration window in seconds and false alarm rate per frame */
+#define CALIBRATION_DURATION_MIN_LIMIT (10u)
+#define CALIBRATION_DURATION_MAX_LIMIT (3600u)
+#define CALIBRATION_FAR_MIN_LIMIT (0.00001f)
+#define CALIBRATION_FAR_MAX_LIMIT (0.1f)
+
 /* Names for presence mode */
 #define MACRO_ONLY_STRING      ("macro_only")
 #define MICRO_ONLY_STRING      ("micro_only")
 #define MICRO_IF_MACRO_STRING  ("micro_if_macro")
 #define MICRO_AND_MACRO_STRING ("micro_and_macro")
 
+#define CALIBRATE_PROPOSE_STRING ("propose")
+#define CALIBRATE_APPLY_STRING   ("apply")
+
 /*******************************************************************************
 *  Global Variables
 *******************************************************************************/
 
+/* Key suffix of every zone field, in the order of zone_field_t */
+static const char* const zone_field_keys[ZONE_FIELD_COUNT] =
+{
+	"min_range",
+	"max_range",
+	"macro_threshold",
+	"micro_threshold",
+	"macro_validity",
+	"micro_validity"
+};
+
+/* Reported name of every calibration state, in the order of threshold_calib_state_t */
+static const char* const calibration_state_names[] =
+{
+	"idle",
+	"learning",
+	"proposed",
+	"applied",
+	"failed"
+};
+
+/* Upper limit of every zone field, the lower limit is 0 */
+static const float zone_field_limits[ZONE_FIELD_COUNT] =
+{
+	ZONE_RANGE_MAX_LIMIT,
+	ZONE_RANGE_MAX_LIMIT,
+	ZONE_THRESHOLD_MAX_LIMIT,
+	ZONE_THRESHOLD_MAX_LIMIT,
+	ZONE_VALIDITY_MAX_LIMIT,
+	ZONE_VALIDITY_MAX_LIMIT
+};
+
 /* macros used for json construction */
 typedef enum {
     FLOAT_VALUE = 0,
@@ -166,8 +225,8 @@ subs_rslt_t publish_device_properties (pub_msg_type_t pub_msg_type, radar_presen
             APP_LOG_DEBUG(("buffer_to_publish = %s", buffer_to_publish));
 
             /* Publish the fimrware version to the respective topic */
-            rc = publish_to_mqtt_topic(buffer_to_publish, strnlen(buffer_to_publish, DEVICE_PROPERTIES_MQTT_MESSAGE_SIZE)+1, 
-                                    (char*)mqtt_topic_publish_device_properties);
+            rc = publish_to_mqtt_topic_async(buffer_to_publish, strnlen(buffer_to_publish, DEVICE_PROPERTIES_MQTT_MESSAGE_SIZE)+1, 
+                                    (char*)mqtt_topic_publish_device_properties, NET_WRITER_LANE_BULK);
 
             if(SUBS_SUCCESS != rc)
             {
@@ -183,13 +242,31 @@ subs_rslt_t publish_device_properties (pub_msg_type_t pub_msg_type, radar_presen
 		case PUB_DEVICE_PROPERTIES_ACK:
 		{
 			//To-Do: By default micro_if_macro mode is sent as of today,since it is supported to micro_if_macro only, it is hardcoded.
-			snprintf(buffer_to_publish, DEVICE_PROPERTIES_MQTT_MESSAGE_SIZE, "{\"state\":{\"reported\":{\"get_desired_state\":%d,\"LocationSharing\":%d,\"Deprovision\":%d,\"max_range\":%.2f,\"macro_threshold\":%.2f,\"micro_threshold\":%.2f,\"mode\":\"micro_if_macro\",\"Sensor_Solution\":\"XENSIV BGT60TR13C Presence Detection\"},\"desired\":null}}",
+			int len = snprintf(buffer_to_publish, DEVICE_PROPERTIES_MQTT_MESSAGE_SIZE, "{\"state\":{\"reported\":{\"get_desired_state\":%d,\"LocationSharing\":%d,\"Deprovision\":%d,\"max_range\":%.2f,\"macro_threshold\":%.2f,\"micro_threshold\":%.2f,\"track_report_interval\":%lu,\"shadow_macro_threshold\":%.2f,\"shadow_micro_threshold\":%.2f,\"calibration\":\"%s\",\"calibrated_macro_threshold\":%.2f,\"calibrated_micro_threshold\":%.2f,\"calibration_duration\":%lu,\"calibration_far\":%.5f",
+
+					GET_DESIRED_PROPERTIES_STATE_FALSE, location_sharing, deprovision, device_attributes.max_range,device_attributes.macro_threshold,device_attributes.micro_threshold,device_attributes.track_report_interval,
+					device_attributes.shadow_macro_threshold, device_attributes.shadow_micro_threshold,
+					calibration_state_names[device_attributes.calibration_state], device_attributes.calibrated_macro_threshold,
+					device_attributes.calibrated_micro_threshold, device_attributes.calibration_duration, device_attributes.calibration_far);
+
+			/* Presence zones use the keys of the desired state */
+			for (uint32_t zone = 0; (zone < ZONE_ENGINE_MAX_ZONES) && (len < DEVICE_PROPERTIES_MQTT_MESSAGE_SIZE); zone++)
+			{
+				for (uint32_t field = 0; (field < ZONE_FIELD_COUNT) && (len < DEVICE_PROPERTIES_MQTT_MESSAGE_SIZE); field++)
+				{
+					len += snprintf(&buffer_to_publish[len], DEVICE_PROPERTIES_MQTT_MESSAGE_SIZE - len, ",\"zone%lu_%s\":%.3f",
+							zone, zone_field_keys[field], zone_engine_get_field(&device_attributes.zones[zone], (zone_field_t)field));
+				}
+			}
 
-					GET_DESIRED_PROPERTIES_STATE_FALSE, location_sharing, deprovision, device_attributes.max_range,device_attributes.macro_threshold,device_attributes.micro_threshold);
+			if (len < DEVICE_PROPERTIES_MQTT_MESSAGE_SIZE)
+			{
+				snprintf(&buffer_to_publish[len], DEVICE_PROPERTIES_MQTT_MESSAGE_SIZE - len, ",\"mode\":\"micro_if_macro\",\"Sensor_Solution\":\"XENSIV BGT60TR13C Presence Detection\"},\"desired\":null}}");
+			}
 			APP_LOG_DEBUG(("buffer_to_publish = %s", buffer_to_publish));
 			/* Publish to respective topic */
-			rc = publish_to_mqtt_topic(buffer_to_publish, strnlen(buffer_to_publish, DEVICE_PROPERTIES_MQTT_MESSAGE_SIZE)+1,
-									(char*)mqtt_topic_publish_device_properties);
+			rc = publish_to_mqtt_topic_async(buffer_to_publish, strnlen(buffer_to_publish, DEVICE_PROPERTIES_MQTT_MESSAGE_SIZE)+1,
+									(char*)mqtt_topic_publish_device_properties, NET_WRITER_LANE_BULK);
 
 			if(SUBS_SUCCESS != rc)
 			{
@@ -234,6 +311,14 @@ cy_rslt_t parse_device_properties(cy_JSON_object_t *json_object, void* callback_
 	float macro_threshold;
 	float micro_threshold;
 	char mode[MODE_LEN];
+	uint32_t track_report_interval;
+	float shadow_threshold;
+	char calibrate[MODE_LEN];
+	uint32_t calibration_duration;
+	float calibration_far;
+	uint32_t restart;
+	float zone_value;
+	char zone_key[RDR_ZONE_KEY_LEN];
 
     publisher_data_t publisher_q_data;
     if(NULL == json_object)
@@ -305,6 +390,127 @@ cy_rslt_t parse_device_properties(cy_JSON_object_t *json_object, void* callback_
 
 		}
 
+    if(SUBS_SUCCESS == compare_and_store(json_object, &track_report_interval, (char*)RDR_TRACK_REPORT_INTERVAL, (char*)PARAMS_PARENT_OBJECT, false))
+		{
+			if ((track_report_interval > TRACK_REPORT_INTERVAL_MAX_LIMIT) || (track_report_interval < TRACK_REPORT_INTERVAL_MIN_LIMIT)) {
+				track_report_interval = TRACK_REPORT_INTERVAL_MAX_LIMIT;
+				APP_LOG_ERROR(("track_report_interval parameter out of range"));
+			}
+
+			publisher_q_data.cmd = UPDATE_RADAR_TRACK_REPORT_INTERVAL;
+			publisher_q_data.track_report_interval = track_report_interval;
+
+			xQueueSend(publisher_task_q, &publisher_q_data, portMAX_DELAY);
+
+		}
+
+	/* Shadow detector thresholds, 0 keeps the production value for that threshold */
+    if(SUBS_SUCCESS == compare_and_store(json_object, &shadow_threshold, (char*)RDR_SHADOW_MACRO_THRESHOLD, (char*)PARAMS_PARENT_OBJECT, true))
+		{
+			if ((shadow_threshold != 0.0f) && ((shadow_threshold > MACRO_THRESHOLD_MAX_LIMIT) || (shadow_threshold < MACRO_THRESHOLD_MIN_LIMIT))) {
+				shadow_threshold = 0.0f;
+				APP_LOG_ERROR(("shadow_macro_threshold parameter out of range"));
+			}
+
+			publisher_q_data.cmd = UPDATE_RADAR_SHADOW_MACRO_THRESHOLD;
+			publisher_q_data.macro_threshold = shadow_threshold;
+
+			xQueueSend(publisher_task_q, &publisher_q_data, portMAX_DELAY);
+
+		}
+
+    if(SUBS_SUCCESS == compare_and_store(json_object, &shadow_threshold, (char*)RDR_SHADOW_MICRO_THRESHOLD, (char*)PARAMS_PARENT_OBJECT, true))
+		{
+			if ((shadow_threshold != 0.0f) && ((shadow_threshold > MICRO_THRESHOLD_MAX_LIMIT) || (shadow_threshold < MICRO_THRESHOLD_MIN_LIMIT))) {
+				shadow_threshold = 0.0f;
+				APP_LOG_ERROR(("shadow_micro_threshold parameter out of range"));
+			}
+
+			publisher_q_data.cmd = UPDATE_RADAR_SHADOW_MICRO_THRESHOLD;
+			publisher_q_data.micro_threshold = shadow_threshold;
+
+			xQueueSend(publisher_task_q, &publisher_q_data, portMAX_DELAY);
+
+		}
+
+	/* Threshold calibration, the room must stay empty during the window */
+    if(SUBS_SUCCESS == compare_and_store(json_object, &calibration_duration, (char*)RDR_CALIBRATION_DURATION, (char*)PARAMS_PARENT_OBJECT, false))
+		{
+			if ((calibration_duration > CALIBRATION_DURATION_MAX_LIMIT) || (calibration_duration < CALIBRATION_DURATION_MIN_LIMIT)) {
+				calibration_duration = THRESHOLD_CALIB_DEFAULT_DURATION_MS / 1000u;
+				APP_LOG_ERROR(("calibration_duration parameter out of range"));
+			}
+
+			publisher_q_data.cmd = UPDATE_RADAR_CALIBRATION_DURATION;
+			publisher_q_data.calibration_duration = calibration_duration;
+
+			xQueueSend(publisher_task_q, &publisher_q_data, portMAX_DELAY);
+
+		}
+
+    if(SUBS_SUCCESS == compare_and_store(json_object, &calibration_far, (char*)RDR_CALIBRATION_FAR, (char*)PARAMS_PARENT_OBJECT, true))
+		{
+			if ((calibration_far > CALIBRATION_FAR_MAX_LIMIT) || (calibration_far < CALIBRATION_FAR_MIN_LIMIT)) {
+				calibration_far = THRESHOLD_CALIB_DEFAULT_FAR;
+				APP_LOG_ERROR(("calibration_far parameter out of range"));
+			}
+
+			publisher_q_data.cmd = UPDATE_RADAR_CALIBRATION_FAR;
+			publisher_q_data.calibration_far = calibration_far;
+
+			xQueueSend(publisher_task_q, &publisher_q_data, portMAX_DELAY);
+
+		}
+
+    if(SUBS_SUCCESS == compare_and_store(json_object, &calibrate, (char*)RDR_CALIBRATE, (char*)PARAMS_PARENT_OBJECT, true))
+		{
+			if ((strcmp(calibrate, CALIBRATE_APPLY_STRING) == 0) || (strcmp(calibrate, CALIBRATE_PROPOSE_STRING) == 0)) {
+				publisher_q_data.cmd = UPDATE_RADAR_CALIBRATION;
+				publisher_q_data.calibration_apply = (strcmp(calibrate, CALIBRATE_APPLY_STRING) == 0);
+
+				xQueueSend(publisher_task_q, &publisher_q_data, portMAX_DELAY);
+			}
+			else {
+				APP_LOG_ERROR(("calibrate parameter must be propose or apply"));
+			}
+
+		}
+
+	/* Controlled restart once the acknowledgement has cleared the desired state */
+    if(SUBS_SUCCESS == compare_and_store(json_object, &restart, (char*)RDR_RESTART, (char*)PARAMS_PARENT_OBJECT, false))
+		{
+			if (restart != 0u) {
+				publisher_q_data.cmd = UPDATE_RADAR_RESTART;
+
+				xQueueSend(publisher_task_q, &publisher_q_data, portMAX_DELAY);
+			}
+
+		}
+
+	/* Presence zones, one key per zone and field e.g. zone0_max_range */
+	for (uint32_t zone = 0; zone < ZONE_ENGINE_MAX_ZONES; zone++)
+	{
+		for (uint32_t field = 0; field < ZONE_FIELD_COUNT; field++)
+		{
+			snprintf(zone_key, sizeof(zone_key), RDR_ZONE_KEY_FORMAT, zone, zone_field_keys[field]);
+
+			if(SUBS_SUCCESS == compare_and_store(json_object, &zone_value, zone_key, (char*)PARAMS_PARENT_OBJECT, true))
+			{
+				if ((zone_value > zone_field_limits[field]) || (zone_value < 0.0f)) {
+					zone_value = (zone_value < 0.0f) ? 0.0f : zone_field_limits[field];
+					APP_LOG_ERROR(("%s parameter out of range", zone_key));
+				}
+
+				publisher_q_data.cmd = UPDATE_RADAR_ZONE;
+				publisher_q_data.zone_id = (uint8_t)zone;
+				publisher_q_data.zone_field = (zone_field_t)field;
+				publisher_q_data.zone_value = zone_value;
+
+				xQueueSend(publisher_task_q, &publisher_q_data, portMAX_DELAY);
+			}
+		}
+	}
+
 
 	return CY_RSLT_SUCCESS;
 }
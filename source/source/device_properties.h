@@ -47,7 +47,12 @@
 #include "cy_mqtt_api.h"
 #include "publisher_task.h"
 
+/* Ids in the telemetry: the board, given per controller at build time, and
+ * the first of its sensors; further sensors count up from it
+ */
+#ifndef RADAR_BOARD
 #define RADAR_BOARD                            		(0)
+#endif
 #define RADAR_SENSOR                           		(0)
 #define DEVICE_PROPERTIES_MQTT_MESSAGE_SIZE         (3072)
 
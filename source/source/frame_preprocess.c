@@ -0,0 +1,336 @@
+/*****************************************************************************
+ * File name: frame_preprocess.c
+ *
+ * Description: This file converts the raw 12 bit FIFO samples into the float
+ * frame consumed by the presence library and builds the average chirp. The
+ * frame can be preprocessed at once or chirp by chirp while it is read from
+ * the FIFO; both paths execute the same operations in the same order so the
+ * results are bit identical. With several receive antennas the interleaved
+ * samples are split into one plane per antenna. It only depends on CMSIS-DSP.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <string.h>
+
+/* Header file for local task */
+#include "frame_preprocess.h"
+#include "hot_path.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Full scale of the 12 bit ADC */
+#define ADC_FULL_SCALE                      (4096.0F)
+
+/* Shift of a 12 bit sample to Q15, so that arm_q15_to_float divides it by
+ * ADC_FULL_SCALE. Both halves of a word can be shifted at once, a sample
+ * never carries into the next one.
+ */
+#define ADC_TO_Q15_SHIFT                    (3u)
+
+#if (RANGE_FFT_FIXED_POINT != 0)
+/* Largest 12 bit sample */
+#define ADC_MAX                             (4095u)
+
+/* Shift of a 12 bit sample to the fixed point sample of the range processing */
+#define ADC_TO_SAMPLE_SHIFT                 ((uint32_t)RANGE_FFT_FIXED_POINT - 12u)
+
+/* Largest sum of raw samples the average chirp can hold */
+#define SUM_MAX                             ((1ULL << RANGE_FFT_FIXED_POINT) - 1u)
+#endif
+
+/* Packs the low halfword of a and the low halfword of b into one word */
+#if defined(ARM_MATH_DSP)
+#define PACK_LOW_HALFWORDS(a, b)            __PKHBT((a), (b), 16)
+#else
+#define PACK_LOW_HALFWORDS(a, b)            (((a) & 0xFFFFu) | ((b) << 16))
+#endif
+
+/* Packs the low halfword of a and the high halfword of b into one word */
+#if defined(ARM_MATH_DSP)
+#define PACK_LOW_HIGH_HALFWORDS(a, b)       __PKHBT((a), (b), 0)
+#else
+#define PACK_LOW_HIGH_HALFWORDS(a, b)       (((a) & 0xFFFFu) | ((b) & 0xFFFF0000u))
+#endif
+
+/*******************************************************************************
+ * Function Name: deinterleave_3rx
+ *******************************************************************************
+ * Summary:
+ *   Splits the samples of three antennas into Q15 planes. Two samples of
+ *   every antenna are handled per iteration: three words are read, shifted
+ *   at once and repacked into one word per antenna.
+ *
+ * Parameters:
+ *   raw: 3 * samples interleaved raw samples, 4 byte aligned
+ *   planes: 3 planes of samples Q15 samples, 4 byte aligned
+ *   samples: samples per antenna
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+HOT_PATH_FUNC static void deinterleave_3rx(const uint16_t* raw, q15_t* planes, uint32_t samples)
+{
+    const uint8_t* src = (const uint8_t*)raw;
+    uint8_t* rx1 = (uint8_t*)&planes[0];
+    uint8_t* rx2 = (uint8_t*)&planes[samples];
+    uint8_t* rx3 = (uint8_t*)&planes[2u * samples];
+
+    for (uint32_t pair = 0; pair < (samples / 2u); ++pair)
+    {
+        uint32_t w0;                /* RX1 s0, RX2 s0 */
+        uint32_t w1;                /* RX3 s0, RX1 s1 */
+        uint32_t w2;                /* RX2 s1, RX3 s1 */
+        uint32_t out;
+
+        /* memcpy of a word compiles to a single load or store */
+        memcpy(&w0, &src[0], sizeof(w0));
+        memcpy(&w1, &src[4], sizeof(w1));
+        memcpy(&w2, &src[8], sizeof(w2));
+        src += 12;
+
+        w0 <<= ADC_TO_Q15_SHIFT;
+        w1 <<= ADC_TO_Q15_SHIFT;
+        w2 <<= ADC_TO_Q15_SHIFT;
+
+        out = PACK_LOW_HIGH_HALFWORDS(w0, w1);
+        memcpy(rx1, &out, sizeof(out));
+        out = PACK_LOW_HALFWORDS(w0 >> 16, w2);
+        memcpy(rx2, &out, sizeof(out));
+        out = PACK_LOW_HIGH_HALFWORDS(w1, w2);
+        memcpy(rx3, &out, sizeof(out));
+        rx1 += 4;
+        rx2 += 4;
+        rx3 += 4;
+    }
+
+    if ((samples % 2u) != 0u)
+    {
+        const uint16_t* last = &raw[3u * (samples - 1u)];
+
+        planes[samples - 1u] = (q15_t)(last[0] << ADC_TO_Q15_SHIFT);
+        planes[(2u * samples) - 1u] = (q15_t)(last[1] << ADC_TO_Q15_SHIFT);
+        planes[(3u * samples) - 1u] = (q15_t)(last[2] << ADC_TO_Q15_SHIFT);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: deinterleave
+ *******************************************************************************
+ * Summary:
+ *   Splits the samples of any number of antennas into Q15 planes.
+ *
+ * Parameters:
+ *   raw: num_antennas * samples interleaved raw samples
+ *   planes: num_antennas planes of samples Q15 samples
+ *   samples: samples per antenna
+ *   num_antennas: number of antennas
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+HOT_PATH_FUNC static void deinterleave(const uint16_t* raw, q15_t* planes, uint32_t samples, uint32_t num_antennas)
+{
+    for (uint32_t sample = 0; sample < samples; ++sample)
+    {
+        for (uint32_t antenna = 0; antenna < num_antennas; ++antenna)
+        {
+            planes[(antenna * samples) + sample] = (q15_t)(*raw++ << ADC_TO_Q15_SHIFT);
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: frame_preprocess_init
+ *******************************************************************************
+ * Summary:
+ *   Initializes the preprocessing state with caller owned buffers.
+ *
+ * Parameters:
+ *   pre: preprocessing state
+ *   frame: output frame, num_antennas * num_chirps * samples_per_chirp samples
+ *   avg_chirp: output average chirps, num_antennas * samples_per_chirp samples
+ *   scratch: num_antennas * samples_per_chirp samples, NULL with one antenna
+ *   samples_per_chirp: samples per chirp and antenna
+ *   num_antennas: receive antennas in the raw data
+ *   num_chirps: chirps per frame
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void frame_preprocess_init(frame_preprocess_t* pre, float32_t* frame, range_sample_t* avg_chirp, q15_t* scratch,
+                           uint32_t samples_per_chirp, uint32_t num_antennas, uint32_t num_chirps)
+{
+    pre->frame = frame;
+    pre->avg_chirp = avg_chirp;
+    pre->scratch = scratch;
+    pre->samples_per_chirp = samples_per_chirp;
+    pre->num_antennas = num_antennas;
+    pre->chunk_len = samples_per_chirp * num_antennas;
+    pre->num_chirps = num_chirps;
+    pre->chirps_done = 0;
+    pre->sum_shift = 0;
+
+#if (RANGE_FFT_FIXED_POINT != 0)
+    /* The raw samples are summed in the average chirp, Q15 sums of more
+     * than 8 chirps drop the low bits of every sample
+     */
+    while (((uint64_t)num_chirps * (ADC_MAX >> pre->sum_shift)) > SUM_MAX)
+    {
+        ++pre->sum_shift;
+    }
+#endif
+}
+
+/*******************************************************************************
+ * Function Name: frame_preprocess_start
+ *******************************************************************************
+ * Summary:
+ *   Starts a new frame, previously added chunks are dropped.
+ *
+ * Parameters:
+ *   pre: preprocessing state
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void frame_preprocess_start(frame_preprocess_t* pre)
+{
+    pre->chirps_done = 0;
+#if (RANGE_FFT_FIXED_POINT != 0)
+    memset(pre->avg_chirp, 0, pre->chunk_len * sizeof(range_sample_t));
+#else
+    arm_fill_f32(0, pre->avg_chirp, pre->chunk_len);
+#endif
+}
+
+/*******************************************************************************
+ * Function Name: frame_preprocess_add_chunk
+ *******************************************************************************
+ * Summary:
+ *   Converts the raw samples of the next chirp and accumulates the average
+ *   chirps. The averages are scaled when the last chirp of the frame is added.
+ *   The fixed point averages are summed from the raw samples without any
+ *   float32 arithmetic.
+ *
+ * Parameters:
+ *   pre: preprocessing state
+ *   raw: chunk_len raw samples of the next chirp
+ *
+ * Return:
+ *   true if the frame is complete
+ ******************************************************************************/
+HOT_PATH_FUNC bool frame_preprocess_add_chunk(frame_preprocess_t* pre, const uint16_t* raw)
+{
+    const uint32_t plane_len = pre->num_chirps * pre->samples_per_chirp;
+    float32_t* chirp = &pre->frame[pre->samples_per_chirp * pre->chirps_done];
+
+    if (pre->num_antennas == 1u)
+    {
+        float32_t* frame_ptr = chirp;
+
+        for (uint32_t sample = 0; sample < pre->chunk_len; ++sample)
+        {
+            *frame_ptr++ = ((float32_t)raw[sample] / ADC_FULL_SCALE);
+        }
+    }
+    else
+    {
+        if (pre->num_antennas == 3u)
+        {
+            deinterleave_3rx(raw, pre->scratch, pre->samples_per_chirp);
+        }
+        else
+        {
+            deinterleave(raw, pre->scratch, pre->samples_per_chirp, pre->num_antennas);
+        }
+
+        for (uint32_t antenna = 0; antenna < pre->num_antennas; ++antenna)
+        {
+            arm_q15_to_float(&pre->scratch[antenna * pre->samples_per_chirp], &chirp[antenna * plane_len],
+                             pre->samples_per_chirp);
+        }
+    }
+
+#if (RANGE_FFT_FIXED_POINT != 0)
+    for (uint32_t sample = 0; sample < pre->samples_per_chirp; ++sample)
+    {
+        const uint16_t* raw_sample = &raw[sample * pre->num_antennas];
+
+        for (uint32_t antenna = 0; antenna < pre->num_antennas; ++antenna)
+        {
+            pre->avg_chirp[(antenna * pre->samples_per_chirp) + sample] +=
+                (range_sample_t)(raw_sample[antenna] >> pre->sum_shift);
+        }
+    }
+#else
+    for (uint32_t antenna = 0; antenna < pre->num_antennas; ++antenna)
+    {
+        float32_t* avg_chirp = &pre->avg_chirp[antenna * pre->samples_per_chirp];
+
+        arm_add_f32(avg_chirp, &chirp[antenna * plane_len], avg_chirp, pre->samples_per_chirp);
+    }
+#endif
+
+    if (++pre->chirps_done < pre->num_chirps)
+    {
+        return false;
+    }
+
+#if (RANGE_FFT_FIXED_POINT != 0)
+    for (uint32_t sample = 0; sample < pre->chunk_len; ++sample)
+    {
+        uint64_t sum = (uint64_t)(uint32_t)pre->avg_chirp[sample] << (ADC_TO_SAMPLE_SHIFT + pre->sum_shift);
+
+        pre->avg_chirp[sample] = (range_sample_t)(sum / pre->num_chirps);
+    }
+#else
+    arm_scale_f32(pre->avg_chirp, 1.0f / (float32_t)pre->num_chirps, pre->avg_chirp, pre->chunk_len);
+#endif
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: frame_preprocess_whole
+ *******************************************************************************
+ * Summary:
+ *   Preprocesses a frame that has been read from the FIFO at once.
+ *
+ * Parameters:
+ *   pre: preprocessing state
+ *   raw: num_chirps * chunk_len raw samples
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void frame_preprocess_whole(frame_preprocess_t* pre, const uint16_t* raw)
+{
+    frame_preprocess_start(pre);
+
+    for (uint32_t chirp = 0; chirp < pre->num_chirps; ++chirp)
+    {
+        (void)frame_preprocess_add_chunk(pre, &raw[pre->chunk_len * chirp]);
+    }
+}
+
+/* [] END OF FILE */
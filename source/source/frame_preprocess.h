@@ -0,0 +1,72 @@
+/******************************************************************************
+ * File Name:   frame_preprocess.h
+ *
+ * Description: This file contains the function prototypes and constants used
+ *   in frame_preprocess.c.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#pragma once
+
+/* Header file from system */
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Header file for library */
+#include "arm_math.h"
+
+/* Header file for local task */
+#include "range_fft.h"
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+/* Preprocessing state of one frame. A frame is made of num_chirps chunks of
+ * samples_per_chirp * num_antennas raw samples, interleaved per sample over
+ * the antennas. The converted frame is stored in one plane per antenna,
+ * chirp after chirp, so the plane of the first antenna has the layout of a
+ * single antenna frame. An average chirp is built per antenna, in the sample
+ * format of the range processing, see RANGE_FFT_FIXED_POINT.
+ */
+typedef struct
+{
+    float32_t* frame;               /* num_antennas planes of num_chirps * samples_per_chirp samples */
+    range_sample_t* avg_chirp;      /* num_antennas planes of samples_per_chirp samples */
+    q15_t* scratch;                 /* chunk_len samples, only used with several antennas */
+    uint32_t sum_shift;             /* fixed point only, raw samples are summed shifted right by this */
+    uint32_t samples_per_chirp;
+    uint32_t num_antennas;
+    uint32_t chunk_len;
+    uint32_t num_chirps;
+    uint32_t chirps_done;
+} frame_preprocess_t;
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+void frame_preprocess_init(frame_preprocess_t* pre, float32_t* frame, range_sample_t* avg_chirp, q15_t* scratch,
+                           uint32_t samples_per_chirp, uint32_t num_antennas, uint32_t num_chirps);
+void frame_preprocess_start(frame_preprocess_t* pre);
+bool frame_preprocess_add_chunk(frame_preprocess_t* pre, const uint16_t* raw);
+void frame_preprocess_whole(frame_preprocess_t* pre, const uint16_t* raw);
+
+/* [] END OF FILE */
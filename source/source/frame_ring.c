@@ -0,0 +1,281 @@
+/*****************************************************************************
+ * File name: frame_ring.c
+ *
+ * Description: This file contains the ring that passes frames from the
+ * core running the acquisition to the core running the processing. The ring
+ * lives in RAM seen by both cores; the producer only writes head and the
+ * slots it owns, the consumer only writes tail, so each side works without
+ * locks. A memory barrier orders the slot contents against the index that
+ * hands them over. Neither core of the PSoC 6 caches data, so no cache
+ * maintenance is needed. The code does not depend on the platform and runs
+ * on a host as well.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <string.h>
+
+/* Header file for local task */
+#include "frame_ring.h"
+
+#if defined(__ARM_ARCH)
+#include "cmsis_compiler.h"
+#endif
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Orders the accesses of the slots against the accesses of the indices, for
+ * the other core as well as for the compiler
+ */
+#if defined(__ARM_ARCH)
+#define FRAME_RING_BARRIER()                __DMB()
+#else
+#define FRAME_RING_BARRIER()                __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#endif
+
+#define FRAME_RING_SLOT(index)              ((index) & (FRAME_RING_SLOTS - 1u))
+
+/*******************************************************************************
+ * Function Name: frame_ring_init
+ *******************************************************************************
+ * Summary:
+ *   Initializes an empty, stopped ring. Called by the consumer before the
+ *   ring is handed over to the producer.
+ *
+ * Parameters:
+ *   ring: ring, in memory shared by both cores
+ *   setup: acquisition the producer programs
+ *   samples: FRAME_RING_SLOTS * setup->samples_per_frame samples, shared too
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void frame_ring_init(frame_ring_t* ring, const frame_ring_setup_t* setup, uint16_t* samples)
+{
+    memset(ring, 0, sizeof(*ring));
+    ring->setup = *setup;
+    ring->samples = samples;
+    ring->version = FRAME_RING_VERSION;
+
+    /* Checked by the producer last */
+    FRAME_RING_BARRIER();
+    ring->magic = FRAME_RING_MAGIC;
+    FRAME_RING_BARRIER();
+}
+
+/*******************************************************************************
+ * Function Name: frame_ring_set_running
+ *******************************************************************************
+ * Summary:
+ *   Starts or stops the acquisition of the producer. Frames published before
+ *   the producer sees the change stay in the ring, see frame_ring_flush.
+ *
+ * Parameters:
+ *   ring: ring
+ *   run: true to acquire frames
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void frame_ring_set_running(frame_ring_t* ring, bool run)
+{
+    ring->run = run ? 1u : 0u;
+    FRAME_RING_BARRIER();
+}
+
+/*******************************************************************************
+ * Function Name: frame_ring_peek
+ *******************************************************************************
+ * Summary:
+ *   Returns the oldest published frame. The frame stays owned by the
+ *   consumer until frame_ring_release.
+ *
+ * Parameters:
+ *   ring: ring
+ *   header: header of the frame
+ *
+ * Return:
+ *   samples of the frame, NULL if the ring is empty
+ ******************************************************************************/
+const uint16_t* frame_ring_peek(frame_ring_t* ring, frame_ring_header_t* header)
+{
+    uint32_t tail = ring->tail;
+    uint32_t slot;
+
+    if (ring->head == tail)
+    {
+        return NULL;
+    }
+
+    /* The slot is read after the index that published it */
+    FRAME_RING_BARRIER();
+
+    slot = FRAME_RING_SLOT(tail);
+    *header = ring->headers[slot];
+
+    return &ring->samples[slot * ring->setup.samples_per_frame];
+}
+
+/*******************************************************************************
+ * Function Name: frame_ring_release
+ *******************************************************************************
+ * Summary:
+ *   Hands the frame returned by frame_ring_peek back to the producer.
+ *
+ * Parameters:
+ *   ring: ring
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void frame_ring_release(frame_ring_t* ring)
+{
+    /* All reads of the slot are done before the producer may reuse it */
+    FRAME_RING_BARRIER();
+    ring->tail = ring->tail + 1u;
+}
+
+/*******************************************************************************
+ * Function Name: frame_ring_flush
+ *******************************************************************************
+ * Summary:
+ *   Releases all published frames, e.g. the stale frames left when the
+ *   acquisition is restarted.
+ *
+ * Parameters:
+ *   ring: ring
+ *
+ * Return:
+ *   number of frames released
+ ******************************************************************************/
+uint32_t frame_ring_flush(frame_ring_t* ring)
+{
+    uint32_t head = ring->head;
+    uint32_t count = head - ring->tail;
+
+    FRAME_RING_BARRIER();
+    ring->tail = head;
+
+    return count;
+}
+
+/*******************************************************************************
+ * Function Name: frame_ring_valid
+ *******************************************************************************
+ * Summary:
+ *   Checks that the ring was set up by a consumer using the same layout.
+ *
+ * Parameters:
+ *   ring: ring
+ *
+ * Return:
+ *   true if the producer can attach
+ ******************************************************************************/
+bool frame_ring_valid(const frame_ring_t* ring)
+{
+    if (ring->magic != FRAME_RING_MAGIC)
+    {
+        return false;
+    }
+
+    FRAME_RING_BARRIER();
+
+    return (ring->version == FRAME_RING_VERSION) && (ring->samples != NULL) &&
+           (ring->setup.samples_per_irq > 0u) &&
+           (ring->setup.samples_per_frame >= ring->setup.samples_per_irq) &&
+           ((ring->setup.samples_per_frame % ring->setup.samples_per_irq) == 0u);
+}
+
+/*******************************************************************************
+ * Function Name: frame_ring_running
+ *******************************************************************************
+ * Summary:
+ *   Tells the producer whether the consumer wants frames.
+ *
+ * Parameters:
+ *   ring: ring
+ *
+ * Return:
+ *   true if frames are to be acquired
+ ******************************************************************************/
+bool frame_ring_running(const frame_ring_t* ring)
+{
+    return ring->run != 0u;
+}
+
+/*******************************************************************************
+ * Function Name: frame_ring_reserve
+ *******************************************************************************
+ * Summary:
+ *   Returns the free slot the next frame is written to. The slot stays the
+ *   same until frame_ring_publish, so a frame can be written block by block.
+ *   A full ring is counted as overrun and the caller drops the frame.
+ *
+ * Parameters:
+ *   ring: ring
+ *
+ * Return:
+ *   samples of the slot, NULL if the ring is full
+ ******************************************************************************/
+uint16_t* frame_ring_reserve(frame_ring_t* ring)
+{
+    uint32_t head = ring->head;
+
+    if ((head - ring->tail) >= FRAME_RING_SLOTS)
+    {
+        ring->overruns = ring->overruns + 1u;
+        return NULL;
+    }
+
+    /* The slot is written after the index that released it */
+    FRAME_RING_BARRIER();
+
+    return &ring->samples[FRAME_RING_SLOT(head) * ring->setup.samples_per_frame];
+}
+
+/*******************************************************************************
+ * Function Name: frame_ring_publish
+ *******************************************************************************
+ * Summary:
+ *   Hands the frame written to the slot of frame_ring_reserve over to the
+ *   consumer. The caller then rings the doorbell of the consumer.
+ *
+ * Parameters:
+ *   ring: ring
+ *   header: header of the frame
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void frame_ring_publish(frame_ring_t* ring, const frame_ring_header_t* header)
+{
+    uint32_t head = ring->head;
+
+    ring->headers[FRAME_RING_SLOT(head)] = *header;
+
+    /* The samples and the header are visible before the index */
+    FRAME_RING_BARRIER();
+    ring->head = head + 1u;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,111 @@
+/******************************************************************************
+ * File Name:   frame_ring.h
+ *
+ * Description: This file contains the function prototypes and constants used
+ *   in frame_ring.c.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+
+#pragma once
+
+/* Header file from system */
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Header file for local task */
+#include "frame_sequence.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Layout of frame_ring_t, a producer built with another layout does not attach */
+#define FRAME_RING_VERSION                  (1u)
+#define FRAME_RING_MAGIC                    (0x474E5246u)   /* "FRNG" */
+
+/* Frames buffered between the cores, a power of two */
+#define FRAME_RING_SLOTS                    (4u)
+
+#if ((FRAME_RING_SLOTS & (FRAME_RING_SLOTS - 1u)) != 0u)
+#error "FRAME_RING_SLOTS must be a power of two"
+#endif
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+/* Acquisition set up by the consumer, the producer programs the sensor with it */
+typedef struct
+{
+    const uint32_t* registers;          /* register list of the sensor */
+    uint32_t num_registers;
+    uint32_t samples_per_irq;           /* FIFO interrupt threshold */
+    uint32_t samples_per_frame;
+    uint32_t irq_period_us;             /* time between two FIFO interrupts */
+} frame_ring_setup_t;
+
+typedef struct
+{
+    uint32_t sequence;                  /* frame number, see frame_sequence_frame */
+    uint32_t stamp_us;                  /* FIFO interrupt of the first block, producer time base */
+    uint32_t num_samples;
+    frame_sequence_stats_t stats;       /* producer statistics including this frame */
+} frame_ring_header_t;
+
+/* Single producer, single consumer ring of frames in memory shared by both
+ * cores. Each index is written by one side only, so no lock is needed.
+ */
+typedef struct
+{
+    /* Set by the consumer before the ring is handed over, read only afterwards */
+    uint32_t magic;
+    uint32_t version;
+    frame_ring_setup_t setup;
+    uint16_t* samples;                  /* FRAME_RING_SLOTS frames of setup.samples_per_frame */
+
+    /* Written by the producer only */
+    volatile uint32_t head;             /* frames published */
+    volatile uint32_t overruns;         /* frames dropped because the ring was full */
+
+    /* Written by the consumer only */
+    volatile uint32_t tail;             /* frames released */
+    volatile uint32_t run;              /* frames are wanted */
+
+    frame_ring_header_t headers[FRAME_RING_SLOTS];
+} frame_ring_t;
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+/* Consumer */
+void frame_ring_init(frame_ring_t* ring, const frame_ring_setup_t* setup, uint16_t* samples);
+void frame_ring_set_running(frame_ring_t* ring, bool run);
+const uint16_t* frame_ring_peek(frame_ring_t* ring, frame_ring_header_t* header);
+void frame_ring_release(frame_ring_t* ring);
+uint32_t frame_ring_flush(frame_ring_t* ring);
+
+/* Producer */
+bool frame_ring_valid(const frame_ring_t* ring);
+bool frame_ring_running(const frame_ring_t* ring);
+uint16_t* frame_ring_reserve(frame_ring_t* ring);
+void frame_ring_publish(frame_ring_t* ring, const frame_ring_header_t* header);
+
+/* [] END OF FILE */
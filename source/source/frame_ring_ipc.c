@@ -0,0 +1,157 @@
+/*****************************************************************************
+ * File name: frame_ring_ipc.c
+ *
+ * Description: This file contains the inter-processor communication of
+ * the frame ring. The consumer core leaves the address of the ring in the
+ * data register of an IPC channel it keeps locked; the producer core reads
+ * it from there. After each published frame the producer rings a doorbell,
+ * an IPC notify event that raises an interrupt on the consumer core.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <stddef.h>
+
+/* Header file for library */
+#include "cy_ipc_drv.h"
+#include "cy_sysint.h"
+
+/* Header file for local task */
+#include "frame_ring_ipc.h"
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static void (*frame_ring_doorbell_cb)(void) = NULL;
+
+/*******************************************************************************
+ * Function Name: frame_ring_ipc_isr
+ *******************************************************************************
+ * Summary:
+ *   Doorbell interrupt of the consumer core. Several doorbells may be merged
+ *   into one interrupt, the consumer checks the ring for all frames.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void frame_ring_ipc_isr(void)
+{
+    IPC_INTR_STRUCT_Type* intr = Cy_IPC_Drv_GetIntrBaseAddr(FRAME_RING_IPC_INTR);
+    uint32_t status = Cy_IPC_Drv_GetInterruptStatusMasked(intr);
+
+    Cy_IPC_Drv_ClearInterrupt(intr, CY_IPC_NO_NOTIFICATION, Cy_IPC_Drv_ExtractAcquireMask(status));
+
+    if (frame_ring_doorbell_cb != NULL)
+    {
+        frame_ring_doorbell_cb();
+    }
+}
+
+/*******************************************************************************
+ * Function Name: frame_ring_ipc_offer
+ *******************************************************************************
+ * Summary:
+ *   Hands an initialized ring over to the producer core and enables the
+ *   doorbell interrupt. The channel stays locked by the consumer for as long
+ *   as the ring is offered.
+ *
+ * Parameters:
+ *   ring: ring, see frame_ring_init
+ *   doorbell_cb: called from the doorbell interrupt
+ *
+ * Return:
+ *   true on success
+ ******************************************************************************/
+bool frame_ring_ipc_offer(frame_ring_t* ring, void (*doorbell_cb)(void))
+{
+    IPC_STRUCT_Type* channel = Cy_IPC_Drv_GetIpcBaseAddress(FRAME_RING_IPC_CHANNEL);
+    const cy_stc_sysint_t intr_cfg =
+    {
+        .intrSrc      = (IRQn_Type)((uint32_t)cpuss_interrupts_ipc_0_IRQn + FRAME_RING_IPC_INTR),
+        .intrPriority = FRAME_RING_IPC_INTR_PRIORITY
+    };
+
+    frame_ring_doorbell_cb = doorbell_cb;
+    if (Cy_SysInt_Init(&intr_cfg, frame_ring_ipc_isr) != CY_SYSINT_SUCCESS)
+    {
+        return false;
+    }
+    Cy_IPC_Drv_SetInterruptMask(Cy_IPC_Drv_GetIntrBaseAddr(FRAME_RING_IPC_INTR), CY_IPC_NO_NOTIFICATION,
+                                1uL << FRAME_RING_IPC_CHANNEL);
+    NVIC_EnableIRQ(intr_cfg.intrSrc);
+
+    /* The lock tells the producer that the data register holds the ring */
+    Cy_IPC_Drv_WriteDataValue(channel, (uint32_t)(uintptr_t)ring);
+    __DMB();
+
+    return Cy_IPC_Drv_LockAcquire(channel) == CY_IPC_DRV_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: frame_ring_ipc_attach
+ *******************************************************************************
+ * Summary:
+ *   Looks for the ring offered by the consumer core. The producer polls
+ *   until the consumer has booted and offered a valid ring.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   ring, NULL if none is offered yet
+ ******************************************************************************/
+frame_ring_t* frame_ring_ipc_attach(void)
+{
+    IPC_STRUCT_Type* channel = Cy_IPC_Drv_GetIpcBaseAddress(FRAME_RING_IPC_CHANNEL);
+    frame_ring_t* ring;
+
+    if (!Cy_IPC_Drv_IsLockAcquired(channel))
+    {
+        return NULL;
+    }
+
+    ring = (frame_ring_t*)(uintptr_t)Cy_IPC_Drv_ReadDataValue(channel);
+
+    return ((ring != NULL) && frame_ring_valid(ring)) ? ring : NULL;
+}
+
+/*******************************************************************************
+ * Function Name: frame_ring_ipc_notify
+ *******************************************************************************
+ * Summary:
+ *   Rings the doorbell of the consumer core, called after frame_ring_publish.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void frame_ring_ipc_notify(void)
+{
+    Cy_IPC_Drv_AcquireNotify(Cy_IPC_Drv_GetIpcBaseAddress(FRAME_RING_IPC_CHANNEL), 1uL << FRAME_RING_IPC_INTR);
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,63 @@
+/******************************************************************************
+ * File Name:   frame_ring_ipc.h
+ *
+ * Description: This file contains the function prototypes and constants used
+ *   in frame_ring_ipc.c.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+
+#pragma once
+
+/* Header file from system */
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Header file for local task */
+#include "frame_ring.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* IPC channel holding the address of the ring and ringing the doorbell. The
+ * channels and interrupt structures below 8 are used by the system IPC of
+ * the PDL on both cores.
+ */
+#define FRAME_RING_IPC_CHANNEL              (8u)
+
+/* IPC interrupt structure of the doorbell, routed to the consumer core */
+#define FRAME_RING_IPC_INTR                 (8u)
+
+/* Priority of the doorbell interrupt on the consumer core */
+#define FRAME_RING_IPC_INTR_PRIORITY        (6u)
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+/* Consumer */
+bool frame_ring_ipc_offer(frame_ring_t* ring, void (*doorbell_cb)(void));
+
+/* Producer */
+frame_ring_t* frame_ring_ipc_attach(void);
+void frame_ring_ipc_notify(void);
+
+/* [] END OF FILE */
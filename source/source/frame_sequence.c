@@ -0,0 +1,267 @@
+/*****************************************************************************
+ * File name: frame_sequence.c
+ *
+ * Description: This file keeps track of the frames delivered by the sensor.
+ * Interrupt timestamps are buffered by the ISR and extended to the
+ * millisecond time base of the presence library. The FRAME_CNT field of the
+ * sensor, read after every frame, is compared with the frames read from the
+ * FIFO so that lost frames are counted and the sequence number of the
+ * delivered frames reflects the gaps. It does not depend on the RTOS or the
+ * HAL, register values and times are passed in by the caller.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <string.h>
+
+/* Header file for local task */
+#include "frame_sequence.h"
+
+/*******************************************************************************
+ * Function Name: update_counter
+ *******************************************************************************
+ * Summary:
+ *   Accumulates the frames started by the sensor since the last update.
+ *
+ * Parameters:
+ *   seq: sequence state
+ *   counter: FRAME_CNT value read from the sensor
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void update_counter(frame_sequence_t* seq, uint32_t counter)
+{
+    counter &= FRAME_SEQUENCE_COUNTER_MASK;
+    seq->produced += (counter - seq->last_counter) & FRAME_SEQUENCE_COUNTER_MASK;
+    seq->last_counter = counter;
+}
+
+/*******************************************************************************
+ * Function Name: frame_sequence_init
+ *******************************************************************************
+ * Summary:
+ *   Initializes the sequence state, the sensor frame counter is expected to
+ *   start from zero.
+ *
+ * Parameters:
+ *   seq: sequence state
+ *   base_ms: system time in ms mapped to now_us
+ *   now_us: current value of the timestamp timer
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void frame_sequence_init(frame_sequence_t* seq, uint32_t base_ms, uint32_t now_us)
+{
+    memset(seq, 0, sizeof(*seq));
+    seq->base_ms = base_ms;
+    seq->last_stamp_us = now_us;
+}
+
+/*******************************************************************************
+ * Function Name: frame_sequence_irq
+ *******************************************************************************
+ * Summary:
+ *   Records the timestamp of a FIFO interrupt, to be called from the ISR.
+ *   The oldest stamp is overwritten if the task falls behind.
+ *
+ * Parameters:
+ *   seq: sequence state
+ *   stamp_us: current value of the timestamp timer
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void frame_sequence_irq(frame_sequence_t* seq, uint32_t stamp_us)
+{
+    uint32_t count = seq->stamp_count;
+
+    seq->stamp_us[count % FRAME_SEQUENCE_STAMP_DEPTH] = stamp_us;
+    seq->stamp_count = count + 1u;
+}
+
+/*******************************************************************************
+ * Function Name: frame_sequence_next_stamp
+ *******************************************************************************
+ * Summary:
+ *   Takes the oldest interrupt timestamp not consumed yet.
+ *
+ * Parameters:
+ *   seq: sequence state
+ *   stamp_us: oldest timestamp
+ *
+ * Return:
+ *   false if there is none, i.e. the data was already waiting in the FIFO
+ *   and did not raise an interrupt
+ ******************************************************************************/
+bool frame_sequence_next_stamp(frame_sequence_t* seq, uint32_t* stamp_us)
+{
+    uint32_t count = seq->stamp_count;
+
+    if (count == seq->stamp_index)
+    {
+        return false;
+    }
+
+    if ((count - seq->stamp_index) > FRAME_SEQUENCE_STAMP_DEPTH)
+    {
+        seq->stamp_index = count - FRAME_SEQUENCE_STAMP_DEPTH;
+    }
+
+    *stamp_us = seq->stamp_us[seq->stamp_index % FRAME_SEQUENCE_STAMP_DEPTH];
+    ++seq->stamp_index;
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: frame_sequence_time_ms
+ *******************************************************************************
+ * Summary:
+ *   Converts a timestamp into the ms time base passed to the presence
+ *   library. Stamps are expected in order and less than 2^32 us apart.
+ *
+ * Parameters:
+ *   seq: sequence state
+ *   stamp_us: timestamp of the frame
+ *
+ * Return:
+ *   time in ms
+ ******************************************************************************/
+uint32_t frame_sequence_time_ms(frame_sequence_t* seq, uint32_t stamp_us)
+{
+    seq->elapsed_us += (uint32_t)(stamp_us - seq->last_stamp_us);
+    seq->last_stamp_us = stamp_us;
+
+    return seq->base_ms + (uint32_t)(seq->elapsed_us / 1000u);
+}
+
+/*******************************************************************************
+ * Function Name: frame_sequence_frame
+ *******************************************************************************
+ * Summary:
+ *   Accounts a frame read from the FIFO. Frames started by the sensor that
+ *   are neither in the FIFO nor in progress have been lost and open a gap in
+ *   the sequence.
+ *
+ * Parameters:
+ *   seq: sequence state
+ *   counter: FRAME_CNT value read after the frame
+ *   backlog_frames: complete frames still in the FIFO
+ *   late: the next frame completed before this one was read
+ *   latency_us: time from the interrupt to the end of the read
+ *
+ * Return:
+ *   sequence number of the frame
+ ******************************************************************************/
+uint32_t frame_sequence_frame(frame_sequence_t* seq, uint32_t counter, uint32_t backlog_frames,
+                              bool late, uint32_t latency_us)
+{
+    uint32_t outstanding;
+
+    update_counter(seq, counter);
+    ++seq->consumed;
+
+    /* One frame may be in progress on top of the backlog */
+    outstanding = seq->produced - seq->consumed;
+    if (outstanding > (backlog_frames + 1u))
+    {
+        uint32_t lost = outstanding - (backlog_frames + 1u);
+
+        seq->consumed += lost;
+        seq->sequence += lost;
+        seq->stats.dropped_frames += lost;
+    }
+
+    ++seq->sequence;
+    ++seq->stats.frames;
+
+    if (late)
+    {
+        ++seq->stats.late_frames;
+    }
+
+    if (latency_us > seq->stats.max_latency_us)
+    {
+        seq->stats.max_latency_us = latency_us;
+    }
+
+    return seq->sequence;
+}
+
+/*******************************************************************************
+ * Function Name: frame_sequence_drop
+ *******************************************************************************
+ * Summary:
+ *   Accounts all frames started by the sensor and not read yet as dropped,
+ *   to be called before the FIFO is flushed.
+ *
+ * Parameters:
+ *   seq: sequence state
+ *   counter: FRAME_CNT value read before the flush
+ *   overflow: the FIFO overflowed
+ *
+ * Return:
+ *   number of dropped frames
+ ******************************************************************************/
+uint32_t frame_sequence_drop(frame_sequence_t* seq, uint32_t counter, bool overflow)
+{
+    uint32_t lost;
+
+    update_counter(seq, counter);
+
+    lost = seq->produced - seq->consumed;
+    seq->consumed = seq->produced;
+    seq->sequence += lost;
+    seq->stats.dropped_frames += lost;
+
+    if (overflow)
+    {
+        ++seq->stats.fifo_overflows;
+    }
+
+    return lost;
+}
+
+/*******************************************************************************
+ * Function Name: frame_sequence_restart
+ *******************************************************************************
+ * Summary:
+ *   Restarts the counter accounting after the sensor frame generation has
+ *   been restarted, which resets FRAME_CNT. Pending interrupt stamps are
+ *   discarded.
+ *
+ * Parameters:
+ *   seq: sequence state
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void frame_sequence_restart(frame_sequence_t* seq)
+{
+    seq->stamp_index = seq->stamp_count;
+    seq->last_counter = 0;
+    seq->produced = 0;
+    seq->consumed = 0;
+}
+
+/* [] END OF FILE */
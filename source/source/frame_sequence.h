@@ -0,0 +1,87 @@
+/******************************************************************************
+ * File Name:   frame_sequence.h
+ *
+ * Description: This file contains the function prototypes and constants used
+ *   in frame_sequence.c.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#pragma once
+
+/* Header file from system */
+#include <stdbool.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* The FRAME_CNT field of the sensor STAT1 register is 12 bit wide */
+#define FRAME_SEQUENCE_COUNTER_MASK         (0xFFFu)
+
+/* Interrupt timestamps buffered between the ISR and the radar task */
+#define FRAME_SEQUENCE_STAMP_DEPTH          (8u)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef struct
+{
+    uint32_t frames;                    /* frames delivered in sequence */
+    uint32_t dropped_frames;            /* frames produced by the sensor and lost */
+    uint32_t late_frames;               /* frames read after the next one completed */
+    uint32_t fifo_overflows;
+    uint32_t recoveries;                /* FIFO flush and frame restart */
+    uint32_t max_latency_us;            /* interrupt to end of FIFO read */
+} frame_sequence_stats_t;
+
+typedef struct
+{
+    /* Written by the ISR only */
+    volatile uint32_t stamp_us[FRAME_SEQUENCE_STAMP_DEPTH];
+    volatile uint32_t stamp_count;
+
+    uint32_t stamp_index;               /* next stamp consumed by the task */
+    uint32_t last_stamp_us;
+    uint64_t elapsed_us;                /* since init, extends the 32 bit stamps */
+    uint32_t base_ms;
+
+    uint32_t last_counter;              /* FRAME_CNT at the last update */
+    uint32_t produced;                  /* frames started since the last restart */
+    uint32_t consumed;                  /* frames read or dropped since the last restart */
+    uint32_t sequence;                  /* number of the last frame, continues across restarts */
+
+    frame_sequence_stats_t stats;
+} frame_sequence_t;
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+void frame_sequence_init(frame_sequence_t* seq, uint32_t base_ms, uint32_t now_us);
+void frame_sequence_irq(frame_sequence_t* seq, uint32_t stamp_us);
+bool frame_sequence_next_stamp(frame_sequence_t* seq, uint32_t* stamp_us);
+uint32_t frame_sequence_time_ms(frame_sequence_t* seq, uint32_t stamp_us);
+uint32_t frame_sequence_frame(frame_sequence_t* seq, uint32_t counter, uint32_t backlog_frames,
+                              bool late, uint32_t latency_us);
+uint32_t frame_sequence_drop(frame_sequence_t* seq, uint32_t counter, bool overflow);
+void frame_sequence_restart(frame_sequence_t* seq);
+
+/* [] END OF FILE */
@@ -0,0 +1,84 @@
+/*****************************************************************************
+ * File name: hot_path.c
+ *
+ * Description: This file contains the statistics of the hot path of the
+ * radar processing: the cycles spent per frame in the preprocessing, in the
+ * presence library and in the whole processing. Compare them between builds
+ * with and without the RAM placement to measure its gain, see README.md.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <inttypes.h>
+#include <stdio.h>
+
+/* Header file for local task */
+#include "hot_path.h"
+
+/*******************************************************************************
+ * Function Name: hot_path_account
+ *******************************************************************************
+ * Summary:
+ *   Records the cycles the caller measured for one stage of a frame. The
+ *   statistics are printed periodically when the whole frame is recorded.
+ *
+ * Parameters:
+ *   stats: statistics
+ *   stage: timed stage
+ *   cycles: measured cycles
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void hot_path_account(hot_path_stats_t* stats, hot_path_stage_t stage, uint32_t cycles)
+{
+    static const char* const names[HOT_PATH_STAGE_COUNT] = { "preprocess", "presence", "frame" };
+    hot_path_stage_stats_t* stage_stats = &stats->stages[stage];
+
+    ++stage_stats->frames;
+    stage_stats->last_cycles = cycles;
+    stage_stats->total_cycles += cycles;
+    if (cycles > stage_stats->max_cycles)
+    {
+        stage_stats->max_cycles = cycles;
+    }
+
+    if ((stage != HOT_PATH_STAGE_FRAME) || ((stage_stats->frames % HOT_PATH_STATS_PRINT_INTERVAL) != 0u))
+    {
+        return;
+    }
+
+    printf("[INFO] hot path from %s:", (HOT_PATH_ENABLED != 0) ? "RAM" : "flash");
+    for (uint32_t i = 0; i < (uint32_t)HOT_PATH_STAGE_COUNT; ++i)
+    {
+        const hot_path_stage_stats_t* s = &stats->stages[i];
+
+        if (s->frames > 0u)
+        {
+            printf(" %s avg %" PRIu32 " max %" PRIu32, names[i], (uint32_t)(s->total_cycles / s->frames),
+                   s->max_cycles);
+        }
+    }
+    printf(" cycles per frame\n");
+}
+
+/* [] END OF FILE */
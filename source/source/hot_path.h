@@ -0,0 +1,96 @@
+/******************************************************************************
+ * File Name:   hot_path.h
+ *
+ * Description: This file contains the function prototypes and constants used
+ *   in hot_path.c.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#pragma once
+
+/* Header file from system */
+#include <stdbool.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Set to 0 to run the annotated kernels from flash and leave the placement of
+ * the buffers to the linker, e.g. to measure the gain of the RAM placement
+ */
+#ifndef HOT_PATH_ENABLED
+#define HOT_PATH_ENABLED                    (1)
+#endif
+
+/* Alignment of the hot buffers, a whole number of 32 byte lines so that
+ * word and burst DMA transfers never straddle another buffer
+ */
+#define HOT_PATH_BUFFER_ALIGN               (32u)
+
+/* Statistics are printed every time this many frames have been processed */
+#define HOT_PATH_STATS_PRINT_INTERVAL       (2000u)
+
+/* Functions marked HOT_PATH_FUNC are copied to RAM at startup and run without
+ * flash wait states. Buffers marked HOT_PATH_BUFFER are grouped at the start
+ * of .bss. Both are placed by the GCC linker script, which also runs the
+ * presence library and the CMSIS-DSP kernels of the frame from RAM; other
+ * toolchains keep the default placement.
+ */
+#if (HOT_PATH_ENABLED != 0) && defined(__GNUC__) && !defined(__ARMCC_VERSION)
+#define HOT_PATH_FUNC                       __attribute__((section(".hot_path")))
+#define HOT_PATH_BUFFER                     __attribute__((section(".bss.hot_path"), aligned(HOT_PATH_BUFFER_ALIGN)))
+#else
+#define HOT_PATH_FUNC
+#define HOT_PATH_BUFFER                     __attribute__((aligned(HOT_PATH_BUFFER_ALIGN)))
+#endif
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+/* Stages of a frame timed by radar_task */
+typedef enum
+{
+    HOT_PATH_STAGE_PREPROCESS = 0,      /* conversion and averaging of the frame */
+    HOT_PATH_STAGE_PRESENCE,            /* presence library */
+    HOT_PATH_STAGE_FRAME,               /* whole processing of the frame */
+    HOT_PATH_STAGE_COUNT
+} hot_path_stage_t;
+
+typedef struct
+{
+    uint32_t frames;
+    uint32_t last_cycles;
+    uint32_t max_cycles;
+    uint64_t total_cycles;
+} hot_path_stage_stats_t;
+
+typedef struct
+{
+    hot_path_stage_stats_t stages[HOT_PATH_STAGE_COUNT];
+} hot_path_stats_t;
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+void hot_path_account(hot_path_stats_t* stats, hot_path_stage_t stage, uint32_t cycles);
+
+/* [] END OF FILE */
@@ -0,0 +1,558 @@
+/*****************************************************************************
+ * File name: micro_sdft.c
+ *
+ * Description: This file contains an incremental micro motion analyzer. The
+ * complex range spectrum of every observed range bin is kept over the slow
+ * time window and the low Doppler bins are updated with a sliding DFT, i.e.
+ * with a constant cost per frame instead of a full FFT over the window. The
+ * bins are periodically recomputed from the history to bound the numerical
+ * drift. The analyzer can replace the micro detection of the presence
+ * library in the micro if macro mode: an absence reported by the library is
+ * turned into a micro presence as long as micro motion is observed.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Header file for local task */
+#include "micro_sdft.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Avoids a division by zero when the reference spectrum is empty */
+#define DRIFT_REFERENCE_MIN                 (1.0e-12f)
+
+/*******************************************************************************
+ * Function Name: clamp_config
+ *******************************************************************************
+ * Summary:
+ *   Derives the analyzer dimensions from a presence configuration, limited
+ *   to the static buffers.
+ *
+ * Parameters:
+ *   sdft: analyzer state
+ *   config: presence configuration
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void clamp_config(micro_sdft_t* sdft, const xensiv_radar_presence_config_t* config)
+{
+    int32_t min_bin = (config->min_range_bin > 0) ? config->min_range_bin : 0;
+    int32_t num_bins = config->max_range_bin - min_bin + 1;
+    int32_t num_doppler = config->micro_movement_compare_idx;
+    uint32_t len = (uint32_t)config->micro_fft_size;
+
+    num_bins = (num_bins > (int32_t)MICRO_SDFT_MAX_RANGE_BINS) ? (int32_t)MICRO_SDFT_MAX_RANGE_BINS : num_bins;
+    num_doppler = (num_doppler > (int32_t)MICRO_SDFT_MAX_DOPPLER_BINS) ? (int32_t)MICRO_SDFT_MAX_DOPPLER_BINS : num_doppler;
+    len = (len > MICRO_SDFT_MAX_LEN) ? MICRO_SDFT_MAX_LEN : len;
+
+    sdft->enabled = (config->mode == XENSIV_RADAR_PRESENCE_MODE_MICRO_IF_MACRO) &&
+                    (num_bins > 0) && (num_doppler > 0) && (len > (2u * (uint32_t)num_doppler));
+    sdft->min_bin = (uint32_t)min_bin;
+    sdft->num_bins = (num_bins > 0) ? (uint32_t)num_bins : 0u;
+    sdft->num_doppler = (num_doppler > 0) ? (uint32_t)num_doppler : 0u;
+    sdft->len = len;
+    sdft->validity_ms = (uint32_t)config->micro_movement_validity_ms;
+}
+
+/*******************************************************************************
+ * Function Name: init_twiddles
+ *******************************************************************************
+ * Summary:
+ *   Computes the rotation of every observed Doppler bin per slow time sample.
+ *
+ * Parameters:
+ *   sdft: analyzer state
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void init_twiddles(micro_sdft_t* sdft)
+{
+    for (uint32_t k = 0; k < sdft->num_doppler; ++k)
+    {
+        float32_t phase = (2.0f * PI * (float32_t)(k + 1u)) / (float32_t)sdft->len;
+
+        sdft->twiddle[k][0] = arm_cos_f32(phase);
+        sdft->twiddle[k][1] = arm_sin_f32(phase);
+        sdft->twiddle[sdft->num_doppler + k][0] = sdft->twiddle[k][0];
+        sdft->twiddle[sdft->num_doppler + k][1] = -sdft->twiddle[k][1];
+    }
+}
+
+/*******************************************************************************
+ * Function Name: doppler_index
+ *******************************************************************************
+ * Summary:
+ *   Maps an entry of the dft array to its Doppler bin modulo len.
+ *
+ * Parameters:
+ *   sdft: analyzer state
+ *   entry: index into dft
+ *
+ * Return:
+ *   Doppler bin in 0..len-1
+ ******************************************************************************/
+static uint32_t doppler_index(const micro_sdft_t* sdft, uint32_t entry)
+{
+    return (entry < sdft->num_doppler) ? (entry + 1u) : (sdft->len - (entry - sdft->num_doppler + 1u));
+}
+
+/*******************************************************************************
+ * Function Name: resync
+ *******************************************************************************
+ * Summary:
+ *   Replaces the recursive Doppler bins of a range bin by the values computed
+ *   from its history and records the drift found.
+ *
+ * Parameters:
+ *   sdft: analyzer state
+ *   bin: observed range bin, 0 based
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void resync(micro_sdft_t* sdft, uint32_t bin)
+{
+    float32_t reference[2u * MICRO_SDFT_MAX_DOPPLER_BINS][2];
+    float32_t error = 0.0f;
+    float32_t norm = 0.0f;
+
+    micro_sdft_reference(sdft, bin, reference);
+
+    for (uint32_t entry = 0; entry < (2u * sdft->num_doppler); ++entry)
+    {
+        float32_t re = sdft->dft[bin][entry][0] - reference[entry][0];
+        float32_t im = sdft->dft[bin][entry][1] - reference[entry][1];
+
+        error += (re * re) + (im * im);
+        norm += (reference[entry][0] * reference[entry][0]) + (reference[entry][1] * reference[entry][1]);
+
+        sdft->dft[bin][entry][0] = reference[entry][0];
+        sdft->dft[bin][entry][1] = reference[entry][1];
+    }
+
+    if (norm > DRIFT_REFERENCE_MIN)
+    {
+        float32_t drift;
+
+        (void)arm_sqrt_f32(error / norm, &drift);
+        if (drift > sdft->stats.max_drift)
+        {
+            sdft->stats.max_drift = drift;
+        }
+    }
+    ++sdft->stats.resyncs;
+}
+
+/*******************************************************************************
+ * Function Name: update_metric
+ *******************************************************************************
+ * Summary:
+ *   Computes the mean Doppler magnitude per slow time sample of a range bin.
+ *
+ * Parameters:
+ *   sdft: analyzer state
+ *   bin: observed range bin, 0 based
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void update_metric(micro_sdft_t* sdft, uint32_t bin)
+{
+    float32_t magnitude = 0.0f;
+
+    for (uint32_t entry = 0; entry < (2u * sdft->num_doppler); ++entry)
+    {
+        float32_t abs_value;
+
+        (void)arm_sqrt_f32((sdft->dft[bin][entry][0] * sdft->dft[bin][entry][0]) +
+                           (sdft->dft[bin][entry][1] * sdft->dft[bin][entry][1]), &abs_value);
+        magnitude += abs_value;
+    }
+
+    sdft->metric[bin] = magnitude / (float32_t)(2u * sdft->num_doppler * sdft->len);
+}
+
+/*******************************************************************************
+ * Function Name: micro_sdft_init
+ *******************************************************************************
+ * Summary:
+ *   Initializes the analyzer for a presence configuration.
+ *
+ * Parameters:
+ *   sdft: analyzer state
+ *   config: presence configuration
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void micro_sdft_init(micro_sdft_t* sdft, const xensiv_radar_presence_config_t* config)
+{
+    memset(sdft, 0, sizeof(*sdft));
+    clamp_config(sdft, config);
+    init_twiddles(sdft);
+}
+
+/*******************************************************************************
+ * Function Name: micro_sdft_configure
+ *******************************************************************************
+ * Summary:
+ *   Follows configuration changes, the history is restarted if the analyzer
+ *   dimensions changed.
+ *
+ * Parameters:
+ *   sdft: analyzer state
+ *   config: presence configuration
+ *
+ * Return:
+ *   true if the analyzer has been restarted
+ ******************************************************************************/
+bool micro_sdft_configure(micro_sdft_t* sdft, const xensiv_radar_presence_config_t* config)
+{
+    micro_sdft_t previous;
+
+    previous.enabled = sdft->enabled;
+    previous.min_bin = sdft->min_bin;
+    previous.num_bins = sdft->num_bins;
+    previous.num_doppler = sdft->num_doppler;
+    previous.len = sdft->len;
+
+    clamp_config(sdft, config);
+
+    if ((previous.enabled == sdft->enabled) && (previous.min_bin == sdft->min_bin) &&
+        (previous.num_bins == sdft->num_bins) && (previous.num_doppler == sdft->num_doppler) &&
+        (previous.len == sdft->len))
+    {
+        return false;
+    }
+
+    init_twiddles(sdft);
+    micro_sdft_reset(sdft);
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: micro_sdft_reset
+ *******************************************************************************
+ * Summary:
+ *   Restarts the slow time history, e.g. after a frame rate change.
+ *
+ * Parameters:
+ *   sdft: analyzer state
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void micro_sdft_reset(micro_sdft_t* sdft)
+{
+    memset(sdft->history, 0, sizeof(sdft->history));
+    memset(sdft->dft, 0, sizeof(sdft->dft));
+    memset(sdft->metric, 0, sizeof(sdft->metric));
+    sdft->head = 0;
+    sdft->filled = 0;
+}
+
+/*******************************************************************************
+ * Function Name: micro_sdft_update
+ *******************************************************************************
+ * Summary:
+ *   Adds the range profile of a frame to the slow time history and updates
+ *   the Doppler bins of every observed range bin:
+ *   X_k = (X_k + x_new - x_old) * e^(j*2*pi*k/len)
+ *
+ * Parameters:
+ *   sdft: analyzer state
+ *   profile: range profile of the frame
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void micro_sdft_update(micro_sdft_t* sdft, const range_profile_t* profile)
+{
+    uint32_t resync_bin = sdft->frame_count % MICRO_SDFT_RESYNC_FRAMES;
+
+    ++sdft->frame_count;
+
+    if (!sdft->enabled)
+    {
+        return;
+    }
+
+    for (uint32_t bin = 0; bin < sdft->num_bins; ++bin)
+    {
+        uint32_t range_bin = sdft->min_bin + bin;
+        float32_t* sample = sdft->history[bin][sdft->head];
+        float32_t spectrum_re;
+        float32_t spectrum_im;
+        float32_t delta_re;
+        float32_t delta_im;
+
+        if (range_bin >= profile->num_bins)
+        {
+            sdft->metric[bin] = 0.0f;
+            continue;
+        }
+
+        spectrum_re = (float32_t)profile->spectrum[2u * range_bin] * profile->sample_scale;
+        spectrum_im = (float32_t)profile->spectrum[(2u * range_bin) + 1u] * profile->sample_scale;
+        delta_re = spectrum_re - sample[0];
+        delta_im = spectrum_im - sample[1];
+        sample[0] = spectrum_re;
+        sample[1] = spectrum_im;
+
+        for (uint32_t entry = 0; entry < (2u * sdft->num_doppler); ++entry)
+        {
+            float32_t* x = sdft->dft[bin][entry];
+            const float32_t* w = sdft->twiddle[entry];
+            float32_t re = x[0] + delta_re;
+            float32_t im = x[1] + delta_im;
+
+            x[0] = (re * w[0]) - (im * w[1]);
+            x[1] = (re * w[1]) + (im * w[0]);
+        }
+
+        update_metric(sdft, bin);
+    }
+
+    sdft->head = (sdft->head + 1u) % sdft->len;
+    if (sdft->filled < sdft->len)
+    {
+        ++sdft->filled;
+    }
+
+    if ((resync_bin < sdft->num_bins) && (sdft->filled >= sdft->len))
+    {
+        resync(sdft, resync_bin);
+        update_metric(sdft, resync_bin);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: micro_sdft_motion
+ *******************************************************************************
+ * Summary:
+ *   Tells whether micro motion is observed in any range bin.
+ *
+ * Parameters:
+ *   sdft: analyzer state
+ *   range_bin: range bin with the strongest micro motion, can be NULL
+ *
+ * Return:
+ *   true if micro motion is observed over a full window
+ ******************************************************************************/
+bool micro_sdft_motion(const micro_sdft_t* sdft, int32_t* range_bin)
+{
+    float32_t max_metric = 0.0f;
+    uint32_t max_bin = 0;
+
+    if (!sdft->enabled || (sdft->filled < sdft->len))
+    {
+        return false;
+    }
+
+    for (uint32_t bin = 0; bin < sdft->num_bins; ++bin)
+    {
+        if (sdft->metric[bin] > max_metric)
+        {
+            max_metric = sdft->metric[bin];
+            max_bin = bin;
+        }
+    }
+
+    if (range_bin != NULL)
+    {
+        *range_bin = (int32_t)(sdft->min_bin + max_bin);
+    }
+
+    return (max_metric > MICRO_SDFT_THRESHOLD);
+}
+
+/*******************************************************************************
+ * Function Name: micro_sdft_reference
+ *******************************************************************************
+ * Summary:
+ *   Computes the observed Doppler bins of a range bin directly from the
+ *   history. Used to resynchronize and as reference for the accuracy of the
+ *   recursive update.
+ *
+ * Parameters:
+ *   sdft: analyzer state
+ *   bin: observed range bin, 0 based
+ *   dft: output, 2 * num_doppler complex values in the order of sdft->dft
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void micro_sdft_reference(const micro_sdft_t* sdft, uint32_t bin, float32_t dft[][2])
+{
+    for (uint32_t entry = 0; entry < (2u * sdft->num_doppler); ++entry)
+    {
+        uint32_t k = doppler_index(sdft, entry);
+        float32_t re = 0.0f;
+        float32_t im = 0.0f;
+
+        for (uint32_t m = 0; m < sdft->len; ++m)
+        {
+            const float32_t* x = sdft->history[bin][(sdft->head + m) % sdft->len];
+            float32_t phase = (-2.0f * PI * (float32_t)((k * m) % sdft->len)) / (float32_t)sdft->len;
+            float32_t c = arm_cos_f32(phase);
+            float32_t s = arm_sin_f32(phase);
+
+            re += (x[0] * c) - (x[1] * s);
+            im += (x[0] * s) + (x[1] * c);
+        }
+
+        dft[entry][0] = re;
+        dft[entry][1] = im;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: micro_sdft_filter_event
+ *******************************************************************************
+ * Summary:
+ *   Replaces the micro detection of the library: an absence reported while
+ *   micro motion is observed is turned into a micro presence.
+ *
+ * Parameters:
+ *   sdft: analyzer state
+ *   event: event reported by the presence library
+ *   converted: storage for a converted event
+ *
+ * Return:
+ *   event to be reported, either event or converted
+ ******************************************************************************/
+const xensiv_radar_presence_event_t* micro_sdft_filter_event(micro_sdft_t* sdft,
+                                                             const xensiv_radar_presence_event_t* event,
+                                                             xensiv_radar_presence_event_t* converted)
+{
+    int32_t range_bin;
+
+    if (!sdft->enabled)
+    {
+        return event;
+    }
+
+    if (event->state == XENSIV_RADAR_PRESENCE_STATE_MACRO_PRESENCE)
+    {
+        sdft->micro_presence = false;
+    }
+    else if ((event->state == XENSIV_RADAR_PRESENCE_STATE_ABSENCE) && micro_sdft_motion(sdft, &range_bin))
+    {
+        sdft->micro_presence = true;
+        sdft->last_motion_ms = event->timestamp;
+
+        converted->state = XENSIV_RADAR_PRESENCE_STATE_MICRO_PRESENCE;
+        converted->range_bin = range_bin;
+        converted->timestamp = event->timestamp;
+        event = converted;
+    }
+    else
+    {
+        /* Reported as is */
+    }
+
+    return event;
+}
+
+/*******************************************************************************
+ * Function Name: micro_sdft_check_absence
+ *******************************************************************************
+ * Summary:
+ *   Called after every frame. Ends a micro presence once no micro motion has
+ *   been observed for micro_movement_validity_ms.
+ *
+ * Parameters:
+ *   sdft: analyzer state
+ *   time_ms: timestamp of the frame
+ *   event: filled in with the absence
+ *
+ * Return:
+ *   true if event has been filled in
+ ******************************************************************************/
+bool micro_sdft_check_absence(micro_sdft_t* sdft, uint32_t time_ms, xensiv_radar_presence_event_t* event)
+{
+    if (!sdft->micro_presence)
+    {
+        return false;
+    }
+
+    if (micro_sdft_motion(sdft, NULL))
+    {
+        sdft->last_motion_ms = time_ms;
+        return false;
+    }
+
+    if ((time_ms - sdft->last_motion_ms) < sdft->validity_ms)
+    {
+        return false;
+    }
+
+    sdft->micro_presence = false;
+    event->state = XENSIV_RADAR_PRESENCE_STATE_ABSENCE;
+    event->range_bin = 0;
+    event->timestamp = time_ms;
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: micro_sdft_account
+ *******************************************************************************
+ * Summary:
+ *   Records the cycles the caller measured for one micro_sdft_update call
+ *   and prints the statistics periodically.
+ *
+ * Parameters:
+ *   sdft: analyzer state
+ *   cycles: measured cycles
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void micro_sdft_account(micro_sdft_t* sdft, uint32_t cycles)
+{
+    micro_sdft_stats_t* stats = &sdft->stats;
+
+    ++stats->frames;
+    stats->last_cycles = cycles;
+    stats->total_cycles += cycles;
+    if (cycles > stats->max_cycles)
+    {
+        stats->max_cycles = cycles;
+    }
+
+    if ((stats->frames % MICRO_SDFT_STATS_PRINT_INTERVAL) == 0u)
+    {
+        printf("[INFO] micro sliding DFT %" PRIu32 "x%" PRIu32 " bins: avg %" PRIu32 " max %" PRIu32
+               " cycles per frame, %" PRIu32 " resyncs, max drift %.2e\n",
+               sdft->num_bins, 2u * sdft->num_doppler, (uint32_t)(stats->total_cycles / stats->frames),
+               stats->max_cycles, stats->resyncs, (double)stats->max_drift);
+    }
+}
+
+/* [] END OF FILE */
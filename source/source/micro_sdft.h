@@ -0,0 +1,126 @@
+/******************************************************************************
+ * File Name:   micro_sdft.h
+ *
+ * Description: This file contains the function prototypes and constants used
+ *   in micro_sdft.c.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#pragma once
+
+/* Header file from system */
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Header file for library */
+#include "arm_math.h"
+#include "xensiv_radar_presence.h"
+
+/* Header file for local task */
+#include "range_fft.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Set to 1 to replace the micro detection of the presence library by the
+ * sliding DFT. It requires RANGE_FFT_ENABLED and only acts in
+ * XENSIV_RADAR_PRESENCE_MODE_MICRO_IF_MACRO.
+ */
+#define MICRO_SDFT_ENABLED                  (0)
+
+/* Range bins between min_range_bin and max_range_bin that can be observed */
+#define MICRO_SDFT_MAX_RANGE_BINS           (8u)
+
+/* Longest slow time window, i.e. micro_fft_size */
+#define MICRO_SDFT_MAX_LEN                  (128u)
+
+/* Highest Doppler bin, i.e. micro_movement_compare_idx */
+#define MICRO_SDFT_MAX_DOPPLER_BINS         (8u)
+
+/* Every range bin is recomputed from its history once in this many frames
+ * to bound the drift of the recursive update
+ */
+#define MICRO_SDFT_RESYNC_FRAMES            (1024u)
+
+/* Mean Doppler magnitude per slow time sample that counts as micro motion.
+ * Starting point for the profile of register_list, to be tuned on recordings.
+ */
+#define MICRO_SDFT_THRESHOLD                (0.002f)
+
+/* Statistics are printed every time this many frames have been processed */
+#define MICRO_SDFT_STATS_PRINT_INTERVAL     (2000u)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef struct
+{
+    uint32_t frames;
+    uint32_t last_cycles;
+    uint32_t max_cycles;
+    uint64_t total_cycles;
+    uint32_t resyncs;
+    float32_t max_drift;                /* largest relative error found by a resync */
+} micro_sdft_stats_t;
+
+typedef struct
+{
+    /* Taken from the presence configuration */
+    bool enabled;
+    uint32_t min_bin;
+    uint32_t num_bins;
+    uint32_t len;
+    uint32_t num_doppler;               /* positive and negative Doppler bins each */
+    uint32_t validity_ms;
+
+    /* e^(j*2*pi*k/len) for k = 1..num_doppler followed by k = -1..-num_doppler */
+    float32_t twiddle[2u * MICRO_SDFT_MAX_DOPPLER_BINS][2];
+
+    float32_t history[MICRO_SDFT_MAX_RANGE_BINS][MICRO_SDFT_MAX_LEN][2];
+    float32_t dft[MICRO_SDFT_MAX_RANGE_BINS][2u * MICRO_SDFT_MAX_DOPPLER_BINS][2];
+    float32_t metric[MICRO_SDFT_MAX_RANGE_BINS];
+    uint32_t head;                      /* oldest sample, overwritten next */
+    uint32_t filled;
+    uint32_t frame_count;
+
+    bool micro_presence;                /* an absence has been turned into micro presence */
+    uint32_t last_motion_ms;
+
+    micro_sdft_stats_t stats;
+} micro_sdft_t;
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+void micro_sdft_init(micro_sdft_t* sdft, const xensiv_radar_presence_config_t* config);
+bool micro_sdft_configure(micro_sdft_t* sdft, const xensiv_radar_presence_config_t* config);
+void micro_sdft_reset(micro_sdft_t* sdft);
+void micro_sdft_update(micro_sdft_t* sdft, const range_profile_t* profile);
+bool micro_sdft_motion(const micro_sdft_t* sdft, int32_t* range_bin);
+void micro_sdft_reference(const micro_sdft_t* sdft, uint32_t bin, float32_t dft[][2]);
+const xensiv_radar_presence_event_t* micro_sdft_filter_event(micro_sdft_t* sdft,
+                                                             const xensiv_radar_presence_event_t* event,
+                                                             xensiv_radar_presence_event_t* converted);
+bool micro_sdft_check_absence(micro_sdft_t* sdft, uint32_t time_ms, xensiv_radar_presence_event_t* event);
+void micro_sdft_account(micro_sdft_t* sdft, uint32_t cycles);
+
+/* [] END OF FILE */
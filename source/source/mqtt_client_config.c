@@ -126,4 +126,8 @@ cy_mqtt_connect_info_t connection_info =
     #error "Invalid QoS setting! MQTT_MESSAGES_QOS must be either 0 or 1."
 #endif
 
+#if ((MQTT_PUBLISH_QOS != 0) && (MQTT_PUBLISH_QOS != 1))
+    #error "Invalid QoS setting! MQTT_PUBLISH_QOS must be either 0 or 1."
+#endif
+
 /* [] END OF FILE */
\ No newline at end of file
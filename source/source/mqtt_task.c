@@ -74,6 +74,10 @@
 #include <inttypes.h>
 #include <time.h>
 #include "radar_task.h"
+#include "tls_crypto.h"
+#include "credential_cache.h"
+#include "net_writer.h"
+#include "net_batch.h"
 /******************************************************************************
 * Macros
 ******************************************************************************/
@@ -99,6 +103,7 @@
 #define MQTT_INSTANCE_CREATED            (1lu << 4)
 #define MQTT_CONNECTION_SUCCESS          (1lu << 5)
 #define MQTT_MSG_RECEIVED                (1lu << 6)
+#define CREDENTIALS_CACHED               (1lu << 7)
 
 /* Macros used for constructing the last will message(LMT) topic */
 #define MQTT_TOPIC_LASTWILL_START           "lwt/things/"
@@ -107,6 +112,7 @@
 
 /* Macros used for constructing Telemetry, Publish and subscribe topic names */
 #define TELEMETRY                           "/telemetry"
+#define DIAGNOSTICS                         "/diagnostics"
 #define AWS_THING_START                     "$aws/things/"
 #define AWS_SUB_DEVICE_PROPERTIES           "/shadow/update/delta"
 #define AWS_PUB_DEVICE_PROPERTIES           "/shadow/update"
@@ -157,6 +163,7 @@ uint8_t *mqtt_network_buffer = NULL;
 /*MQTT topics for publish and subscribe to MQTT broker*/
 uint8_t mqtt_topic_publish_telemetry [MQTT_TOPIC_PUBLISH_TELEMETRY_LEN];
 uint8_t mqtt_topic_publish_device_properties [MQTT_TOPIC_PUBLISH_DEVICE_PROPERTIES_LEN];
+uint8_t mqtt_topic_publish_diagnostics [MQTT_TOPIC_PUBLISH_DIAGNOSTICS_LEN];
 uint8_t mqtt_topic_subscribe_device_properties [MQTT_TOPIC_SUBSCRIBE_LEN];
 uint8_t mqtt_topic_lastwill [MQTT_TOPIC_LASTWILL_TOPIC_LEN];
 
@@ -222,6 +229,14 @@ void mqtt_client_task(void *pvParameters)
     /* To avoid compiler warnings */
     (void) pvParameters;
 
+    /* Check and measure the TLS crypto while no other task is running */
+    if (!tls_crypto_self_test())
+    {
+        APP_LOG_ERROR(("TLS crypto self test failed!"));
+        goto exit_cleanup;
+    }
+    tls_crypto_benchmark();
+
     /* Create a message queue to communicate with other tasks and callbacks. */
     mqtt_task_q = xQueueCreate(MQTT_TASK_QUEUE_LENGTH, sizeof(mqtt_task_cmd_t));
 
@@ -268,6 +283,19 @@ void mqtt_client_task(void *pvParameters)
         goto exit_cleanup;
     }
 
+#if (NET_WRITER_ENABLED != 0)
+    /* Create the network writer task and its publish workers, that publish for the other tasks, and cleanup
+     * if the operation fails.
+     */
+    if ((!net_writer_init(publish_to_mqtt_topic, (MQTT_PUBLISH_QOS > 0) ? NET_WRITER_WINDOW : 1u)) ||
+        (pdPASS != xTaskCreate(net_writer_task, "Network writer task", NET_WRITER_TASK_STACK_SIZE,
+                               NULL, NET_WRITER_TASK_PRIORITY, &net_writer_task_handle)))
+    {
+        APP_LOG_ERROR(("Failed to create the Network writer task!"));
+        goto exit_cleanup;
+    }
+#endif
+
     /* Create the publisher task and cleanup if the operation fails. */
     if (pdPASS != xTaskCreate(publisher_task, "Publisher task", PUBLISHER_TASK_STACK_SIZE, 
                               NULL, PUBLISHER_TASK_PRIORITY, &publisher_task_handle))
@@ -289,6 +317,7 @@ void mqtt_client_task(void *pvParameters)
 
     /* Wait for the task creation to complete. */
     vTaskDelay(pdMS_TO_TICKS(TASK_CREATION_DELAY_MS));
+    net_writer_benchmark((char*)mqtt_topic_publish_diagnostics);
 
     /* Start exchanging messages with cloud */
     publisher_q_data.cmd = PUBLISHER_INIT;
@@ -314,6 +343,7 @@ void mqtt_client_task(void *pvParameters)
                     /* Deinit the publisher before initiating reconnection. */
                     publisher_q_data.cmd = PUBLISHER_DEINIT;
                     xQueueSend(publisher_task_q, &publisher_q_data, portMAX_DELAY);
+                    net_writer_set_connected(false);
 
                     /* Although the connection with the MQTT Broker is lost, 
                      * call the MQTT disconnect API for cleanup of threads and 
@@ -340,6 +370,9 @@ void mqtt_client_task(void *pvParameters)
                         goto exit_cleanup;
                     }
 
+                    /* Publish the messages of the outbox again */
+                    net_writer_set_connected(true);
+
                     /* Initiate MQTT subscribe post the reconnection. */
                     subscriber_q_data.cmd = SUBSCRIBE_TO_TOPIC;
                     xQueueSend(subscriber_task_q, &subscriber_q_data, portMAX_DELAY);
@@ -360,6 +393,13 @@ void mqtt_client_task(void *pvParameters)
      * cleanup for various operations based on the status_flag.
      */
     exit_cleanup:
+    /* Before the publisher task, a frame in process may wait for its queue */
+    if (radar_task_handle != NULL)
+    {
+        radar_task_cleanup();
+        vTaskDelete(radar_task_handle);
+    }
+
     APP_LOG_INFO(("Terminating Publisher and Subscriber tasks..."));
     if (subscriber_task_handle != NULL)
     {
@@ -371,11 +411,14 @@ void mqtt_client_task(void *pvParameters)
         vTaskDelete(publisher_task_handle);
     }
 
-	if (radar_task_handle != NULL)
+#if (NET_WRITER_ENABLED != 0)
+    if (net_writer_task_handle != NULL)
     {
-        radar_task_cleanup();
-        vTaskDelete(radar_task_handle);
+        vTaskDelete(net_writer_task_handle);
     }
+    net_writer_deinit();
+#endif
+
     cleanup();
     APP_LOG_INFO(("Cleanup Done\nTerminating the MQTT task..."));
     vTaskDelete(NULL);
@@ -428,6 +471,10 @@ static cy_rslt_t wifi_connect(void)
                  * successful Wi-Fi connection, print the assigned IP address.
                  */
                 status_flag |= WIFI_CONNECTED;
+
+                /* Times the IPC of the packets sent, with NET_TRACE_ENABLED */
+                net_batch_trace_netif(netif_default);
+
                 if (ip_address.version == CY_WCM_IP_VER_V4)
                 {
                     APP_LOG_INFO(("IPv4 Address Assigned: %s", ip4addr_ntoa((const ip4_addr_t *) &ip_address.ip.v4)));
@@ -481,9 +528,13 @@ static cy_rslt_t mqtt_init(void)
     }
     CHECK_RESULT(result, BUFFER_INITIALIZED, "Network Buffer allocation failed!\n\n");
 
-    security_info->client_cert_size = CLOUD_CERT_KEY_LEN;
-    security_info->private_key_size = CLOUD_CERT_KEY_LEN;
-    security_info->root_ca_size = CLOUD_CERT_KEY_LEN;
+    /* Parse and validate the credentials once instead of on every connect,
+     * with the real lengths of the blobs of CLOUD_CERT_KEY_LEN bytes.
+     */
+    if (credential_cache_init(security_info, CLOUD_CERT_KEY_LEN))
+    {
+        status_flag |= CREDENTIALS_CACHED;
+    }
 
     /* Create the MQTT client instance. */
     result = cy_mqtt_create(mqtt_network_buffer, MQTT_NETWORK_BUFFER_SIZE,
@@ -559,9 +610,11 @@ static cy_rslt_t mqtt_connect(void)
             }
         }
 
-        /* Establish the MQTT connection. */
-        
+        /* Establish the MQTT connection, the TLS handshake takes most of the time. */
+        TickType_t connect_start = xTaskGetTickCount();
         result = cy_mqtt_connect(mqtt_connection, &connection_info);
+        tls_crypto_account_connect((uint32_t)((xTaskGetTickCount() - connect_start) * portTICK_PERIOD_MS),
+                                   (result == CY_RSLT_SUCCESS));
         if (result == CY_RSLT_SUCCESS)
         {
             APP_LOG_INFO(("MQTT connection successful."));
@@ -720,6 +773,11 @@ static void cleanup(void)
     {
         vPortFree((void *) mqtt_network_buffer);
     }
+    /* Release the cached credentials while the TLS layer is initialized. */
+    if (status_flag & CREDENTIALS_CACHED)
+    {
+        credential_cache_free(security_info);
+    }
     /* Deinit the MQTT library. */
     if (status_flag & LIBS_INITIALIZED)
     {
@@ -766,6 +824,7 @@ static subs_rslt_t construct_mqtt_topics(void)
     strncpy((char*)cloud_tenant_id, TENANT_ID, strlen(TENANT_ID) + 1);
 
     snprintf((char *)mqtt_topic_publish_telemetry, sizeof(mqtt_topic_publish_telemetry), "%s%s%s%s", cloud_tenant_id, "/", mqtt_client_identifier, TELEMETRY);
+    snprintf((char *)mqtt_topic_publish_diagnostics, sizeof(mqtt_topic_publish_diagnostics), "%s%s%s%s", cloud_tenant_id, "/", mqtt_client_identifier, DIAGNOSTICS);
     snprintf((char *)mqtt_topic_publish_device_properties, sizeof(mqtt_topic_publish_device_properties), "%s%s%s", AWS_THING_START, mqtt_client_identifier, AWS_PUB_DEVICE_PROPERTIES);
     snprintf((char *)mqtt_topic_subscribe_device_properties, sizeof(mqtt_topic_subscribe_device_properties), "%s%s%s", AWS_THING_START, mqtt_client_identifier, AWS_SUB_DEVICE_PROPERTIES);
     snprintf((char *)mqtt_topic_lastwill, sizeof(mqtt_topic_lastwill), "%s%s%s", MQTT_TOPIC_LASTWILL_START, mqtt_client_identifier, MQTT_TOPIC_LASTWILL_END);
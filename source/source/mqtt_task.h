@@ -58,6 +58,7 @@
 /* Maximum Length of Publish and subscriber topic names */
 #define MQTT_TOPIC_PUBLISH_TELEMETRY_LEN            (128)
 #define MQTT_TOPIC_PUBLISH_DEVICE_PROPERTIES_LEN    (64)
+#define MQTT_TOPIC_PUBLISH_DIAGNOSTICS_LEN          (128)
 #define MQTT_TOPIC_SUBSCRIBE_LEN                    (64)
 
 /*******************************************************************************
@@ -76,6 +77,7 @@ extern cy_mqtt_t mqtt_connection;
 extern QueueHandle_t mqtt_task_q;
 extern uint8_t mqtt_topic_publish_telemetry [MQTT_TOPIC_PUBLISH_TELEMETRY_LEN];
 extern uint8_t mqtt_topic_publish_device_properties [MQTT_TOPIC_PUBLISH_DEVICE_PROPERTIES_LEN];
+extern uint8_t mqtt_topic_publish_diagnostics [MQTT_TOPIC_PUBLISH_DIAGNOSTICS_LEN];
 extern uint8_t mqtt_topic_subscribe_device_properties [MQTT_TOPIC_SUBSCRIBE_LEN];
 
 /*******************************************************************************
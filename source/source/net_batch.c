@@ -0,0 +1,494 @@
+/*****************************************************************************
+ * File name: net_batch.c
+ *
+ * Description: This file contains the batching of the outbound telemetry
+ * and the instrumentation of the publish calls. With the SCL component every
+ * packet sent crosses the IPC to the CM0+ core. With NET_BATCH_ENABLED,
+ * messages published on the same topic within NET_BATCH_WINDOW_MS share one
+ * publish as a JSON array; a single message is published unchanged. Each
+ * publish call records its latency. With NET_TRACE_ENABLED the latency is
+ * split into the time the calling task was running (TLS and MQTT), taken by
+ * the FreeRTOS task switch hooks, the time the lwIP link output took to hand
+ * the packets to the CM0+ over the IPC, and the rest: the TCP/IP thread, the
+ * Wi-Fi link, the broker and other tasks.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Header file includes */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#if (NET_TRACE_ENABLED != 0)
+#include "lwip/netif.h"
+#endif
+
+/* Header file for local task */
+#include "cycle_counter.h"
+#include "net_batch.h"
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static net_batch_call_stats_t call_stats;
+
+/* Task of the traced publish call, only one at a time */
+static void* volatile traced_task = NULL;
+static volatile uint32_t traced_in_cycles;
+static volatile uint32_t traced_cycles;
+
+#if (NET_TRACE_ENABLED != 0)
+/* Link output of the SCL driver and the packets it sent during the traced call */
+static netif_linkoutput_fn scl_linkoutput = NULL;
+static volatile uint32_t traced_ipc_cycles;
+static volatile uint32_t traced_ipc_packets;
+#endif
+
+static const uint32_t latency_bounds_ms[NET_BATCH_LATENCY_BUCKETS - 1u] = NET_BATCH_LATENCY_BOUNDS_MS;
+
+/*******************************************************************************
+ * Function Name: net_batch_init
+ *******************************************************************************
+ * Summary:
+ *   Initializes an empty batch.
+ *
+ * Parameters:
+ *   batch: batch
+ *   publish: publishes a payload, publish_to_mqtt_topic
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void net_batch_init(net_batch_t* batch, net_batch_publish_t publish)
+{
+    memset(batch, 0, sizeof(*batch));
+    batch->publish = publish;
+    cycle_counter_init();
+}
+
+/*******************************************************************************
+ * Function Name: net_batch_add
+ *******************************************************************************
+ * Summary:
+ *   Adds a message to the batch. The batch is published first if the
+ *   message does not fit, goes to another topic or the window has elapsed.
+ *   A message too long to share a publish is published on its own.
+ *
+ * Parameters:
+ *   batch: batch
+ *   topic: topic of the message
+ *   message: JSON message
+ *   length: length of the message, with or without terminating NUL
+ *   now_ms: current time in ms
+ *
+ * Return:
+ *   result of the publish done meanwhile, SUBS_SUCCESS if none
+ ******************************************************************************/
+subs_rslt_t net_batch_add(net_batch_t* batch, char* topic, const char* message, uint32_t length, uint32_t now_ms)
+{
+    /* Room for '[', ']' and NUL */
+    const uint32_t capacity = NET_BATCH_BUFFER_SIZE - 3u;
+    uint32_t text_length = length;
+    uint32_t separator = (batch->count > 0u) ? 1u : 0u;
+    subs_rslt_t result = SUBS_SUCCESS;
+
+    if ((text_length > 0u) && (message[text_length - 1u] == '\0'))
+    {
+        --text_length;
+    }
+
+    if ((batch->count > 0u) &&
+        ((topic != batch->topic) || (batch->count >= NET_BATCH_MAX_MESSAGES) ||
+         ((batch->length + separator + text_length) > capacity) ||
+         ((now_ms - batch->opened_ms) >= NET_BATCH_WINDOW_MS)))
+    {
+        result = net_batch_flush(batch);
+        separator = 0;
+    }
+
+    if (text_length > capacity)
+    {
+        subs_rslt_t own_result = batch->publish((char*)message, (int)length, topic);
+
+        return (result == SUBS_SUCCESS) ? own_result : result;
+    }
+
+    if (batch->count == 0u)
+    {
+        batch->topic = topic;
+        batch->opened_ms = now_ms;
+    }
+    else
+    {
+        batch->buffer[1u + batch->length++] = ',';
+    }
+
+    memcpy(&batch->buffer[1u + batch->length], message, text_length);
+    batch->length += text_length;
+    ++batch->count;
+
+#if (NET_BATCH_ENABLED == 0)
+    result = net_batch_flush(batch);
+#endif
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: net_batch_flush
+ *******************************************************************************
+ * Summary:
+ *   Publishes the batch: a single message as it was added, several
+ *   messages as a JSON array. The payload length counts the terminating
+ *   NUL, like the other publishes.
+ *
+ * Parameters:
+ *   batch: batch
+ *
+ * Return:
+ *   result of the publish, SUBS_SUCCESS for an empty batch
+ ******************************************************************************/
+subs_rslt_t net_batch_flush(net_batch_t* batch)
+{
+    net_batch_stats_t* stats = &batch->stats;
+    char* payload;
+    uint32_t payload_length;
+    subs_rslt_t result;
+
+    if (batch->count == 0u)
+    {
+        return SUBS_SUCCESS;
+    }
+
+    if (batch->count == 1u)
+    {
+        batch->buffer[1u + batch->length] = '\0';
+        payload = &batch->buffer[1];
+        payload_length = batch->length + 1u;
+    }
+    else
+    {
+        batch->buffer[0] = '[';
+        batch->buffer[1u + batch->length] = ']';
+        batch->buffer[2u + batch->length] = '\0';
+        payload = batch->buffer;
+        payload_length = batch->length + 3u;
+    }
+
+    result = batch->publish(payload, (int)payload_length, batch->topic);
+
+    ++stats->batches;
+    stats->messages += batch->count;
+    if (batch->count > stats->max_messages)
+    {
+        stats->max_messages = batch->count;
+    }
+
+    batch->count = 0;
+    batch->length = 0;
+
+    if ((stats->batches % NET_BATCH_STATS_PRINT_INTERVAL) == 0u)
+    {
+        printf("[INFO] network batching: %" PRIu32 " messages in %" PRIu32 " publishes, at most %" PRIu32
+               " per publish\n", stats->messages, stats->batches, stats->max_messages);
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: net_batch_wait_ms
+ *******************************************************************************
+ * Summary:
+ *   Tells how long the caller may wait for more messages before the batch
+ *   has to be published.
+ *
+ * Parameters:
+ *   batch: batch
+ *   now_ms: current time in ms
+ *
+ * Return:
+ *   time in ms, 0 if the window has elapsed, NET_BATCH_WAIT_FOREVER if the
+ *   batch is empty
+ ******************************************************************************/
+uint32_t net_batch_wait_ms(const net_batch_t* batch, uint32_t now_ms)
+{
+    uint32_t elapsed_ms;
+
+    if (batch->count == 0u)
+    {
+        return NET_BATCH_WAIT_FOREVER;
+    }
+
+    elapsed_ms = now_ms - batch->opened_ms;
+
+    return (elapsed_ms >= NET_BATCH_WINDOW_MS) ? 0u : (NET_BATCH_WINDOW_MS - elapsed_ms);
+}
+
+/*******************************************************************************
+ * Function Name: net_batch_call_begin
+ *******************************************************************************
+ * Summary:
+ *   Starts the measurement of a publish call made by the calling task. The
+ *   running time is traced for one call at a time, calls that overlap it
+ *   are only timed.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   start of the call, for net_batch_call_end
+ ******************************************************************************/
+uint32_t net_batch_call_begin(void)
+{
+    uint32_t start_cycles;
+
+    taskENTER_CRITICAL();
+    start_cycles = cycle_counter_get();
+#if (NET_TRACE_ENABLED != 0)
+    if (traced_task == NULL)
+    {
+        traced_in_cycles = start_cycles;
+        traced_cycles = 0;
+        traced_ipc_cycles = 0;
+        traced_ipc_packets = 0;
+        traced_task = xTaskGetCurrentTaskHandle();
+    }
+#endif
+    taskEXIT_CRITICAL();
+
+    return start_cycles;
+}
+
+/*******************************************************************************
+ * Function Name: net_batch_call_end
+ *******************************************************************************
+ * Summary:
+ *   Ends the measurement started by net_batch_call_begin and prints the
+ *   statistics periodically: the latency, the latency histogram and with
+ *   NET_TRACE_ENABLED how much of it the calling task was running and the
+ *   IPC took.
+ *
+ * Parameters:
+ *   start_cycles: returned by net_batch_call_begin
+ *   bytes: payload length of the call
+ *   success: the call succeeded
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void net_batch_call_end(uint32_t start_cycles, uint32_t bytes, bool success)
+{
+    net_batch_call_stats_t* stats = &call_stats;
+    uint32_t elapsed_cycles;
+    uint32_t cpu_cycles = 0;
+    uint32_t ipc_cycles = 0;
+    uint32_t ipc_packets = 0;
+    bool traced = false;
+    uint32_t elapsed_us;
+    uint32_t bucket = 0;
+    bool print;
+    net_batch_call_stats_t snapshot;
+
+    /* Up to NET_WRITER_WINDOW publish workers end their calls concurrently */
+    taskENTER_CRITICAL();
+    elapsed_cycles = cycle_counter_elapsed(start_cycles);
+    if (traced_task == xTaskGetCurrentTaskHandle())
+    {
+        cpu_cycles = traced_cycles + cycle_counter_elapsed(traced_in_cycles);
+#if (NET_TRACE_ENABLED != 0)
+        ipc_cycles = traced_ipc_cycles;
+        ipc_packets = traced_ipc_packets;
+#endif
+        traced_task = NULL;
+        traced = true;
+    }
+
+    elapsed_us = cycle_counter_to_us(elapsed_cycles);
+
+    ++stats->calls;
+    stats->bytes += bytes;
+    stats->total_us += elapsed_us;
+    if (traced)
+    {
+        /* Both counters were read at slightly different times. The IPC runs
+         * in the TCP/IP thread while the calling task waits.
+         */
+        cpu_cycles = (cpu_cycles < elapsed_cycles) ? cpu_cycles : elapsed_cycles;
+        ipc_cycles = (ipc_cycles < (elapsed_cycles - cpu_cycles)) ? ipc_cycles : (elapsed_cycles - cpu_cycles);
+        stats->traced_us += elapsed_us;
+        stats->cpu_us += cycle_counter_to_us(cpu_cycles);
+        stats->ipc_us += cycle_counter_to_us(ipc_cycles);
+        stats->ipc_packets += ipc_packets;
+    }
+    if (!success)
+    {
+        ++stats->failures;
+    }
+    if (elapsed_us > stats->max_us)
+    {
+        stats->max_us = elapsed_us;
+    }
+
+    while ((bucket < (NET_BATCH_LATENCY_BUCKETS - 1u)) && (elapsed_us >= (latency_bounds_ms[bucket] * 1000u)))
+    {
+        ++bucket;
+    }
+    ++stats->histogram[bucket];
+
+    print = ((stats->calls % NET_BATCH_STATS_PRINT_INTERVAL) == 0u);
+    if (print)
+    {
+        snapshot = *stats;
+    }
+    taskEXIT_CRITICAL();
+
+    if (print)
+    {
+        stats = &snapshot;
+        printf("[INFO] network: %" PRIu32 " publishes, %" PRIu32 " failed, %" PRIu32 " bytes, avg %" PRIu32
+               " max %" PRIu32 " us\n",
+               stats->calls, stats->failures, stats->bytes, (uint32_t)(stats->total_us / stats->calls), stats->max_us);
+#if (NET_TRACE_ENABLED != 0)
+        if (stats->traced_us > 0u)
+        {
+            uint32_t cpu_percent = (uint32_t)((stats->cpu_us * 100u) / stats->traced_us);
+            uint32_t ipc_percent = (uint32_t)((stats->ipc_us * 100u) / stats->traced_us);
+
+            printf("[INFO] network time: %" PRIu32 "%% TLS and MQTT, %" PRIu32 "%% IPC to the CM0+ in %" PRIu32
+                   " packets, %" PRIu32 "%% TCP/IP thread, Wi-Fi, broker and other tasks\n",
+                   cpu_percent, ipc_percent, stats->ipc_packets, 100u - cpu_percent - ipc_percent);
+        }
+#endif
+        printf("[INFO] network latency: <1 ms %" PRIu32 ", <2 ms %" PRIu32 ", <5 ms %" PRIu32 ", <10 ms %" PRIu32
+               ", <20 ms %" PRIu32 ", <50 ms %" PRIu32 ", <100 ms %" PRIu32 ", more %" PRIu32 "\n",
+               stats->histogram[0], stats->histogram[1], stats->histogram[2], stats->histogram[3],
+               stats->histogram[4], stats->histogram[5], stats->histogram[6], stats->histogram[7]);
+    }
+}
+
+#if (NET_TRACE_ENABLED != 0)
+/*******************************************************************************
+ * Function Name: traced_linkoutput
+ *******************************************************************************
+ * Summary:
+ *   Link output of the traced interface, runs in the TCP/IP thread. Calls
+ *   the link output of the SCL driver, which hands the packet to the CM0+
+ *   over the IPC, and adds its time to the traced publish call.
+ *
+ * Parameters:
+ *   netif: interface
+ *   p: packet
+ *
+ * Return:
+ *   result of the SCL driver
+ ******************************************************************************/
+static err_t traced_linkoutput(struct netif* netif, struct pbuf* p)
+{
+    uint32_t start_cycles = cycle_counter_get();
+    err_t result = scl_linkoutput(netif, p);
+    uint32_t elapsed_cycles = cycle_counter_elapsed(start_cycles);
+
+    taskENTER_CRITICAL();
+    if (traced_task != NULL)
+    {
+        traced_ipc_cycles = traced_ipc_cycles + elapsed_cycles;
+        traced_ipc_packets = traced_ipc_packets + 1u;
+    }
+    taskEXIT_CRITICAL();
+
+    return result;
+}
+#endif
+
+/*******************************************************************************
+ * Function Name: net_batch_trace_netif
+ *******************************************************************************
+ * Summary:
+ *   Times the packets sent on the Wi-Fi interface with NET_TRACE_ENABLED, to
+ *   tell the IPC time of the publish calls. Called once the interface is up,
+ *   again after a reconnection.
+ *
+ * Parameters:
+ *   netif: Wi-Fi interface
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void net_batch_trace_netif(struct netif* netif)
+{
+#if (NET_TRACE_ENABLED != 0)
+    if ((netif != NULL) && (netif->linkoutput != traced_linkoutput))
+    {
+        scl_linkoutput = netif->linkoutput;
+        netif->linkoutput = traced_linkoutput;
+    }
+#else
+    (void)netif;
+#endif
+}
+
+/*******************************************************************************
+ * Function Name: net_batch_switched_in
+ *******************************************************************************
+ * Summary:
+ *   traceTASK_SWITCHED_IN hook, runs in the context switch.
+ *
+ * Parameters:
+ *   task: task switched in
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void net_batch_switched_in(void* task)
+{
+    if ((traced_task != NULL) && (task == traced_task))
+    {
+        traced_in_cycles = cycle_counter_get();
+    }
+}
+
+/*******************************************************************************
+ * Function Name: net_batch_switched_out
+ *******************************************************************************
+ * Summary:
+ *   traceTASK_SWITCHED_OUT hook, runs in the context switch.
+ *
+ * Parameters:
+ *   task: task switched out
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void net_batch_switched_out(void* task)
+{
+    if ((traced_task != NULL) && (task == traced_task))
+    {
+        traced_cycles = traced_cycles + cycle_counter_elapsed(traced_in_cycles);
+    }
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,128 @@
+/******************************************************************************
+ * File Name:   net_batch.h
+ *
+ * Description: This file contains the function prototypes and constants used
+ *   in net_batch.c.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+
+#pragma once
+
+/* Header file from system */
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Header file for local task */
+#include "common_variables.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Set to 1 to publish the telemetry messages of a topic that arrive within
+ * NET_BATCH_WINDOW_MS as one JSON array. The consumers of the topic must then
+ * accept an array in place of a single message.
+ */
+#ifndef NET_BATCH_ENABLED
+#define NET_BATCH_ENABLED                   (0)
+#endif
+
+/* Longest time a message waits for others to share its publish */
+#define NET_BATCH_WINDOW_MS                 (20u)
+
+/* Payload of one batch, within MQTT_NETWORK_BUFFER_SIZE */
+#define NET_BATCH_BUFFER_SIZE               (1024u)
+
+/* Messages of one batch */
+#define NET_BATCH_MAX_MESSAGES              (8u)
+
+/* Returned by net_batch_wait_ms for an empty batch */
+#define NET_BATCH_WAIT_FOREVER              (UINT32_MAX)
+
+/* Upper bounds in ms of the publish latency histogram, the last bucket is open */
+#define NET_BATCH_LATENCY_BOUNDS_MS         { 1u, 2u, 5u, 10u, 20u, 50u, 100u }
+#define NET_BATCH_LATENCY_BUCKETS           (8u)
+
+/* Publish calls between two statistics prints */
+#define NET_BATCH_STATS_PRINT_INTERVAL      (100u)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+struct netif;
+
+/* Same as publish_to_mqtt_topic */
+typedef subs_rslt_t (*net_batch_publish_t)(char* message, int length, char* topic);
+
+typedef struct
+{
+    uint32_t batches;                   /* publishes of the batch */
+    uint32_t messages;                  /* messages in them */
+    uint32_t max_messages;
+} net_batch_stats_t;
+
+typedef struct
+{
+    net_batch_publish_t publish;
+
+    /* buffer[0] is left for the '[' of several messages */
+    char buffer[NET_BATCH_BUFFER_SIZE];
+    uint32_t length;                    /* from buffer[1] */
+    uint32_t count;
+    char* topic;
+    uint32_t opened_ms;                 /* first message of the batch */
+
+    net_batch_stats_t stats;
+} net_batch_t;
+
+/* Every publish call, batched or not */
+typedef struct
+{
+    uint32_t calls;
+    uint32_t failures;
+    uint32_t bytes;
+    uint64_t total_us;
+    uint32_t max_us;
+    uint64_t traced_us;                 /* of the calls with a traced running time */
+    uint64_t cpu_us;                    /* calling task running: TLS and MQTT on the CM4 */
+    uint64_t ipc_us;                    /* packets handed to the CM0+ by the lwIP link output */
+    uint32_t ipc_packets;
+    uint32_t histogram[NET_BATCH_LATENCY_BUCKETS];
+} net_batch_call_stats_t;
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+void net_batch_init(net_batch_t* batch, net_batch_publish_t publish);
+subs_rslt_t net_batch_add(net_batch_t* batch, char* topic, const char* message, uint32_t length, uint32_t now_ms);
+subs_rslt_t net_batch_flush(net_batch_t* batch);
+uint32_t net_batch_wait_ms(const net_batch_t* batch, uint32_t now_ms);
+
+uint32_t net_batch_call_begin(void);
+void net_batch_call_end(uint32_t start_cycles, uint32_t bytes, bool success);
+
+/* With NET_TRACE_ENABLED, see FreeRTOSConfig.h */
+void net_batch_trace_netif(struct netif* netif);
+void net_batch_switched_in(void* task);
+void net_batch_switched_out(void* task);
+
+/* [] END OF FILE */
@@ -0,0 +1,945 @@
+/*****************************************************************************
+ * File name: net_writer.c
+ *
+ * Description: This file contains the network writer, the only task that
+ * publishes. Other tasks hand a serialized message to net_writer_publish,
+ * which copies it and returns at once, so they are not blocked by the TLS
+ * write. Messages wait in one of two lanes: the latency lane goes first,
+ * the bulk lane keeps a floor of the published bytes and a slot of the
+ * window free for the latency lane. Every message is published whole, as
+ * it was handed over, one message per publish. Each publish is kept in a
+ * bounded outbox until it completes. With QoS 1 up to a window of publishes
+ * wait for their PUBACK at the same time, each in its own publish worker,
+ * and complete in the order of the PUBACKs. A failed publish stays in the
+ * outbox and is published again after a delay, or after the reconnect.
+ * Every message completes through its callback with its latency from the
+ * hand over to the end of the publish.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Header file includes */
+#include "FreeRTOS.h"
+#include "queue.h"
+#include "task.h"
+
+/* Header file for local task */
+#include "net_writer.h"
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+TaskHandle_t net_writer_task_handle = NULL;
+
+static TaskHandle_t worker_task_handles[NET_WRITER_WINDOW];
+
+static QueueHandle_t lane_q[NET_WRITER_LANES] = { NULL, NULL };
+static QueueHandle_t send_q = NULL;     /* outbox slots for the publish workers */
+static QueueHandle_t ack_q = NULL;      /* results of the publish workers */
+static net_batch_publish_t writer_publish = NULL;
+
+/* Publishes in flight at most, changed by the benchmark */
+static volatile uint32_t window = NET_WRITER_WINDOW;
+static volatile bool connected = true;
+static volatile bool reconnected = false;
+
+/* Payload bytes not completed yet, updated by the senders and the writer */
+static uint32_t queued_bytes[NET_WRITER_LANES] = { 0, 0 };
+static uint32_t next_id = 0;
+
+static const uint32_t lane_queue_length[NET_WRITER_LANES] =
+{
+    NET_WRITER_LATENCY_QUEUE_LENGTH, NET_WRITER_BULK_QUEUE_LENGTH
+};
+static const uint32_t lane_max_queued_bytes[NET_WRITER_LANES] =
+{
+    NET_WRITER_LATENCY_MAX_QUEUED_BYTES, NET_WRITER_BULK_MAX_QUEUED_BYTES
+};
+
+/* Publishes not acknowledged yet, used by the writer only */
+static net_writer_entry_t outbox[NET_WRITER_WINDOW];
+static uint32_t next_sequence = 0;
+
+/* Published bytes of each lane for the bulk floor, halved every
+ * NET_WRITER_FLOOR_SPAN_BYTES
+ */
+static uint32_t floor_bytes[NET_WRITER_LANES];
+
+static net_writer_stats_t writer_stats;
+
+static const uint32_t latency_bounds_ms[NET_WRITER_LATENCY_BUCKETS - 1u] = NET_WRITER_LATENCY_BOUNDS_MS;
+
+/*******************************************************************************
+ * Function Name: now_ms
+ *******************************************************************************
+ * Summary:
+ *   Returns the FreeRTOS time in ms.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   time in ms
+ ******************************************************************************/
+static uint32_t now_ms(void)
+{
+    return (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+}
+
+/*******************************************************************************
+ * Function Name: print_stats
+ *******************************************************************************
+ * Summary:
+ *   Prints the statistics every NET_WRITER_STATS_PRINT_INTERVAL messages.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void print_stats(void)
+{
+    net_writer_stats_t* stats = &writer_stats;
+    uint32_t total = stats->messages + stats->dropped;
+
+    if ((total == 0u) || ((total % NET_WRITER_STATS_PRINT_INTERVAL) != 0u))
+    {
+        return;
+    }
+
+    printf("[INFO] net writer: %" PRIu32 " messages in %" PRIu32 " publishes, %" PRIu32 " failed, %" PRIu32
+           " dropped, avg %" PRIu32 " max %" PRIu32 " ms\n",
+           stats->messages, stats->writes, stats->failures, stats->dropped,
+           (stats->messages > 0u) ? (uint32_t)(stats->total_latency_ms / stats->messages) : 0u,
+           stats->max_latency_ms);
+    printf("[INFO] net writer window %" PRIu32 ": max %" PRIu32 " in flight, %" PRIu32 " retransmitted, %" PRIu32
+           " completed out of order\n",
+           window, stats->max_in_flight, stats->retransmits, stats->out_of_order);
+    for (uint32_t lane = 0; lane < NET_WRITER_LANES; ++lane)
+    {
+        const net_writer_lane_stats_t* lane_stats = &stats->lanes[lane];
+
+        printf("[INFO] net writer %s lane: %" PRIu32 " messages, %" PRIu32 " dropped, max %" PRIu32
+               " queued, queueing avg %" PRIu32 " max %" PRIu32 " ms, %" PRIu32 " bytes\n",
+               (lane == NET_WRITER_LANE_LATENCY) ? "latency" : "bulk", lane_stats->messages, lane_stats->dropped,
+               lane_stats->max_depth,
+               (lane_stats->messages > 0u) ? (uint32_t)(lane_stats->total_delay_ms / lane_stats->messages) : 0u,
+               lane_stats->max_delay_ms, (uint32_t)lane_stats->bytes);
+    }
+    printf("[INFO] net writer latency: <10 ms %" PRIu32 ", <20 ms %" PRIu32 ", <50 ms %" PRIu32 ", <100 ms %" PRIu32
+           ", <200 ms %" PRIu32 ", <500 ms %" PRIu32 ", <1000 ms %" PRIu32 ", more %" PRIu32 "\n",
+           stats->histogram[0], stats->histogram[1], stats->histogram[2], stats->histogram[3],
+           stats->histogram[4], stats->histogram[5], stats->histogram[6], stats->histogram[7]);
+}
+
+/*******************************************************************************
+ * Function Name: complete
+ *******************************************************************************
+ * Summary:
+ *   Completes a message: accounts its latency and calls its callback.
+ *
+ * Parameters:
+ *   msg: message
+ *   success: the publish of the message succeeded
+ *   end_ms: end of the publish
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void complete(const net_writer_msg_t* msg, bool success, uint32_t end_ms)
+{
+    net_writer_stats_t* stats = &writer_stats;
+    uint32_t latency_ms = end_ms - msg->queued_ms;
+    uint32_t bucket = 0;
+
+    taskENTER_CRITICAL();
+    queued_bytes[msg->lane] -= msg->length;
+    taskEXIT_CRITICAL();
+
+    ++stats->messages;
+    stats->total_latency_ms += latency_ms;
+    if (!success)
+    {
+        ++stats->failures;
+    }
+    if (latency_ms > stats->max_latency_ms)
+    {
+        stats->max_latency_ms = latency_ms;
+    }
+
+    while ((bucket < (NET_WRITER_LATENCY_BUCKETS - 1u)) && (latency_ms >= latency_bounds_ms[bucket]))
+    {
+        ++bucket;
+    }
+    ++stats->histogram[bucket];
+
+    if (msg->done != NULL)
+    {
+        msg->done(msg->id, success, latency_ms, msg->arg);
+    }
+
+    print_stats();
+}
+
+/*******************************************************************************
+ * Function Name: complete_entry
+ *******************************************************************************
+ * Summary:
+ *   Completes the message of an outbox entry and frees the entry.
+ *
+ * Parameters:
+ *   entry: outbox entry
+ *   success: the publish of the entry succeeded
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void complete_entry(net_writer_entry_t* entry, bool success)
+{
+    complete(&entry->msg, success, now_ms());
+
+    free(entry->payload);
+    entry->payload = NULL;
+    entry->state = NET_WRITER_ENTRY_FREE;
+}
+
+/*******************************************************************************
+ * Function Name: account_delay
+ *******************************************************************************
+ * Summary:
+ *   Accounts the queueing delay of a message in its lane, when its first
+ *   publish starts.
+ *
+ * Parameters:
+ *   msg: message
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void account_delay(const net_writer_msg_t* msg)
+{
+    net_writer_lane_stats_t* lane_stats = &writer_stats.lanes[msg->lane];
+    uint32_t delay_ms = now_ms() - msg->queued_ms;
+
+    ++lane_stats->messages;
+    lane_stats->total_delay_ms += delay_ms;
+    if (delay_ms > lane_stats->max_delay_ms)
+    {
+        lane_stats->max_delay_ms = delay_ms;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: fill_entry
+ *******************************************************************************
+ * Summary:
+ *   Fills a free outbox entry with a message, whose payload the entry takes
+ *   over.
+ *
+ * Parameters:
+ *   entry: free outbox entry
+ *   msg: message received from its lane
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void fill_entry(net_writer_entry_t* entry, const net_writer_msg_t* msg)
+{
+    entry->msg = *msg;
+    entry->payload = msg->payload;
+    entry->length = msg->length;
+    entry->topic = msg->topic;
+    entry->lane = msg->lane;
+    entry->attempts = 0;
+    entry->sequence = next_sequence++;
+
+    account_delay(msg);
+}
+
+/*******************************************************************************
+ * Function Name: next_lane
+ *******************************************************************************
+ * Summary:
+ *   Selects the lane of the next publish. The latency lane goes first
+ *   unless the bulk lane got less than NET_WRITER_BULK_FLOOR_PERCENT of the
+ *   recent bytes. With a window above 1 the bulk lane leaves a slot free.
+ *
+ * Parameters:
+ *   bulk_in_use: outbox entries of the bulk lane
+ *
+ * Return:
+ *   lane, NET_WRITER_LANES if nothing can start
+ ******************************************************************************/
+static uint32_t next_lane(uint32_t bulk_in_use)
+{
+    bool latency = (uxQueueMessagesWaiting(lane_q[NET_WRITER_LANE_LATENCY]) > 0u);
+    bool bulk = ((window == 1u) || (bulk_in_use < (window - 1u))) &&
+                (uxQueueMessagesWaiting(lane_q[NET_WRITER_LANE_BULK]) > 0u);
+    uint32_t total = floor_bytes[NET_WRITER_LANE_LATENCY] + floor_bytes[NET_WRITER_LANE_BULK];
+
+    if (latency && bulk &&
+        (((uint64_t)floor_bytes[NET_WRITER_LANE_BULK] * 100u) < ((uint64_t)total * NET_WRITER_BULK_FLOOR_PERCENT)))
+    {
+        return NET_WRITER_LANE_BULK;
+    }
+
+    if (latency)
+    {
+        return NET_WRITER_LANE_LATENCY;
+    }
+
+    return bulk ? NET_WRITER_LANE_BULK : NET_WRITER_LANES;
+}
+
+/*******************************************************************************
+ * Function Name: fill_from_lane
+ *******************************************************************************
+ * Summary:
+ *   Fills a free outbox entry with the next message of a lane.
+ *
+ * Parameters:
+ *   entry: free outbox entry
+ *   lane: lane selected by next_lane
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void fill_from_lane(net_writer_entry_t* entry, uint32_t lane)
+{
+    net_writer_lane_stats_t* lane_stats = &writer_stats.lanes[lane];
+    uint32_t depth = (uint32_t)uxQueueMessagesWaiting(lane_q[lane]);
+    net_writer_msg_t msg;
+
+    if (depth > lane_stats->max_depth)
+    {
+        lane_stats->max_depth = depth;
+    }
+
+    (void)xQueueReceive(lane_q[lane], &msg, 0);
+    fill_entry(entry, &msg);
+}
+
+/*******************************************************************************
+ * Function Name: send_entry
+ *******************************************************************************
+ * Summary:
+ *   Hands an outbox entry to the publish workers.
+ *
+ * Parameters:
+ *   slot: outbox slot of the entry
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void send_entry(uint32_t slot)
+{
+    net_writer_entry_t* entry = &outbox[slot];
+    uint32_t in_flight = 0;
+
+    entry->state = NET_WRITER_ENTRY_IN_FLIGHT;
+    ++writer_stats.writes;
+    writer_stats.lanes[entry->lane].bytes += entry->length;
+
+    floor_bytes[entry->lane] += entry->length;
+    if ((floor_bytes[NET_WRITER_LANE_LATENCY] + floor_bytes[NET_WRITER_LANE_BULK]) > NET_WRITER_FLOOR_SPAN_BYTES)
+    {
+        floor_bytes[NET_WRITER_LANE_LATENCY] /= 2u;
+        floor_bytes[NET_WRITER_LANE_BULK] /= 2u;
+    }
+
+    for (uint32_t i = 0; i < NET_WRITER_WINDOW; ++i)
+    {
+        if (outbox[i].state == NET_WRITER_ENTRY_IN_FLIGHT)
+        {
+            ++in_flight;
+        }
+    }
+    if (in_flight > writer_stats.max_in_flight)
+    {
+        writer_stats.max_in_flight = in_flight;
+    }
+
+    /* send_q holds a slot for every entry */
+    (void)xQueueSendToBack(send_q, &slot, 0);
+}
+
+/*******************************************************************************
+ * Function Name: handle_ack
+ *******************************************************************************
+ * Summary:
+ *   Handles the result of a publish worker. PUBACKs can arrive in any order,
+ *   an entry completes as soon as its own arrives. A failed entry is kept in
+ *   the outbox and published again, at the latest after the reconnect.
+ *
+ * Parameters:
+ *   ack: result
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void handle_ack(const net_writer_ack_t* ack)
+{
+    net_writer_entry_t* entry = &outbox[ack->slot];
+
+    if (ack->success)
+    {
+        for (uint32_t i = 0; i < NET_WRITER_WINDOW; ++i)
+        {
+            if ((outbox[i].state == NET_WRITER_ENTRY_IN_FLIGHT) && (outbox[i].sequence < entry->sequence))
+            {
+                ++writer_stats.out_of_order;
+                break;
+            }
+        }
+
+        complete_entry(entry, true);
+    }
+    else if (++entry->attempts >= NET_WRITER_MAX_ATTEMPTS)
+    {
+        complete_entry(entry, false);
+    }
+    else
+    {
+        entry->state = NET_WRITER_ENTRY_RETRY;
+        entry->failed_ms = now_ms();
+    }
+}
+
+/*******************************************************************************
+ * Function Name: dispatch
+ *******************************************************************************
+ * Summary:
+ *   Publishes the failed entries again once NET_WRITER_RETRY_DELAY_MS has
+ *   elapsed, oldest first, then fills the free outbox entries from the
+ *   lanes within the window. Nothing is published while disconnected, the
+ *   messages wait in their lanes then.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void dispatch(void)
+{
+    uint32_t in_use = 0;
+    uint32_t bulk_in_use = 0;
+
+    if (!connected)
+    {
+        return;
+    }
+
+    if (reconnected)
+    {
+        reconnected = false;
+        for (uint32_t i = 0; i < NET_WRITER_WINDOW; ++i)
+        {
+            outbox[i].attempts = 0;
+            outbox[i].failed_ms = now_ms() - NET_WRITER_RETRY_DELAY_MS;
+        }
+    }
+
+    for (;;)
+    {
+        uint32_t oldest = NET_WRITER_WINDOW;
+
+        for (uint32_t i = 0; i < NET_WRITER_WINDOW; ++i)
+        {
+            if ((outbox[i].state == NET_WRITER_ENTRY_RETRY) &&
+                ((now_ms() - outbox[i].failed_ms) >= NET_WRITER_RETRY_DELAY_MS) &&
+                ((oldest == NET_WRITER_WINDOW) || (outbox[i].sequence < outbox[oldest].sequence)))
+            {
+                oldest = i;
+            }
+        }
+
+        if (oldest == NET_WRITER_WINDOW)
+        {
+            break;
+        }
+
+        ++writer_stats.retransmits;
+        send_entry(oldest);
+    }
+
+    for (uint32_t i = 0; i < NET_WRITER_WINDOW; ++i)
+    {
+        if (outbox[i].state != NET_WRITER_ENTRY_FREE)
+        {
+            ++in_use;
+            if (outbox[i].lane == NET_WRITER_LANE_BULK)
+            {
+                ++bulk_in_use;
+            }
+        }
+    }
+
+    for (uint32_t slot = 0; (slot < NET_WRITER_WINDOW) && (in_use < window); ++slot)
+    {
+        uint32_t lane;
+
+        if (outbox[slot].state != NET_WRITER_ENTRY_FREE)
+        {
+            continue;
+        }
+
+        lane = next_lane(bulk_in_use);
+        if (lane == NET_WRITER_LANES)
+        {
+            break;
+        }
+
+        fill_from_lane(&outbox[slot], lane);
+        ++in_use;
+        if (lane == NET_WRITER_LANE_BULK)
+        {
+            ++bulk_in_use;
+        }
+        send_entry(slot);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: worker_task
+ *******************************************************************************
+ * Summary:
+ *   Publish worker, publishes one outbox entry at a time. For QoS 1 the
+ *   publish returns with the PUBACK, so the workers keep up to the window
+ *   of publishes waiting for their PUBACK.
+ *
+ * Parameters:
+ *   void *pvParameters : Task parameter defined during task creation (unused)
+ *
+ * Return:
+ *   void
+ ******************************************************************************/
+static void worker_task(void* pvParameters)
+{
+    net_writer_ack_t ack;
+
+    (void)pvParameters;
+
+    for (;;)
+    {
+        if (xQueueReceive(send_q, &ack.slot, portMAX_DELAY) == pdTRUE)
+        {
+            net_writer_entry_t* entry = &outbox[ack.slot];
+
+#if (NET_WRITER_INJECT_DELAY_MS > 0)
+            vTaskDelay(pdMS_TO_TICKS(NET_WRITER_INJECT_DELAY_MS));
+#endif
+
+            ack.success = (writer_publish(entry->payload, (int)entry->length, entry->topic) == SUBS_SUCCESS);
+
+            /* ack_q holds a result for every entry */
+            (void)xQueueSendToBack(ack_q, &ack, 0);
+            xTaskNotifyGive(net_writer_task_handle);
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: net_writer_init
+ *******************************************************************************
+ * Summary:
+ *   Creates the lanes of the writer and the publish workers, before any
+ *   task publishes. The writer task is created by the caller.
+ *
+ * Parameters:
+ *   publish: publishes a payload, publish_to_mqtt_topic
+ *   in_flight: publishes in flight at most, 1 for QoS 0
+ *
+ * Return:
+ *   true if the queues and the workers were created
+ ******************************************************************************/
+bool net_writer_init(net_batch_publish_t publish, uint32_t in_flight)
+{
+    writer_publish = publish;
+    window = ((in_flight >= 1u) && (in_flight <= NET_WRITER_WINDOW)) ? in_flight : NET_WRITER_WINDOW;
+    connected = true;
+
+    for (uint32_t lane = 0; lane < NET_WRITER_LANES; ++lane)
+    {
+        queued_bytes[lane] = 0;
+        if (lane_q[lane] == NULL)
+        {
+            lane_q[lane] = xQueueCreate(lane_queue_length[lane], sizeof(net_writer_msg_t));
+        }
+    }
+
+    if (send_q == NULL)
+    {
+        send_q = xQueueCreate(NET_WRITER_WINDOW, sizeof(uint32_t));
+        ack_q = xQueueCreate(NET_WRITER_WINDOW, sizeof(net_writer_ack_t));
+    }
+
+    if ((lane_q[NET_WRITER_LANE_LATENCY] == NULL) || (lane_q[NET_WRITER_LANE_BULK] == NULL) ||
+        (send_q == NULL) || (ack_q == NULL))
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < window; ++i)
+    {
+        if ((worker_task_handles[i] == NULL) &&
+            (pdPASS != xTaskCreate(worker_task, "Network publish worker", NET_WRITER_TASK_STACK_SIZE,
+                                   NULL, NET_WRITER_TASK_PRIORITY, &worker_task_handles[i])))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: net_writer_deinit
+ *******************************************************************************
+ * Summary:
+ *   Deletes the publish workers, after the writer task was deleted.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void net_writer_deinit(void)
+{
+    for (uint32_t i = 0; i < NET_WRITER_WINDOW; ++i)
+    {
+        if (worker_task_handles[i] != NULL)
+        {
+            vTaskDelete(worker_task_handles[i]);
+            worker_task_handles[i] = NULL;
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: net_writer_task
+ *******************************************************************************
+ * Summary:
+ *   Task that makes all publishes, in the order of net_writer_publish,
+ *   through the publish workers and completes the messages.
+ *
+ * Parameters:
+ *   void *pvParameters : Task parameter defined during task creation (unused)
+ *
+ * Return:
+ *   void
+ ******************************************************************************/
+void net_writer_task(void* pvParameters)
+{
+    net_writer_ack_t ack;
+    TickType_t wait = portMAX_DELAY;
+
+    (void)pvParameters;
+
+    for (;;)
+    {
+        /* Woken by new messages, results of the workers and connection changes,
+         * or to retry the failed entries
+         */
+        (void)ulTaskNotifyTake(pdTRUE, wait);
+
+        while (xQueueReceive(ack_q, &ack, 0) == pdTRUE)
+        {
+            handle_ack(&ack);
+        }
+
+        dispatch();
+
+        wait = portMAX_DELAY;
+        for (uint32_t i = 0; i < NET_WRITER_WINDOW; ++i)
+        {
+            if (outbox[i].state == NET_WRITER_ENTRY_RETRY)
+            {
+                wait = pdMS_TO_TICKS(NET_WRITER_RETRY_DELAY_MS);
+            }
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: net_writer_set_connected
+ *******************************************************************************
+ * Summary:
+ *   Stops the publishes while the connection to the broker is lost. After
+ *   the reconnect the failed entries of the outbox are published at once,
+ *   each with NET_WRITER_MAX_ATTEMPTS attempts again. The session is clean,
+ *   the broker does not resend them, so a message can arrive twice.
+ *
+ * Parameters:
+ *   is_connected: the client is connected to the broker
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void net_writer_set_connected(bool is_connected)
+{
+    if (is_connected && !connected)
+    {
+        reconnected = true;
+    }
+
+    connected = is_connected;
+
+    if (net_writer_task_handle != NULL)
+    {
+        xTaskNotifyGive(net_writer_task_handle);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: net_writer_publish
+ *******************************************************************************
+ * Summary:
+ *   Hands a message over to the writer task without waiting. The message is
+ *   copied, the caller can reuse its buffer at once. A message is dropped if
+ *   the queue or the byte budget of its lane is full, which happens when the
+ *   broker does not keep up.
+ *
+ * Parameters:
+ *   topic: topic, must stay valid until the message completes
+ *   message: payload
+ *   length: payload length
+ *   lane: NET_WRITER_LANE_LATENCY for events, NET_WRITER_LANE_BULK for
+ *         telemetry and reports
+ *   done: called by the writer task when the message completes, can be NULL
+ *   arg: argument of done
+ *
+ * Return:
+ *   id of the message passed to done, 0 if the message was dropped
+ ******************************************************************************/
+uint32_t net_writer_publish(char* topic, const char* message, uint32_t length, net_writer_lane_t lane,
+                            net_writer_done_t done, void* arg)
+{
+    net_writer_msg_t msg;
+    bool reserved;
+    bool accepted;
+
+    if ((lane >= NET_WRITER_LANES) || (lane_q[lane] == NULL) || (length == 0u))
+    {
+        return 0;
+    }
+
+    taskENTER_CRITICAL();
+    reserved = ((queued_bytes[lane] + length) <= lane_max_queued_bytes[lane]);
+    if (reserved)
+    {
+        queued_bytes[lane] += length;
+        msg.id = ++next_id;
+        if (msg.id == 0u)
+        {
+            msg.id = ++next_id;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    accepted = reserved;
+    if (accepted)
+    {
+        msg.payload = malloc(length);
+        accepted = (msg.payload != NULL);
+    }
+
+    if (accepted)
+    {
+        memcpy(msg.payload, message, length);
+        msg.length = length;
+        msg.topic = topic;
+        msg.lane = (uint8_t)lane;
+        msg.queued_ms = now_ms();
+        msg.done = done;
+        msg.arg = arg;
+
+        if (xQueueSendToBack(lane_q[lane], &msg, 0) != pdTRUE)
+        {
+            free(msg.payload);
+            accepted = false;
+        }
+    }
+
+    if (!accepted)
+    {
+        /* Counted by the senders while the writer prints the statistics */
+        taskENTER_CRITICAL();
+        if (reserved)
+        {
+            queued_bytes[lane] -= length;
+        }
+        ++writer_stats.dropped;
+        ++writer_stats.lanes[lane].dropped;
+        taskEXIT_CRITICAL();
+
+        return 0;
+    }
+
+    if (net_writer_task_handle != NULL)
+    {
+        xTaskNotifyGive(net_writer_task_handle);
+    }
+
+    return msg.id;
+}
+
+/*******************************************************************************
+ * Function Name: net_writer_get_stats
+ *******************************************************************************
+ * Summary:
+ *   Copies the statistics, with the queueing delay of each lane, e.g. to
+ *   report them.
+ *
+ * Parameters:
+ *   stats: destination
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void net_writer_get_stats(net_writer_stats_t* stats)
+{
+    taskENTER_CRITICAL();
+    *stats = writer_stats;
+    taskEXIT_CRITICAL();
+}
+
+#if (NET_WRITER_BENCHMARK != 0)
+static volatile uint32_t bench_completed;
+static volatile uint32_t bench_failed;
+static volatile uint32_t bench_max_ms;
+static volatile uint64_t bench_total_ms;
+
+/*******************************************************************************
+ * Function Name: bench_done
+ *******************************************************************************
+ * Summary:
+ *   Completion callback of the benchmark messages.
+ *
+ * Parameters:
+ *   id: message id
+ *   success: the message was published
+ *   latency_ms: latency of the message
+ *   arg: unused
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void bench_done(uint32_t id, bool success, uint32_t latency_ms, void* arg)
+{
+    (void)id;
+    (void)arg;
+
+    if (!success)
+    {
+        ++bench_failed;
+    }
+    bench_total_ms += latency_ms;
+    if (latency_ms > bench_max_ms)
+    {
+        bench_max_ms = latency_ms;
+    }
+    ++bench_completed;
+}
+#endif
+
+/*******************************************************************************
+ * Function Name: net_writer_benchmark
+ *******************************************************************************
+ * Summary:
+ *   Publishes with NET_WRITER_BENCHMARK NET_WRITER_BENCH_MESSAGES messages as
+ *   fast as the writer accepts them at every window from 1 to the window in
+ *   use, and
+ *   prints the events per second and the latency of each window. Point
+ *   MQTT_BROKER_ADDRESS to a local broker to measure the round trip of the
+ *   broker rather than the Internet.
+ *
+ * Parameters:
+ *   topic: topic of the messages
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void net_writer_benchmark(char* topic)
+{
+#if (NET_WRITER_BENCHMARK != 0)
+    static char message[NET_WRITER_BENCH_MESSAGE_SIZE];
+    uint32_t in_use = window;
+
+    if (net_writer_task_handle == NULL)
+    {
+        return;
+    }
+
+    for (uint32_t test_window = 1; test_window <= in_use; ++test_window)
+    {
+        uint32_t start_ms;
+        uint32_t elapsed_ms;
+
+        window = test_window;
+        bench_completed = 0;
+        bench_failed = 0;
+        bench_max_ms = 0;
+        bench_total_ms = 0;
+        start_ms = now_ms();
+
+        for (uint32_t i = 0; i < NET_WRITER_BENCH_MESSAGES; ++i)
+        {
+            memset(message, ' ', sizeof(message));
+            (void)snprintf(message, sizeof(message), "{\"benchmark\":%" PRIu32 ",\"message\":%" PRIu32 "}",
+                           test_window, i);
+            message[strnlen(message, sizeof(message))] = ' ';
+            message[sizeof(message) - 1u] = '\0';
+
+            while (0u == net_writer_publish(topic, message, sizeof(message), NET_WRITER_LANE_LATENCY,
+                                            bench_done, NULL))
+            {
+                vTaskDelay(1);
+            }
+        }
+
+        while (bench_completed < NET_WRITER_BENCH_MESSAGES)
+        {
+            vTaskDelay(1);
+        }
+
+        elapsed_ms = now_ms() - start_ms;
+        printf("[INFO] net writer benchmark window %" PRIu32 ": %" PRIu32 " events/s, avg %" PRIu32 " max %"
+               PRIu32 " ms, %" PRIu32 " failed\n",
+               test_window, (NET_WRITER_BENCH_MESSAGES * 1000u) / ((elapsed_ms > 0u) ? elapsed_ms : 1u),
+               (uint32_t)(bench_total_ms / NET_WRITER_BENCH_MESSAGES), bench_max_ms, bench_failed);
+    }
+
+    window = in_use;
+#else
+    (void)topic;
+#endif
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,216 @@
+/******************************************************************************
+ * File Name:   net_writer.h
+ *
+ * Description: This file contains the function prototypes and constants used
+ *   in net_writer.c.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+
+#pragma once
+
+/* Header file from system */
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Header file includes */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Header file for library */
+#include "core_mqtt_config.h"
+
+/* Header file for local task */
+#include "common_variables.h"
+#include "net_batch.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Set to 0 to publish from the calling task, which waits for the network */
+#ifndef NET_WRITER_ENABLED
+#define NET_WRITER_ENABLED                  (1)
+#endif
+
+/* Task parameters of the network writer and of its publish workers, the stack
+ * of the TLS writes
+ */
+#define NET_WRITER_TASK_PRIORITY            (4)
+#define NET_WRITER_TASK_STACK_SIZE          (1024 * 1)
+
+/* Publishes waiting for their PUBACK, one publish worker each. Every one
+ * takes an entry of the outgoing publish state of the MQTT library.
+ */
+#ifndef NET_WRITER_WINDOW
+#define NET_WRITER_WINDOW                   (4u)
+#endif
+
+/* Messages waiting for the writer in the latency and the bulk lane */
+#define NET_WRITER_LATENCY_QUEUE_LENGTH     (16u)
+#define NET_WRITER_BULK_QUEUE_LENGTH        (8u)
+
+/* Payload bytes of a lane waiting for the writer or their PUBACK, further
+ * messages of the lane are dropped
+ */
+#define NET_WRITER_LATENCY_MAX_QUEUED_BYTES (4096u)
+#define NET_WRITER_BULK_MAX_QUEUED_BYTES    (8192u)
+
+/* Share of the published bytes the bulk lane gets while the latency lane
+ * is busy, over about the last NET_WRITER_FLOOR_SPAN_BYTES
+ */
+#define NET_WRITER_BULK_FLOOR_PERCENT       (10u)
+#define NET_WRITER_FLOOR_SPAN_BYTES         (16384u)
+
+/* Failed publishes of an outbox entry before its messages fail, counted
+ * again from 0 after a reconnect
+ */
+#define NET_WRITER_MAX_ATTEMPTS             (3u)
+
+/* Time between two attempts of an outbox entry */
+#define NET_WRITER_RETRY_DELAY_MS           (1000u)
+
+/* Set to a delay in ms before every publish to emulate a slow broker */
+#ifndef NET_WRITER_INJECT_DELAY_MS
+#define NET_WRITER_INJECT_DELAY_MS          (0u)
+#endif
+
+/* Set to 1 to measure the events per second and the latency at every window
+ * from 1 to the window in use once connected
+ */
+#ifndef NET_WRITER_BENCHMARK
+#define NET_WRITER_BENCHMARK                (0)
+#endif
+#define NET_WRITER_BENCH_MESSAGES           (200u)
+#define NET_WRITER_BENCH_MESSAGE_SIZE       (128u)
+
+/* Upper bounds in ms of the message latency histogram, the last bucket is open */
+#define NET_WRITER_LATENCY_BOUNDS_MS        { 10u, 20u, 50u, 100u, 200u, 500u, 1000u }
+#define NET_WRITER_LATENCY_BUCKETS          (8u)
+
+/* Completed or dropped messages between two statistics prints */
+#define NET_WRITER_STATS_PRINT_INTERVAL     (100u)
+
+#if ((NET_WRITER_WINDOW < 1) || (NET_WRITER_WINDOW > MQTT_STATE_ARRAY_MAX_COUNT))
+#error "NET_WRITER_WINDOW must be between 1 and MQTT_STATE_ARRAY_MAX_COUNT"
+#endif
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+/* Called by the writer task once a message was published or failed.
+ * latency_ms is the time from net_writer_publish to the end of the publish,
+ * for QoS 1 to its PUBACK.
+ */
+typedef void (*net_writer_done_t)(uint32_t id, bool success, uint32_t latency_ms, void* arg);
+
+/* The latency lane goes first, the bulk lane has a floor of the bandwidth */
+typedef enum
+{
+    NET_WRITER_LANE_LATENCY,
+    NET_WRITER_LANE_BULK,
+    NET_WRITER_LANES
+} net_writer_lane_t;
+
+typedef struct
+{
+    char* payload;                      /* copy owned by the writer */
+    uint32_t length;
+    char* topic;                        /* must stay valid, the topics of mqtt_task.c */
+    uint8_t lane;
+    uint32_t id;
+    uint32_t queued_ms;
+    net_writer_done_t done;
+    void* arg;
+} net_writer_msg_t;
+
+typedef enum
+{
+    NET_WRITER_ENTRY_FREE,
+    NET_WRITER_ENTRY_IN_FLIGHT,         /* with a publish worker */
+    NET_WRITER_ENTRY_RETRY              /* failed, published again when connected */
+} net_writer_entry_state_t;
+
+/* One publish of the outbox, kept until it is acknowledged */
+typedef struct
+{
+    net_writer_entry_state_t state;
+    uint32_t sequence;                  /* order of the publishes */
+    char* payload;                      /* owned, the payload of the message */
+    uint32_t length;
+    char* topic;
+    uint8_t lane;
+    uint32_t attempts;
+    uint32_t failed_ms;                 /* last failed attempt */
+    net_writer_msg_t msg;               /* payload is not used */
+} net_writer_entry_t;
+
+/* Result of a publish worker */
+typedef struct
+{
+    uint32_t slot;
+    bool success;
+} net_writer_ack_t;
+
+/* Queueing delay: from net_writer_publish until the first publish starts */
+typedef struct
+{
+    uint32_t messages;
+    uint32_t dropped;
+    uint32_t max_depth;
+    uint64_t bytes;                     /* published, retransmissions included */
+    uint64_t total_delay_ms;
+    uint32_t max_delay_ms;
+} net_writer_lane_stats_t;
+
+typedef struct
+{
+    uint32_t messages;                  /* completed, published or failed */
+    uint32_t failures;
+    uint32_t dropped;                   /* queue or memory full */
+    uint32_t writes;                    /* publishes, retransmissions included */
+    uint32_t retransmits;
+    uint32_t out_of_order;              /* publishes completed before an earlier one */
+    uint32_t max_in_flight;
+    uint64_t total_latency_ms;
+    uint32_t max_latency_ms;
+    uint32_t histogram[NET_WRITER_LATENCY_BUCKETS];
+    net_writer_lane_stats_t lanes[NET_WRITER_LANES];
+} net_writer_stats_t;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+extern TaskHandle_t net_writer_task_handle;
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+bool net_writer_init(net_batch_publish_t publish, uint32_t window);
+void net_writer_deinit(void);
+void net_writer_task(void* pvParameters);
+void net_writer_set_connected(bool connected);
+uint32_t net_writer_publish(char* topic, const char* message, uint32_t length, net_writer_lane_t lane,
+                            net_writer_done_t done, void* arg);
+void net_writer_get_stats(net_writer_stats_t* stats);
+void net_writer_benchmark(char* topic);
+
+/* [] END OF FILE */
@@ -0,0 +1,219 @@
+/*****************************************************************************
+ * File name: overload_governor.c
+ *
+ * Description: This file contains the overload governor of the radar
+ * processing. It compares the processing time of every frame against the
+ * frame period and degrades the processing in defined steps when the budget
+ * is exceeded, restoring full fidelity once the load drops again. It does not
+ * depend on the RTOS or the HAL, processing times are passed in by the caller.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <string.h>
+
+/* Header file for local task */
+#include "overload_governor.h"
+
+/*******************************************************************************
+ * Function Name: change_level
+ *******************************************************************************
+ * Summary:
+ *   Moves the governor to a new level and notifies the registered callback.
+ *
+ * Parameters:
+ *   governor: governor instance
+ *   level: new level
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void change_level(overload_governor_t* governor, overload_level_t level)
+{
+    overload_level_t old_level = governor->level;
+
+    governor->level = level;
+    governor->over_count = 0;
+    governor->under_count = 0;
+
+    if (governor->callback != NULL)
+    {
+        governor->callback(old_level, level, governor->load_permille, governor->callback_data);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: overload_governor_init
+ *******************************************************************************
+ * Summary:
+ *   Initializes a governor at full fidelity.
+ *
+ * Parameters:
+ *   governor: governor instance
+ *   budget_us: processing budget per frame, i.e. the frame period
+ *   callback: called on every level change, can be NULL
+ *   callback_data: passed to the callback
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void overload_governor_init(overload_governor_t* governor, uint32_t budget_us,
+                            overload_governor_cb_t callback, void* callback_data)
+{
+    memset(governor, 0, sizeof(*governor));
+    governor->level = OVERLOAD_LEVEL_NONE;
+    governor->budget_us = budget_us;
+    governor->callback = callback;
+    governor->callback_data = callback_data;
+}
+
+/*******************************************************************************
+ * Function Name: overload_governor_set_budget
+ *******************************************************************************
+ * Summary:
+ *   Updates the processing budget, e.g. after a frame period change.
+ *
+ * Parameters:
+ *   governor: governor instance
+ *   budget_us: processing budget per frame
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void overload_governor_set_budget(overload_governor_t* governor, uint32_t budget_us)
+{
+    governor->budget_us = budget_us;
+}
+
+/*******************************************************************************
+ * Function Name: overload_governor_skip_frame
+ *******************************************************************************
+ * Summary:
+ *   Called for every acquired frame. Tells whether the frame has to be
+ *   dropped after reading it from the FIFO.
+ *
+ * Parameters:
+ *   governor: governor instance
+ *
+ * Return:
+ *   true if the frame shall not be processed
+ ******************************************************************************/
+bool overload_governor_skip_frame(overload_governor_t* governor)
+{
+    bool skip = false;
+
+    ++governor->frame_count;
+    if ((governor->level >= OVERLOAD_LEVEL_SKIP_ALTERNATE) && ((governor->frame_count & 1u) != 0u))
+    {
+        ++governor->skipped_frames;
+        skip = true;
+    }
+
+    return skip;
+}
+
+/*******************************************************************************
+ * Function Name: overload_governor_report
+ *******************************************************************************
+ * Summary:
+ *   Reports the processing time of a processed frame and updates the level.
+ *
+ * Parameters:
+ *   governor: governor instance
+ *   processing_us: processing time of the frame
+ *
+ * Return:
+ *   true if the level changed
+ ******************************************************************************/
+bool overload_governor_report(overload_governor_t* governor, uint32_t processing_us)
+{
+    /* Skipped frames give their period to the processed ones */
+    uint32_t periods = (governor->level >= OVERLOAD_LEVEL_SKIP_ALTERNATE) ? 2u : 1u;
+    uint32_t budget_us = governor->budget_us * periods;
+    overload_level_t level = governor->level;
+
+    if (budget_us == 0u)
+    {
+        return false;
+    }
+
+    if (processing_us > governor->max_processing_us)
+    {
+        governor->max_processing_us = processing_us;
+    }
+    governor->load_permille = (uint32_t)(((uint64_t)processing_us * 1000u) / budget_us);
+
+    if (governor->load_permille > OVERLOAD_GOVERNOR_HIGH_PERMILLE)
+    {
+        governor->under_count = 0;
+        if ((++governor->over_count >= OVERLOAD_GOVERNOR_DEGRADE_FRAMES) &&
+            (level < (OVERLOAD_LEVEL_COUNT - 1)))
+        {
+            change_level(governor, (overload_level_t)(level + 1));
+        }
+    }
+    else if (governor->load_permille < OVERLOAD_GOVERNOR_LOW_PERMILLE)
+    {
+        governor->over_count = 0;
+        if ((++governor->under_count >= OVERLOAD_GOVERNOR_RESTORE_FRAMES) &&
+            (level > OVERLOAD_LEVEL_NONE))
+        {
+            change_level(governor, (overload_level_t)(level - 1));
+        }
+    }
+    else
+    {
+        governor->over_count = 0;
+        governor->under_count = 0;
+    }
+
+    return (level != governor->level);
+}
+
+/*******************************************************************************
+ * Function Name: overload_governor_apply_config
+ *******************************************************************************
+ * Summary:
+ *   Overrides the presence configuration fields degraded by the given level.
+ *
+ * Parameters:
+ *   level: governor level
+ *   config: configuration to be modified
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void overload_governor_apply_config(overload_level_t level, xensiv_radar_presence_config_t* config)
+{
+    if (level >= OVERLOAD_LEVEL_MICRO_DECIMATION)
+    {
+        config->micro_fft_decimation_enabled = true;
+    }
+
+    if ((level >= OVERLOAD_LEVEL_MICRO_FFT_SHRINK) &&
+        (config->micro_fft_size > OVERLOAD_GOVERNOR_SHRUNK_MICRO_FFT_SIZE))
+    {
+        config->micro_fft_size = OVERLOAD_GOVERNOR_SHRUNK_MICRO_FFT_SIZE;
+    }
+}
+
+/* [] END OF FILE */
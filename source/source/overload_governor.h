@@ -0,0 +1,95 @@
+/******************************************************************************
+ * File Name:   overload_governor.h
+ *
+ * Description: This file contains the function prototypes and constants used
+ *   in overload_governor.c.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#pragma once
+
+/* Header file from system */
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Header file for library */
+#include "xensiv_radar_presence.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Processing time relative to the budget, in permille, that degrades one step */
+#define OVERLOAD_GOVERNOR_HIGH_PERMILLE         (900u)
+
+/* Processing time relative to the budget, in permille, that restores one step */
+#define OVERLOAD_GOVERNOR_LOW_PERMILLE          (450u)
+
+/* Consecutive frames over budget before degrading */
+#define OVERLOAD_GOVERNOR_DEGRADE_FRAMES        (3u)
+
+/* Consecutive frames under the low mark before restoring */
+#define OVERLOAD_GOVERNOR_RESTORE_FRAMES        (400u)
+
+/* micro_fft_size used in the most degraded step */
+#define OVERLOAD_GOVERNOR_SHRUNK_MICRO_FFT_SIZE (64)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+/* Degradation steps, every step includes the previous ones */
+typedef enum
+{
+    OVERLOAD_LEVEL_NONE = 0,            /* full fidelity */
+    OVERLOAD_LEVEL_SKIP_ALTERNATE,      /* process every other frame */
+    OVERLOAD_LEVEL_MICRO_DECIMATION,    /* micro_fft_decimation_enabled */
+    OVERLOAD_LEVEL_MICRO_FFT_SHRINK,    /* micro_fft_size reduced */
+    OVERLOAD_LEVEL_COUNT
+} overload_level_t;
+
+typedef void (*overload_governor_cb_t)(overload_level_t old_level, overload_level_t new_level,
+                                       uint32_t load_permille, void* data);
+
+typedef struct
+{
+    overload_level_t level;
+    uint32_t budget_us;                 /* frame period */
+    uint32_t load_permille;             /* load of the last processed frame */
+    uint32_t over_count;
+    uint32_t under_count;
+    uint32_t frame_count;               /* used for alternate frame skipping */
+    uint32_t max_processing_us;
+    uint32_t skipped_frames;
+    overload_governor_cb_t callback;
+    void* callback_data;
+} overload_governor_t;
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+void overload_governor_init(overload_governor_t* governor, uint32_t budget_us,
+                            overload_governor_cb_t callback, void* callback_data);
+void overload_governor_set_budget(overload_governor_t* governor, uint32_t budget_us);
+bool overload_governor_skip_frame(overload_governor_t* governor);
+bool overload_governor_report(overload_governor_t* governor, uint32_t processing_us);
+void overload_governor_apply_config(overload_level_t level, xensiv_radar_presence_config_t* config);
+
+/* [] END OF FILE */
@@ -51,6 +51,8 @@
 #include "mqtt_task.h"
 #include "subscriber_task.h"
 #include "device_properties.h"
+#include "net_batch.h"
+#include "net_writer.h"
 
 /* Configuration file for MQTT client */
 #include "mqtt_client_config.h"
@@ -70,9 +72,10 @@
 
 #define PUBLISHER_TASK_QUEUE_LENGTH                     (10u)
 #define DEFAULT_RADAR_MAX_RANGE							(2.0)
-#define DEFAULT_RADAR_MACRO_THRESHOLD					(1.0)
-#define DEFAULT_RADAR_MICRO_THRESHOLD					(25.0)
+#define DEFAULT_RADAR_MACRO_THRESHOLD					(RADAR_DEFAULT_MACRO_THRESHOLD)
+#define DEFAULT_RADAR_MICRO_THRESHOLD					(RADAR_DEFAULT_MICRO_THRESHOLD)
 #define DEFAULT_RADAR_MODE								(2)
+#define DEFAULT_RADAR_TRACK_REPORT_INTERVAL				(TARGET_TRACKER_REPORT_INTERVAL_MS)
 #define CONVERT_TO_MS                                   (1000)
 #define SENSOR_TELEMETRY_BUFFER_SIZE					(240)
 #define PRESENCE_OUT_EVENT								(0)
@@ -88,10 +91,143 @@ TaskHandle_t publisher_task_handle;
 /* Handle of the queue holding the commands for the publisher task */
 QueueHandle_t publisher_task_q;
 
+/* Telemetry waiting to share a publish */
+static net_batch_t telemetry_batch;
+
+/* The message being handed over is the acknowledgement of a restart request */
+static bool restart_after_publish = false;
+
 /******************************************************************************
 * Function Prototypes
 *******************************************************************************/
 
+/******************************************************************************
+ * Function Name: publish_done
+ ******************************************************************************
+ * Summary:
+ *  Completion callback of the network writer, reports failed messages.
+ *
+ * Parameters:
+ *  uint32_t id : Message id
+ *  bool success : The message was published
+ *  uint32_t latency_ms : Time from the hand over to the end of the publish
+ *  void* arg : Topic of the message
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void publish_done(uint32_t id, bool success, uint32_t latency_ms, void* arg)
+{
+    if (!success)
+    {
+        APP_LOG_ERROR(("Publisher: message %lu to %s failed after %lu ms", id, (char*)arg, latency_ms));
+    }
+}
+
+/******************************************************************************
+ * Function Name: restart_publish_done
+ ******************************************************************************
+ * Summary:
+ *  Completion callback of the acknowledgement of a restart request. The
+ *  acknowledgement clears the desired state of the shadow, so the device
+ *  restarts only once it was published, otherwise the request would be
+ *  received again after the restart.
+ *
+ * Parameters:
+ *  uint32_t id : Message id
+ *  bool success : The message was published
+ *  uint32_t latency_ms : Time from the hand over to the end of the publish
+ *  void* arg : Topic of the message
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void restart_publish_done(uint32_t id, bool success, uint32_t latency_ms, void* arg)
+{
+    radar_config_data_t radar_config_q_data = {0};
+
+    publish_done(id, success, latency_ms, arg);
+
+    if (!success)
+    {
+        APP_LOG_ERROR(("Publisher: restart cancelled, the acknowledgement was not published"));
+        return;
+    }
+
+    /* radar_config_task saves the detection state and resets the device */
+    radar_config_q_data.cmd = UPDATE_RADAR_RESTART_CONFIG;
+    if (pdTRUE != xQueueSend(radar_config_task_q, &radar_config_q_data, 0))
+    {
+        APP_LOG_ERROR(("Publisher: restart cancelled, radar_config_task is busy"));
+    }
+}
+
+/******************************************************************************
+ * Function Name: publish_telemetry_batch
+ ******************************************************************************
+ * Summary:
+ *  Publish callback of the telemetry batch, in the bulk lane.
+ *
+ * Parameters:
+ *  char* message : Message to be published
+ *  int length : Message length to be published
+ *  char* mqtt_topic : Topic that the message has to be published to
+ *
+ * Return:
+ *  subs_rslt_t - SUBS_SUCCESS on success
+ *
+ ******************************************************************************/
+static subs_rslt_t publish_telemetry_batch(char* message, int length, char* mqtt_topic)
+{
+    return publish_to_mqtt_topic_async(message, length, mqtt_topic, NET_WRITER_LANE_BULK);
+}
+
+/******************************************************************************
+ * Function Name: publish_telemetry
+ ******************************************************************************
+ * Summary:
+ *  Adds a telemetry message to the batch, that is published once full, when
+ *  its window has elapsed or before another publish.
+ *
+ * Parameters:
+ *  char* message : Message to be published
+ *  char* mqtt_topic : Topic that the message has to be published to
+ *
+ * Return:
+ *  subs_rslt_t - SUBS_SUCCESS on success
+ *
+ ******************************************************************************/
+static subs_rslt_t publish_telemetry(char* message, char* mqtt_topic)
+{
+    uint32_t now_ms = (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+
+    return net_batch_add(&telemetry_batch, mqtt_topic, message,
+            strnlen(message, DEVICE_PROPERTIES_MQTT_MESSAGE_SIZE)+1, now_ms);
+}
+
+/******************************************************************************
+ * Function Name: publish_event
+ ******************************************************************************
+ * Summary:
+ *  Publishes an event in the latency lane, ahead of the batched telemetry
+ *  and the reports, one event per publish.
+ *
+ * Parameters:
+ *  char* message : Message to be published
+ *  char* mqtt_topic : Topic that the message has to be published to
+ *
+ * Return:
+ *  subs_rslt_t - SUBS_SUCCESS on success
+ *
+ ******************************************************************************/
+static subs_rslt_t publish_event(char* message, char* mqtt_topic)
+{
+    return publish_to_mqtt_topic_async(message, strnlen(message, DEVICE_PROPERTIES_MQTT_MESSAGE_SIZE)+1, mqtt_topic,
+            NET_WRITER_LANE_LATENCY);
+}
+
 /******************************************************************************
  * Function Name: publisher_task
  ******************************************************************************
@@ -112,7 +248,7 @@ void publisher_task(void *pvParameters)
     publisher_data_t publisher_q_data;
 	radar_config_data_t radar_config_q_data;
 	char *buffer_to_publish = NULL;
-	int sensor = RADAR_SENSOR+1;
+	int sensor;
 	int board = RADAR_BOARD+1;
 
     /* To avoid compiler warnings */
@@ -132,18 +268,42 @@ void publisher_task(void *pvParameters)
     		.max_range = DEFAULT_RADAR_MAX_RANGE,
     		.macro_threshold = DEFAULT_RADAR_MACRO_THRESHOLD,
 			.micro_threshold = DEFAULT_RADAR_MICRO_THRESHOLD,
-			.mode = DEFAULT_RADAR_MODE
+			.mode = DEFAULT_RADAR_MODE,
+			.track_report_interval = DEFAULT_RADAR_TRACK_REPORT_INTERVAL,
+			.calibration_state = THRESHOLD_CALIB_IDLE,
+			.calibration_duration = THRESHOLD_CALIB_DEFAULT_DURATION_MS / 1000u,
+			.calibration_far = THRESHOLD_CALIB_DEFAULT_FAR
     	};
 
+	/* Zones start disabled, as in radar_task */
+	for (uint32_t zone = 0; zone < ZONE_ENGINE_MAX_ZONES; zone++)
+	{
+		zone_engine_default_config(&radar_presence_attributes.zones[zone]);
+	}
 
     /* Create a message queue to communicate with other tasks and callbacks. */
     publisher_task_q = xQueueCreate(PUBLISHER_TASK_QUEUE_LENGTH, sizeof(publisher_data_t));
 
+    net_batch_init(&telemetry_batch, publish_telemetry_batch);
+
     while (true)
     {
-        /* Wait for commands from other tasks and callbacks. */
-        if (pdTRUE == xQueueReceive(publisher_task_q, &publisher_q_data, portMAX_DELAY))
+        uint32_t wait_ms = net_batch_wait_ms(&telemetry_batch, (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS));
+
+        /* The window of the batch has elapsed */
+        if (0u == wait_ms)
+        {
+            (void)net_batch_flush(&telemetry_batch);
+            wait_ms = NET_BATCH_WAIT_FOREVER;
+        }
+
+        /* Wait for commands from other tasks and callbacks, at most until the batch is due. */
+        if (pdTRUE == xQueueReceive(publisher_task_q, &publisher_q_data,
+                (NET_BATCH_WAIT_FOREVER == wait_ms) ? portMAX_DELAY : pdMS_TO_TICKS(wait_ms)))
         {
+            /* Telemetry of the sensor that produced it */
+            sensor = RADAR_SENSOR + publisher_q_data.sensor + 1;
+
             switch(publisher_q_data.cmd)
             {
                 case PUBLISHER_INIT:
@@ -163,6 +323,7 @@ void publisher_task(void *pvParameters)
                 {
                     /* Publish the fimrware version */
                     APP_LOG_DEBUG(("PUBLISH_FW_VERSION"));
+                    (void)net_batch_flush(&telemetry_batch);
                     publish_device_properties(PUB_FW_VERSION, radar_presence_attributes);
                     break;
                 }
@@ -171,7 +332,13 @@ void publisher_task(void *pvParameters)
                 {
                     /* Publish acknowledgement for the device properties */
                     APP_LOG_DEBUG(("PUBLISH_DEVICE_PROPERTIES_UPDATE_ACK"));
+                    (void)net_batch_flush(&telemetry_batch);
+
+                    /* A requested restart follows the publish of this acknowledgement */
+                    restart_after_publish = radar_presence_attributes.restart_requested;
                     publish_device_properties(PUB_DEVICE_PROPERTIES_ACK, radar_presence_attributes);
+                    restart_after_publish = false;
+                    radar_presence_attributes.restart_requested = false;
                     break;
                 }
 
@@ -208,8 +375,7 @@ void publisher_task(void *pvParameters)
 
 
 					/* Publish the message to respective topic */
-					rc = publish_to_mqtt_topic(buffer_to_publish, strnlen(buffer_to_publish, DEVICE_PROPERTIES_MQTT_MESSAGE_SIZE)+1, 
-									(char*)mqtt_topic_publish_telemetry);
+					rc = publish_event(buffer_to_publish, (char*)mqtt_topic_publish_telemetry);
 		
 					if(SUBS_SUCCESS != rc)
 					{
@@ -221,6 +387,194 @@ void publisher_task(void *pvParameters)
 					}
 					break;
 				}
+				case PUBLISH_RADAR_OVERLOAD_EVENT:
+				{
+					uint32_t time_val = (uint32_t)time(NULL);
+					snprintf(buffer_to_publish, SENSOR_TELEMETRY_BUFFER_SIZE, "{\"e\":{\"n\":\"RDR_SENSOR_OVERLOAD_EVENT\",\"l\":%u,\"p\":%lu,\"b\":%u,\"s\":%u,\"t\":%lu}}",
+							publisher_q_data.overload_level, publisher_q_data.overload_load_permille, board, sensor, time_val);
+					APP_LOG_DEBUG(("buffer_to_publish = %s", buffer_to_publish));
+
+					rc = publish_event(buffer_to_publish, (char*)mqtt_topic_publish_telemetry);
+					if(SUBS_SUCCESS != rc)
+					{
+						APP_LOG_ERROR(("Overload event publish failed %d", rc));
+					}
+					break;
+				}
+				case PUBLISH_RADAR_FRAME_STATS:
+				{
+					uint32_t time_val = (uint32_t)time(NULL);
+					snprintf(buffer_to_publish, SENSOR_TELEMETRY_BUFFER_SIZE, "{\"e\":{\"n\":\"RDR_SENSOR_FRAME_STATS\",\"f\":%lu,\"d\":%lu,\"l\":%lu,\"o\":%lu,\"r\":%lu,\"b\":%u,\"s\":%u,\"t\":%lu}}",
+							publisher_q_data.frame_count, publisher_q_data.dropped_frames, publisher_q_data.late_frames,
+							publisher_q_data.fifo_overflows, publisher_q_data.recoveries, board, sensor, time_val);
+					APP_LOG_DEBUG(("buffer_to_publish = %s", buffer_to_publish));
+
+					rc = publish_telemetry(buffer_to_publish, (char*)mqtt_topic_publish_telemetry);
+					if(SUBS_SUCCESS != rc)
+					{
+						APP_LOG_ERROR(("Frame statistics publish failed %d", rc));
+					}
+					break;
+				}
+				case PUBLISH_RADAR_TARGETS:
+				{
+					uint32_t time_val = (uint32_t)time(NULL);
+					int len = snprintf(buffer_to_publish, SENSOR_TELEMETRY_BUFFER_SIZE, "{\"e\":{\"n\":\"RDR_SENSOR_TARGETS\",\"c\":%u,\"d\":[",
+							publisher_q_data.target_count);
+
+					for (uint8_t i = 0; (i < publisher_q_data.target_count) && (len < SENSOR_TELEMETRY_BUFFER_SIZE); i++)
+					{
+						len += snprintf(&buffer_to_publish[len], SENSOR_TELEMETRY_BUFFER_SIZE - len, "%s%.2f",
+								(i == 0) ? "" : ",", publisher_q_data.target_distance[i]);
+					}
+
+					/* Azimuth per target in degrees when the sensor estimates angles */
+					if (publisher_q_data.target_angles && (len < SENSOR_TELEMETRY_BUFFER_SIZE))
+					{
+						len += snprintf(&buffer_to_publish[len], SENSOR_TELEMETRY_BUFFER_SIZE - len, "],\"a\":[");
+
+						for (uint8_t i = 0; (i < publisher_q_data.target_count) && (len < SENSOR_TELEMETRY_BUFFER_SIZE); i++)
+						{
+							len += snprintf(&buffer_to_publish[len], SENSOR_TELEMETRY_BUFFER_SIZE - len, "%s%.1f",
+									(i == 0) ? "" : ",", publisher_q_data.target_azimuth[i]);
+						}
+					}
+
+					if (len < SENSOR_TELEMETRY_BUFFER_SIZE)
+					{
+						snprintf(&buffer_to_publish[len], SENSOR_TELEMETRY_BUFFER_SIZE - len, "],\"b\":%u,\"s\":%u,\"t\":%lu}}",
+								board, sensor, time_val);
+					}
+					APP_LOG_DEBUG(("buffer_to_publish = %s", buffer_to_publish));
+
+					rc = publish_telemetry(buffer_to_publish, (char*)mqtt_topic_publish_telemetry);
+					if(SUBS_SUCCESS != rc)
+					{
+						APP_LOG_ERROR(("Targets publish failed %d", rc));
+					}
+					break;
+				}
+				case PUBLISH_RADAR_TRACKS:
+				{
+					uint32_t time_val = (uint32_t)time(NULL);
+					int len = snprintf(buffer_to_publish, SENSOR_TELEMETRY_BUFFER_SIZE, "{\"e\":{\"n\":\"RDR_SENSOR_TRACKS\",\"k\":[");
+
+					for (uint8_t i = 0; (i < publisher_q_data.track_count) && (len < SENSOR_TELEMETRY_BUFFER_SIZE); i++)
+					{
+						len += snprintf(&buffer_to_publish[len], SENSOR_TELEMETRY_BUFFER_SIZE - len, "%s{\"i\":%u,\"d\":%.2f,\"v\":%.2f}",
+								(i == 0) ? "" : ",", publisher_q_data.tracks[i].id, publisher_q_data.tracks[i].distance,
+								publisher_q_data.tracks[i].velocity);
+					}
+
+					if (len < SENSOR_TELEMETRY_BUFFER_SIZE)
+					{
+						snprintf(&buffer_to_publish[len], SENSOR_TELEMETRY_BUFFER_SIZE - len, "],\"b\":%u,\"s\":%u,\"t\":%lu}}",
+								board, sensor, time_val);
+					}
+					APP_LOG_DEBUG(("buffer_to_publish = %s", buffer_to_publish));
+
+					rc = publish_telemetry(buffer_to_publish, (char*)mqtt_topic_publish_telemetry);
+					if(SUBS_SUCCESS != rc)
+					{
+						APP_LOG_ERROR(("Tracks publish failed %d", rc));
+					}
+					break;
+				}
+				case PUBLISH_RADAR_ZONES:
+				{
+					uint32_t time_val = (uint32_t)time(NULL);
+					snprintf(buffer_to_publish, SENSOR_TELEMETRY_BUFFER_SIZE, "{\"e\":{\"n\":\"RDR_SENSOR_ZONES\",\"z\":%lu,\"b\":%u,\"s\":%u,\"t\":%lu}}",
+							publisher_q_data.zone_mask, board, sensor, time_val);
+					APP_LOG_DEBUG(("buffer_to_publish = %s", buffer_to_publish));
+
+					rc = publish_telemetry(buffer_to_publish, (char*)mqtt_topic_publish_telemetry);
+					if(SUBS_SUCCESS != rc)
+					{
+						APP_LOG_ERROR(("Zones publish failed %d", rc));
+					}
+					break;
+				}
+				case PUBLISH_RADAR_MOTION:
+				{
+					uint32_t time_val = (uint32_t)time(NULL);
+					snprintf(buffer_to_publish, SENSOR_TELEMETRY_BUFFER_SIZE, "{\"e\":{\"n\":\"RDR_SENSOR_MOTION\",\"w\":%u,\"v\":%.2f,\"d\":%.2f,\"b\":%u,\"s\":%u,\"t\":%lu}}",
+							publisher_q_data.walking ? 1u : 0u, publisher_q_data.velocity, publisher_q_data.distance, board, sensor, time_val);
+					APP_LOG_DEBUG(("buffer_to_publish = %s", buffer_to_publish));
+
+					rc = publish_telemetry(buffer_to_publish, (char*)mqtt_topic_publish_telemetry);
+					if(SUBS_SUCCESS != rc)
+					{
+						APP_LOG_ERROR(("Motion publish failed %d", rc));
+					}
+					break;
+				}
+				case PUBLISH_RADAR_ZONE_EVENT:
+				{
+					uint32_t time_val = (uint32_t)time(NULL);
+					uint32_t io = (publisher_q_data.zone_state == XENSIV_RADAR_PRESENCE_STATE_MACRO_PRESENCE) ? PRESENCE_MACRO_EVENT :
+							((publisher_q_data.zone_state == XENSIV_RADAR_PRESENCE_STATE_MICRO_PRESENCE) ? PRESENCE_MICRO_EVENT : PRESENCE_OUT_EVENT);
+					snprintf(buffer_to_publish, SENSOR_TELEMETRY_BUFFER_SIZE, "{\"e\":{\"n\":\"RDR_SENSOR_ZONE_EVENT\",\"z\":%u,\"io\":%lu,\"b\":%u,\"s\":%u,\"d\":%.2f,\"t\":%lu}}",
+							publisher_q_data.zone_id, io, board, sensor, publisher_q_data.distance, time_val);
+					APP_LOG_DEBUG(("buffer_to_publish = %s", buffer_to_publish));
+
+					rc = publish_event(buffer_to_publish, (char*)mqtt_topic_publish_telemetry);
+					if(SUBS_SUCCESS != rc)
+					{
+						APP_LOG_ERROR(("Zone event publish failed %d", rc));
+					}
+					break;
+				}
+				case PUBLISH_RADAR_SHADOW_EVENT:
+				{
+					uint32_t time_val = (uint32_t)time(NULL);
+					uint32_t io = (publisher_q_data.event == XENSIV_RADAR_PRESENCE_STATE_MACRO_PRESENCE) ? PRESENCE_MACRO_EVENT :
+							((publisher_q_data.event == XENSIV_RADAR_PRESENCE_STATE_MICRO_PRESENCE) ? PRESENCE_MICRO_EVENT : PRESENCE_OUT_EVENT);
+					snprintf(buffer_to_publish, SENSOR_TELEMETRY_BUFFER_SIZE, "{\"e\":{\"n\":\"RDR_SENSOR_SHADOW_EVENT\",\"io\":%lu,\"d\":%.2f,\"ma\":%.2f,\"mi\":%.2f,\"f\":%lu,\"k\":%lu,\"b\":%u,\"s\":%u,\"t\":%lu}}",
+							io, publisher_q_data.distance, publisher_q_data.macro_threshold, publisher_q_data.micro_threshold,
+							publisher_q_data.frame_count, publisher_q_data.dropped_frames, board, sensor, time_val);
+					APP_LOG_DEBUG(("buffer_to_publish = %s", buffer_to_publish));
+
+					/* Never on the telemetry topic, the shadow detector is only evaluated */
+					rc = publish_telemetry(buffer_to_publish, (char*)mqtt_topic_publish_diagnostics);
+					if(SUBS_SUCCESS != rc)
+					{
+						APP_LOG_ERROR(("Shadow event publish failed %d", rc));
+					}
+					break;
+				}
+				case PUBLISH_RADAR_CALIBRATION:
+				{
+					radar_presence_attributes.calibration_state = publisher_q_data.calibration_state;
+					radar_presence_attributes.calibrated_macro_threshold = publisher_q_data.macro_threshold;
+					radar_presence_attributes.calibrated_micro_threshold = publisher_q_data.micro_threshold;
+
+					/* radar_task already configured the applied thresholds */
+					if (publisher_q_data.calibration_state == THRESHOLD_CALIB_APPLIED)
+					{
+						radar_presence_attributes.macro_threshold = publisher_q_data.macro_threshold;
+						radar_presence_attributes.micro_threshold = publisher_q_data.micro_threshold;
+					}
+
+					/* The result is part of the reported state, after the telemetry that preceded it */
+					(void)net_batch_flush(&telemetry_batch);
+					publish_device_properties(PUB_DEVICE_PROPERTIES_ACK, radar_presence_attributes);
+					break;
+				}
+				case UPDATE_RADAR_RESTART:
+				{
+					/* Wait for the acknowledgement, see restart_publish_done */
+					radar_presence_attributes.restart_requested = true;
+					break;
+				}
+				case UPDATE_RADAR_STORED_CONFIG:
+				{
+					/* radar_task booted with the stored configuration, nothing to forward */
+					radar_presence_attributes.max_range = publisher_q_data.max_range;
+					radar_presence_attributes.macro_threshold = publisher_q_data.macro_threshold;
+					radar_presence_attributes.micro_threshold = publisher_q_data.micro_threshold;
+					radar_presence_attributes.mode = publisher_q_data.mode;
+					break;
+				}
 				case UPDATE_RADAR_MAX_RANGE:
 					{
 						radar_presence_attributes.max_range = publisher_q_data.max_range;
@@ -265,6 +619,81 @@ void publisher_task(void *pvParameters)
 						radar_config_q_data.cmd = UPDATE_RADAR_MODE_CONFIG;
 						radar_config_q_data.mode = radar_presence_attributes.mode;
 
+						xQueueSend(radar_config_task_q, &radar_config_q_data, portMAX_DELAY);
+						break;
+					}
+
+				case UPDATE_RADAR_TRACK_REPORT_INTERVAL:
+					{
+						radar_presence_attributes.track_report_interval = publisher_q_data.track_report_interval;
+
+						/* Notify radar_config_task to set radar configuration */
+						radar_config_q_data.cmd = UPDATE_RADAR_TRACK_REPORT_INTERVAL_CONFIG;
+						radar_config_q_data.track_report_interval = radar_presence_attributes.track_report_interval;
+
+						xQueueSend(radar_config_task_q, &radar_config_q_data, portMAX_DELAY);
+						break;
+					}
+
+				case UPDATE_RADAR_SHADOW_MACRO_THRESHOLD:
+				case UPDATE_RADAR_SHADOW_MICRO_THRESHOLD:
+					{
+						if (publisher_q_data.cmd == UPDATE_RADAR_SHADOW_MACRO_THRESHOLD)
+						{
+							radar_presence_attributes.shadow_macro_threshold = publisher_q_data.macro_threshold;
+						}
+						else
+						{
+							radar_presence_attributes.shadow_micro_threshold = publisher_q_data.micro_threshold;
+						}
+
+						/* Notify radar_config_task to set radar configuration */
+						radar_config_q_data.cmd = UPDATE_RADAR_SHADOW_CONFIG;
+						radar_config_q_data.macro_threshold = radar_presence_attributes.shadow_macro_threshold;
+						radar_config_q_data.micro_threshold = radar_presence_attributes.shadow_micro_threshold;
+
+						xQueueSend(radar_config_task_q, &radar_config_q_data, portMAX_DELAY);
+						break;
+					}
+
+				case UPDATE_RADAR_CALIBRATION:
+					{
+						radar_presence_attributes.calibration_state = THRESHOLD_CALIB_LEARNING;
+
+						/* Notify radar_config_task to start the calibration */
+						radar_config_q_data.cmd = UPDATE_RADAR_CALIBRATION_CONFIG;
+						radar_config_q_data.calibration_apply = publisher_q_data.calibration_apply;
+						radar_config_q_data.calibration_duration = radar_presence_attributes.calibration_duration;
+						radar_config_q_data.calibration_far = radar_presence_attributes.calibration_far;
+
+						xQueueSend(radar_config_task_q, &radar_config_q_data, portMAX_DELAY);
+						break;
+					}
+
+				case UPDATE_RADAR_CALIBRATION_DURATION:
+					{
+						/* Used by the next calibration */
+						radar_presence_attributes.calibration_duration = publisher_q_data.calibration_duration;
+						break;
+					}
+
+				case UPDATE_RADAR_CALIBRATION_FAR:
+					{
+						/* Used by the next calibration */
+						radar_presence_attributes.calibration_far = publisher_q_data.calibration_far;
+						break;
+					}
+
+				case UPDATE_RADAR_ZONE:
+					{
+						zone_engine_set_field(&radar_presence_attributes.zones[publisher_q_data.zone_id],
+								publisher_q_data.zone_field, publisher_q_data.zone_value);
+
+						/* Notify radar_config_task to set radar configuration, always with the whole zone */
+						radar_config_q_data.cmd = UPDATE_RADAR_ZONE_CONFIG;
+						radar_config_q_data.zone_id = publisher_q_data.zone_id;
+						radar_config_q_data.zone = radar_presence_attributes.zones[publisher_q_data.zone_id];
+
 						xQueueSend(radar_config_task_q, &radar_config_q_data, portMAX_DELAY);
 						break;
 					}
@@ -279,11 +708,56 @@ void publisher_task(void *pvParameters)
     }
 }
 
+/******************************************************************************
+ * Function Name: publish_to_mqtt_topic_async
+ ******************************************************************************
+ * Summary:
+ *  Hands a message over to the network writer and returns without waiting
+ *  for the network. Messages are published in the order of the calls.
+ *  Without the network writer the message is published at once.
+ *
+ * Parameters:
+ *  char* publish_message : Message to be published, copied
+ *  int publish_message_length : Message length to be published
+ *  char* mqtt_topic : Topic that the message has to be published to
+ *  net_writer_lane_t lane : NET_WRITER_LANE_LATENCY for events,
+ *                           NET_WRITER_LANE_BULK for telemetry and reports
+ *
+ * Return:
+ *  subs_rslt_t - SUBS_SUCCESS if the message was accepted
+ *
+ ******************************************************************************/
+subs_rslt_t publish_to_mqtt_topic_async(char* publish_message, int publish_message_length, char* mqtt_topic,
+                                        net_writer_lane_t lane)
+{
+#if (NET_WRITER_ENABLED != 0)
+    if (0u == net_writer_publish(mqtt_topic, publish_message, (uint32_t)publish_message_length, lane,
+                                 restart_after_publish ? restart_publish_done : publish_done, mqtt_topic))
+    {
+        APP_LOG_ERROR(("Publisher: message to %s dropped, the network writer is full", mqtt_topic));
+        return SUBS_FAILURE;
+    }
+
+    return SUBS_SUCCESS;
+#else
+    (void)lane;
+
+    subs_rslt_t result = publish_to_mqtt_topic(publish_message, publish_message_length, mqtt_topic);
+
+    if (restart_after_publish)
+    {
+        restart_publish_done(0u, (result == SUBS_SUCCESS), 0u, mqtt_topic);
+    }
+    return result;
+#endif
+}
+
 /******************************************************************************
  * Function Name: publish_to_mqtt_topic
  ******************************************************************************
  * Summary:
- *  Publish messages to given topic
+ *  Publish messages to given topic, called by the publish workers of the
+ *  network writer. For QoS 1 it returns once the PUBACK was received.
  *
  * Parameters:
  *  char* publish_message : Message to be published
@@ -297,11 +771,12 @@ void publisher_task(void *pvParameters)
 subs_rslt_t publish_to_mqtt_topic(char* publish_message, int publish_message_length, char* mqtt_topic)
 {
     cy_rslt_t result;
+    uint32_t start_cycles;
 
     /* Construct the message to be published*/
     cy_mqtt_publish_info_t publish_info =
     {
-        .qos = (cy_mqtt_qos_t) MQTT_MESSAGES_QOS,
+        .qos = (cy_mqtt_qos_t) MQTT_PUBLISH_QOS,
         .topic = mqtt_topic,
         .topic_len = (strlen(mqtt_topic)),
         .retain = false,
@@ -312,8 +787,10 @@ subs_rslt_t publish_to_mqtt_topic(char* publish_message, int publish_message_len
 
     APP_LOG_DEBUG(("Publish to Topic[%s]: Publishing[%d]: %s", publish_info.topic, publish_info.payload_len, publish_info.payload));
     
-    /* Publish the message */
+    /* Publish the message, timed for the network statistics */
+    start_cycles = net_batch_call_begin();
     result = cy_mqtt_publish(mqtt_connection, &publish_info);
+    net_batch_call_end(start_cycles, (uint32_t)publish_message_length, (result == CY_RSLT_SUCCESS));
 
     if (result != CY_RSLT_SUCCESS)
     {
@@ -47,6 +47,11 @@
 #include "queue.h"
 #include "common_variables.h"
 #include "radar_task.h"
+#include "target_detect.h"
+#include "target_tracker.h"
+#include "zone_engine.h"
+#include "threshold_calib.h"
+#include "net_writer.h"
 /*******************************************************************************
 * Macros
 ********************************************************************************/
@@ -70,7 +75,25 @@ typedef enum
 	UPDATE_RADAR_MAX_RANGE,
 	UPDATE_RADAR_MACRO_THRESHOLD,
 	UPDATE_RADAR_MICRO_THRESHOLD,
-	UPDATE_RADAR_MODE
+	UPDATE_RADAR_MODE,
+	PUBLISH_RADAR_OVERLOAD_EVENT,
+	PUBLISH_RADAR_FRAME_STATS,
+	PUBLISH_RADAR_TARGETS,
+	PUBLISH_RADAR_TRACKS,
+	PUBLISH_RADAR_ZONES,
+	PUBLISH_RADAR_MOTION,
+	UPDATE_RADAR_TRACK_REPORT_INTERVAL,
+	PUBLISH_RADAR_ZONE_EVENT,
+	UPDATE_RADAR_ZONE,
+	PUBLISH_RADAR_SHADOW_EVENT,
+	UPDATE_RADAR_SHADOW_MACRO_THRESHOLD,
+	UPDATE_RADAR_SHADOW_MICRO_THRESHOLD,
+	UPDATE_RADAR_CALIBRATION,
+	UPDATE_RADAR_CALIBRATION_DURATION,
+	UPDATE_RADAR_CALIBRATION_FAR,
+	PUBLISH_RADAR_CALIBRATION,
+	UPDATE_RADAR_STORED_CONFIG,
+	UPDATE_RADAR_RESTART
 
 } publisher_cmd_t;
 
@@ -81,8 +104,34 @@ typedef struct{
 	float macro_threshold;
 	float micro_threshold;
 	char mode;
+	uint8_t sensor;		/* index of the sensor on this board */
 	xensiv_radar_presence_state_t event;
 	float distance;
+	uint8_t overload_level;
+	uint32_t overload_load_permille;
+	uint32_t frame_count;
+	uint32_t dropped_frames;
+	uint32_t late_frames;
+	uint32_t fifo_overflows;
+	uint32_t recoveries;
+	uint8_t target_count;
+	float target_distance[TARGET_DETECT_MAX_TARGETS];
+	bool target_angles;
+	float target_azimuth[TARGET_DETECT_MAX_TARGETS];
+	uint8_t track_count;
+	target_track_report_t tracks[TARGET_TRACKER_MAX_TRACKS];
+	uint32_t track_report_interval;
+	uint32_t zone_mask;
+	bool walking;
+	float velocity;
+	uint8_t zone_id;
+	xensiv_radar_presence_state_t zone_state;
+	zone_field_t zone_field;
+	float zone_value;
+	bool calibration_apply;
+	uint32_t calibration_duration;
+	float calibration_far;
+	threshold_calib_state_t calibration_state;
 } publisher_data_t;
 
 
@@ -93,6 +142,16 @@ typedef struct
 	float macro_threshold;
 	float micro_threshold;
 	char  mode;
+	uint32_t track_report_interval;
+	zone_config_t zones[ZONE_ENGINE_MAX_ZONES];
+	float shadow_macro_threshold;
+	float shadow_micro_threshold;
+	threshold_calib_state_t calibration_state;
+	float calibrated_macro_threshold;
+	float calibrated_micro_threshold;
+	uint32_t calibration_duration;      /* seconds */
+	float calibration_far;
+	bool restart_requested;             /* restart once the next acknowledgement is published */
 } radar_presence_attributes_t;
 
 /*******************************************************************************
@@ -106,6 +165,8 @@ extern QueueHandle_t publisher_task_q;
 ********************************************************************************/
 void publisher_task(void *pvParameters);
 subs_rslt_t publish_to_mqtt_topic(char* publish_message, int publish_message_length, char* mqtt_topic);
+subs_rslt_t publish_to_mqtt_topic_async(char* publish_message, int publish_message_length, char* mqtt_topic,
+                                        net_writer_lane_t lane);
 
 #endif /* PUBLISHER_TASK_H_ */
 
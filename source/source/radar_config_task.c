@@ -32,9 +32,12 @@
 #include "stdlib.h"
 
 /* Header file from library */
+#include "cybsp.h"
 #include "cy_json_parser.h"
 
 /* Header file for local tasks */
+#include "adaptive_rate.h"
+#include "config_store.h"
 #include "publisher_task.h"
 #include "radar_config_task.h"
 #include "radar_task.h"
@@ -42,6 +45,9 @@
 
 #define RADAR_CONFIG_TASK_QUEUE_LENGTH                     (10u)
 
+/* Time for the last log lines before a requested restart */
+#define RADAR_RESTART_DELAY_MS                             (100u)
+
 /*******************************************************************************
  * Global Variables
  ******************************************************************************/
@@ -52,6 +58,42 @@ xensiv_radar_presence_config_t config;
 
 
 
+#if (CONFIG_STORE_ENABLED != 0)
+/*******************************************************************************
+ * Function Name: store_config
+ *******************************************************************************
+ * Summary:
+ *      Hands the configuration in use to the store, which writes it once it
+ *      is stable. The flash is not readable during the write, the sensor FIFO
+ *      keeps the frames meanwhile.
+ *
+ * Parameters:
+ *   handle: presence library handle
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void store_config(xensiv_radar_presence_handle_t handle)
+{
+	xensiv_radar_presence_config_t current;
+	bool valid = false;
+	uint32_t time_ms = (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+
+	if (xSemaphoreTake(sem_radar_sensing_context, portMAX_DELAY) == pdTRUE)
+	{
+		valid = radar_task_get_stored_config(handle, &current);
+
+		xSemaphoreGive(sem_radar_sensing_context);
+	}
+
+	if (valid)
+	{
+		config_store_save(&config_store, &current, time_ms);
+	}
+	(void)config_store_poll(&config_store, time_ms);
+}
+#endif
+
 /*******************************************************************************
  * Function Name: radar_config_task
  *******************************************************************************
@@ -82,14 +124,21 @@ void radar_config_task(void *pvParameters)
     {
 		//printf("Running radar config task \r\n");
 
-		if (pdTRUE == xQueueReceive(radar_config_task_q, &radarData, portMAX_DELAY))
+		TickType_t wait = portMAX_DELAY;
+
+#if (CONFIG_STORE_ENABLED != 0)
+		/* Also picks up changes made by radar_task, e.g. applied calibrations */
+		wait = pdMS_TO_TICKS(CONFIG_STORE_POLL_MS);
+#endif
+
+		if (pdTRUE == xQueueReceive(radar_config_task_q, &radarData, wait))
 		{
 			switch(radarData.cmd)
             {
 
 				 case UPDATE_RADAR_PRESENCE_MAX_RANGE_CONFIG:
 				 {
-					 result = xensiv_radar_presence_get_config(handle, &config);
+					 result = adaptive_rate_get_config(handle, &config);
 
 					 if (result != XENSIV_RADAR_PRESENCE_OK)
 					     {
@@ -100,7 +149,7 @@ void radar_config_task(void *pvParameters)
 
 					 	if (xSemaphoreTake(sem_radar_sensing_context, portMAX_DELAY) == pdTRUE)
 					 	{
-						 result = xensiv_radar_presence_set_config(handle, &config);
+						 result = adaptive_rate_set_config(handle, &config);
 						 xensiv_radar_presence_reset(handle);
 
 						 xSemaphoreGive(sem_radar_sensing_context);
@@ -113,7 +162,7 @@ void radar_config_task(void *pvParameters)
 						 else
 						 {
 							 config.max_range_bin = 0;
-							 xensiv_radar_presence_get_config(handle, &config);
+							 adaptive_rate_get_config(handle, &config);
 							 APP_LOG_DEBUG(("Radar Presence max_range = %ld",config.max_range_bin));
 						 }
 
@@ -122,7 +171,7 @@ void radar_config_task(void *pvParameters)
 
 				 case UPDATE_RADAR_MACRO_THRESHOLD_CONFIG:
 				 {
-						 result = xensiv_radar_presence_get_config(handle, &config);
+						 result = adaptive_rate_get_config(handle, &config);
 
 						 if (result != XENSIV_RADAR_PRESENCE_OK)
 							 {
@@ -132,7 +181,7 @@ void radar_config_task(void *pvParameters)
 						 config.macro_threshold = radarData.macro_threshold;
 						 if (xSemaphoreTake(sem_radar_sensing_context, portMAX_DELAY) == pdTRUE)
 						 {
-						 result = xensiv_radar_presence_set_config(handle, &config);
+						 result = adaptive_rate_set_config(handle, &config);
 						 xensiv_radar_presence_reset(handle);
 
 						 xSemaphoreGive(sem_radar_sensing_context);
@@ -145,7 +194,7 @@ void radar_config_task(void *pvParameters)
 							 else
 							 {
 								 config.macro_threshold = 0;
-								 xensiv_radar_presence_get_config(handle, &config);
+								 adaptive_rate_get_config(handle, &config);
 								 APP_LOG_DEBUG(("Radar Presence macro_threshold = %f",config.macro_threshold));
 							 }
 
@@ -156,7 +205,7 @@ void radar_config_task(void *pvParameters)
 
 				 case UPDATE_RADAR_MICRO_THRESHOLD_CONFIG:
 				 {
-						 result = xensiv_radar_presence_get_config(handle, &config);
+						 result = adaptive_rate_get_config(handle, &config);
 
 						 if (result != XENSIV_RADAR_PRESENCE_OK)
 							 {
@@ -166,7 +215,7 @@ void radar_config_task(void *pvParameters)
 						 config.micro_threshold = radarData.micro_threshold;
 						 if (xSemaphoreTake(sem_radar_sensing_context, portMAX_DELAY) == pdTRUE)
 						 {
-						 result = xensiv_radar_presence_set_config(handle, &config);
+						 result = adaptive_rate_set_config(handle, &config);
 						 xensiv_radar_presence_reset(handle);
 
 						 xSemaphoreGive(sem_radar_sensing_context);
@@ -179,7 +228,7 @@ void radar_config_task(void *pvParameters)
 							 else
 							 {
 								 config.micro_threshold = 0;
-								 xensiv_radar_presence_get_config(handle, &config);
+								 adaptive_rate_get_config(handle, &config);
 								 APP_LOG_DEBUG(("Radar Presence micro_threshold = %f",config.micro_threshold));
 							 }
 
@@ -189,7 +238,7 @@ void radar_config_task(void *pvParameters)
 
 				 case UPDATE_RADAR_MODE_CONFIG:
 				 {
-						 result = xensiv_radar_presence_get_config(handle, &config);
+						 result = adaptive_rate_get_config(handle, &config);
 
 						 if (result != XENSIV_RADAR_PRESENCE_OK)
 							 {
@@ -199,7 +248,7 @@ void radar_config_task(void *pvParameters)
 						 config.mode = (xensiv_radar_presence_mode_t)radarData.mode;
 						 if (xSemaphoreTake(sem_radar_sensing_context, portMAX_DELAY) == pdTRUE)
 						 {
-						 result = xensiv_radar_presence_set_config(handle, &config);
+						 result = adaptive_rate_set_config(handle, &config);
 						 xensiv_radar_presence_reset(handle);
 
 						 xSemaphoreGive(sem_radar_sensing_context);
@@ -212,7 +261,7 @@ void radar_config_task(void *pvParameters)
 							 else
 							 {
 								 config.mode = 0;
-								 xensiv_radar_presence_get_config(handle, &config);
+								 adaptive_rate_get_config(handle, &config);
 								 APP_LOG_DEBUG(("Radar Presence mode = %d",config.mode));
 							 }
 
@@ -220,6 +269,83 @@ void radar_config_task(void *pvParameters)
 					break;
 				 }
 
+				 case UPDATE_RADAR_TRACK_REPORT_INTERVAL_CONFIG:
+				 {
+						 /* Only the telemetry rate changes, the detection keeps running */
+						 radar_task_set_track_report_interval(radarData.track_report_interval);
+						 APP_LOG_DEBUG(("Radar track report interval = %lu",radarData.track_report_interval));
+
+					break;
+				 }
+
+				 case UPDATE_RADAR_SHADOW_CONFIG:
+				 {
+						 /* The production detector is not touched */
+						 if (xSemaphoreTake(sem_radar_sensing_context, portMAX_DELAY) == pdTRUE)
+						 {
+						 radar_task_set_shadow_thresholds(radarData.macro_threshold, radarData.micro_threshold);
+
+						 xSemaphoreGive(sem_radar_sensing_context);
+						 }
+						 APP_LOG_DEBUG(("Radar shadow macro_threshold = %f micro_threshold = %f",radarData.macro_threshold, radarData.micro_threshold));
+
+					break;
+				 }
+
+				 case UPDATE_RADAR_CALIBRATION_CONFIG:
+				 {
+						 /* radar_task reports the result once the learning window ends */
+						 if (xSemaphoreTake(sem_radar_sensing_context, portMAX_DELAY) == pdTRUE)
+						 {
+						 radar_task_start_calibration(radarData.calibration_duration * 1000u, radarData.calibration_far,
+								 radarData.calibration_apply);
+
+						 xSemaphoreGive(sem_radar_sensing_context);
+						 }
+						 APP_LOG_DEBUG(("Radar calibration %lu s far = %f apply = %d",radarData.calibration_duration, radarData.calibration_far, radarData.calibration_apply));
+
+					break;
+				 }
+
+				 case UPDATE_RADAR_RESTART_CONFIG:
+				 {
+						 /* Requested through the shadow, the acknowledgement was published */
+						 APP_LOG_INFO(("Radar restart, saving the detection state"));
+
+						 /* Suspends radar_task, no frame is processed afterwards */
+						 radar_task_shutdown();
+
+						 /* Let the log reach the terminal */
+						 vTaskDelay(pdMS_TO_TICKS(RADAR_RESTART_DELAY_MS));
+						 NVIC_SystemReset();
+					break;
+				 }
+
+				 case UPDATE_RADAR_ZONE_CONFIG:
+				 {
+						 bool zone_result = false;
+
+						 /* The zones are evaluated inside the sensing context */
+						 if (xSemaphoreTake(sem_radar_sensing_context, portMAX_DELAY) == pdTRUE)
+						 {
+						 zone_result = radar_task_set_zone(radarData.zone_id, &radarData.zone);
+
+						 xSemaphoreGive(sem_radar_sensing_context);
+						 }
+
+						 if (!zone_result)
+						 {
+							 APP_LOG_ERROR(("Error while setting zone %u", radarData.zone_id));
+						 }
+						 else
+						 {
+							 APP_LOG_DEBUG(("Radar zone %u = %.2f..%.2f m",radarData.zone_id, radarData.zone.min_range, radarData.zone.max_range));
+						 }
+
+					break;
+				 }
+
+
 
 
 				default:
@@ -227,6 +353,10 @@ void radar_config_task(void *pvParameters)
 
 			}
 		}
+
+#if (CONFIG_STORE_ENABLED != 0)
+		store_config(handle);
+#endif
     }
 }
 
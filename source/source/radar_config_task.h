@@ -30,6 +30,8 @@
 #include "FreeRTOS.h"
 #include "task.h"
 
+#include "zone_engine.h"
+
 /*******************************************************************************
  * Macros
  ******************************************************************************/
@@ -47,7 +49,12 @@ typedef enum
 	UPDATE_RADAR_PRESENCE_MAX_RANGE_CONFIG,
 	UPDATE_RADAR_MACRO_THRESHOLD_CONFIG,
 	UPDATE_RADAR_MICRO_THRESHOLD_CONFIG,
-	UPDATE_RADAR_MODE_CONFIG
+	UPDATE_RADAR_MODE_CONFIG,
+	UPDATE_RADAR_TRACK_REPORT_INTERVAL_CONFIG,
+	UPDATE_RADAR_ZONE_CONFIG,
+	UPDATE_RADAR_SHADOW_CONFIG,
+	UPDATE_RADAR_CALIBRATION_CONFIG,
+	UPDATE_RADAR_RESTART_CONFIG
 } radar_config_cmd_t;
 
 /* Struct to be passed to the publisher task queue */
@@ -57,6 +64,12 @@ typedef struct{
 	float macro_threshold;
 	float micro_threshold;
 	char mode;
+	uint32_t track_report_interval;
+	uint8_t zone_id;
+	zone_config_t zone;
+	bool calibration_apply;
+	uint32_t calibration_duration;      /* seconds */
+	float calibration_far;
 } radar_config_data_t;
 
 
@@ -0,0 +1,205 @@
+/*****************************************************************************
+ * File name: radar_sensor.c
+ *
+ * Description: This file contains the helpers of the radar task to drive
+ * several sensors from one controller. Complete frames of all sensors are
+ * processed in the order of their interrupt timestamps, the further sensors
+ * follow the presence configuration of the first one, and the processing
+ * cost and the queueing delay of every sensor are accounted so the CPU
+ * share and the fairness of the scheduling can be compared.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <inttypes.h>
+#include <stdio.h>
+
+/* Header file for local task */
+#include "cycle_counter.h"
+#include "radar_sensor.h"
+
+/*******************************************************************************
+ * Function Name: config_equal
+ *******************************************************************************
+ * Summary:
+ *   Compares two presence configurations field by field, the padding of the
+ *   structures is not defined.
+ *
+ * Parameters:
+ *   a: first configuration
+ *   b: second configuration
+ *
+ * Return:
+ *   true if all fields are equal
+ ******************************************************************************/
+static bool config_equal(const xensiv_radar_presence_config_t* a, const xensiv_radar_presence_config_t* b)
+{
+    return (a->bandwidth == b->bandwidth) &&
+           (a->num_samples_per_chirp == b->num_samples_per_chirp) &&
+           (a->micro_fft_decimation_enabled == b->micro_fft_decimation_enabled) &&
+           (a->micro_fft_size == b->micro_fft_size) &&
+           (a->macro_threshold == b->macro_threshold) &&
+           (a->micro_threshold == b->micro_threshold) &&
+           (a->min_range_bin == b->min_range_bin) &&
+           (a->max_range_bin == b->max_range_bin) &&
+           (a->macro_compare_interval_ms == b->macro_compare_interval_ms) &&
+           (a->macro_movement_validity_ms == b->macro_movement_validity_ms) &&
+           (a->micro_movement_validity_ms == b->micro_movement_validity_ms) &&
+           (a->macro_movement_confirmations == b->macro_movement_confirmations) &&
+           (a->macro_trigger_range == b->macro_trigger_range) &&
+           (a->mode == b->mode) &&
+           (a->macro_fft_bandpass_filter_enabled == b->macro_fft_bandpass_filter_enabled) &&
+           (a->micro_movement_compare_idx == b->micro_movement_compare_idx);
+}
+
+/*******************************************************************************
+ * Function Name: radar_sensor_oldest
+ *******************************************************************************
+ * Summary:
+ *   Selects the complete frame with the oldest interrupt timestamp. The
+ *   timestamps come from one free running timer and are compared modulo
+ *   2^32. Frames with the same timestamp go to the lower sensor first.
+ *
+ * Parameters:
+ *   frames: pending frame of every sensor
+ *   count: number of sensors
+ *
+ * Return:
+ *   sensor of the oldest frame, -1 if no frame is ready
+ ******************************************************************************/
+int32_t radar_sensor_oldest(const radar_sensor_frame_t* frames, uint32_t count)
+{
+    int32_t oldest = -1;
+
+    for (uint32_t sensor = 0; sensor < count; ++sensor)
+    {
+        if (!frames[sensor].ready)
+        {
+            continue;
+        }
+
+        if ((oldest < 0) || ((int32_t)(frames[sensor].stamp_us - frames[oldest].stamp_us) < 0))
+        {
+            oldest = (int32_t)sensor;
+        }
+    }
+
+    return oldest;
+}
+
+/*******************************************************************************
+ * Function Name: radar_sensor_follow_config
+ *******************************************************************************
+ * Summary:
+ *   Applies the configuration of the first sensor to the presence library
+ *   instance of a further sensor when it changed.
+ *
+ * Parameters:
+ *   handle: presence library instance of the sensor
+ *   applied: configuration of the instance, updated
+ *   config: configuration of the first sensor
+ *
+ * Return:
+ *   true if the configuration was changed
+ ******************************************************************************/
+bool radar_sensor_follow_config(xensiv_radar_presence_handle_t handle, xensiv_radar_presence_config_t* applied,
+                                const xensiv_radar_presence_config_t* config)
+{
+    if (config_equal(applied, config) ||
+        (xensiv_radar_presence_set_config(handle, config) != XENSIV_RADAR_PRESENCE_OK))
+    {
+        return false;
+    }
+
+    *applied = *config;
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: radar_sensor_account
+ *******************************************************************************
+ * Summary:
+ *   Records the cycles spent on one frame of a sensor and the time the frame
+ *   waited for the processing. Prints the statistics of all sensors
+ *   periodically: the share of the processing time each sensor takes and
+ *   how long its frames waited behind the frames of the others.
+ *
+ * Parameters:
+ *   stats: statistics of all sensors
+ *   count: number of sensors
+ *   sensor: sensor of the frame
+ *   cycles: preprocessing and processing cycles of the frame
+ *   wait_us: time from the end of the FIFO read to the start of processing
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void radar_sensor_account(radar_sensor_stats_t* stats, uint32_t count, uint32_t sensor, uint32_t cycles,
+                          uint32_t wait_us)
+{
+    radar_sensor_stats_t* sensor_stats = &stats[sensor];
+    uint64_t all_cycles = 0;
+    uint32_t all_frames = 0;
+
+    ++sensor_stats->frames;
+    sensor_stats->total_cycles += cycles;
+    sensor_stats->total_wait_us += wait_us;
+    if (cycles > sensor_stats->max_cycles)
+    {
+        sensor_stats->max_cycles = cycles;
+    }
+    if (wait_us > sensor_stats->max_wait_us)
+    {
+        sensor_stats->max_wait_us = wait_us;
+    }
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        all_cycles += stats[i].total_cycles;
+        all_frames += stats[i].frames;
+    }
+
+    if ((all_frames % RADAR_SENSOR_STATS_PRINT_INTERVAL) != 0u)
+    {
+        return;
+    }
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const radar_sensor_stats_t* s = &stats[i];
+
+        if (s->frames == 0u)
+        {
+            printf("[INFO] sensor %" PRIu32 ": no frame\n", i);
+            continue;
+        }
+
+        printf("[INFO] sensor %" PRIu32 ": %" PRIu32 " frames, avg %" PRIu32 " max %" PRIu32 " us, %" PRIu32
+               "%% of the processing, waited avg %" PRIu32 " max %" PRIu32 " us\n",
+               i, s->frames, cycle_counter_to_us((uint32_t)(s->total_cycles / s->frames)),
+               cycle_counter_to_us(s->max_cycles), (all_cycles > 0u) ? (uint32_t)((s->total_cycles * 100u) / all_cycles) : 0u,
+               (uint32_t)(s->total_wait_us / s->frames), s->max_wait_us);
+    }
+}
+
+/* [] END OF FILE */
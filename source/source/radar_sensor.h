@@ -0,0 +1,99 @@
+/******************************************************************************
+ * File Name:   radar_sensor.h
+ *
+ * Description: This file contains the function prototypes and constants used
+ *   in radar_sensor.c.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+
+#pragma once
+
+/* Header file from system */
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Header file for library */
+#include "cyhal.h"
+#include "xensiv_radar_presence.h"
+
+/* Header file for local task */
+#include "resource_map.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Sensors one controller can drive, see RADAR_NUM_SENSORS */
+#define RADAR_SENSOR_MAX_SENSORS            (4u)
+
+/* Pins of every sensor, from resource_map.h */
+#define RADAR_SENSOR_PINS                                                                                  \
+{                                                                                                          \
+    { PIN_XENSIV_BGT60TRXX_SPI_CSN, PIN_XENSIV_BGT60TRXX_IRQ, PIN_XENSIV_BGT60TRXX_RSTN },                 \
+    { PIN_XENSIV_BGT60TRXX_2_SPI_CSN, PIN_XENSIV_BGT60TRXX_2_IRQ, PIN_XENSIV_BGT60TRXX_2_RSTN },           \
+    { PIN_XENSIV_BGT60TRXX_3_SPI_CSN, PIN_XENSIV_BGT60TRXX_3_IRQ, PIN_XENSIV_BGT60TRXX_3_RSTN },           \
+    { PIN_XENSIV_BGT60TRXX_4_SPI_CSN, PIN_XENSIV_BGT60TRXX_4_IRQ, PIN_XENSIV_BGT60TRXX_4_RSTN }            \
+}
+
+/* Frames processed over all sensors between two statistics prints */
+#define RADAR_SENSOR_STATS_PRINT_INTERVAL   (2000u)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+/* The SPI bus and LDO_EN are shared by all sensors */
+typedef struct
+{
+    cyhal_gpio_t csn;
+    cyhal_gpio_t irq;
+    cyhal_gpio_t rstn;
+} radar_sensor_pins_t;
+
+/* Complete frame of a sensor waiting to be processed */
+typedef struct
+{
+    bool ready;
+    uint32_t stamp_us;                  /* interrupt of the first block */
+    uint32_t ready_us;                  /* end of the FIFO read */
+    uint32_t time_ms;                   /* acquisition time for the presence library */
+    uint32_t preprocess_cycles;
+} radar_sensor_frame_t;
+
+typedef struct
+{
+    uint32_t frames;
+    uint64_t total_cycles;              /* preprocessing and processing */
+    uint32_t max_cycles;
+    uint64_t total_wait_us;             /* complete frame to start of processing */
+    uint32_t max_wait_us;
+} radar_sensor_stats_t;
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+int32_t radar_sensor_oldest(const radar_sensor_frame_t* frames, uint32_t count);
+bool radar_sensor_follow_config(xensiv_radar_presence_handle_t handle, xensiv_radar_presence_config_t* applied,
+                                const xensiv_radar_presence_config_t* config);
+void radar_sensor_account(radar_sensor_stats_t* stats, uint32_t count, uint32_t sensor, uint32_t cycles,
+                          uint32_t wait_us);
+
+/* [] END OF FILE */
@@ -28,6 +28,8 @@
 /* Header file from system */
 #include <inttypes.h>
 #include <stdio.h>
+#include <string.h>
+#include <time.h>
 
 /* Header file includes */
 #include "cybsp.h"
@@ -38,11 +40,33 @@
 #include "timers.h"
 
 /* Header file for local task */
+#include "adaptive_rate.h"
+#include "angle_estimate.h"
+#include "config_store.h"
+#include "cycle_counter.h"
+#include "frame_preprocess.h"
+#include "frame_ring.h"
+#include "frame_ring_ipc.h"
+#include "frame_sequence.h"
+#include "hot_path.h"
+#include "micro_sdft.h"
+#include "overload_governor.h"
 #include "publisher_task.h"
 #include "radar_config_task.h"
+#include "radar_sensor.h"
 #include "radar_task.h"
+#include "range_doppler.h"
+#include "range_fft.h"
 #include "resource_map.h"
+#include "shadow_presence.h"
+#include "target_detect.h"
+#include "target_tracker.h"
+#include "threshold_calib.h"
+#include "warm_start.h"
 #include "xensiv_radar_presence.h"
+#include "zone_config.h"
+#include "zone_engine.h"
+#include "zone_occupancy.h"
 
 /*******************************************************************************
  * Macros
@@ -69,6 +93,87 @@
 
 #define NUM_SAMPLES_PER_CHIRP               XENSIV_BGT60TRXX_CONF_NUM_SAMPLES_PER_CHIRP
 #define NUM_CHIRPS_PER_FRAME                XENSIV_BGT60TRXX_CONF_NUM_CHIRPS_PER_FRAME
+#define NUM_RX_ANTENNAS                     XENSIV_BGT60TRXX_CONF_NUM_RX_ANTENNAS
+/* Raw samples of one chirp over all antennas */
+#define NUM_SAMPLES_PER_CHUNK               (XENSIV_BGT60TRXX_CONF_NUM_SAMPLES_PER_CHIRP *\
+                                             XENSIV_BGT60TRXX_CONF_NUM_RX_ANTENNAS)
+
+/* Samples read per FIFO interrupt, one chirp in streaming mode */
+#if (RADAR_STREAMING_MODE != 0)
+#define NUM_SAMPLES_PER_IRQ                 NUM_SAMPLES_PER_CHUNK
+#else
+#define NUM_SAMPLES_PER_IRQ                 NUM_SAMPLES_PER_FRAME
+#endif
+#define FRAME_PERIOD_MS                     ((uint32_t)(XENSIV_BGT60TRXX_CONF_FRAME_REPETION_TIME_S * 1000))
+
+/* Time between two FIFO interrupts, used for data that did not raise one */
+#if (RADAR_STREAMING_MODE != 0)
+#define IRQ_PERIOD_US                       ((uint32_t)(XENSIV_BGT60TRXX_CONF_CHIRP_REPETION_TIME_S * 1000000))
+#else
+#define IRQ_PERIOD_US                       ((uint32_t)(XENSIV_BGT60TRXX_CONF_FRAME_REPETION_TIME_S * 1000000))
+#endif
+
+/* Frame periods without FIFO interrupt before the acquisition is restarted */
+#define FRAME_STALL_PERIODS                 (10u)
+
+/* The FIFO fill status counts 24 bit words holding two samples each */
+#define FIFO_FILL_SAMPLES(fstat)            (((((fstat) & XENSIV_BGT60TRXX_REG_FSTAT_FILL_STATUS_MSK) >>\
+                                               XENSIV_BGT60TRXX_REG_FSTAT_FILL_STATUS_POS)) * 2u)
+
+/* Interval of the frame statistics reports while counters change */
+#define FRAME_STATS_REPORT_INTERVAL_MS      (10000u)
+
+/* Frequency of the timer used for interrupt timestamps */
+#define STAMP_TIMER_FREQUENCY               (1000000UL)
+
+/* Wait for the end of the frame in process before radar_task is stopped; the
+ * frame can wait for the publisher task queue with the sensing context taken
+ */
+#ifndef RADAR_TASK_STOP_TIMEOUT_MS
+#define RADAR_TASK_STOP_TIMEOUT_MS          (1000u)
+#endif
+#if (MICRO_SDFT_ENABLED != 0) && (RANGE_FFT_ENABLED == 0)
+#error "MICRO_SDFT_ENABLED requires RANGE_FFT_ENABLED"
+#endif
+
+#if (TARGET_DETECT_ENABLED != 0) && (RANGE_FFT_ENABLED == 0)
+#error "TARGET_DETECT_ENABLED requires RANGE_FFT_ENABLED"
+#endif
+
+#if (TARGET_TRACKER_ENABLED != 0) && (TARGET_DETECT_ENABLED == 0)
+#error "TARGET_TRACKER_ENABLED requires TARGET_DETECT_ENABLED"
+#endif
+
+#if (RADAR_NUM_SENSORS < 1) || (RADAR_NUM_SENSORS > RADAR_SENSOR_MAX_SENSORS)
+#error "RADAR_NUM_SENSORS must be 1 to 4"
+#endif
+
+#if (RADAR_NUM_SENSORS > 1) && (RADAR_ACQUISITION_CM0P != 0)
+#error "The acquisition of the CM0+ core drives one sensor"
+#endif
+
+/* The slow scan stops the frame generation while the task sleeps */
+#if (RADAR_NUM_SENSORS > 1) && (ADAPTIVE_RATE_ENABLED != 0)
+#error "Several sensors require ADAPTIVE_RATE_ENABLED=0"
+#endif
+
+/* Velocities are measured inside a frame when the profile has several chirps */
+#define RANGE_DOPPLER_ACTIVE                ((RANGE_DOPPLER_ENABLED != 0) && (NUM_CHIRPS_PER_FRAME > 1))
+
+/* Doppler resolution of the profile, lambda / (2 * chirps * chirp repetition time) */
+#define SPEED_OF_LIGHT                      (299792458.0f)
+#define CENTER_FREQUENCY_HZ                 ((float32_t)(XENSIV_BGT60TRXX_CONF_LOWER_FREQ_HZ +\
+                                                         XENSIV_BGT60TRXX_CONF_UPPER_FREQ_HZ) / 2.0f)
+#define DOPPLER_VELOCITY_RESOLUTION         (SPEED_OF_LIGHT / (2.0f * CENTER_FREQUENCY_HZ * NUM_CHIRPS_PER_FRAME *\
+                                                               (float32_t)XENSIV_BGT60TRXX_CONF_CHIRP_REPETION_TIME_S))
+
+/* Angles are estimated for the targets when the profile has the antennas */
+#define ANGLE_ESTIMATE_ACTIVE               ((ANGLE_ESTIMATE_ENABLED != 0) && (TARGET_DETECT_ENABLED != 0) &&\
+                                             (NUM_RX_ANTENNAS == ANGLE_ESTIMATE_NUM_ANTENNAS))
+
+/* Minimum interval between two target list reports */
+#define TARGET_REPORT_INTERVAL_MS           (1000u)
+
 /* Interrupt priorities */
 #define GPIO_INTERRUPT_PRIORITY             (6)
 
@@ -82,11 +187,123 @@ SemaphoreHandle_t sem_radar_sensing_context = NULL;
 
 float32_t Bin_len = 0.0f;
 
+#if (CONFIG_STORE_ENABLED != 0)
+/* Loaded before the library is allocated, then kept up to date by radar_config_task */
+config_store_t config_store;
+#endif
+
+/* Library instance of radar_task, for radar_task_shutdown */
+static xensiv_radar_presence_handle_t presence_handle = NULL;
+
+#if (RADAR_ACQUISITION_CM0P == 0)
 static cyhal_spi_t spi_obj;
-static xensiv_bgt60trxx_mtb_t bgt60_obj;
-static uint16_t bgt60_buffer[NUM_SAMPLES_PER_FRAME] __attribute__((aligned(2)));
-static float32_t frame[NUM_SAMPLES_PER_FRAME];
-static float32_t avg_chirp[NUM_SAMPLES_PER_CHIRP];
+/* Buffers of the frame, grouped and aligned by HOT_PATH_BUFFER; the word
+ * alignment is needed for the de-interleaving of several antennas
+ */
+static uint16_t bgt60_buffer[RADAR_NUM_SENSORS][NUM_SAMPLES_PER_FRAME] HOT_PATH_BUFFER;
+#else
+/* Frames of the CM0+ core, in RAM both cores access */
+static frame_ring_t frame_ring;
+static uint16_t frame_ring_samples[FRAME_RING_SLOTS * NUM_SAMPLES_PER_FRAME] HOT_PATH_BUFFER;
+#endif
+/* One plane per antenna, the presence library uses the first one */
+static float32_t frame[NUM_SAMPLES_PER_FRAME] HOT_PATH_BUFFER;
+static range_sample_t avg_chirp[NUM_SAMPLES_PER_CHUNK] HOT_PATH_BUFFER;
+#if (NUM_RX_ANTENNAS > 1)
+static q15_t rx_planes[NUM_SAMPLES_PER_CHUNK] HOT_PATH_BUFFER;
+#endif
+static hot_path_stats_t hot_path_stats;
+static overload_governor_t governor;
+static frame_preprocess_t preprocess;
+static frame_sequence_t sequence;
+#if (RADAR_ACQUISITION_CM0P == 0)
+static cyhal_timer_t stamp_timer;
+
+/* Acquisition of one sensor, the frames of the first one are 'frame' and
+ * 'avg_chirp' and go through the whole processing
+ */
+typedef struct
+{
+    uint32_t id;
+    xensiv_bgt60trxx_mtb_t bgt60_obj;
+    uint16_t* buffer;
+    frame_preprocess_t* preprocess;
+    frame_sequence_t* sequence;
+    uint32_t block_stamp_us;
+    uint32_t frame_stamp_us;
+    uint32_t frame_cycles;
+    uint32_t last_block_ms;             /* FIFO data seen, for the stall detection */
+} sensor_t;
+
+static const radar_sensor_pins_t sensor_pins[RADAR_SENSOR_MAX_SENSORS] = RADAR_SENSOR_PINS;
+static sensor_t sensors[RADAR_NUM_SENSORS];
+static radar_sensor_frame_t pending_frames[RADAR_NUM_SENSORS];
+#endif
+#if (RADAR_NUM_SENSORS > 1)
+/* Further sensors: their frames only go through the presence library */
+typedef struct
+{
+    frame_preprocess_t preprocess;
+    frame_sequence_t sequence;
+    xensiv_radar_presence_handle_t handle;
+    xensiv_radar_presence_config_t config;
+} secondary_sensor_t;
+
+static secondary_sensor_t secondary_sensors[RADAR_NUM_SENSORS - 1];
+static float32_t secondary_frames[RADAR_NUM_SENSORS - 1][NUM_SAMPLES_PER_FRAME] HOT_PATH_BUFFER;
+static range_sample_t secondary_avg_chirps[RADAR_NUM_SENSORS - 1][NUM_SAMPLES_PER_CHUNK];
+#if (NUM_RX_ANTENNAS > 1)
+static q15_t secondary_rx_planes[RADAR_NUM_SENSORS - 1][NUM_SAMPLES_PER_CHUNK];
+#endif
+#endif
+static radar_sensor_stats_t sensor_stats[RADAR_NUM_SENSORS];
+#if (RANGE_FFT_ENABLED != 0)
+static range_fft_t range_fft HOT_PATH_BUFFER;
+/* Range profile of the last processed frame */
+static const range_profile_t* range_profile = NULL;
+#endif
+#if (MICRO_SDFT_ENABLED != 0)
+static micro_sdft_t micro_sdft;
+#endif
+#if (TARGET_DETECT_ENABLED != 0)
+static target_detect_t target_detect;
+#endif
+#if (TARGET_TRACKER_ENABLED != 0)
+static target_tracker_t target_tracker;
+/* Written by radar_config_task */
+static volatile uint32_t track_report_interval_ms = TARGET_TRACKER_REPORT_INTERVAL_MS;
+#endif
+#if (ZONE_ENGINE_ENABLED != 0)
+/* Configured by radar_config_task under sem_radar_sensing_context */
+static zone_engine_t zone_engine;
+#endif
+#if (THRESHOLD_CALIB_ENABLED != 0)
+/* Started by radar_config_task under sem_radar_sensing_context */
+static threshold_calib_t threshold_calib;
+#endif
+#if (SHADOW_PRESENCE_ENABLED != 0)
+/* Thresholds set by radar_config_task under sem_radar_sensing_context */
+static shadow_presence_t shadow_presence;
+static float32_t shadow_frame[NUM_SAMPLES_PER_CHIRP];
+#endif
+#if RANGE_DOPPLER_ACTIVE
+static range_doppler_t range_doppler;
+static float32_t range_doppler_map[RANGE_DOPPLER_MAP_SIZE(NUM_SAMPLES_PER_CHIRP, NUM_CHIRPS_PER_FRAME)];
+#endif
+#if ANGLE_ESTIMATE_ACTIVE
+/* Range processing of the antennas after the first one */
+static range_fft_t rx_range_fft[ANGLE_ESTIMATE_NUM_ANTENNAS - 1u];
+static angle_estimate_t angle_estimate;
+static zone_occupancy_t zone_occupancy;
+
+/* Zones observed by the sensor, see configs/zone_config.h */
+static const zone_t zones[] = ZONE_CONFIG_ZONES;
+#endif
+
+/* The register list of the other profiles is exported along with their
+ * radar_settings header, see RADAR_PROFILE_3RX and RADAR_PROFILE_DOPPLER
+ */
+#if (RADAR_PROFILE_3RX == 0) && (RADAR_PROFILE_DOPPLER == 0)
 
 uint32_t register_list[] = { 
     0x11e8270UL, 
@@ -129,23 +346,28 @@ uint32_t register_list[] = {
     0xad000000UL, 
     0xb7000000UL
 };
+#endif
 
 /*******************************************************************************
  * Function Prototypes
  ******************************************************************************/
 static int32_t init_sensor(void);
+#if (RADAR_ACQUISITION_CM0P == 0)
 static void xensiv_bgt60trxx_interrupt_handler(void* args, cyhal_gpio_event_t event);
+#endif
 
+#if (RADAR_ACQUISITION_CM0P == 0)
 /*******************************************************************************
 * Function Name: xensiv_bgt60trxx_interrupt_handler
 ********************************************************************************
 * Summary:
 * This is the interrupt handler to react on sensor indicating the availability 
 * of new data
-*    1. Notifies main task on interrupt from sensor
+*    1. Records the interrupt timestamp
+*    2. Notifies main task on interrupt from sensor
 *
 * Parameters:
-*  void
+*  args: sensor that raised the interrupt
 *
 * Return:
 *  none
@@ -157,9 +379,35 @@ static void xensiv_bgt60trxx_interrupt_handler(void *args, cyhal_gpio_event_t ev
 static void xensiv_bgt60trxx_interrupt_handler(void *args, cyhal_gpio_irq_event_t event)
 #endif
 {
-    CY_UNUSED_PARAMETER(args);
     CY_UNUSED_PARAMETER(event);
 
+    sensor_t* sensor = (sensor_t*)args;
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    frame_sequence_irq(sensor->sequence, cyhal_timer_read(&stamp_timer));
+
+    vTaskNotifyGiveFromISR(radar_task_handle, &xHigherPriorityTaskWoken);
+
+    /* Context switch needed? */
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+#else
+/*******************************************************************************
+* Function Name: frame_ring_doorbell
+********************************************************************************
+* Summary:
+* This is the doorbell of the CM0+ core, rung for each frame it published
+* in the frame ring. Notifies main task.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  none
+*
+*******************************************************************************/
+static void frame_ring_doorbell(void)
+{
     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
     vTaskNotifyGiveFromISR(radar_task_handle, &xHigherPriorityTaskWoken);
@@ -167,6 +415,7 @@ static void xensiv_bgt60trxx_interrupt_handler(void *args, cyhal_gpio_irq_event_
     /* Context switch needed? */
     portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 }
+#endif
 
 /*******************************************************************************
 * Function Name: init_leds
@@ -205,12 +454,52 @@ static int32_t init_leds(void)
 }
 
 
+#if (RADAR_ACQUISITION_CM0P == 0)
+/*******************************************************************************
+* Function Name: init_stamp_timer
+********************************************************************************
+* Summary:
+* This function starts a free running 1 MHz timer used to timestamp the sensor
+* interrupts.
+* Parameters:
+*  void
+*
+* Return:
+*  Success or error
+*
+*******************************************************************************/
+static int32_t init_stamp_timer(void)
+{
+    const cyhal_timer_cfg_t timer_cfg =
+    {
+        .compare_value = 0,
+        .period        = 0xFFFFFFFFUL,
+        .direction     = CYHAL_TIMER_DIR_UP,
+        .is_compare    = false,
+        .is_continuous = true,
+        .value         = 0
+    };
+
+    if ((cyhal_timer_init(&stamp_timer, NC, NULL) != CY_RSLT_SUCCESS) ||
+        (cyhal_timer_configure(&stamp_timer, &timer_cfg) != CY_RSLT_SUCCESS) ||
+        (cyhal_timer_set_frequency(&stamp_timer, STAMP_TIMER_FREQUENCY) != CY_RSLT_SUCCESS) ||
+        (cyhal_timer_start(&stamp_timer) != CY_RSLT_SUCCESS))
+    {
+        printf("ERROR: timestamp timer initialization failed\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+
 /*******************************************************************************
 * Function Name: init_sensor
 ********************************************************************************
 * Summary:
-* This function configures the SPI interface, initializes radar and interrupt
-* service routine to indicate the availability of radar data. 
+* This function configures the SPI interface, initializes every radar and
+* the interrupt service routine to indicate the availability of radar data.
+* The sensors share the SPI bus, each one has its own chip select.
 * 
 * Parameters:
 *  void
@@ -261,30 +550,94 @@ static int32_t init_sensor(void)
     /* Wait LDO stable */
     (void)cyhal_system_delay_ms(5);
 
-    if (xensiv_bgt60trxx_mtb_init(&bgt60_obj, 
-                                  &spi_obj, 
-                                  PIN_XENSIV_BGT60TRXX_SPI_CSN, 
-                                  PIN_XENSIV_BGT60TRXX_RSTN, 
-                                  register_list, 
-                                  XENSIV_BGT60TRXX_CONF_NUM_REGS) != CY_RSLT_SUCCESS)
+    if (init_stamp_timer() != 0)
     {
-        printf("ERROR: xensiv_bgt60trxx_mtb_init failed\n");
         return -1;
     }
 
-    if (xensiv_bgt60trxx_mtb_interrupt_init(&bgt60_obj,
-                                            NUM_SAMPLES_PER_FRAME,
-                                            PIN_XENSIV_BGT60TRXX_IRQ,
-                                            GPIO_INTERRUPT_PRIORITY,
-                                            xensiv_bgt60trxx_interrupt_handler,
-                                            NULL) != CY_RSLT_SUCCESS)
+    for (uint32_t id = 0; id < RADAR_NUM_SENSORS; ++id)
+    {
+        sensor_t* sensor = &sensors[id];
+        const radar_sensor_pins_t* pins = &sensor_pins[id];
+
+        sensor->id = id;
+        sensor->buffer = bgt60_buffer[id];
+#if (RADAR_NUM_SENSORS > 1)
+        sensor->preprocess = (id == 0u) ? &preprocess : &secondary_sensors[id - 1u].preprocess;
+        sensor->sequence = (id == 0u) ? &sequence : &secondary_sensors[id - 1u].sequence;
+#else
+        sensor->preprocess = &preprocess;
+        sensor->sequence = &sequence;
+#endif
+
+        if ((pins->csn == NC) || (pins->irq == NC) || (pins->rstn == NC))
+        {
+            printf("ERROR: pins of sensor %" PRIu32 " missing in resource_map.h\n", id);
+            return -1;
+        }
+
+        if (xensiv_bgt60trxx_mtb_init(&sensor->bgt60_obj, 
+                                      &spi_obj, 
+                                      pins->csn, 
+                                      pins->rstn, 
+                                      register_list, 
+                                      XENSIV_BGT60TRXX_CONF_NUM_REGS) != CY_RSLT_SUCCESS)
+        {
+            printf("ERROR: xensiv_bgt60trxx_mtb_init of sensor %" PRIu32 " failed\n", id);
+            return -1;
+        }
+
+        if (xensiv_bgt60trxx_mtb_interrupt_init(&sensor->bgt60_obj,
+                                                NUM_SAMPLES_PER_IRQ,
+                                                pins->irq,
+                                                GPIO_INTERRUPT_PRIORITY,
+                                                xensiv_bgt60trxx_interrupt_handler,
+                                                sensor) != CY_RSLT_SUCCESS)
+        {
+            printf("ERROR: xensiv_bgt60trxx_mtb_interrupt_init of sensor %" PRIu32 " failed\n", id);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+#else
+/*******************************************************************************
+* Function Name: init_sensor
+********************************************************************************
+* Summary:
+* This function sets up the frame ring with the acquisition of this profile
+* and offers it to the CM0+ core, which initializes the radar with it.
+* 
+* Parameters:
+*  void
+*
+* Return:
+*  Success or error 
+*
+*******************************************************************************/
+static int32_t init_sensor(void)
+{
+    static const frame_ring_setup_t setup =
+    {
+        .registers         = register_list,
+        .num_registers     = XENSIV_BGT60TRXX_CONF_NUM_REGS,
+        .samples_per_irq   = NUM_SAMPLES_PER_IRQ,
+        .samples_per_frame = NUM_SAMPLES_PER_FRAME,
+        .irq_period_us     = IRQ_PERIOD_US
+    };
+
+    frame_ring_init(&frame_ring, &setup, frame_ring_samples);
+
+    if (!frame_ring_ipc_offer(&frame_ring, frame_ring_doorbell))
     {
-        printf("ERROR: xensiv_bgt60trxx_mtb_interrupt_init failed\n");
+        printf("ERROR: frame ring offer to the CM0+ core failed\n");
         return -1;
     }
 
     return 0;
 }
+#endif
 
 /*******************************************************************************
 * Function Name: presence_detection_cb
@@ -305,6 +658,23 @@ void presence_detection_cb(xensiv_radar_presence_handle_t handle,
 	(void)data;
     (void)handle;
 
+#if (MICRO_SDFT_ENABLED != 0)
+    xensiv_radar_presence_event_t converted_event;
+
+    /* The sliding DFT decides on micro presence */
+    event = micro_sdft_filter_event(&micro_sdft, event, &converted_event);
+#endif
+#if RANGE_DOPPLER_ACTIVE
+    /* Before the duplicate filter, a repeated presence still takes over */
+    range_doppler_filter_event(&range_doppler, event);
+#endif
+
+    /* Drop repeated states caused by acquisition profile switches */
+    if (!adaptive_rate_filter_event(event))
+    {
+        return;
+    }
+
     publisher_data_t publisher_q_data = {0};
     publisher_q_data.cmd = PUBLISH_RADAR_TELEMETRY;
     int32_t range_bin;
@@ -351,6 +721,74 @@ void presence_detection_cb(xensiv_radar_presence_handle_t handle,
     xQueueSend(publisher_task_q, &publisher_q_data, portMAX_DELAY);
 }
 
+#if (SHADOW_PRESENCE_ENABLED != 0)
+/*******************************************************************************
+* Function Name: shadow_presence_cb
+********************************************************************************
+* Summary:
+* This is the callback function of the shadow presence detector. Its events
+* only go to the diagnostics, never to the LEDs or the presence telemetry.
+* Parameters:
+*  event: shadow presence event
+*  data: unused
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void shadow_presence_cb(const xensiv_radar_presence_event_t* event, void* data)
+{
+    publisher_data_t publisher_q_data = {0};
+
+    (void)data;
+
+    publisher_q_data.cmd = PUBLISH_RADAR_SHADOW_EVENT;
+    publisher_q_data.event = event->state;
+    publisher_q_data.distance = (event->state == XENSIV_RADAR_PRESENCE_STATE_ABSENCE) ? 0.0f : (event->range_bin * Bin_len);
+    publisher_q_data.macro_threshold = shadow_presence.config.macro_threshold;
+    publisher_q_data.micro_threshold = shadow_presence.config.micro_threshold;
+    publisher_q_data.dropped_frames = shadow_presence.stats.skipped_frames;
+    publisher_q_data.frame_count = shadow_presence.stats.frames;
+
+    /* Diagnostics must not block the acquisition */
+    xQueueSend(publisher_task_q, &publisher_q_data, 0);
+}
+#endif
+
+/*******************************************************************************
+* Function Name: overload_event_cb
+********************************************************************************
+* Summary:
+* This is the callback function of the overload governor. It is called on every
+* degradation step change and reports it on terminal and to the cloud.
+* Parameters:
+*  old_level: previous governor level
+*  new_level: new governor level
+*  load_permille: processing load that caused the change
+*  data: unused
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void overload_event_cb(overload_level_t old_level, overload_level_t new_level,
+                              uint32_t load_permille, void* data)
+{
+    (void)data;
+
+    publisher_data_t publisher_q_data = {0};
+
+    printf("[WARN] processing overload level %d -> %d, load %" PRIu32 " permille, max %" PRIu32 " us\n",
+           (int)old_level, (int)new_level, load_permille, governor.max_processing_us);
+
+    publisher_q_data.cmd = PUBLISH_RADAR_OVERLOAD_EVENT;
+    publisher_q_data.overload_level = (uint8_t)new_level;
+    publisher_q_data.overload_load_permille = load_permille;
+
+    /* Diagnostics must not block the acquisition */
+    xQueueSend(publisher_task_q, &publisher_q_data, 0);
+}
+
 /*******************************************************************************
  * Function Name: ifx_currenttime
  *******************************************************************************
@@ -369,153 +807,1573 @@ static uint64_t ifx_currenttime()
 }
 
 /*******************************************************************************
- * Function Name: radar_task
+ * Function Name: report_frame_stats
  *******************************************************************************
  * Summary:
- *   Initializes GPIO ports, context object of RadarSensing for presence
- *   detection, then initializes radar device configuration,
- *   sets parameters for presence detection, registers
- *   callback to handle presence detection and
- *   continuously processes data acquired from radar.
+ *   Publishes the frame sequence counters of a sensor when they changed
+ *   since its last report, at most once per FRAME_STATS_REPORT_INTERVAL_MS
+ *   unless forced.
  *
  * Parameters:
- *   pvParameters: thread
+ *   sensor: sensor of the counters
+ *   stats: frame sequence counters
+ *   time_ms: current time in ms
+ *   force: report without waiting for the interval
  *
  * Return:
  *   none
  ******************************************************************************/
-void radar_task(void *pvParameters)
+static void report_frame_stats(uint32_t sensor, const frame_sequence_stats_t* stats, uint32_t time_ms, bool force)
 {
-    (void)pvParameters;
-
-    xensiv_radar_presence_handle_t handle;
-
-    static const xensiv_radar_presence_config_t default_config =
-	{
-		.bandwidth                         = 460E6,
-		.num_samples_per_chirp             = XENSIV_BGT60TRXX_CONF_NUM_SAMPLES_PER_CHIRP,
-		.micro_fft_decimation_enabled      = false,
-		.micro_fft_size                    = 128,
-		.macro_threshold                   = 0.5f,
-		.micro_threshold                   = 12.5f,
-		.min_range_bin                     = 1,
-		.max_range_bin                     = 5,
-		.macro_compare_interval_ms         = 250,
-		.macro_movement_validity_ms        = 1000,
-		.micro_movement_validity_ms        = 4000,
-		.macro_movement_confirmations      = 0,
-		.macro_trigger_range               = 1,
-		.mode                              = XENSIV_RADAR_PRESENCE_MODE_MICRO_IF_MACRO,
-		.macro_fft_bandpass_filter_enabled = false,
-		.micro_movement_compare_idx       = 5
-	};
-
+    static frame_sequence_stats_t reported[RADAR_NUM_SENSORS];
+    static uint32_t report_time_ms[RADAR_NUM_SENSORS];
+    publisher_data_t publisher_q_data = {0};
 
-    /* Init the sensor */
-    if (init_sensor() != 0)
+    if ((stats->dropped_frames == reported[sensor].dropped_frames) &&
+        (stats->late_frames == reported[sensor].late_frames) &&
+        (stats->recoveries == reported[sensor].recoveries))
     {
-        CY_ASSERT(0);
+        return;
     }
 
-    if (init_leds () != 0)
+    if (!force && ((time_ms - report_time_ms[sensor]) < FRAME_STATS_REPORT_INTERVAL_MS))
     {
-        CY_ASSERT(0);
+        return;
     }
 
-    xensiv_radar_presence_set_malloc_free(pvPortMalloc,
-                                          vPortFree);
+    reported[sensor] = *stats;
+    report_time_ms[sensor] = time_ms;
 
-    if (xensiv_radar_presence_alloc(&handle, &default_config) != 0)
-    {
-        CY_ASSERT(0);
-    }
+    publisher_q_data.cmd = PUBLISH_RADAR_FRAME_STATS;
+    publisher_q_data.sensor = (uint8_t)sensor;
+    publisher_q_data.frame_count = stats->frames;
+    publisher_q_data.dropped_frames = stats->dropped_frames;
+    publisher_q_data.late_frames = stats->late_frames;
+    publisher_q_data.fifo_overflows = stats->fifo_overflows;
+    publisher_q_data.recoveries = stats->recoveries;
 
-    Bin_len = xensiv_radar_presence_get_bin_length(handle);
+    /* Diagnostics must not block the acquisition */
+    xQueueSend(publisher_task_q, &publisher_q_data, 0);
+}
 
-    xensiv_radar_presence_set_callback(handle, presence_detection_cb, NULL);
+#if (TARGET_DETECT_ENABLED != 0)
+/*******************************************************************************
+ * Function Name: report_targets
+ *******************************************************************************
+ * Summary:
+ *   Publishes the target list when the number of targets or their range bins
+ *   changed since the last report, at most once per
+ *   TARGET_REPORT_INTERVAL_MS.
+ *
+ * Parameters:
+ *   list: target list of the last frame
+ *   time_ms: current time in ms
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void report_targets(const target_list_t* list, uint32_t time_ms)
+{
+    static uint32_t reported_bins[TARGET_DETECT_MAX_TARGETS];
+    static uint32_t reported_count;
+    static uint32_t report_time_ms;
+    publisher_data_t publisher_q_data = {0};
+    bool changed = (list->count != reported_count);
 
-    /* Initiate semaphore mutex to protect 'radar_sensing_context' */
-    sem_radar_sensing_context = xSemaphoreCreateMutex();
-    if (sem_radar_sensing_context == NULL)
+    for (uint32_t i = 0; (i < list->count) && !changed; ++i)
     {
-        printf(" 'sem_radar_sensing_context' semaphore creation failed... Task suspend\n\n");
-        vTaskSuspend(NULL);
+        changed = (list->targets[i].range_bin != reported_bins[i]);
     }
 
-    /**
-     * Create task for radar configuration. Configuration parameters come from
-     * Subscriber task. Subscribed topics are configured inside 'mqtt_client_config.c'.
-     */
-    if (pdPASS != xTaskCreate(radar_config_task,
-                              RADAR_CONFIG_TASK_NAME,
-                              RADAR_CONFIG_TASK_STACK_SIZE,
-							  handle,
-                              RADAR_CONFIG_TASK_PRIORITY,
-                              &radar_config_task_handle))
+    if (!changed || ((time_ms - report_time_ms) < TARGET_REPORT_INTERVAL_MS))
     {
-        printf("Failed to create Radar config task!\n");
-        CY_ASSERT(0);
+        return;
     }
 
-    cyhal_gpio_write(CYBSP_USER_LED, false); /* USER_LED is active low */
+    report_time_ms = time_ms;
+    reported_count = list->count;
 
-    if (xensiv_bgt60trxx_start_frame(&bgt60_obj.dev, true) != XENSIV_BGT60TRXX_STATUS_OK)
+    publisher_q_data.cmd = PUBLISH_RADAR_TARGETS;
+    publisher_q_data.target_count = (uint8_t)list->count;
+    for (uint32_t i = 0; i < list->count; ++i)
     {
-        CY_ASSERT(0);
+        reported_bins[i] = list->targets[i].range_bin;
+        publisher_q_data.target_distance[i] = list->targets[i].distance;
+        publisher_q_data.target_azimuth[i] = list->targets[i].azimuth;
     }
+#if ANGLE_ESTIMATE_ACTIVE
+    publisher_q_data.target_angles = true;
+#endif
 
-    //printf("Presence application running \n\n");
+    /* Diagnostics must not block the acquisition */
+    xQueueSend(publisher_task_q, &publisher_q_data, 0);
+}
+#endif
 
-    for (;;)
-    {
-        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+#if (TARGET_TRACKER_ENABLED != 0)
+/*******************************************************************************
+ * Function Name: report_tracks
+ *******************************************************************************
+ * Summary:
+ *   Publishes the confirmed tracks every track_report_interval_ms. Nothing is
+ *   published while there are no tracks, except one empty report after the
+ *   last track was lost.
+ *
+ * Parameters:
+ *   time_ms: current time in ms
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void report_tracks(uint32_t time_ms)
+{
+    static uint32_t reported_count;
+    static uint32_t report_time_ms;
+    publisher_data_t publisher_q_data = {0};
+    uint32_t count;
+
+    if ((time_ms - report_time_ms) < track_report_interval_ms)
+    {
+        return;
+    }
+
+    count = target_tracker_get_confirmed(&target_tracker, publisher_q_data.tracks, TARGET_TRACKER_MAX_TRACKS);
+    if ((count == 0u) && (reported_count == 0u))
+    {
+        return;
+    }
+
+    report_time_ms = time_ms;
+    reported_count = count;
+
+    publisher_q_data.cmd = PUBLISH_RADAR_TRACKS;
+    publisher_q_data.track_count = (uint8_t)count;
+
+    /* Diagnostics must not block the acquisition */
+    xQueueSend(publisher_task_q, &publisher_q_data, 0);
+}
+#endif
+
+#if RANGE_DOPPLER_ACTIVE
+/*******************************************************************************
+ * Function Name: report_motion
+ *******************************************************************************
+ * Summary:
+ *   Publishes the motion class of the frame when it changed between static
+ *   and walking, at most once per TARGET_REPORT_INTERVAL_MS.
+ *
+ * Parameters:
+ *   result: range-Doppler result of the last frame
+ *   time_ms: current time in ms
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void report_motion(const range_doppler_result_t* result, uint32_t time_ms)
+{
+    static bool reported_walking;
+    static uint32_t report_time_ms;
+    publisher_data_t publisher_q_data = {0};
+
+    if ((result->walking == reported_walking) || ((time_ms - report_time_ms) < TARGET_REPORT_INTERVAL_MS))
+    {
+        return;
+    }
+
+    report_time_ms = time_ms;
+    reported_walking = result->walking;
+
+    publisher_q_data.cmd = PUBLISH_RADAR_MOTION;
+    publisher_q_data.walking = result->walking;
+    publisher_q_data.velocity = result->velocity;
+    publisher_q_data.distance = (float)result->range_bin * Bin_len;
+
+    /* Diagnostics must not block the acquisition */
+    xQueueSend(publisher_task_q, &publisher_q_data, 0);
+}
+#endif
+
+#if (ZONE_ENGINE_ENABLED != 0)
+/*******************************************************************************
+ * Function Name: report_zone_events
+ *******************************************************************************
+ * Summary:
+ *   Publishes the state changes of the presence zones.
+ *
+ * Parameters:
+ *   events: state changes of the frame
+ *   count: number of events
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void report_zone_events(const zone_event_t* events, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        publisher_data_t publisher_q_data = {0};
+
+        publisher_q_data.cmd = PUBLISH_RADAR_ZONE_EVENT;
+        publisher_q_data.zone_id = events[i].zone_id;
+        publisher_q_data.zone_state = events[i].state;
+        publisher_q_data.distance = (float)events[i].range_bin * Bin_len;
+
+        xQueueSend(publisher_task_q, &publisher_q_data, portMAX_DELAY);
+    }
+}
+#endif
+
+#if ANGLE_ESTIMATE_ACTIVE
+/*******************************************************************************
+ * Function Name: report_zones
+ *******************************************************************************
+ * Summary:
+ *   Publishes the occupied zones after a change.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void report_zones(void)
+{
+    publisher_data_t publisher_q_data = {0};
+
+    publisher_q_data.cmd = PUBLISH_RADAR_ZONES;
+    publisher_q_data.zone_mask = zone_occupancy.occupied;
+
+    /* Diagnostics must not block the acquisition */
+    xQueueSend(publisher_task_q, &publisher_q_data, 0);
+}
+#endif
+
+#if (THRESHOLD_CALIB_ENABLED != 0)
+/*******************************************************************************
+ * Function Name: calibrate_thresholds
+ *******************************************************************************
+ * Summary:
+ *   Runs the learning window of the threshold calibration. The window keeps
+ *   the full frame rate and forces the micro and macro mode so both metrics
+ *   are computed in every frame. The user configuration is not touched, at
+ *   the end the library returns to the current user mode, including a mode
+ *   changed during the window, with the calibrated thresholds if they are
+ *   applied. Called between two frames with sem_radar_sensing_context taken.
+ *
+ * Parameters:
+ *   handle: presence library handle
+ *   time_ms: time of the frame
+ *
+ * Return:
+ *   true if the window ended, see report_calibration
+ ******************************************************************************/
+static bool calibrate_thresholds(xensiv_radar_presence_handle_t handle, uint32_t time_ms)
+{
+    static bool active = false;
+    xensiv_radar_presence_config_t config;
+    float32_t macro = 0.0f;
+    float32_t micro = 0.0f;
+    int32_t index;
+
+    if (!threshold_calib_learning(&threshold_calib))
+    {
+        return false;
+    }
+
+    if (!active)
+    {
+        active = true;
+        adaptive_rate_hold_full(handle, true);
+        adaptive_rate_force_mode(handle, true, XENSIV_RADAR_PRESENCE_MODE_MICRO_AND_MACRO);
+        return false;
+    }
+
+    (void)xensiv_radar_presence_get_max_macro(handle, &macro, &index);
+    (void)xensiv_radar_presence_get_max_micro(handle, &micro, &index);
+    if (!threshold_calib_update(&threshold_calib, macro, micro, time_ms))
+    {
+        return false;
+    }
+
+    if (threshold_calib.state == THRESHOLD_CALIB_APPLIED)
+    {
+        (void)adaptive_rate_get_config(handle, &config);
+        config.macro_threshold = threshold_calib.macro_threshold;
+        config.micro_threshold = threshold_calib.micro_threshold;
+        (void)adaptive_rate_set_config(handle, &config);
+    }
+    adaptive_rate_force_mode(handle, false, XENSIV_RADAR_PRESENCE_MODE_MICRO_AND_MACRO);
+    adaptive_rate_hold_full(handle, false);
+    active = false;
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: report_calibration
+ *******************************************************************************
+ * Summary:
+ *   Publishes the result of the threshold calibration.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void report_calibration(void)
+{
+    publisher_data_t publisher_q_data = {0};
+
+    publisher_q_data.cmd = PUBLISH_RADAR_CALIBRATION;
+    publisher_q_data.calibration_state = threshold_calib.state;
+    publisher_q_data.macro_threshold = threshold_calib.macro_threshold;
+    publisher_q_data.micro_threshold = threshold_calib.micro_threshold;
+
+    xQueueSend(publisher_task_q, &publisher_q_data, portMAX_DELAY);
+}
+#endif
+
+/*******************************************************************************
+ * Function Name: load_config
+ *******************************************************************************
+ * Summary:
+ *   Replaces the default configuration by the stored one, so that the
+ *   detection uses the tuned values from the first frame instead of waiting
+ *   for the device shadow. A record of another acquisition profile is not
+ *   used.
+ *
+ * Parameters:
+ *   config: default configuration, replaced by the stored one
+ *
+ * Return:
+ *   true if the stored configuration was loaded
+ ******************************************************************************/
+static bool load_config(xensiv_radar_presence_config_t* config)
+{
+#if (CONFIG_STORE_ENABLED != 0)
+    xensiv_radar_presence_config_t stored;
+
+    config_store_init(&config_store, CONFIG_STORE_BACKEND);
+    if (!config_store_load(&config_store, &stored))
+    {
+        return false;
+    }
+
+    if ((stored.num_samples_per_chirp != config->num_samples_per_chirp) || (stored.bandwidth != config->bandwidth))
+    {
+        printf("[WARN] stored configuration of another acquisition profile ignored\n");
+        return false;
+    }
+
+    *config = stored;
+    return true;
+#else
+    (void)config;
+    return false;
+#endif
+}
+
+/*******************************************************************************
+ * Function Name: report_stored_config
+ *******************************************************************************
+ * Summary:
+ *   Hands the stored configuration to the publisher so the reported state
+ *   matches the detection before the device shadow is received.
+ *
+ * Parameters:
+ *   config: configuration loaded at boot
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void report_stored_config(const xensiv_radar_presence_config_t* config)
+{
+    publisher_data_t publisher_q_data = {0};
+
+    publisher_q_data.cmd = UPDATE_RADAR_STORED_CONFIG;
+    publisher_q_data.max_range = (float)config->max_range_bin * Bin_len;
+    publisher_q_data.macro_threshold = config->macro_threshold;
+    publisher_q_data.micro_threshold = config->micro_threshold;
+    publisher_q_data.mode = (char)config->mode;
+
+    xQueueSend(publisher_task_q, &publisher_q_data, portMAX_DELAY);
+}
+
+#if (WARM_START_ENABLED != 0)
+/*******************************************************************************
+ * Function Name: restore_snapshot
+ *******************************************************************************
+ * Summary:
+ *   Restores the detection state written by radar_task_shutdown if it was
+ *   learned with the configuration in use. The static clutter estimate
+ *   keeps a person present at boot from being taken as clutter, and the
+ *   presence state is not reported again, see adaptive_rate_restore_state.
+ *   The presence library itself always starts cold.
+ *
+ * Parameters:
+ *   handle: presence library handle
+ *   config: configuration in use
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void restore_snapshot(xensiv_radar_presence_handle_t handle, const xensiv_radar_presence_config_t* config)
+{
+    static warm_start_snapshot_t snapshot;
+    uint32_t start_cycles = cycle_counter_get();
+    uint32_t time_s = (uint32_t)time(NULL);
+    xensiv_radar_presence_state_t state;
+
+    if (!warm_start_init() || !warm_start_load(&snapshot, time_s))
+    {
+        return;
+    }
+
+    if ((snapshot.num_samples_per_chirp != config->num_samples_per_chirp) ||
+        (snapshot.min_range_bin != config->min_range_bin) || (snapshot.max_range_bin != config->max_range_bin))
+    {
+        printf("[WARN] warm start: snapshot of another configuration ignored\n");
+        return;
+    }
+
+#if (RANGE_FFT_ENABLED != 0)
+    (void)range_fft_set_clutter(&range_fft, snapshot.clutter, snapshot.clutter_bins);
+#endif
+    state = (xensiv_radar_presence_state_t)snapshot.presence_state;
+    adaptive_rate_restore_state(handle, state, (uint32_t)ifx_currenttime());
+
+    printf("[INFO] warm start: state %" PRIu32 " clutter %" PRIu32 " bins, %" PRIu32 " s old, restored in %" PRIu32
+           " us\n", snapshot.presence_state, snapshot.clutter_bins, time_s - snapshot.saved_s,
+           cycle_counter_to_us(cycle_counter_elapsed(start_cycles)));
+}
+
+/*******************************************************************************
+ * Function Name: save_snapshot
+ *******************************************************************************
+ * Summary:
+ *   Writes the detection state for the next boot, called with
+ *   sem_radar_sensing_context taken.
+ *
+ * Parameters:
+ *   handle: presence library handle
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void save_snapshot(xensiv_radar_presence_handle_t handle)
+{
+    static warm_start_snapshot_t snapshot;
+    xensiv_radar_presence_config_t config;
+    uint32_t start_cycles = cycle_counter_get();
+    bool result;
+
+    memset(&snapshot, 0, sizeof(snapshot));
+    (void)adaptive_rate_get_config(handle, &config);
+    snapshot.num_samples_per_chirp = config.num_samples_per_chirp;
+    snapshot.min_range_bin = config.min_range_bin;
+    snapshot.max_range_bin = config.max_range_bin;
+    snapshot.presence_state = (uint32_t)adaptive_rate_get_state();
+#if (RANGE_FFT_ENABLED != 0)
+    snapshot.clutter_bins = range_fft_get_clutter(&range_fft, snapshot.clutter);
+#endif
+
+    result = warm_start_save(&snapshot, (uint32_t)time(NULL));
+
+    printf("[%s] warm start: snapshot of %u bytes %s in %" PRIu32 " us\n", result ? "INFO" : "WARN",
+           (unsigned int)sizeof(snapshot), result ? "written" : "not written",
+           cycle_counter_to_us(cycle_counter_elapsed(start_cycles)));
+}
+#endif
+
+#if (RADAR_ACQUISITION_CM0P == 0)
+/*******************************************************************************
+ * Function Name: read_frame_counter
+ *******************************************************************************
+ * Summary:
+ *   Reads the number of frames started by a sensor.
+ *
+ * Parameters:
+ *   sensor: sensor
+ *   counter: FRAME_CNT field of the STAT1 register
+ *
+ * Return:
+ *   true on success
+ ******************************************************************************/
+static bool read_frame_counter(const sensor_t* sensor, uint32_t* counter)
+{
+    uint32_t stat1;
+
+    if (xensiv_bgt60trxx_get_reg(&sensor->bgt60_obj.dev, XENSIV_BGT60TRXX_REG_STAT1, &stat1) != XENSIV_BGT60TRXX_STATUS_OK)
+    {
+        return false;
+    }
+
+    *counter = (stat1 & XENSIV_BGT60TRXX_REG_STAT1_FRAME_CNT_MSK) >> XENSIV_BGT60TRXX_REG_STAT1_FRAME_CNT_POS;
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: restart_acquisition
+ *******************************************************************************
+ * Summary:
+ *   Recovers the acquisition of a sensor after a FIFO overflow or error
+ *   without a new sensor initialization: frame generation is stopped, the
+ *   FIFO is flushed and frame generation is restarted. All frames not read
+ *   so far are accounted as dropped.
+ *
+ * Parameters:
+ *   sensor: sensor
+ *   overflow: the FIFO overflowed
+ *   reason: printed on terminal
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void restart_acquisition(sensor_t* sensor, bool overflow, const char* reason)
+{
+    frame_sequence_t* seq = sensor->sequence;
+    uint32_t counter = seq->last_counter;
+    uint32_t lost;
+
+    (void)read_frame_counter(sensor, &counter);
+    lost = frame_sequence_drop(seq, counter, overflow);
+
+    xensiv_bgt60trxx_start_frame(&sensor->bgt60_obj.dev, false);
+    if (xensiv_bgt60trxx_soft_reset(&sensor->bgt60_obj.dev, XENSIV_BGT60TRXX_RESET_FIFO) != XENSIV_BGT60TRXX_STATUS_OK)
+    {
+        printf("[WARN] sensor %" PRIu32 ": FIFO reset failed\n", sensor->id);
+    }
+
+    /* Interrupts of flushed data are dropped, the FIFO status of the other
+     * sensors is read again before the task waits
+     */
+    (void)ulTaskNotifyTake(pdTRUE, 0);
+    frame_sequence_restart(seq);
+    frame_preprocess_start(sensor->preprocess);
+    ++seq->stats.recoveries;
+
+    if (xensiv_bgt60trxx_start_frame(&sensor->bgt60_obj.dev, true) != XENSIV_BGT60TRXX_STATUS_OK)
+    {
+        printf("[WARN] sensor %" PRIu32 ": restarting the frame after FIFO flush failed\n", sensor->id);
+    }
+
+    printf("[WARN] sensor %" PRIu32 ": %s, FIFO flushed, %" PRIu32 " frames dropped\n", sensor->id, reason, lost);
+    report_frame_stats(sensor->id, &seq->stats, (uint32_t)ifx_currenttime(), true);
+}
+
+/*******************************************************************************
+ * Function Name: read_block
+ *******************************************************************************
+ * Summary:
+ *   Reads the next block of a sensor from its FIFO and preprocesses it. The
+ *   FIFO fill status decides whether data is available, so interrupts
+ *   coalesced by the task notification or data that did not raise an
+ *   interrupt are not lost, and stale notifications are ignored. In
+ *   streaming mode every block is one chirp which is preprocessed right
+ *   away, so only the last chirp is left to be handled at the end of the
+ *   frame. A FIFO overflow or error, or no data for FRAME_STALL_PERIODS
+ *   frame periods, restarts the acquisition.
+ *
+ * Parameters:
+ *   sensor: sensor
+ *   pending: set when the frame is complete
+ *
+ * Return:
+ *   true if a block was read or the acquisition was restarted
+ ******************************************************************************/
+static bool read_block(sensor_t* sensor, radar_sensor_frame_t* pending)
+{
+    frame_preprocess_t* preprocess = sensor->preprocess;
+    uint16_t* block = &sensor->buffer[NUM_SAMPLES_PER_IRQ * preprocess->chirps_done];
+    uint32_t now_ms = (uint32_t)ifx_currenttime();
+    uint32_t fstat;
+    uint32_t fill_samples;
+    uint32_t backlog_frames;
+    uint32_t counter;
+    uint32_t latency_us;
+    uint32_t start_cycles;
+    bool frame_ready;
+
+    if (xensiv_bgt60trxx_get_reg(&sensor->bgt60_obj.dev, XENSIV_BGT60TRXX_REG_FSTAT, &fstat) != XENSIV_BGT60TRXX_STATUS_OK)
+    {
+        restart_acquisition(sensor, false, "FIFO status read failed");
+        return true;
+    }
+
+    if ((fstat & XENSIV_BGT60TRXX_REG_FSTAT_FOF_ERR_MSK) != 0u)
+    {
+        restart_acquisition(sensor, true, "FIFO overflow");
+        return true;
+    }
+
+    fill_samples = FIFO_FILL_SAMPLES(fstat);
+    if (fill_samples < NUM_SAMPLES_PER_IRQ)
+    {
+        if ((now_ms - sensor->last_block_ms) >= (FRAME_STALL_PERIODS * FRAME_PERIOD_MS))
+        {
+            restart_acquisition(sensor, false, "no FIFO interrupt");
+            sensor->last_block_ms = now_ms;
+            return true;
+        }
+        return false;
+    }
+    sensor->last_block_ms = now_ms;
+
+    /* Data that was already waiting did not raise an interrupt */
+    if (!frame_sequence_next_stamp(sensor->sequence, &sensor->block_stamp_us))
+    {
+        sensor->block_stamp_us += IRQ_PERIOD_US;
+    }
+
+    if (preprocess->chirps_done == 0u)
+    {
+        sensor->frame_stamp_us = sensor->block_stamp_us;
+        sensor->frame_cycles = 0;
+    }
+
+    if (xensiv_bgt60trxx_get_fifo_data(&sensor->bgt60_obj.dev, block, NUM_SAMPLES_PER_IRQ) != XENSIV_BGT60TRXX_STATUS_OK)
+    {
+        restart_acquisition(sensor, false, "FIFO read failed");
+        return true;
+    }
+    latency_us = cyhal_timer_read(&stamp_timer) - sensor->block_stamp_us;
+
+    start_cycles = cycle_counter_get();
+#if (RADAR_STREAMING_MODE != 0)
+    frame_ready = frame_preprocess_add_chunk(preprocess, block);
+#else
+    frame_preprocess_whole(preprocess, block);
+    frame_ready = true;
+#endif
+    sensor->frame_cycles += cycle_counter_elapsed(start_cycles);
+
+    if (!frame_ready)
+    {
+        return true;
+    }
+
+    if (!read_frame_counter(sensor, &counter))
+    {
+        restart_acquisition(sensor, false, "frame counter read failed");
+        return true;
+    }
+
+    /* A following frame completed before this one was read */
+    backlog_frames = (fill_samples - NUM_SAMPLES_PER_IRQ) / NUM_SAMPLES_PER_FRAME;
+    (void)frame_sequence_frame(sensor->sequence, counter, backlog_frames, (backlog_frames > 0u), latency_us);
+
+    pending->stamp_us = sensor->frame_stamp_us;
+    pending->ready_us = cyhal_timer_read(&stamp_timer);
+    pending->time_ms = frame_sequence_time_ms(sensor->sequence, sensor->frame_stamp_us);
+    pending->preprocess_cycles = sensor->frame_cycles;
+    pending->ready = true;
+    frame_preprocess_start(preprocess);
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: acquire_frame
+ *******************************************************************************
+ * Summary:
+ *   Reads the FIFO of every sensor without a complete frame and returns the
+ *   complete frame with the oldest interrupt timestamp, so the sensors are
+ *   served in the order their frames were acquired. A sensor keeps its
+ *   complete frame in its preprocessing buffers until it is returned; its
+ *   FIFO holds the following data meanwhile. The task waits for a sensor
+ *   interrupt only when no FIFO had data.
+ *
+ * Parameters:
+ *   sensor_id: sensor of the frame
+ *   time_ms: acquisition time of the frame, from the interrupt timestamp
+ *   preprocess_cycles: cycles spent in preprocessing
+ *   wait_us: time the complete frame waited to be returned
+ *
+ * Return:
+ *   true if a complete frame is available, in 'frame' for the first sensor
+ ******************************************************************************/
+static bool acquire_frame(uint32_t* sensor_id, uint32_t* time_ms, uint32_t* preprocess_cycles, uint32_t* wait_us)
+{
+    bool activity = false;
+    int32_t oldest;
+    radar_sensor_frame_t* pending;
+
+    for (uint32_t id = 0; id < RADAR_NUM_SENSORS; ++id)
+    {
+        if (!pending_frames[id].ready)
+        {
+            activity = read_block(&sensors[id], &pending_frames[id]) || activity;
+        }
+    }
+
+    oldest = radar_sensor_oldest(pending_frames, RADAR_NUM_SENSORS);
+    if (oldest < 0)
+    {
+        if (!activity)
+        {
+            /* Any sensor interrupt wakes the task, a timeout lets the stalls be detected */
+            (void)ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(FRAME_STALL_PERIODS * FRAME_PERIOD_MS));
+        }
+        return false;
+    }
+
+    pending = &pending_frames[oldest];
+    pending->ready = false;
+
+    *sensor_id = (uint32_t)oldest;
+    *time_ms = pending->time_ms;
+    *preprocess_cycles = pending->preprocess_cycles;
+    *wait_us = cyhal_timer_read(&stamp_timer) - pending->ready_us;
+
+    return true;
+}
+#else
+/*******************************************************************************
+ * Function Name: acquire_frame
+ *******************************************************************************
+ * Summary:
+ *   Takes the next frame the CM0+ core published in the frame ring and
+ *   preprocesses it. The ring decides whether a frame is available, the
+ *   doorbell only wakes the task. The CM0+ core keeps the frame sequence
+ *   and recovers the acquisition, its statistics come with every frame.
+ *
+ * Parameters:
+ *   sensor_id: sensor of the frame, always the first one
+ *   time_ms: acquisition time of the frame, from the interrupt timestamp
+ *   preprocess_cycles: cycles spent in preprocessing
+ *   wait_us: time the complete frame waited in the ring, not measured
+ *
+ * Return:
+ *   true if a complete frame is available in 'frame'
+ ******************************************************************************/
+static bool acquire_frame(uint32_t* sensor_id, uint32_t* time_ms, uint32_t* preprocess_cycles, uint32_t* wait_us)
+{
+    static bool stamp_base_set = false;
+    frame_ring_header_t header;
+    const uint16_t* samples;
+    uint32_t start_cycles;
+
+    *sensor_id = 0;
+    *preprocess_cycles = 0;
+    *wait_us = 0;
+
+    samples = frame_ring_peek(&frame_ring, &header);
+    if (samples == NULL)
+    {
+        if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(FRAME_STALL_PERIODS * FRAME_PERIOD_MS)) == 0u)
+        {
+            printf("[WARN] no frame from the CM0+ core, %" PRIu32 " ring overruns\n", frame_ring.overruns);
+        }
+        return false;
+    }
+
+    start_cycles = cycle_counter_get();
+    frame_preprocess_whole(&preprocess, samples);
+    *preprocess_cycles = cycle_counter_elapsed(start_cycles);
+    frame_ring_release(&frame_ring);
+
+    /* The timestamps come from a timer of the CM0+ core */
+    if (!stamp_base_set)
+    {
+        frame_sequence_init(&sequence, (uint32_t)ifx_currenttime(), header.stamp_us);
+        stamp_base_set = true;
+    }
+
+    sequence.stats = header.stats;
+    *time_ms = frame_sequence_time_ms(&sequence, header.stamp_us);
+    frame_preprocess_start(&preprocess);
+
+    return true;
+}
+#endif
+
+#if (RADAR_NUM_SENSORS > 1)
+/*******************************************************************************
+* Function Name: secondary_presence_cb
+********************************************************************************
+* Summary:
+* This is the callback function of the presence library instances of the
+* further sensors. Their events go to the terminal and the presence
+* telemetry with the id of the sensor, the LEDs show the first sensor.
+* Parameters:
+*  handle: presence library instance
+*  event: presence event
+*  data: sensor index
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void secondary_presence_cb(xensiv_radar_presence_handle_t handle,
+                                  const xensiv_radar_presence_event_t* event, void* data)
+{
+    uint32_t sensor = (uint32_t)(uintptr_t)data;
+    publisher_data_t publisher_q_data = {0};
+
+    (void)handle;
+
+    publisher_q_data.cmd = PUBLISH_RADAR_TELEMETRY;
+    publisher_q_data.sensor = (uint8_t)sensor;
+    publisher_q_data.event = event->state;
+
+    if (event->state == XENSIV_RADAR_PRESENCE_STATE_ABSENCE)
+    {
+        printf("[INFO] sensor %" PRIu32 " absence %" PRIu32 "\n", sensor, event->timestamp);
+    }
+    else
+    {
+        publisher_q_data.distance = event->range_bin * Bin_len;
+        printf("[INFO] sensor %" PRIu32 " %s presence %.2f %" PRIu32 "\n", sensor,
+               (event->state == XENSIV_RADAR_PRESENCE_STATE_MACRO_PRESENCE) ? "macro" : "micro",
+               publisher_q_data.distance, event->timestamp);
+    }
+
+    /* Publish the read value to cloud */
+    xQueueSend(publisher_task_q, &publisher_q_data, portMAX_DELAY);
+}
+
+/*******************************************************************************
+ * Function Name: init_secondary_sensors
+ *******************************************************************************
+ * Summary:
+ *   Allocates a presence library instance per further sensor, with the
+ *   configuration of the first sensor, and prepares their preprocessing.
+ *
+ * Parameters:
+ *   config: configuration of the first sensor
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void init_secondary_sensors(const xensiv_radar_presence_config_t* config)
+{
+    for (uint32_t id = 1; id < RADAR_NUM_SENSORS; ++id)
+    {
+        secondary_sensor_t* secondary = &secondary_sensors[id - 1u];
+
+        if (xensiv_radar_presence_alloc(&secondary->handle, config) != 0)
+        {
+            printf("ERROR: presence library allocation of sensor %" PRIu32 " failed\n", id);
+            CY_ASSERT(0);
+        }
+        secondary->config = *config;
+        xensiv_radar_presence_set_callback(secondary->handle, secondary_presence_cb, (void*)(uintptr_t)id);
+
+#if (NUM_RX_ANTENNAS > 1)
+        frame_preprocess_init(&secondary->preprocess, secondary_frames[id - 1u], secondary_avg_chirps[id - 1u],
+                              secondary_rx_planes[id - 1u], NUM_SAMPLES_PER_CHIRP, NUM_RX_ANTENNAS, NUM_CHIRPS_PER_FRAME);
+#else
+        frame_preprocess_init(&secondary->preprocess, secondary_frames[id - 1u], secondary_avg_chirps[id - 1u],
+                              NULL, NUM_SAMPLES_PER_CHIRP, NUM_RX_ANTENNAS, NUM_CHIRPS_PER_FRAME);
+#endif
+        frame_preprocess_start(&secondary->preprocess);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: process_secondary_frame
+ *******************************************************************************
+ * Summary:
+ *   Runs the presence library on a frame of a further sensor, after
+ *   applying configuration changes radar_config_task made on the first
+ *   sensor.
+ *
+ * Parameters:
+ *   sensor: sensor of the frame, from 1
+ *   time_ms: acquisition time of the frame
+ *   preprocess_cycles: cycles spent in preprocessing
+ *   wait_us: time the complete frame waited to be processed
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void process_secondary_frame(uint32_t sensor, uint32_t time_ms, uint32_t preprocess_cycles, uint32_t wait_us)
+{
+    secondary_sensor_t* secondary = &secondary_sensors[sensor - 1u];
+    xensiv_radar_presence_config_t config;
+    uint32_t start_cycles;
+
+    report_frame_stats(sensor, &secondary->sequence.stats, time_ms, false);
+
+    start_cycles = cycle_counter_get();
+    if (xSemaphoreTake(sem_radar_sensing_context, portMAX_DELAY) == pdTRUE)
+    {
+        if (adaptive_rate_get_config(presence_handle, &config) == XENSIV_RADAR_PRESENCE_OK)
+        {
+            (void)radar_sensor_follow_config(secondary->handle, &secondary->config, &config);
+        }
+
+        if (xensiv_radar_presence_process_frame(secondary->handle, secondary_frames[sensor - 1u], time_ms) !=
+            XENSIV_RADAR_PRESENCE_OK)
+        {
+            printf("Failed during frame processing of sensor %" PRIu32 "\n", sensor);
+        }
+
+        xSemaphoreGive(sem_radar_sensing_context);
+    }
+
+    radar_sensor_account(sensor_stats, RADAR_NUM_SENSORS, sensor, preprocess_cycles + cycle_counter_elapsed(start_cycles),
+                         wait_us);
+}
+#endif
+
+/*******************************************************************************
+ * Function Name: start_acquisition
+ *******************************************************************************
+ * Summary:
+ *   Starts or stops frame generation of all sensors. Stopping resets the
+ *   sensor FSM and FIFO. With RADAR_ACQUISITION_CM0P the CM0+ core follows
+ *   the request, frames it published before it saw the stop are released on
+ *   start.
+ *
+ * Parameters:
+ *   start: true to start
+ *
+ * Return:
+ *   true on success
+ ******************************************************************************/
+static bool start_acquisition(bool start)
+{
+#if (RADAR_ACQUISITION_CM0P == 0)
+    bool result = true;
+
+    for (uint32_t id = 0; id < RADAR_NUM_SENSORS; ++id)
+    {
+        result = (xensiv_bgt60trxx_start_frame(&sensors[id].bgt60_obj.dev, start) == XENSIV_BGT60TRXX_STATUS_OK) &&
+                 result;
+        sensors[id].last_block_ms = (uint32_t)ifx_currenttime();
+    }
+
+    return result;
+#else
+    if (start)
+    {
+        (void)frame_ring_flush(&frame_ring);
+    }
+    frame_ring_set_running(&frame_ring, start);
+
+    return true;
+#endif
+}
+
+/*******************************************************************************
+ * Function Name: radar_task
+ *******************************************************************************
+ * Summary:
+ *   Initializes GPIO ports, context object of RadarSensing for presence
+ *   detection, then initializes radar device configuration,
+ *   sets parameters for presence detection, registers
+ *   callback to handle presence detection and
+ *   continuously processes data acquired from radar.
+ *
+ * Parameters:
+ *   pvParameters: thread
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void radar_task(void *pvParameters)
+{
+    (void)pvParameters;
+
+    xensiv_radar_presence_handle_t handle;
+    xensiv_radar_presence_event_t synthesized_event;
+    adaptive_rate_profile_id_t active_profile = ADAPTIVE_RATE_PROFILE_FULL;
+    TickType_t slow_scan_wake = 0;
+
+    static const xensiv_radar_presence_config_t default_config =
+	{
+		.bandwidth                         = 460E6,
+		.num_samples_per_chirp             = XENSIV_BGT60TRXX_CONF_NUM_SAMPLES_PER_CHIRP,
+		.micro_fft_decimation_enabled      = false,
+		.micro_fft_size                    = 128,
+		.macro_threshold                   = RADAR_DEFAULT_MACRO_THRESHOLD,
+		.micro_threshold                   = RADAR_DEFAULT_MICRO_THRESHOLD,
+		.min_range_bin                     = 1,
+		.max_range_bin                     = 5,
+		.macro_compare_interval_ms         = 250,
+		.macro_movement_validity_ms        = 1000,
+		.micro_movement_validity_ms        = 4000,
+		.macro_movement_confirmations      = 0,
+		.macro_trigger_range               = 1,
+		.mode                              = XENSIV_RADAR_PRESENCE_MODE_MICRO_IF_MACRO,
+		.macro_fft_bandpass_filter_enabled = false,
+		.micro_movement_compare_idx       = 5
+	};
+    xensiv_radar_presence_config_t boot_config = default_config;
+    bool boot_config_stored;
+
+
+    /* Init the sensor */
+    if (init_sensor() != 0)
+    {
+        CY_ASSERT(0);
+    }
+
+    if (init_leds () != 0)
+    {
+        CY_ASSERT(0);
+    }
+
+    xensiv_radar_presence_set_malloc_free(pvPortMalloc,
+                                          vPortFree);
+
+    boot_config_stored = load_config(&boot_config);
+    if (xensiv_radar_presence_alloc(&handle, &boot_config) != 0)
+    {
+        /* The stored configuration can be refused by another library version */
+        boot_config = default_config;
+        boot_config_stored = false;
+        if (xensiv_radar_presence_alloc(&handle, &boot_config) != 0)
+        {
+            CY_ASSERT(0);
+        }
+    }
+
+    presence_handle = handle;
+    Bin_len = xensiv_radar_presence_get_bin_length(handle);
+    if (boot_config_stored)
+    {
+        report_stored_config(&boot_config);
+    }
+
+    xensiv_radar_presence_set_callback(handle, presence_detection_cb, NULL);
+
+#if (RANGE_FFT_ENABLED != 0)
+    range_fft_benchmark(&range_fft);
+    if (range_fft_init(&range_fft, NUM_SAMPLES_PER_CHIRP, Bin_len) != 0)
+    {
+        CY_ASSERT(0);
+    }
+#endif
+#if RANGE_DOPPLER_ACTIVE
+    if (range_doppler_init(&range_doppler, range_doppler_map, NUM_SAMPLES_PER_CHIRP, NUM_CHIRPS_PER_FRAME,
+                           DOPPLER_VELOCITY_RESOLUTION) != 0)
+    {
+        CY_ASSERT(0);
+    }
+    range_doppler_set_range(&range_doppler, (uint32_t)boot_config.min_range_bin, (uint32_t)boot_config.max_range_bin);
+#endif
+#if ANGLE_ESTIMATE_ACTIVE
+    for (uint32_t rx = 0; rx < (ANGLE_ESTIMATE_NUM_ANTENNAS - 1u); ++rx)
+    {
+        if (range_fft_init(&rx_range_fft[rx], NUM_SAMPLES_PER_CHIRP, Bin_len) != 0)
+        {
+            CY_ASSERT(0);
+        }
+    }
+    angle_estimate_init(&angle_estimate);
+    zone_occupancy_init(&zone_occupancy, zones, sizeof(zones) / sizeof(zones[0]));
+#endif
+
+    adaptive_rate_init(handle, FRAME_PERIOD_MS);
+#if (MICRO_SDFT_ENABLED != 0)
+    micro_sdft_init(&micro_sdft, &boot_config);
+#endif
+#if (TARGET_DETECT_ENABLED != 0)
+    target_detect_init(&target_detect, TARGET_DETECT_OS_CFAR);
+    target_detect_set_range(&target_detect, (uint32_t)boot_config.min_range_bin, (uint32_t)boot_config.max_range_bin);
+#endif
+#if (TARGET_TRACKER_ENABLED != 0)
+    target_tracker_init(&target_tracker);
+#endif
+#if (ZONE_ENGINE_ENABLED != 0)
+    zone_engine_init(&zone_engine, Bin_len);
+#endif
+#if (THRESHOLD_CALIB_ENABLED != 0)
+    threshold_calib_init(&threshold_calib);
+#endif
+#if (SHADOW_PRESENCE_ENABLED != 0)
+    shadow_presence_init(&shadow_presence, shadow_frame, NUM_SAMPLES_PER_CHIRP, shadow_presence_cb, NULL);
+#endif
+
+    cycle_counter_init();
+#if (WARM_START_ENABLED != 0)
+    restore_snapshot(handle, &boot_config);
+#endif
+#if (NUM_RX_ANTENNAS > 1)
+    frame_preprocess_init(&preprocess, frame, avg_chirp, rx_planes, NUM_SAMPLES_PER_CHIRP, NUM_RX_ANTENNAS, NUM_CHIRPS_PER_FRAME);
+#else
+    frame_preprocess_init(&preprocess, frame, avg_chirp, NULL, NUM_SAMPLES_PER_CHIRP, NUM_RX_ANTENNAS, NUM_CHIRPS_PER_FRAME);
+#endif
+    frame_preprocess_start(&preprocess);
+#if (RADAR_NUM_SENSORS > 1)
+    init_secondary_sensors(&boot_config);
+#endif
+    overload_governor_init(&governor, FRAME_PERIOD_MS * 1000u, overload_event_cb, NULL);
+#if (RADAR_ACQUISITION_CM0P == 0)
+    for (uint32_t id = 0; id < RADAR_NUM_SENSORS; ++id)
+    {
+        frame_sequence_init(sensors[id].sequence, (uint32_t)ifx_currenttime(), cyhal_timer_read(&stamp_timer));
+    }
+#endif
+
+    /* Initiate semaphore mutex to protect 'radar_sensing_context' */
+    sem_radar_sensing_context = xSemaphoreCreateMutex();
+    if (sem_radar_sensing_context == NULL)
+    {
+        printf(" 'sem_radar_sensing_context' semaphore creation failed... Task suspend\n\n");
+        vTaskSuspend(NULL);
+    }
+
+    /**
+     * Create task for radar configuration. Configuration parameters come from
+     * Subscriber task. Subscribed topics are configured inside 'mqtt_client_config.c'.
+     */
+    if (pdPASS != xTaskCreate(radar_config_task,
+                              RADAR_CONFIG_TASK_NAME,
+                              RADAR_CONFIG_TASK_STACK_SIZE,
+							  handle,
+                              RADAR_CONFIG_TASK_PRIORITY,
+                              &radar_config_task_handle))
+    {
+        printf("Failed to create Radar config task!\n");
+        CY_ASSERT(0);
+    }
 
-        if (xensiv_bgt60trxx_get_fifo_data(&bgt60_obj.dev,
-                                            bgt60_buffer,
-                                            NUM_SAMPLES_PER_FRAME) == XENSIV_BGT60TRXX_STATUS_OK)
+    cyhal_gpio_write(CYBSP_USER_LED, false); /* USER_LED is active low */
+
+    if (!start_acquisition(true))
+    {
+        CY_ASSERT(0);
+    }
+
+    //printf("Presence application running \n\n");
+
+    for (;;)
+    {
+        uint32_t sensor_id;
+        uint32_t time_ms;
+        uint32_t preprocess_cycles;
+        uint32_t wait_us;
+#if (ZONE_ENGINE_ENABLED != 0)
+        zone_event_t zone_events[ZONE_ENGINE_MAX_ZONES];
+        uint32_t num_zone_events = 0;
+#endif
+#if (THRESHOLD_CALIB_ENABLED != 0)
+        bool calibration_done = false;
+#endif
+
+        if (!acquire_frame(&sensor_id, &time_ms, &preprocess_cycles, &wait_us))
+        {
+            continue;
+        }
+
+#if (RADAR_NUM_SENSORS > 1)
+        if (sensor_id != 0u)
+        {
+            process_secondary_frame(sensor_id, time_ms, preprocess_cycles, wait_us);
+            continue;
+        }
+#endif
+        hot_path_account(&hot_path_stats, HOT_PATH_STAGE_PREPROCESS, preprocess_cycles);
+
+        report_frame_stats(sensor_id, &sequence.stats, time_ms, false);
+
+        /* The FIFO has been drained, an overloaded system drops the frame here */
+        if ((adaptive_rate_get_profile() == ADAPTIVE_RATE_PROFILE_FULL) &&
+            overload_governor_skip_frame(&governor))
+        {
+            continue;
+        }
+
+        uint32_t start_cycles = cycle_counter_get();
+
+        /* A target in the clutter free profile starts the wake up latency of slow scan */
+        bool motion = false;
+
+#if (RANGE_FFT_ENABLED != 0)
+        range_profile = range_fft_process(&range_fft, avg_chirp);
+        range_fft_account(&range_fft, cycle_counter_elapsed(start_cycles));
+#endif
+
+#if (TARGET_DETECT_ENABLED != 0)
+        uint32_t detect_cycles = cycle_counter_get();
+        target_list_t* target_list = target_detect_process(&target_detect, range_profile);
+
+        motion = (target_list->count > 0u);
+
+#if ANGLE_ESTIMATE_ACTIVE
+        uint32_t angle_cycles = cycle_counter_get();
+        const range_profile_t* rx_profiles[ANGLE_ESTIMATE_NUM_ANTENNAS] = { range_profile };
+
+        /* The clutter maps of all antennas are updated in every frame */
+        for (uint32_t rx = 1; rx < ANGLE_ESTIMATE_NUM_ANTENNAS; ++rx)
+        {
+            rx_profiles[rx] = range_fft_process(&rx_range_fft[rx - 1u], &avg_chirp[rx * NUM_SAMPLES_PER_CHIRP]);
+        }
+        angle_estimate_process(&angle_estimate, target_list, rx_profiles);
+        angle_estimate_account(&angle_estimate, cycle_counter_elapsed(angle_cycles));
+
+        if (zone_occupancy_update(&zone_occupancy, target_list, time_ms))
+        {
+            report_zones();
+        }
+#endif
+#if (TARGET_TRACKER_ENABLED != 0)
+        target_tracker_update(&target_tracker, target_list, range_profile, time_ms);
+#endif
+        target_detect_account(&target_detect, cycle_counter_elapsed(detect_cycles));
+        report_targets(target_list, time_ms);
+#if (TARGET_TRACKER_ENABLED != 0)
+        report_tracks(time_ms);
+#endif
+#endif
+
+#if (MICRO_SDFT_ENABLED != 0)
+        /* The slow time window needs the full frame rate */
+        if (adaptive_rate_get_profile() == ADAPTIVE_RATE_PROFILE_FULL)
+        {
+            uint32_t sdft_cycles = cycle_counter_get();
+
+            micro_sdft_update(&micro_sdft, range_profile);
+            micro_sdft_account(&micro_sdft, cycle_counter_elapsed(sdft_cycles));
+        }
+#endif
+
+#if RANGE_DOPPLER_ACTIVE
+        uint32_t doppler_cycles = cycle_counter_get();
+
+        /* The first antenna plane holds the chirps one after the other */
+        report_motion(range_doppler_process(&range_doppler, frame), time_ms);
+        range_doppler_account(&range_doppler, cycle_counter_elapsed(doppler_cycles));
+#endif
 
+        if (xSemaphoreTake(sem_radar_sensing_context, portMAX_DELAY) == pdTRUE)
         {
-            /* Data preprocessing */
-            uint16_t *bgt60_buffer_ptr = &bgt60_buffer[0];
-            float32_t *frame_ptr = &frame[0];
-            for (int32_t sample = 0; sample < NUM_SAMPLES_PER_FRAME; ++sample)
+#if (SHADOW_PRESENCE_ENABLED != 0)
+            shadow_presence_capture(&shadow_presence, frame);
+#endif
+            uint32_t presence_cycles = cycle_counter_get();
+
+            if((xensiv_radar_presence_process_frame(handle, frame, time_ms)) != XENSIV_RADAR_PRESENCE_OK)
+            {
+                printf("Failed during frame processing\n");
+            }
+            hot_path_account(&hot_path_stats, HOT_PATH_STAGE_PRESENCE, cycle_counter_elapsed(presence_cycles));
+
+#if (MICRO_SDFT_ENABLED != 0) || (TARGET_DETECT_ENABLED != 0) || RANGE_DOPPLER_ACTIVE || (SHADOW_PRESENCE_ENABLED != 0)
+            xensiv_radar_presence_config_t user_config;
+
+            /* Follow configuration updates of radar_config_task */
+            (void)adaptive_rate_get_config(handle, &user_config);
+#endif
+#if (TARGET_DETECT_ENABLED != 0)
+            target_detect_set_range(&target_detect, (uint32_t)user_config.min_range_bin, (uint32_t)user_config.max_range_bin);
+#endif
+#if (MICRO_SDFT_ENABLED != 0)
+            (void)micro_sdft_configure(&micro_sdft, &user_config);
+
+            if (micro_sdft_check_absence(&micro_sdft, time_ms, &synthesized_event))
+            {
+                presence_detection_cb(handle, &synthesized_event, NULL);
+            }
+#endif
+#if RANGE_DOPPLER_ACTIVE
+            range_doppler_set_range(&range_doppler, (uint32_t)user_config.min_range_bin, (uint32_t)user_config.max_range_bin);
+
+            const xensiv_radar_presence_event_t* doppler_event =
+                range_doppler_check_presence(&range_doppler, time_ms, user_config.macro_movement_validity_ms);
+            if (doppler_event != NULL)
             {
-                *frame_ptr++ = ((float32_t)(*bgt60_buffer_ptr++) / 4096.0F);
+                presence_detection_cb(handle, doppler_event, NULL);
             }
+#endif
+#if (ZONE_ENGINE_ENABLED != 0)
+            uint32_t zone_cycles = cycle_counter_get();
+
+            num_zone_events = zone_engine_update(&zone_engine, range_profile, time_ms, zone_events);
+            zone_engine_account(&zone_engine, cycle_counter_elapsed(zone_cycles));
+#endif
 
-            // calculate the average of the chirps first
-            arm_fill_f32(0, avg_chirp, NUM_SAMPLES_PER_CHIRP);
+            uint32_t processing_cycles = preprocess_cycles + cycle_counter_elapsed(start_cycles);
 
-            for (int chirp = 0; chirp < NUM_CHIRPS_PER_FRAME; chirp++)
+            hot_path_account(&hot_path_stats, HOT_PATH_STAGE_FRAME, processing_cycles);
+            radar_sensor_account(sensor_stats, RADAR_NUM_SENSORS, sensor_id, processing_cycles, wait_us);
+            overload_governor_set_budget(&governor, adaptive_rate_get_frame_period_ms() * 1000u);
+            if (overload_governor_report(&governor, cycle_counter_to_us(processing_cycles)))
             {
-                arm_add_f32(avg_chirp, &frame[NUM_SAMPLES_PER_CHIRP * chirp], avg_chirp, NUM_SAMPLES_PER_CHIRP);
+                adaptive_rate_set_overload_level(handle, governor.level, time_ms);
             }
 
-            arm_scale_f32(avg_chirp, 1.0f / NUM_CHIRPS_PER_FRAME, avg_chirp, NUM_SAMPLES_PER_CHIRP);
-                
-            if (xSemaphoreTake(sem_radar_sensing_context, portMAX_DELAY) == pdTRUE)
+            /* Profile switches are applied between two frames only */
+            if (adaptive_rate_update(handle, time_ms, motion, &synthesized_event))
             {
-                if((xensiv_radar_presence_process_frame(handle, frame, xTaskGetTickCount() * portTICK_PERIOD_MS)) != XENSIV_RADAR_PRESENCE_OK)
-				{
-					printf("Failed during frame processing\n");
-				}
+                presence_detection_cb(handle, &synthesized_event, NULL);
             }
+#if (THRESHOLD_CALIB_ENABLED != 0)
+            calibration_done = calibrate_thresholds(handle, time_ms);
+#endif
+
+#if (SHADOW_PRESENCE_ENABLED != 0)
+            /* After the governor, the shadow detector only gets the time the production leaves */
+            if (shadow_presence_configure(&shadow_presence, &user_config))
+            {
+                /* ms times permille gives us */
+                uint32_t budget_us = adaptive_rate_get_frame_period_ms() * SHADOW_PRESENCE_BUDGET_PERMILLE;
+                uint32_t spent_us = cycle_counter_to_us(preprocess_cycles + cycle_counter_elapsed(start_cycles));
+                uint32_t available_us = 0;
+                uint32_t shadow_cycles = cycle_counter_get();
+
+                if ((governor.level == OVERLOAD_LEVEL_NONE) && (adaptive_rate_get_profile() == ADAPTIVE_RATE_PROFILE_FULL) &&
+                    (spent_us < budget_us))
+                {
+                    available_us = budget_us - spent_us;
+                }
+
+                if (shadow_presence_process(&shadow_presence, time_ms, available_us))
+                {
+                    shadow_cycles = cycle_counter_elapsed(shadow_cycles);
+                    shadow_presence_account(&shadow_presence, shadow_cycles, cycle_counter_to_us(shadow_cycles));
+                }
+            }
+#endif
+        }
 
-            xSemaphoreGive(sem_radar_sensing_context);
-            
+        xSemaphoreGive(sem_radar_sensing_context);
+
+#if (ZONE_ENGINE_ENABLED != 0)
+        /* Published outside of the sensing context, radar_config_task may wait for it */
+        report_zone_events(zone_events, num_zone_events);
+#endif
+#if (THRESHOLD_CALIB_ENABLED != 0)
+        if (calibration_done)
+        {
+            report_calibration();
+        }
+#endif
 
+        if (adaptive_rate_get_profile() == ADAPTIVE_RATE_PROFILE_SLOW)
+        {
+            if (active_profile != ADAPTIVE_RATE_PROFILE_SLOW)
+            {
+                slow_scan_wake = xTaskGetTickCount();
+            }
 
+            /* Stop frame generation, the sensor idles until the next slow scan slot.
+             * Stopping resets the sensor FSM and FIFO, a notification of a frame
+             * cut by the stop is dropped before the next frame is triggered.
+             */
+            (void)start_acquisition(false);
+            vTaskDelayUntil(&slow_scan_wake, pdMS_TO_TICKS(adaptive_rate_get_frame_period_ms()));
+            (void)ulTaskNotifyTake(pdTRUE, 0);
+            frame_sequence_restart(&sequence);
+            frame_preprocess_start(&preprocess);
+            if (!start_acquisition(true))
+            {
+                printf("[WARN] restarting the frame for slow scan failed\n");
+            }
         }
-        //vTaskDelay(2);
+#if (MICRO_SDFT_ENABLED != 0)
+        if (active_profile != adaptive_rate_get_profile())
+        {
+            micro_sdft_reset(&micro_sdft);
+        }
+#endif
+        active_profile = adaptive_rate_get_profile();
+    }
+}
+
+/*******************************************************************************
+ * Function Name: radar_task_set_track_report_interval
+ *******************************************************************************
+ * Summary:
+ *   Sets the interval of the track telemetry, called by radar_config_task.
+ *
+ * Parameters:
+ *   interval_ms: interval in ms
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void radar_task_set_track_report_interval(uint32_t interval_ms)
+{
+#if (TARGET_TRACKER_ENABLED != 0)
+    track_report_interval_ms = interval_ms;
+#else
+    (void)interval_ms;
+#endif
+}
+
+/*******************************************************************************
+ * Function Name: radar_task_set_zone
+ *******************************************************************************
+ * Summary:
+ *   Applies the configuration of a presence zone, called by radar_config_task
+ *   with sem_radar_sensing_context taken.
+ *
+ * Parameters:
+ *   zone_id: index of the zone
+ *   config: zone configuration
+ *
+ * Return:
+ *   true if the zone id is valid
+ ******************************************************************************/
+bool radar_task_set_zone(uint32_t zone_id, const zone_config_t* config)
+{
+#if (ZONE_ENGINE_ENABLED != 0)
+    return zone_engine_configure(&zone_engine, zone_id, config);
+#else
+    (void)zone_id;
+    (void)config;
+    return false;
+#endif
+}
+
+/*******************************************************************************
+ * Function Name: radar_task_set_shadow_thresholds
+ *******************************************************************************
+ * Summary:
+ *   Sets the thresholds of the shadow presence detector, called by
+ *   radar_config_task with sem_radar_sensing_context taken. The detector
+ *   runs while at least one threshold is not 0.
+ *
+ * Parameters:
+ *   macro_threshold: macro threshold, 0 for the production value
+ *   micro_threshold: micro threshold, 0 for the production value
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void radar_task_set_shadow_thresholds(float macro_threshold, float micro_threshold)
+{
+#if (SHADOW_PRESENCE_ENABLED != 0)
+    shadow_presence_set_thresholds(&shadow_presence, macro_threshold, micro_threshold);
+#else
+    (void)macro_threshold;
+    (void)micro_threshold;
+#endif
+}
+
+/*******************************************************************************
+ * Function Name: radar_task_start_calibration
+ *******************************************************************************
+ * Summary:
+ *   Starts a threshold calibration, called by radar_config_task with
+ *   sem_radar_sensing_context taken. The room must stay empty during the
+ *   learning window.
+ *
+ * Parameters:
+ *   duration_ms: learning window, 0 for the default
+ *   far: false alarm rate per frame, 0 for the default
+ *   apply: configure the thresholds at the end instead of proposing them
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void radar_task_start_calibration(uint32_t duration_ms, float far, bool apply)
+{
+#if (THRESHOLD_CALIB_ENABLED != 0)
+    threshold_calib_start(&threshold_calib, duration_ms, far, apply);
+#else
+    (void)duration_ms;
+    (void)far;
+    (void)apply;
+#endif
+}
+
+/*******************************************************************************
+ * Function Name: radar_task_get_stored_config
+ *******************************************************************************
+ * Summary:
+ *   Reads the configuration to persist, called by radar_config_task with
+ *   sem_radar_sensing_context taken. The mode forced by a threshold
+ *   calibration is not part of it.
+ *
+ * Parameters:
+ *   handle: presence library handle
+ *   config: configuration in use
+ *
+ * Return:
+ *   true if config can be stored
+ ******************************************************************************/
+bool radar_task_get_stored_config(xensiv_radar_presence_handle_t handle, xensiv_radar_presence_config_t* config)
+{
+    return adaptive_rate_get_config(handle, config) == XENSIV_RADAR_PRESENCE_OK;
+}
+
+/*******************************************************************************
+ * Function Name: stop_radar_task
+ *******************************************************************************
+ * Summary:
+ *   Waits up to RADAR_TASK_STOP_TIMEOUT_MS for the end of the frame in
+ *   process and suspends radar_task, so no frame is processed afterwards.
+ *   On success sem_radar_sensing_context is taken and must be given by the
+ *   caller. On timeout radar_task is suspended anyway, e.g. while it waits
+ *   for the queue of a publisher task that does not run anymore.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   true if sem_radar_sensing_context was taken
+ ******************************************************************************/
+static bool stop_radar_task(void)
+{
+    bool taken = (sem_radar_sensing_context != NULL) &&
+                 (xSemaphoreTake(sem_radar_sensing_context, pdMS_TO_TICKS(RADAR_TASK_STOP_TIMEOUT_MS)) == pdTRUE);
+
+    if (radar_task_handle != NULL)
+    {
+        vTaskSuspend(radar_task_handle);
+    }
+
+    return taken;
+}
+
+/*******************************************************************************
+ * Function Name: radar_task_shutdown
+ *******************************************************************************
+ * Summary:
+ *   Prepares a controlled reboot, e.g. before a firmware update is
+ *   activated: stops radar_task, writes the detection snapshot and the
+ *   pending configuration. Must be called while the publisher task runs.
+ *   Nothing is written if the frame in process does not end in time.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void radar_task_shutdown(void)
+{
+    xensiv_radar_presence_config_t config;
+
+    if (presence_handle == NULL)
+    {
+        return;
+    }
+    if (!stop_radar_task())
+    {
+        printf("[INFO] radar task busy for %u ms, detection state not saved\n", RADAR_TASK_STOP_TIMEOUT_MS);
+        return;
+    }
 
+#if (WARM_START_ENABLED != 0)
+    save_snapshot(presence_handle);
+#endif
+#if (CONFIG_STORE_ENABLED != 0)
+    if (radar_task_get_stored_config(presence_handle, &config))
+    {
+        config_store_save(&config_store, &config, (uint32_t)ifx_currenttime());
     }
+    (void)config_store_flush(&config_store, (uint32_t)ifx_currenttime());
+#else
+    (void)config;
+#endif
+
+    xSemaphoreGive(sem_radar_sensing_context);
 }
 
 /*******************************************************************************
  * Function Name: radar_task_cleanup
  *******************************************************************************
  * Summary:
- *   Cleanup all resources radar_task has used/created.
+ *   Cleanup all resources radar_task has used/created. Stops radar_task
+ *   without writing the detection state, it is written on a controlled
+ *   shutdown only. Must be called while the publisher task runs.
  *
  * Parameters:
  *   void
@@ -525,9 +2383,16 @@ void radar_task(void *pvParameters)
  ******************************************************************************/
 void radar_task_cleanup(void)
 {
+    bool taken = stop_radar_task();
+
     if (radar_config_task_handle != NULL)
     {
         vTaskDelete(radar_config_task_handle);
+        radar_config_task_handle = NULL;
+    }
+    if (taken)
+    {
+        xSemaphoreGive(sem_radar_sensing_context);
     }
 }
 
@@ -36,8 +36,62 @@
 #include "xensiv_bgt60trxx_mtb.h"
 #include "xensiv_radar_presence.h"
 
+/* Header file for local task */
+#include "config_store.h"
+#include "zone_engine.h"
+
+/* Set to 1 to acquire the three receive antennas of the BGT60TR13C. The
+ * register set is exported from the radar configurator into
+ * radar_settings_3rx.h, which then also defines register_list.
+ */
+#ifndef RADAR_PROFILE_3RX
+#define RADAR_PROFILE_3RX     (0)
+#endif
+
+/* Set to 1 to acquire several chirps per frame for the range-Doppler
+ * processing, with the register set exported into radar_settings_doppler.h
+ */
+#ifndef RADAR_PROFILE_DOPPLER
+#define RADAR_PROFILE_DOPPLER (0)
+#endif
+
+#if (RADAR_PROFILE_3RX != 0) && (RADAR_PROFILE_DOPPLER != 0)
+#error "Select one acquisition profile"
+#endif
+
+/* The register sets of the other profiles are not part of the example, they
+ * have to be exported for the sensor and antenna board at hand
+ */
+#if defined(__has_include) && (RADAR_PROFILE_3RX != 0)
+#if !__has_include("radar_settings_3rx.h")
+#error "RADAR_PROFILE_3RX: export radar_settings_3rx.h with RX1, RX2 and RX3 enabled and its register_list from the radar configurator"
+#endif
+#endif
+
+#if defined(__has_include) && (RADAR_PROFILE_DOPPLER != 0)
+#if !__has_include("radar_settings_doppler.h")
+#error "RADAR_PROFILE_DOPPLER: export radar_settings_doppler.h with 16, 32 or 64 chirps per frame and its register_list from the radar configurator"
+#endif
+#endif
+
 #define XENSIV_BGT60TRXX_CONF_IMPL
+#if (RADAR_PROFILE_3RX != 0)
+#include "radar_settings_3rx.h"
+#elif (RADAR_PROFILE_DOPPLER != 0)
+#include "radar_settings_doppler.h"
+#else
 #include "radar_settings.h"
+#endif
+
+#if (RADAR_PROFILE_3RX != 0) && defined(XENSIV_BGT60TRXX_CONF_NUM_RX_ANTENNAS) && (XENSIV_BGT60TRXX_CONF_NUM_RX_ANTENNAS != 3)
+#error "radar_settings_3rx.h must enable the three receive antennas"
+#endif
+
+#if (RADAR_PROFILE_DOPPLER != 0) && defined(XENSIV_BGT60TRXX_CONF_NUM_CHIRPS_PER_FRAME) && \
+    (XENSIV_BGT60TRXX_CONF_NUM_CHIRPS_PER_FRAME != 16) && (XENSIV_BGT60TRXX_CONF_NUM_CHIRPS_PER_FRAME != 32) && \
+    (XENSIV_BGT60TRXX_CONF_NUM_CHIRPS_PER_FRAME != 64)
+#error "radar_settings_doppler.h must acquire 16, 32 or 64 chirps per frame"
+#endif
 
 /*******************************************************************************
  * Macros
@@ -46,6 +100,36 @@
 #define RADAR_TASK_STACK_SIZE (1024 * 4)
 #define RADAR_TASK_PRIORITY   (3)
 
+/* Presence thresholds of default_config, also reported by publisher_task */
+#define RADAR_DEFAULT_MACRO_THRESHOLD (0.5f)
+#define RADAR_DEFAULT_MICRO_THRESHOLD (12.5f)
+
+/* Set to 1 to read and preprocess the FIFO chirp by chirp while the frame is
+ * still acquired. Only pays off for profiles with more than one chirp.
+ */
+#ifndef RADAR_STREAMING_MODE
+#define RADAR_STREAMING_MODE  (0)
+#endif
+
+/* Set to 1 to leave the sensor interrupt, the FIFO reads and the frame
+ * sequence to the CM0+ core, see cm0p/acquisition_cm0p.c. Frames then come
+ * through the frame ring and need the CM0+ application of the cm0p folder in
+ * place of the cm0p image of the bundle, which runs the SCL Wi-Fi driver.
+ * Set with RADAR_ACQUISITION_CM0P=1 on the make command line, the Makefile
+ * rejects it together with the SCL component.
+ */
+#ifndef RADAR_ACQUISITION_CM0P
+#define RADAR_ACQUISITION_CM0P (0)
+#endif
+
+/* Number of sensors driven by the controller, up to 4, with the pins of
+ * resource_map.h. The first sensor runs the whole processing, the others
+ * run the presence library with the configuration of the first one.
+ */
+#ifndef RADAR_NUM_SENSORS
+#define RADAR_NUM_SENSORS     (1)
+#endif
+
 /*******************************************************************************
  * Global Variables
  ******************************************************************************/
@@ -53,6 +137,9 @@ extern TaskHandle_t radar_task_handle;
 
 extern SemaphoreHandle_t sem_radar_sensing_context;
 extern xensiv_radar_presence_handle_t handle;
+#if (CONFIG_STORE_ENABLED != 0)
+extern config_store_t config_store;
+#endif
 
 
 /*******************************************************************************
@@ -60,5 +147,11 @@ extern xensiv_radar_presence_handle_t handle;
  ******************************************************************************/
 void radar_task(void *pvParameters);
 void radar_task_cleanup(void);
+void radar_task_shutdown(void);
+void radar_task_set_track_report_interval(uint32_t interval_ms);
+bool radar_task_set_zone(uint32_t zone_id, const zone_config_t* config);
+void radar_task_set_shadow_thresholds(float macro_threshold, float micro_threshold);
+void radar_task_start_calibration(uint32_t duration_ms, float far, bool apply);
+bool radar_task_get_stored_config(xensiv_radar_presence_handle_t handle, xensiv_radar_presence_config_t* config);
 
 /* [] END OF FILE */
@@ -0,0 +1,385 @@
+/*****************************************************************************
+ * File name: range_doppler.c
+ *
+ * Description: This file contains the range-Doppler processing of profiles
+ * with several chirps per frame. Every chirp goes through a real range FFT
+ * whose bins are written transposed into the map, so that the Doppler FFT
+ * of a range bin runs on contiguous memory with a precomputed arm_cfft_f32
+ * instance. The strongest moving cell of the observed range bins gives the
+ * radial velocity of the frame. Motion confirmed over a few frames is
+ * reported as macro presence before the presence library confirms it.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Header file for library */
+#include "arm_const_structs.h"
+
+/* Header file for local task */
+#include "range_doppler.h"
+
+/*******************************************************************************
+ * Function Name: init_window
+ *******************************************************************************
+ * Summary:
+ *   Computes a Hann window normalized to unity coherent gain.
+ *
+ * Parameters:
+ *   window: output window
+ *   size: window length
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void init_window(float32_t* window, uint32_t size)
+{
+    float32_t sum = 0.0f;
+
+    for (uint32_t n = 0; n < size; ++n)
+    {
+        window[n] = 0.5f - (0.5f * arm_cos_f32((2.0f * PI * (float32_t)n) / (float32_t)(size - 1u)));
+        sum += window[n];
+    }
+
+    arm_scale_f32(window, (float32_t)size / sum, window, size);
+}
+
+/*******************************************************************************
+ * Function Name: doppler_instance
+ *******************************************************************************
+ * Summary:
+ *   Selects the precomputed complex FFT instance of a chirp count.
+ *
+ * Parameters:
+ *   num_chirps: chirps per frame
+ *
+ * Return:
+ *   FFT instance, NULL if the chirp count is not supported
+ ******************************************************************************/
+static const arm_cfft_instance_f32* doppler_instance(uint32_t num_chirps)
+{
+    switch (num_chirps)
+    {
+        case 16u:
+            return &arm_cfft_sR_f32_len16;
+        case 32u:
+            return &arm_cfft_sR_f32_len32;
+        case 64u:
+            return &arm_cfft_sR_f32_len64;
+        default:
+            return NULL;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: range_doppler_init
+ *******************************************************************************
+ * Summary:
+ *   Initializes the FFT instances and windows for the given frame shape.
+ *
+ * Parameters:
+ *   rd: range-Doppler state
+ *   map: RANGE_DOPPLER_MAP_SIZE(fft_size, num_chirps) values, caller owned
+ *   fft_size: samples per chirp, a power of two up to RANGE_FFT_MAX_SIZE
+ *   num_chirps: chirps per frame, 16, 32 or 64
+ *   velocity_resolution: meters per second per Doppler bin
+ *
+ * Return:
+ *   0 on success, -1 if the frame shape is not supported
+ ******************************************************************************/
+int32_t range_doppler_init(range_doppler_t* rd, float32_t* map, uint32_t fft_size, uint32_t num_chirps,
+                           float32_t velocity_resolution)
+{
+    memset(rd, 0, sizeof(*rd));
+
+    rd->cfft = doppler_instance(num_chirps);
+    if ((rd->cfft == NULL) || (num_chirps > RANGE_DOPPLER_MAX_CHIRPS) || (fft_size > RANGE_FFT_MAX_SIZE) ||
+        (range_fft_rfft_init_f32(&rd->rfft, fft_size) != ARM_MATH_SUCCESS))
+    {
+        return -1;
+    }
+
+    rd->map = map;
+    rd->fft_size = fft_size;
+    rd->num_chirps = num_chirps;
+    rd->min_bin = 1u;
+    rd->max_bin = (fft_size / 2u) - 1u;
+    rd->velocity_resolution = velocity_resolution;
+    rd->reported_state = XENSIV_RADAR_PRESENCE_STATE_ABSENCE;
+    init_window(rd->range_window, fft_size);
+    init_window(rd->doppler_window, num_chirps);
+
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: range_doppler_set_range
+ *******************************************************************************
+ * Summary:
+ *   Sets the range bins searched for motion, only they are transposed and
+ *   go through the Doppler FFT.
+ *
+ * Parameters:
+ *   rd: range-Doppler state
+ *   min_bin: first range bin
+ *   max_bin: last range bin
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void range_doppler_set_range(range_doppler_t* rd, uint32_t min_bin, uint32_t max_bin)
+{
+    uint32_t last_bin = (rd->fft_size / 2u) - 1u;
+
+    /* The DC bin does not carry targets */
+    rd->min_bin = (min_bin > 0u) ? min_bin : 1u;
+    rd->max_bin = (max_bin < last_bin) ? max_bin : last_bin;
+}
+
+/*******************************************************************************
+ * Function Name: range_doppler_process
+ *******************************************************************************
+ * Summary:
+ *   Computes the range-Doppler map of a frame and finds its strongest moving
+ *   cell. The mean over the chirps is removed from every range bin before
+ *   the Doppler FFT, so static reflections do not show up.
+ *
+ * Parameters:
+ *   rd: range-Doppler state
+ *   frame: num_chirps chirps of fft_size samples
+ *
+ * Return:
+ *   result of the frame, owned by rd
+ ******************************************************************************/
+const range_doppler_result_t* range_doppler_process(range_doppler_t* rd, const float32_t* frame)
+{
+    const uint32_t num_chirps = rd->num_chirps;
+    const uint32_t row_len = 2u * num_chirps;
+    /* Both windows have unity coherent gain, a sinusoid of amplitude A peaks
+     * at A * fft_size / 2 * num_chirps
+     */
+    const float32_t scale = 2.0f / ((float32_t)rd->fft_size * (float32_t)num_chirps);
+    range_doppler_result_t* result = &rd->result;
+    float32_t* magnitude = rd->input;
+
+    /* First pass: range FFT per chirp, written transposed */
+    for (uint32_t chirp = 0; chirp < num_chirps; ++chirp)
+    {
+        const float32_t* samples = &frame[chirp * rd->fft_size];
+        float32_t mean;
+
+        arm_mean_f32(samples, rd->fft_size, &mean);
+        arm_offset_f32(samples, -mean, rd->input, rd->fft_size);
+        arm_mult_f32(rd->input, rd->range_window, rd->input, rd->fft_size);
+        arm_rfft_fast_f32(&rd->rfft, rd->input, rd->spectrum, 0);
+
+        for (uint32_t bin = rd->min_bin; bin <= rd->max_bin; ++bin)
+        {
+            float32_t* cell = &rd->map[(bin * row_len) + (2u * chirp)];
+
+            cell[0] = rd->spectrum[2u * bin];
+            cell[1] = rd->spectrum[(2u * bin) + 1u];
+        }
+    }
+
+    result->motion = false;
+    result->walking = false;
+    result->magnitude = 0.0f;
+
+    /* Second pass: Doppler FFT per range bin on contiguous rows */
+    for (uint32_t bin = rd->min_bin; bin <= rd->max_bin; ++bin)
+    {
+        float32_t* row = &rd->map[bin * row_len];
+        float32_t mean_re = 0.0f;
+        float32_t mean_im = 0.0f;
+        float32_t peak;
+        uint32_t peak_index;
+
+        for (uint32_t chirp = 0; chirp < num_chirps; ++chirp)
+        {
+            mean_re += row[2u * chirp];
+            mean_im += row[(2u * chirp) + 1u];
+        }
+        mean_re /= (float32_t)num_chirps;
+        mean_im /= (float32_t)num_chirps;
+
+        for (uint32_t chirp = 0; chirp < num_chirps; ++chirp)
+        {
+            row[2u * chirp] = (row[2u * chirp] - mean_re) * rd->doppler_window[chirp];
+            row[(2u * chirp) + 1u] = (row[(2u * chirp) + 1u] - mean_im) * rd->doppler_window[chirp];
+        }
+
+        arm_cfft_f32(rd->cfft, row, 0, 1);
+        arm_cmplx_mag_f32(row, magnitude, num_chirps);
+
+        /* The zero Doppler bin only holds what the mean removal left */
+        arm_max_f32(&magnitude[1], num_chirps - 1u, &peak, &peak_index);
+        peak *= scale;
+
+        if (peak > result->magnitude)
+        {
+            int32_t doppler_bin = (int32_t)peak_index + 1;
+
+            if (doppler_bin >= (int32_t)(num_chirps / 2u))
+            {
+                doppler_bin -= (int32_t)num_chirps;
+            }
+
+            result->magnitude = peak;
+            result->range_bin = bin;
+            result->doppler_bin = doppler_bin;
+            result->velocity = (float32_t)doppler_bin * rd->velocity_resolution;
+        }
+    }
+
+    if (result->magnitude > RANGE_DOPPLER_THRESHOLD)
+    {
+        result->motion = true;
+        result->walking = (result->velocity >= RANGE_DOPPLER_WALKING_SPEED) ||
+                          (result->velocity <= -RANGE_DOPPLER_WALKING_SPEED);
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: range_doppler_filter_event
+ *******************************************************************************
+ * Summary:
+ *   Follows the reported presence state. A state reported by anybody else
+ *   takes over a presence reported from the Doppler map.
+ *
+ * Parameters:
+ *   rd: range-Doppler state
+ *   event: event about to be reported
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void range_doppler_filter_event(range_doppler_t* rd, const xensiv_radar_presence_event_t* event)
+{
+    if (event != &rd->event)
+    {
+        rd->doppler_presence = false;
+    }
+
+    rd->reported_state = event->state;
+}
+
+/*******************************************************************************
+ * Function Name: range_doppler_check_presence
+ *******************************************************************************
+ * Summary:
+ *   Called after every processed frame. Reports a macro presence after
+ *   RANGE_DOPPLER_CONFIRM_FRAMES frames with motion during an absence, and
+ *   an absence if the presence library did not take over before the motion
+ *   is older than validity_ms.
+ *
+ * Parameters:
+ *   rd: range-Doppler state
+ *   time_ms: time of the frame
+ *   validity_ms: macro_movement_validity_ms of the presence configuration
+ *
+ * Return:
+ *   event to report, NULL if none
+ ******************************************************************************/
+const xensiv_radar_presence_event_t* range_doppler_check_presence(range_doppler_t* rd, uint32_t time_ms,
+                                                                  uint32_t validity_ms)
+{
+    if (rd->result.motion)
+    {
+        rd->last_motion_ms = time_ms;
+        if (rd->motion_frames < RANGE_DOPPLER_CONFIRM_FRAMES)
+        {
+            ++rd->motion_frames;
+        }
+    }
+    else
+    {
+        rd->motion_frames = 0;
+    }
+
+    if (!rd->doppler_presence && (rd->reported_state == XENSIV_RADAR_PRESENCE_STATE_ABSENCE) &&
+        (rd->motion_frames == RANGE_DOPPLER_CONFIRM_FRAMES))
+    {
+        rd->doppler_presence = true;
+        ++rd->stats.confirmations;
+
+        rd->event.state = XENSIV_RADAR_PRESENCE_STATE_MACRO_PRESENCE;
+        rd->event.range_bin = (int32_t)rd->result.range_bin;
+        rd->event.timestamp = time_ms;
+        return &rd->event;
+    }
+
+    if (rd->doppler_presence && ((time_ms - rd->last_motion_ms) > validity_ms))
+    {
+        rd->doppler_presence = false;
+
+        rd->event.state = XENSIV_RADAR_PRESENCE_STATE_ABSENCE;
+        rd->event.range_bin = 0;
+        rd->event.timestamp = time_ms;
+        return &rd->event;
+    }
+
+    return NULL;
+}
+
+/*******************************************************************************
+ * Function Name: range_doppler_account
+ *******************************************************************************
+ * Summary:
+ *   Records the cycles the caller measured for one range_doppler_process
+ *   call and prints the statistics periodically.
+ *
+ * Parameters:
+ *   rd: range-Doppler state
+ *   cycles: measured cycles
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void range_doppler_account(range_doppler_t* rd, uint32_t cycles)
+{
+    range_doppler_stats_t* stats = &rd->stats;
+
+    ++stats->frames;
+    stats->last_cycles = cycles;
+    stats->total_cycles += cycles;
+    if (cycles > stats->max_cycles)
+    {
+        stats->max_cycles = cycles;
+    }
+
+    if ((stats->frames % RANGE_DOPPLER_STATS_PRINT_INTERVAL) == 0u)
+    {
+        printf("[INFO] range-Doppler %" PRIu32 " chirps bins %" PRIu32 "..%" PRIu32 ": avg %" PRIu32 " max %" PRIu32
+               " cycles per frame, %" PRIu32 " early confirmations\n",
+               rd->num_chirps, rd->min_bin, rd->max_bin, (uint32_t)(stats->total_cycles / stats->frames),
+               stats->max_cycles, stats->confirmations);
+    }
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,136 @@
+/******************************************************************************
+ * File Name:   range_doppler.h
+ *
+ * Description: This file contains the function prototypes and constants used
+ *   in range_doppler.c.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+
+#pragma once
+
+/* Header file from system */
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Header file for library */
+#include "arm_math.h"
+#include "xensiv_radar_presence.h"
+
+/* Header file for local task */
+#include "range_fft.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Set to 0 to skip the range-Doppler processing of multi chirp profiles */
+#define RANGE_DOPPLER_ENABLED               (1)
+
+/* Largest number of chirps per frame, arm_cfft_f32 tables for 16, 32 and 64
+ * points are linked by the Makefile
+ */
+#define RANGE_DOPPLER_MAX_CHIRPS            (64u)
+
+/* Peak Doppler magnitude, in ADC full scale, that counts as motion. Starting
+ * point to be tuned on recordings.
+ */
+#define RANGE_DOPPLER_THRESHOLD             (0.005f)
+
+/* Consecutive frames with motion before a macro presence is reported */
+#define RANGE_DOPPLER_CONFIRM_FRAMES        (2u)
+
+/* Radial speed from which a motion is classified as walking */
+#define RANGE_DOPPLER_WALKING_SPEED         (0.4f)
+
+/* Statistics are printed every time this many frames have been processed */
+#define RANGE_DOPPLER_STATS_PRINT_INTERVAL  (2000u)
+
+/* Size of the caller owned map */
+#define RANGE_DOPPLER_MAP_SIZE(fft_size, num_chirps)  (((fft_size) / 2u) * (num_chirps) * 2u)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+/* Strongest moving cell of the last frame */
+typedef struct
+{
+    bool motion;
+    bool walking;
+    uint32_t range_bin;
+    int32_t doppler_bin;                /* 0 is static */
+    float32_t velocity;                 /* meters per second, positive moving away */
+    float32_t magnitude;
+} range_doppler_result_t;
+
+typedef struct
+{
+    uint32_t frames;
+    uint32_t last_cycles;
+    uint32_t max_cycles;
+    uint64_t total_cycles;
+    uint32_t confirmations;             /* macro presences reported before the library */
+} range_doppler_stats_t;
+
+typedef struct
+{
+    arm_rfft_fast_instance_f32 rfft;
+    const arm_cfft_instance_f32* cfft;
+    uint32_t fft_size;
+    uint32_t num_chirps;
+    uint32_t min_bin;
+    uint32_t max_bin;
+    float32_t velocity_resolution;      /* meters per second per Doppler bin */
+
+    /* Range bin after range bin, num_chirps complex samples each, so the
+     * Doppler FFT of a range bin works on contiguous memory
+     */
+    float32_t* map;
+
+    float32_t range_window[RANGE_FFT_MAX_SIZE];
+    float32_t doppler_window[RANGE_DOPPLER_MAX_CHIRPS];
+    float32_t input[RANGE_FFT_MAX_SIZE];
+    float32_t spectrum[RANGE_FFT_MAX_SIZE];
+    range_doppler_result_t result;
+
+    /* Macro presence confirmation */
+    uint32_t motion_frames;
+    bool doppler_presence;              /* a macro presence has been reported from the Doppler map */
+    xensiv_radar_presence_state_t reported_state;
+    uint32_t last_motion_ms;
+    xensiv_radar_presence_event_t event;
+
+    range_doppler_stats_t stats;
+} range_doppler_t;
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+int32_t range_doppler_init(range_doppler_t* rd, float32_t* map, uint32_t fft_size, uint32_t num_chirps,
+                           float32_t velocity_resolution);
+void range_doppler_set_range(range_doppler_t* rd, uint32_t min_bin, uint32_t max_bin);
+const range_doppler_result_t* range_doppler_process(range_doppler_t* rd, const float32_t* frame);
+void range_doppler_filter_event(range_doppler_t* rd, const xensiv_radar_presence_event_t* event);
+const xensiv_radar_presence_event_t* range_doppler_check_presence(range_doppler_t* rd, uint32_t time_ms,
+                                                                  uint32_t validity_ms);
+void range_doppler_account(range_doppler_t* rd, uint32_t cycles);
+
+/* [] END OF FILE */
@@ -0,0 +1,511 @@
+/*****************************************************************************
+ * File name: range_fft.c
+ *
+ * Description: This file contains the range processing front end. The
+ * average chirp of every frame is windowed and transformed with the CMSIS-DSP
+ * real FFT, the static clutter is removed from the complex spectrum and the
+ * magnitude per range bin is provided as range profile for other consumers.
+ * Window and FFT instance are computed at init, the processing allocates
+ * nothing. It only depends on CMSIS-DSP.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Header file for local task */
+#include "hot_path.h"
+#include "range_fft.h"
+#if (RANGE_FFT_BENCHMARK != 0)
+#include "cycle_counter.h"
+#endif
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#if (RANGE_FFT_FIXED_POINT == 15)
+#define SAMPLE_FRAC_BITS                    (15)
+#define SAMPLE_TO_Q31(x)                    ((q31_t)(x) << 16)
+#define Q31_TO_SAMPLE(x)                    ((q15_t)((x) >> 16))
+#define FLOAT_TO_SAMPLE                     arm_float_to_q15
+#define SAMPLE_TO_FLOAT                     arm_q15_to_float
+#define RFFT_INIT(S, n)                     arm_rfft_init_q15((S), (n), 0, 1)
+#define RFFT                                arm_rfft_q15
+#define SAMPLE_MEAN                         arm_mean_q15
+#define SAMPLE_OFFSET                       arm_offset_q15
+#define SAMPLE_MULT                         arm_mult_q15
+#define SAMPLE_CMPLX_MAG                    arm_cmplx_mag_q15
+#elif (RANGE_FFT_FIXED_POINT == 31)
+#define SAMPLE_FRAC_BITS                    (31)
+#define SAMPLE_TO_Q31(x)                    (x)
+#define Q31_TO_SAMPLE(x)                    (x)
+#define FLOAT_TO_SAMPLE                     arm_float_to_q31
+#define SAMPLE_TO_FLOAT                     arm_q31_to_float
+#define RFFT_INIT(S, n)                     arm_rfft_init_q31((S), (n), 0, 1)
+#define RFFT                                arm_rfft_q31
+#define SAMPLE_MEAN                         arm_mean_q31
+#define SAMPLE_OFFSET                       arm_offset_q31
+#define SAMPLE_MULT                         arm_mult_q31
+#define SAMPLE_CMPLX_MAG                    arm_cmplx_mag_q31
+#endif
+
+/*******************************************************************************
+ * Function Name: window_value
+ *******************************************************************************
+ * Summary:
+ *   Computes one coefficient of a Blackman-Harris window.
+ *
+ * Parameters:
+ *   n: index of the coefficient
+ *   size: window length
+ *
+ * Return:
+ *   coefficient
+ ******************************************************************************/
+static float32_t window_value(uint32_t n, uint32_t size)
+{
+    const float32_t a0 = 0.35875f;
+    const float32_t a1 = 0.48829f;
+    const float32_t a2 = 0.14128f;
+    const float32_t a3 = 0.01168f;
+    float32_t phase = (2.0f * PI * (float32_t)n) / (float32_t)(size - 1u);
+
+    return a0 - (a1 * arm_cos_f32(phase)) + (a2 * arm_cos_f32(2.0f * phase)) - (a3 * arm_cos_f32(3.0f * phase));
+}
+
+/*******************************************************************************
+ * Function Name: init_window
+ *******************************************************************************
+ * Summary:
+ *   Computes a Blackman-Harris window normalized to unity coherent gain. The
+ *   fixed point window is divided by RANGE_FFT_WINDOW_HEADROOM.
+ *
+ * Parameters:
+ *   window: output window
+ *   size: window length
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void init_window(range_sample_t* window, uint32_t size)
+{
+    float32_t sum = 0.0f;
+    float32_t gain;
+
+    for (uint32_t n = 0; n < size; ++n)
+    {
+        sum += window_value(n, size);
+    }
+
+    gain = (float32_t)size / sum;
+#if (RANGE_FFT_FIXED_POINT != 0)
+    gain /= (float32_t)RANGE_FFT_WINDOW_HEADROOM;
+#endif
+
+    for (uint32_t n = 0; n < size; ++n)
+    {
+        float32_t value = window_value(n, size) * gain;
+
+#if (RANGE_FFT_FIXED_POINT != 0)
+        FLOAT_TO_SAMPLE(&value, &window[n], 1);
+#else
+        window[n] = value;
+#endif
+    }
+}
+
+#if (RANGE_FFT_FIXED_POINT != 0)
+/*******************************************************************************
+ * Function Name: process_fixed
+ *******************************************************************************
+ * Summary:
+ *   Fixed point range processing, see range_fft_process. The clutter estimate
+ *   is updated in Q31 so that the small updates of a slow time constant are
+ *   not lost, additions and subtractions saturate.
+ *
+ * Parameters:
+ *   rf: front end state
+ *   chirp: fft_size samples
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+HOT_PATH_FUNC static void process_fixed(range_fft_t* rf, const range_sample_t* chirp)
+{
+    uint32_t num_bins = rf->fft_size / 2u;
+    range_sample_t mean;
+
+    SAMPLE_MEAN(chirp, rf->fft_size, &mean);
+    SAMPLE_OFFSET(chirp, (range_sample_t)-mean, rf->input, rf->fft_size);
+    SAMPLE_MULT(rf->input, rf->window, rf->input, rf->fft_size);
+
+    RFFT(&rf->rfft, rf->input, rf->spectrum);
+
+    /* The imaginary part of the DC bin is 0, kept in line with the float32 variant */
+    rf->spectrum[1] = 0;
+
+    if (!rf->clutter_valid)
+    {
+        for (uint32_t i = 0; i < (2u * num_bins); ++i)
+        {
+            rf->clutter[i] = SAMPLE_TO_Q31(rf->spectrum[i]);
+        }
+        rf->clutter_valid = true;
+    }
+
+    for (uint32_t i = 0; i < (2u * num_bins); ++i)
+    {
+        q31_t sample = SAMPLE_TO_Q31(rf->spectrum[i]);
+        q31_t delta = __QSUB(sample, rf->clutter[i]);
+
+        /* clutter += alpha * (spectrum - clutter) */
+        rf->clutter[i] = __QADD(rf->clutter[i], (q31_t)(((q63_t)delta * rf->clutter_alpha) >> 31));
+        rf->residual[i] = Q31_TO_SAMPLE(__QSUB(sample, rf->clutter[i]));
+    }
+
+    SAMPLE_CMPLX_MAG(rf->residual, rf->input, num_bins);
+    SAMPLE_TO_FLOAT(rf->input, rf->magnitude, num_bins);
+    arm_scale_f32(rf->magnitude, rf->magnitude_scale, rf->magnitude, num_bins);
+}
+#endif
+
+/*******************************************************************************
+ * Function Name: range_fft_rfft_init_f32
+ *******************************************************************************
+ * Summary:
+ *   Initializes a float32 real FFT with the init function of its size. Unlike
+ *   arm_rfft_fast_init_f32, it links only the tables of 32 to
+ *   RANGE_FFT_MAX_SIZE points, which the GCC linker script places in RAM for
+ *   the chirp length in use.
+ *
+ * Parameters:
+ *   instance: real FFT instance
+ *   fft_size: 32, 64 or 128
+ *
+ * Return:
+ *   ARM_MATH_SUCCESS, ARM_MATH_ARGUMENT_ERROR if the size is not supported
+ ******************************************************************************/
+arm_status range_fft_rfft_init_f32(arm_rfft_fast_instance_f32* instance, uint32_t fft_size)
+{
+    switch (fft_size)
+    {
+        case 32u:
+            return arm_rfft_fast_init_32_f32(instance);
+        case 64u:
+            return arm_rfft_fast_init_64_f32(instance);
+        case 128u:
+            return arm_rfft_fast_init_128_f32(instance);
+        default:
+            return ARM_MATH_ARGUMENT_ERROR;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: range_fft_init
+ *******************************************************************************
+ * Summary:
+ *   Initializes the FFT instance and window for the given chirp length.
+ *
+ * Parameters:
+ *   rf: front end state
+ *   fft_size: samples per chirp, a power of two up to RANGE_FFT_MAX_SIZE with
+ *     its RFFT tables linked
+ *   bin_length: meters per range bin
+ *
+ * Return:
+ *   0 on success, -1 if the size is not supported
+ ******************************************************************************/
+int32_t range_fft_init(range_fft_t* rf, uint32_t fft_size, float32_t bin_length)
+{
+    memset(rf, 0, sizeof(*rf));
+
+#if (RANGE_FFT_FIXED_POINT != 0)
+    if ((fft_size > RANGE_FFT_MAX_SIZE) || (RFFT_INIT(&rf->rfft, fft_size) != ARM_MATH_SUCCESS))
+    {
+        return -1;
+    }
+
+    /* The fixed point RFFT scales its output down by fft_size, e.g. 1.15 in
+     * and 8.8 out at 128 points: fft_size / 2 in the complex FFT and 2 in
+     * the split into the real spectrum
+     */
+    rf->clutter_alpha = (q31_t)(RANGE_FFT_CLUTTER_ALPHA * 2147483648.0f);
+    rf->profile.sample_scale = ((float32_t)fft_size * (float32_t)RANGE_FFT_WINDOW_HEADROOM) /
+                               (float32_t)(1ULL << SAMPLE_FRAC_BITS);
+
+    /* The complex magnitude is one integer bit wider than the samples */
+    rf->magnitude_scale = 2.0f * rf->profile.sample_scale * (float32_t)(1ULL << SAMPLE_FRAC_BITS);
+#else
+    if ((fft_size > RANGE_FFT_MAX_SIZE) || (range_fft_rfft_init_f32(&rf->rfft, fft_size) != ARM_MATH_SUCCESS))
+    {
+        return -1;
+    }
+
+    rf->clutter_alpha = RANGE_FFT_CLUTTER_ALPHA;
+    rf->profile.sample_scale = 1.0f;
+#endif
+
+    rf->fft_size = fft_size;
+    init_window(rf->window, fft_size);
+
+    rf->profile.magnitude = rf->magnitude;
+    rf->profile.spectrum = rf->spectrum;
+    rf->profile.residual = rf->residual;
+    rf->profile.num_bins = fft_size / 2u;
+    rf->profile.bin_length = bin_length;
+
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: range_fft_process
+ *******************************************************************************
+ * Summary:
+ *   Computes the range profile of a chirp: mean removal, window, real FFT,
+ *   static clutter removal on the complex spectrum and magnitude. The
+ *   arithmetic is selected by RANGE_FFT_FIXED_POINT.
+ *
+ * Parameters:
+ *   rf: front end state
+ *   chirp: fft_size samples
+ *
+ * Return:
+ *   range profile, owned by rf
+ ******************************************************************************/
+HOT_PATH_FUNC const range_profile_t* range_fft_process(range_fft_t* rf, const range_sample_t* chirp)
+{
+#if (RANGE_FFT_FIXED_POINT != 0)
+    process_fixed(rf, chirp);
+#else
+    uint32_t num_bins = rf->fft_size / 2u;
+    float32_t mean;
+
+    arm_mean_f32(chirp, rf->fft_size, &mean);
+    arm_offset_f32(chirp, -mean, rf->input, rf->fft_size);
+    arm_mult_f32(rf->input, rf->window, rf->input, rf->fft_size);
+
+    arm_rfft_fast_f32(&rf->rfft, rf->input, rf->spectrum, 0);
+
+    /* The imaginary part of the DC bin holds the Nyquist bin which is not used */
+    rf->spectrum[1] = 0.0f;
+
+    if (!rf->clutter_valid)
+    {
+        arm_copy_f32(rf->spectrum, rf->clutter, 2u * num_bins);
+        rf->clutter_valid = true;
+    }
+    else
+    {
+        /* clutter += alpha * (spectrum - clutter) */
+        arm_sub_f32(rf->spectrum, rf->clutter, rf->residual, 2u * num_bins);
+        arm_scale_f32(rf->residual, rf->clutter_alpha, rf->residual, 2u * num_bins);
+        arm_add_f32(rf->clutter, rf->residual, rf->clutter, 2u * num_bins);
+    }
+
+    arm_sub_f32(rf->spectrum, rf->clutter, rf->residual, 2u * num_bins);
+    arm_cmplx_mag_f32(rf->residual, rf->magnitude, num_bins);
+#endif
+
+    ++rf->profile.frame_count;
+    return &rf->profile;
+}
+
+/*******************************************************************************
+ * Function Name: range_fft_account
+ *******************************************************************************
+ * Summary:
+ *   Records the cycles the caller measured for one range_fft_process call
+ *   and prints the statistics periodically.
+ *
+ * Parameters:
+ *   rf: front end state
+ *   cycles: measured cycles
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void range_fft_account(range_fft_t* rf, uint32_t cycles)
+{
+    range_fft_stats_t* stats = &rf->stats;
+
+    ++stats->frames;
+    stats->last_cycles = cycles;
+    stats->total_cycles += cycles;
+    if (cycles > stats->max_cycles)
+    {
+        stats->max_cycles = cycles;
+    }
+
+    if ((stats->frames % RANGE_FFT_STATS_PRINT_INTERVAL) == 0u)
+    {
+        printf("[INFO] range FFT %" PRIu32 " points %s: avg %" PRIu32 " max %" PRIu32 " cycles per frame\n",
+               rf->fft_size, (RANGE_FFT_FIXED_POINT == 15) ? "Q15" : ((RANGE_FFT_FIXED_POINT == 31) ? "Q31" : "f32"),
+               (uint32_t)(stats->total_cycles / stats->frames), stats->max_cycles);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: range_fft_get_clutter
+ *******************************************************************************
+ * Summary:
+ *   Copies the static clutter estimate, e.g. into a warm start snapshot. The
+ *   estimate is copied on the float32 scale whatever the arithmetic.
+ *
+ * Parameters:
+ *   rf: front end state
+ *   clutter: destination of RANGE_FFT_MAX_SIZE values
+ *
+ * Return:
+ *   number of complex bins copied, 0 if there is no estimate yet
+ ******************************************************************************/
+uint32_t range_fft_get_clutter(const range_fft_t* rf, float32_t* clutter)
+{
+    uint32_t num_bins = rf->fft_size / 2u;
+
+    if (!rf->clutter_valid)
+    {
+        return 0;
+    }
+
+#if (RANGE_FFT_FIXED_POINT != 0)
+    arm_q31_to_float(rf->clutter, clutter, 2u * num_bins);
+    arm_scale_f32(clutter, rf->profile.sample_scale * (float32_t)(1ULL << SAMPLE_FRAC_BITS), clutter, 2u * num_bins);
+#else
+    memcpy(clutter, rf->clutter, 2u * num_bins * sizeof(float32_t));
+#endif
+    return num_bins;
+}
+
+/*******************************************************************************
+ * Function Name: range_fft_set_clutter
+ *******************************************************************************
+ * Summary:
+ *   Restores a static clutter estimate learned with the same FFT size, so the
+ *   first frame is not taken as clutter. The estimate is on the float32 scale.
+ *
+ * Parameters:
+ *   rf: front end state
+ *   clutter: complex bins, re/im pairs
+ *   num_bins: number of complex bins
+ *
+ * Return:
+ *   true if the estimate was restored
+ ******************************************************************************/
+bool range_fft_set_clutter(range_fft_t* rf, const float32_t* clutter, uint32_t num_bins)
+{
+    if ((num_bins == 0u) || (num_bins != (rf->fft_size / 2u)))
+    {
+        return false;
+    }
+
+#if (RANGE_FFT_FIXED_POINT != 0)
+    for (uint32_t i = 0; i < (2u * num_bins); ++i)
+    {
+        float32_t value = clutter[i] / (rf->profile.sample_scale * (float32_t)(1ULL << SAMPLE_FRAC_BITS));
+
+        arm_float_to_q31(&value, &rf->clutter[i], 1);
+    }
+#else
+    memcpy(rf->clutter, clutter, 2u * num_bins * sizeof(float32_t));
+#endif
+    rf->clutter_valid = true;
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: range_fft_benchmark
+ *******************************************************************************
+ * Summary:
+ *   Measures with RANGE_FFT_BENCHMARK the cycles of range_fft_process on
+ *   RANGE_FFT_BENCH_FRAMES noisy chirps of a tone at every chirp length from
+ *   32 to RANGE_FFT_MAX_SIZE, and prints them. Does nothing otherwise. Run it
+ *   before the front end is initialized, while the other tasks are idle.
+ *
+ * Parameters:
+ *   rf: front end state, initialized again by the caller afterwards
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void range_fft_benchmark(range_fft_t* rf)
+{
+#if (RANGE_FFT_BENCHMARK != 0)
+    static range_sample_t chirp[RANGE_FFT_MAX_SIZE];
+    uint32_t noise = 1u;
+
+    cycle_counter_init();
+
+    for (uint32_t size = 32u; size <= RANGE_FFT_MAX_SIZE; size *= 2u)
+    {
+        uint64_t total_cycles = 0;
+        uint32_t max_cycles = 0;
+
+        if (range_fft_init(rf, size, 0.0f) != 0)
+        {
+            printf("[WARN] range FFT benchmark: %" PRIu32 " points not supported\n", size);
+            continue;
+        }
+
+        for (uint32_t frame = 0; frame < RANGE_FFT_BENCH_FRAMES; ++frame)
+        {
+            uint32_t start;
+            uint32_t cycles;
+
+            /* Half scale 12 bit samples of a tone, with noise so that no frame is the clutter */
+            for (uint32_t n = 0; n < size; ++n)
+            {
+                float32_t value;
+
+                noise = (noise * 1664525u) + 1013904223u;
+                value = 0.5f + (0.1f * arm_cos_f32((2.0f * PI * 10.3f * (float32_t)n) / (float32_t)size)) +
+                        ((float32_t)(noise >> 24) / 65536.0f);
+#if (RANGE_FFT_FIXED_POINT != 0)
+                FLOAT_TO_SAMPLE(&value, &chirp[n], 1);
+#else
+                chirp[n] = value;
+#endif
+            }
+
+            start = cycle_counter_get();
+            (void)range_fft_process(rf, chirp);
+            cycles = cycle_counter_elapsed(start);
+
+            total_cycles += cycles;
+            if (cycles > max_cycles)
+            {
+                max_cycles = cycles;
+            }
+        }
+
+        printf("[INFO] range FFT benchmark %" PRIu32 " points %s: avg %" PRIu32 " max %" PRIu32 " cycles, %" PRIu32
+               " us\n", size, (RANGE_FFT_FIXED_POINT == 15) ? "Q15" : ((RANGE_FFT_FIXED_POINT == 31) ? "Q31" : "f32"),
+               (uint32_t)(total_cycles / RANGE_FFT_BENCH_FRAMES), max_cycles,
+               cycle_counter_to_us((uint32_t)(total_cycles / RANGE_FFT_BENCH_FRAMES)));
+    }
+#else
+    (void)rf;
+#endif
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,154 @@
+/******************************************************************************
+ * File Name:   range_fft.h
+ *
+ * Description: This file contains the function prototypes and constants used
+ *   in range_fft.c.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#pragma once
+
+/* Header file from system */
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Header file for library */
+#include "arm_math.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Set to 0 to leave range processing to the presence library only */
+#define RANGE_FFT_ENABLED                   (1)
+
+/* Largest chirp length, the Makefile links the RFFT tables up to 128 points,
+ * see range_fft_rfft_init_f32
+ */
+#define RANGE_FFT_MAX_SIZE                  (128u)
+
+/* Update weight of the static clutter estimate, time constant of
+ * 1 / RANGE_FFT_CLUTTER_ALPHA frames
+ */
+#define RANGE_FFT_CLUTTER_ALPHA             (0.01f)
+
+/* Statistics are printed every time this many frames have been processed */
+#define RANGE_FFT_STATS_PRINT_INTERVAL      (2000u)
+
+/* Set to 1 to measure the cycles of range_fft_process at every chirp length
+ * up to RANGE_FFT_MAX_SIZE at boot, build once per RANGE_FFT_FIXED_POINT
+ * value to compare the variants
+ */
+#ifndef RANGE_FFT_BENCHMARK
+#define RANGE_FFT_BENCHMARK                 (0)
+#endif
+#define RANGE_FFT_BENCH_FRAMES              (1000u)
+
+/* Arithmetic of the range processing: 0 for float32, 15 for Q15 or 31 for
+ * Q31. The fixed point variants take the average chirp in the sample format,
+ * keep the clutter estimate in Q31 and convert only the magnitude to float32.
+ */
+#ifndef RANGE_FFT_FIXED_POINT
+#define RANGE_FFT_FIXED_POINT               (0)
+#endif
+
+#if (RANGE_FFT_FIXED_POINT != 0) && (RANGE_FFT_FIXED_POINT != 15) && (RANGE_FFT_FIXED_POINT != 31)
+#error "RANGE_FFT_FIXED_POINT must be 0, 15 or 31"
+#endif
+
+/* The fixed point window is divided by this so that its peak, about 2.8 with
+ * unity coherent gain, stays below 1
+ */
+#define RANGE_FFT_WINDOW_HEADROOM           (4u)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+/* Sample of the chirp and of the complex spectrum */
+#if (RANGE_FFT_FIXED_POINT == 15)
+typedef q15_t range_sample_t;
+typedef arm_rfft_instance_q15 range_rfft_instance_t;
+#elif (RANGE_FFT_FIXED_POINT == 31)
+typedef q31_t range_sample_t;
+typedef arm_rfft_instance_q31 range_rfft_instance_t;
+#else
+typedef float32_t range_sample_t;
+typedef arm_rfft_fast_instance_f32 range_rfft_instance_t;
+#endif
+
+/* Range profile of the last processed chirp, valid until the next call */
+typedef struct
+{
+    const float32_t* magnitude;         /* clutter free magnitude per range bin */
+    const range_sample_t* spectrum;     /* complex spectrum before clutter removal, re/im pairs */
+    const range_sample_t* residual;     /* complex spectrum after clutter removal, re/im pairs */
+    float32_t sample_scale;             /* spectrum sample to the float32 scale, 1 for float32 */
+    uint32_t num_bins;
+    float32_t bin_length;               /* meters per range bin */
+    uint32_t frame_count;
+} range_profile_t;
+
+typedef struct
+{
+    uint32_t frames;
+    uint32_t last_cycles;
+    uint32_t max_cycles;
+    uint64_t total_cycles;
+} range_fft_stats_t;
+
+typedef struct
+{
+    range_rfft_instance_t rfft;
+    uint32_t fft_size;
+    bool clutter_valid;
+#if (RANGE_FFT_FIXED_POINT != 0)
+    q31_t clutter_alpha;
+    float32_t magnitude_scale;                      /* magnitude output of the DSP library to float32 */
+    range_sample_t window[RANGE_FFT_MAX_SIZE];      /* divided by RANGE_FFT_WINDOW_HEADROOM */
+    range_sample_t input[RANGE_FFT_MAX_SIZE];       /* windowed chirp, then the fixed point magnitude */
+    range_sample_t spectrum[2u * RANGE_FFT_MAX_SIZE];   /* the FFT writes fft_size complex bins, the
+                                                         * first fft_size / 2 are used */
+    q31_t clutter[RANGE_FFT_MAX_SIZE];              /* fft_size / 2 complex bins */
+#else
+    float32_t clutter_alpha;
+    float32_t window[RANGE_FFT_MAX_SIZE];
+    float32_t input[RANGE_FFT_MAX_SIZE];            /* windowed chirp, overwritten by the FFT */
+    float32_t spectrum[RANGE_FFT_MAX_SIZE];         /* fft_size / 2 complex bins */
+    float32_t clutter[RANGE_FFT_MAX_SIZE];          /* fft_size / 2 complex bins */
+#endif
+    range_sample_t residual[RANGE_FFT_MAX_SIZE];    /* fft_size / 2 complex bins */
+    float32_t magnitude[RANGE_FFT_MAX_SIZE / 2u];
+    range_profile_t profile;
+    range_fft_stats_t stats;
+} range_fft_t;
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+arm_status range_fft_rfft_init_f32(arm_rfft_fast_instance_f32* instance, uint32_t fft_size);
+int32_t range_fft_init(range_fft_t* rf, uint32_t fft_size, float32_t bin_length);
+const range_profile_t* range_fft_process(range_fft_t* rf, const range_sample_t* chirp);
+void range_fft_account(range_fft_t* rf, uint32_t cycles);
+uint32_t range_fft_get_clutter(const range_fft_t* rf, float32_t* clutter);
+bool range_fft_set_clutter(range_fft_t* rf, const float32_t* clutter, uint32_t num_bins);
+void range_fft_benchmark(range_fft_t* rf);
+
+/* [] END OF FILE */
@@ -57,6 +57,23 @@
 #define PIN_XENSIV_BGT60TRXX_RSTN           CYBSP_GPIO11
 #define PIN_XENSIV_BGT60TRXX_LDO_EN         CYBSP_GPIO5
 
+/* Further sensors, see RADAR_NUM_SENSORS. They share the SPI bus and LDO_EN
+ * of the first sensor, each one has its own chip select, interrupt and
+ * reset. The kit has free pins for two more sensors; assign the pins of a
+ * fourth one on the board in use.
+ */
+#define PIN_XENSIV_BGT60TRXX_2_SPI_CSN      CYBSP_GPIO6
+#define PIN_XENSIV_BGT60TRXX_2_IRQ          CYBSP_GPIO9
+#define PIN_XENSIV_BGT60TRXX_2_RSTN         CYBSP_GPIO12
+
+#define PIN_XENSIV_BGT60TRXX_3_SPI_CSN      CYBSP_GPIO13
+#define PIN_XENSIV_BGT60TRXX_3_IRQ          CYBSP_GPIOA3
+#define PIN_XENSIV_BGT60TRXX_3_RSTN         CYBSP_GPIOA4
+
+#define PIN_XENSIV_BGT60TRXX_4_SPI_CSN      NC
+#define PIN_XENSIV_BGT60TRXX_4_IRQ          NC
+#define PIN_XENSIV_BGT60TRXX_4_RSTN         NC
+
 // #endif
 
 
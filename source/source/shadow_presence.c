@@ -0,0 +1,341 @@
+/*****************************************************************************
+ * File name: shadow_presence.c
+ *
+ * Description: This file contains the shadow presence detector. A second
+ * instance of the presence library runs on the frames of the production
+ * detector with thresholds under evaluation. It follows every other field of
+ * the production configuration, only runs while the production processing
+ * leaves enough of the frame period and reports its events to a callback
+ * that never drives the LEDs or the presence telemetry.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Header file for local task */
+#include "shadow_presence.h"
+
+/*******************************************************************************
+ * Function Name: config_equal
+ *******************************************************************************
+ * Summary:
+ *   Compares two presence configurations field by field, the padding of the
+ *   structures is not defined.
+ *
+ * Parameters:
+ *   a: first configuration
+ *   b: second configuration
+ *
+ * Return:
+ *   true if all fields are equal
+ ******************************************************************************/
+static bool config_equal(const xensiv_radar_presence_config_t* a, const xensiv_radar_presence_config_t* b)
+{
+    return (a->bandwidth == b->bandwidth) &&
+           (a->num_samples_per_chirp == b->num_samples_per_chirp) &&
+           (a->micro_fft_decimation_enabled == b->micro_fft_decimation_enabled) &&
+           (a->micro_fft_size == b->micro_fft_size) &&
+           (a->macro_threshold == b->macro_threshold) &&
+           (a->micro_threshold == b->micro_threshold) &&
+           (a->min_range_bin == b->min_range_bin) &&
+           (a->max_range_bin == b->max_range_bin) &&
+           (a->macro_compare_interval_ms == b->macro_compare_interval_ms) &&
+           (a->macro_movement_validity_ms == b->macro_movement_validity_ms) &&
+           (a->micro_movement_validity_ms == b->micro_movement_validity_ms) &&
+           (a->macro_movement_confirmations == b->macro_movement_confirmations) &&
+           (a->macro_trigger_range == b->macro_trigger_range) &&
+           (a->mode == b->mode) &&
+           (a->macro_fft_bandpass_filter_enabled == b->macro_fft_bandpass_filter_enabled) &&
+           (a->micro_movement_compare_idx == b->micro_movement_compare_idx);
+}
+
+/*******************************************************************************
+ * Function Name: shadow_event_cb
+ *******************************************************************************
+ * Summary:
+ *   Presence library callback of the shadow instance.
+ *
+ * Parameters:
+ *   handle: shadow instance
+ *   event: presence event
+ *   data: shadow detector state
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void shadow_event_cb(xensiv_radar_presence_handle_t handle,
+                            const xensiv_radar_presence_event_t* event, void* data)
+{
+    shadow_presence_t* sp = (shadow_presence_t*)data;
+
+    (void)handle;
+
+    ++sp->stats.events;
+    if (sp->callback != NULL)
+    {
+        sp->callback(event, sp->callback_data);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: shadow_presence_init
+ *******************************************************************************
+ * Summary:
+ *   Initializes the shadow detector disabled.
+ *
+ * Parameters:
+ *   sp: shadow detector state
+ *   frame: buffer for the copy of a frame
+ *   num_samples: samples of a frame processed by the presence library
+ *   callback: called for every shadow event
+ *   callback_data: passed to callback
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void shadow_presence_init(shadow_presence_t* sp, float32_t* frame, uint32_t num_samples,
+                          shadow_presence_cb_t callback, void* callback_data)
+{
+    memset(sp, 0, sizeof(*sp));
+    sp->frame = frame;
+    sp->num_samples = num_samples;
+    sp->callback = callback;
+    sp->callback_data = callback_data;
+}
+
+/*******************************************************************************
+ * Function Name: shadow_presence_set_thresholds
+ *******************************************************************************
+ * Summary:
+ *   Sets the thresholds under evaluation, applied by the next
+ *   shadow_presence_configure. The detector is enabled while at least one
+ *   threshold is set.
+ *
+ * Parameters:
+ *   sp: shadow detector state
+ *   macro_threshold: macro threshold, 0 for the production value
+ *   micro_threshold: micro threshold, 0 for the production value
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void shadow_presence_set_thresholds(shadow_presence_t* sp, float macro_threshold, float micro_threshold)
+{
+    sp->macro_threshold = macro_threshold;
+    sp->micro_threshold = micro_threshold;
+}
+
+/*******************************************************************************
+ * Function Name: shadow_presence_configure
+ *******************************************************************************
+ * Summary:
+ *   Follows the production configuration with the thresholds under
+ *   evaluation. Allocates the shadow instance when it is enabled, frees it
+ *   when it is disabled and restarts it when its configuration changes.
+ *
+ * Parameters:
+ *   sp: shadow detector state
+ *   production: configuration of the production detector
+ *
+ * Return:
+ *   true if the shadow detector runs
+ ******************************************************************************/
+bool shadow_presence_configure(shadow_presence_t* sp, const xensiv_radar_presence_config_t* production)
+{
+    xensiv_radar_presence_config_t config = *production;
+
+    if ((sp->macro_threshold <= 0.0f) && (sp->micro_threshold <= 0.0f))
+    {
+        if (sp->handle != NULL)
+        {
+            xensiv_radar_presence_free(sp->handle);
+            sp->handle = NULL;
+            printf("[INFO] shadow presence stopped\n");
+        }
+        return false;
+    }
+
+    if (sp->macro_threshold > 0.0f)
+    {
+        config.macro_threshold = sp->macro_threshold;
+    }
+    if (sp->micro_threshold > 0.0f)
+    {
+        config.micro_threshold = sp->micro_threshold;
+    }
+
+    if (sp->handle == NULL)
+    {
+        if (xensiv_radar_presence_alloc(&sp->handle, &config) != XENSIV_RADAR_PRESENCE_OK)
+        {
+            /* Not enough memory, the evaluation is abandoned */
+            printf("[WARN] shadow presence allocation failed\n");
+            sp->handle = NULL;
+            sp->macro_threshold = 0.0f;
+            sp->micro_threshold = 0.0f;
+            return false;
+        }
+
+        xensiv_radar_presence_set_callback(sp->handle, shadow_event_cb, sp);
+        sp->config = config;
+        sp->cost_us = 0;
+        printf("[INFO] shadow presence started, macro %.2f micro %.2f\n",
+               config.macro_threshold, config.micro_threshold);
+    }
+    else if (!config_equal(&config, &sp->config))
+    {
+        if (xensiv_radar_presence_set_config(sp->handle, &config) == XENSIV_RADAR_PRESENCE_OK)
+        {
+            sp->config = config;
+        }
+        xensiv_radar_presence_reset(sp->handle);
+    }
+    else
+    {
+        /* Unchanged */
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: shadow_presence_active
+ *******************************************************************************
+ * Summary:
+ *   Tells if the shadow detector runs.
+ *
+ * Parameters:
+ *   sp: shadow detector state
+ *
+ * Return:
+ *   true if the shadow instance is allocated
+ ******************************************************************************/
+bool shadow_presence_active(const shadow_presence_t* sp)
+{
+    return (sp->handle != NULL);
+}
+
+/*******************************************************************************
+ * Function Name: shadow_presence_capture
+ *******************************************************************************
+ * Summary:
+ *   Copies the frame before the production detector processes it.
+ *
+ * Parameters:
+ *   sp: shadow detector state
+ *   frame: preprocessed frame
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void shadow_presence_capture(shadow_presence_t* sp, const float32_t* frame)
+{
+    if (sp->handle != NULL)
+    {
+        memcpy(sp->frame, frame, sp->num_samples * sizeof(float32_t));
+        sp->captured = true;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: shadow_presence_process
+ *******************************************************************************
+ * Summary:
+ *   Processes the captured frame if the expected processing time fits into
+ *   the time left in the frame period. Skipped frames leave a gap in the
+ *   slow time of the shadow instance and are counted.
+ *
+ * Parameters:
+ *   sp: shadow detector state
+ *   time_ms: time of the frame
+ *   available_us: time left for the shadow detector
+ *
+ * Return:
+ *   true if the frame was processed, see shadow_presence_account
+ ******************************************************************************/
+bool shadow_presence_process(shadow_presence_t* sp, uint32_t time_ms, uint32_t available_us)
+{
+    if ((sp->handle == NULL) || !sp->captured)
+    {
+        return false;
+    }
+
+    sp->captured = false;
+    ++sp->stats.frames;
+
+    if (sp->cost_us > available_us)
+    {
+        ++sp->stats.skipped_frames;
+        return false;
+    }
+
+    if (xensiv_radar_presence_process_frame(sp->handle, sp->frame, time_ms) != XENSIV_RADAR_PRESENCE_OK)
+    {
+        printf("[WARN] shadow presence frame processing failed\n");
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: shadow_presence_account
+ *******************************************************************************
+ * Summary:
+ *   Records the time the caller measured for one processed frame, updates the
+ *   expected processing time and prints the statistics periodically.
+ *
+ * Parameters:
+ *   sp: shadow detector state
+ *   cycles: measured cycles
+ *   us: measured time in us
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void shadow_presence_account(shadow_presence_t* sp, uint32_t cycles, uint32_t us)
+{
+    shadow_presence_stats_t* stats = &sp->stats;
+
+    /* Follows increases at once and decreases slowly */
+    sp->cost_us = (us > sp->cost_us) ? us : (sp->cost_us - ((sp->cost_us - us) / 8u));
+
+    ++stats->processed_frames;
+    stats->last_cycles = cycles;
+    stats->total_cycles += cycles;
+    if (cycles > stats->max_cycles)
+    {
+        stats->max_cycles = cycles;
+    }
+
+    if ((stats->processed_frames % SHADOW_PRESENCE_STATS_PRINT_INTERVAL) == 0u)
+    {
+        printf("[INFO] shadow presence: avg %" PRIu32 " max %" PRIu32 " cycles per frame, %" PRIu32
+               " of %" PRIu32 " frames skipped, %" PRIu32 " events\n",
+               (uint32_t)(stats->total_cycles / stats->processed_frames), stats->max_cycles,
+               stats->skipped_frames, stats->frames, stats->events);
+    }
+}
+
+/* [] END OF FILE */
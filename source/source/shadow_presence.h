@@ -0,0 +1,103 @@
+/******************************************************************************
+ * File Name:   shadow_presence.h
+ *
+ * Description: This file contains the function prototypes and constants used
+ *   in shadow_presence.c.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+
+#pragma once
+
+/* Header file from system */
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Header file for library */
+#include "arm_math.h"
+#include "xensiv_radar_presence.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Set to 0 to remove the shadow presence detector */
+#define SHADOW_PRESENCE_ENABLED             (1)
+
+/* Share of the frame period, in permille, the production processing and the
+ * shadow detector may use together. The shadow frame is skipped otherwise.
+ */
+#define SHADOW_PRESENCE_BUDGET_PERMILLE     (700u)
+
+/* Statistics are printed every time this many frames have been offered */
+#define SHADOW_PRESENCE_STATS_PRINT_INTERVAL (2000u)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef void (*shadow_presence_cb_t)(const xensiv_radar_presence_event_t* event, void* data);
+
+typedef struct
+{
+    uint32_t frames;                    /* offered while enabled */
+    uint32_t skipped_frames;            /* over the CPU budget */
+    uint32_t last_cycles;
+    uint32_t max_cycles;
+    uint64_t total_cycles;
+    uint32_t processed_frames;
+    uint32_t events;
+} shadow_presence_stats_t;
+
+typedef struct
+{
+    xensiv_radar_presence_handle_t handle;  /* NULL while disabled */
+    xensiv_radar_presence_config_t config;  /* applied to handle */
+
+    /* Thresholds under evaluation, 0 keeps the production value */
+    float macro_threshold;
+    float micro_threshold;
+
+    /* Copy of the frame, the library does not take it as const */
+    float32_t* frame;
+    uint32_t num_samples;
+    bool captured;
+
+    uint32_t cost_us;                   /* expected processing time of a frame */
+
+    shadow_presence_cb_t callback;
+    void* callback_data;
+
+    shadow_presence_stats_t stats;
+} shadow_presence_t;
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+void shadow_presence_init(shadow_presence_t* sp, float32_t* frame, uint32_t num_samples,
+                          shadow_presence_cb_t callback, void* callback_data);
+void shadow_presence_set_thresholds(shadow_presence_t* sp, float macro_threshold, float micro_threshold);
+bool shadow_presence_configure(shadow_presence_t* sp, const xensiv_radar_presence_config_t* production);
+bool shadow_presence_active(const shadow_presence_t* sp);
+void shadow_presence_capture(shadow_presence_t* sp, const float32_t* frame);
+bool shadow_presence_process(shadow_presence_t* sp, uint32_t time_ms, uint32_t available_us);
+void shadow_presence_account(shadow_presence_t* sp, uint32_t cycles, uint32_t us);
+
+/* [] END OF FILE */
@@ -68,9 +68,10 @@
 #define MQTT_SUBSCRIBE_RETRY_INTERVAL_MS        (1000)
 
 /* Queue length of a message queue that is used to communicate with the 
- * subscriber task.
+ * subscriber task. Publishes received in a burst are queued and parsed
+ * together, so the MQTT receive context is not held by the parser.
  */
-#define SUBSCRIBER_TASK_QUEUE_LENGTH            (1u)
+#define SUBSCRIBER_TASK_QUEUE_LENGTH            (4u)
 
 /* Max number of subscriptions */
 #define NUMBER_OF_SUBSCRIPTIONS (1u)
@@ -88,6 +89,7 @@ QueueHandle_t subscriber_task_q;
 * Function Prototypes
 *******************************************************************************/
 static void subscribe_to_mqtt_topics(void);
+static bool parse_incoming_publish(subscriber_data_t *subscriber_q_data);
 subs_rslt_t construct_module_subscribe_mqtt_topic(char *topic);
 
 /******************************************************************************
@@ -109,7 +111,6 @@ void subscriber_task(void *pvParameters)
     publisher_data_t publisher_q_data;
     /* To avoid compiler warnings */
     (void) pvParameters;
-    cy_rslt_t result;
 
     /* Subscribe to the specified MQTT topic. */
     subscribe_to_mqtt_topics();
@@ -138,15 +139,20 @@ void subscriber_task(void *pvParameters)
                 case PARSE_INCOMING_PUBLISH:
                 {
                     /* Parse the data received from sensor cloud */
-                    APP_LOG_DEBUG(("PARSE_INCOMING_PUBLISH :- recieved json = %s, json_length = %d",subscriber_q_data.json_data, subscriber_q_data.json_data_length));
-                    result = cy_JSON_parser(subscriber_q_data.json_data, subscriber_q_data.json_data_length);
-                    if (result != CY_RSLT_SUCCESS)
+                    bool parsed = parse_incoming_publish(&subscriber_q_data);
+
+                    /* Parse the publishes already queued behind it as well */
+                    while ((pdTRUE == xQueuePeek(subscriber_task_q, &subscriber_q_data, 0)) &&
+                           (PARSE_INCOMING_PUBLISH == subscriber_q_data.cmd))
                     {
-                        APP_LOG_ERROR(("Device property Json parser error!"));
+                        (void)xQueueReceive(subscriber_task_q, &subscriber_q_data, 0);
+                        parsed = parse_incoming_publish(&subscriber_q_data) || parsed;
                     }
-                    else {
+
+                    if (parsed)
+                    {
                         APP_LOG_DEBUG(("Publishing the DP ack"));
-                        /* Once parsing is done, send an acknowledgement to the cloud */
+                        /* Once parsing is done, send one acknowledgement with the resulting properties to the cloud */
                         publisher_q_data.cmd = PUBLISH_DEVICE_PROPERTIES_UPDATE_ACK;
                         xQueueSend(publisher_task_q, &publisher_q_data, portMAX_DELAY);
                     }
@@ -157,6 +163,37 @@ void subscriber_task(void *pvParameters)
     }
 }
 
+/******************************************************************************
+ * Function Name: parse_incoming_publish
+ ******************************************************************************
+ * Summary:
+ *  Parses a device properties message received from sensor cloud and frees
+ *  its copy made by mqtt_subscription_callback
+ *
+ * Parameters:
+ *  subscriber_data_t *subscriber_q_data : Received message
+ *
+ * Return:
+ *  bool - true if the message was parsed
+ *
+ ******************************************************************************/
+static bool parse_incoming_publish(subscriber_data_t *subscriber_q_data)
+{
+    cy_rslt_t result;
+
+    APP_LOG_DEBUG(("PARSE_INCOMING_PUBLISH :- recieved json = %s, json_length = %d",subscriber_q_data->json_data, subscriber_q_data->json_data_length));
+    result = cy_JSON_parser(subscriber_q_data->json_data, subscriber_q_data->json_data_length);
+    if (result != CY_RSLT_SUCCESS)
+    {
+        APP_LOG_ERROR(("Device property Json parser error!"));
+    }
+
+    free(subscriber_q_data->json_data);
+    subscriber_q_data->json_data = NULL;
+
+    return (result == CY_RSLT_SUCCESS);
+}
+
 /******************************************************************************
  * Function Name: subscribe_to_mqtt_topics
  ******************************************************************************
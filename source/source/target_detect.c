@@ -0,0 +1,304 @@
+/*****************************************************************************
+ * File name: target_detect.c
+ *
+ * Description: This file contains the multi target detection on the range
+ * profile. Every range bin between min and max range is compared against a
+ * CA-CFAR or OS-CFAR threshold, adjacent detections are clustered into one
+ * target at their peak and at most TARGET_DETECT_MAX_TARGETS targets are
+ * kept per frame. All memory is part of the detector state.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Header file for local task */
+#include "hot_path.h"
+#include "target_detect.h"
+
+/*******************************************************************************
+ * Function Name: noise_level
+ *******************************************************************************
+ * Summary:
+ *   Estimates the noise level around a cell from the training cells on both
+ *   sides, the DC bin is not used. Near the profile edges only the available
+ *   side contributes.
+ *
+ * Parameters:
+ *   td: detector state
+ *   profile: range profile
+ *   cell: cell under test
+ *
+ * Return:
+ *   noise level
+ ******************************************************************************/
+HOT_PATH_FUNC static float32_t noise_level(const target_detect_t* td, const range_profile_t* profile, uint32_t cell)
+{
+    float32_t training[2u * TARGET_DETECT_TRAINING_CELLS];
+    uint32_t count = 0;
+    const uint32_t offset_min = TARGET_DETECT_GUARD_CELLS + 1u;
+    const uint32_t offset_max = TARGET_DETECT_GUARD_CELLS + TARGET_DETECT_TRAINING_CELLS;
+
+    for (uint32_t offset = offset_min; offset <= offset_max; ++offset)
+    {
+        if (cell >= (offset + 1u))
+        {
+            training[count++] = profile->magnitude[cell - offset];
+        }
+
+        if ((cell + offset) < profile->num_bins)
+        {
+            training[count++] = profile->magnitude[cell + offset];
+        }
+    }
+
+    if (count == 0u)
+    {
+        return 0.0f;
+    }
+
+    if (td->method == TARGET_DETECT_OS_CFAR)
+    {
+        uint32_t rank = (count * TARGET_DETECT_OS_RANK_QUARTERS) / 4u;
+
+        /* Insertion sort, at most 2 * TARGET_DETECT_TRAINING_CELLS cells */
+        for (uint32_t i = 1; i < count; ++i)
+        {
+            float32_t value = training[i];
+            uint32_t j = i;
+
+            while ((j > 0u) && (training[j - 1u] > value))
+            {
+                training[j] = training[j - 1u];
+                --j;
+            }
+            training[j] = value;
+        }
+
+        return training[(rank < count) ? rank : (count - 1u)];
+    }
+    else
+    {
+        float32_t sum = 0.0f;
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            sum += training[i];
+        }
+
+        return sum / (float32_t)count;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: add_target
+ *******************************************************************************
+ * Summary:
+ *   Adds a closed cluster to the target list. Clusters are closed in range
+ *   order; if the list is full the weakest target is replaced.
+ *
+ * Parameters:
+ *   td: detector state
+ *   target: cluster
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void add_target(target_detect_t* td, const target_t* target)
+{
+    target_list_t* list = &td->list;
+
+    if (list->count == TARGET_DETECT_MAX_TARGETS)
+    {
+        uint32_t weakest = 0;
+
+        ++td->stats.dropped_targets;
+
+        for (uint32_t i = 1; i < list->count; ++i)
+        {
+            if (list->targets[i].magnitude < list->targets[weakest].magnitude)
+            {
+                weakest = i;
+            }
+        }
+
+        if (target->magnitude <= list->targets[weakest].magnitude)
+        {
+            return;
+        }
+
+        /* Keep the range order */
+        memmove(&list->targets[weakest], &list->targets[weakest + 1u],
+                (list->count - weakest - 1u) * sizeof(target_t));
+        --list->count;
+    }
+
+    list->targets[list->count++] = *target;
+}
+
+/*******************************************************************************
+ * Function Name: target_detect_init
+ *******************************************************************************
+ * Summary:
+ *   Initializes the detector with an empty range, see target_detect_set_range.
+ *
+ * Parameters:
+ *   td: detector state
+ *   method: CFAR method
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void target_detect_init(target_detect_t* td, target_detect_method_t method)
+{
+    memset(td, 0, sizeof(*td));
+    td->method = method;
+}
+
+/*******************************************************************************
+ * Function Name: target_detect_set_range
+ *******************************************************************************
+ * Summary:
+ *   Sets the range bins searched for targets.
+ *
+ * Parameters:
+ *   td: detector state
+ *   min_bin: first range bin
+ *   max_bin: last range bin
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void target_detect_set_range(target_detect_t* td, uint32_t min_bin, uint32_t max_bin)
+{
+    /* The DC bin does not carry targets */
+    td->min_bin = (min_bin > 0u) ? min_bin : 1u;
+    td->max_bin = max_bin;
+}
+
+/*******************************************************************************
+ * Function Name: target_detect_process
+ *******************************************************************************
+ * Summary:
+ *   Detects the targets of a range profile.
+ *
+ * Parameters:
+ *   td: detector state
+ *   profile: range profile of the frame
+ *
+ * Return:
+ *   target list, owned by td and valid until the next call
+ ******************************************************************************/
+HOT_PATH_FUNC target_list_t* target_detect_process(target_detect_t* td, const range_profile_t* profile)
+{
+    uint32_t max_bin = (td->max_bin < profile->num_bins) ? td->max_bin : (profile->num_bins - 1u);
+    bool in_cluster = false;
+    target_t cluster = {0};
+
+    td->list.count = 0;
+    ++td->list.frame_count;
+
+    for (uint32_t bin = td->min_bin; bin <= max_bin; ++bin)
+    {
+        float32_t magnitude = profile->magnitude[bin];
+        float32_t noise = noise_level(td, profile, bin);
+        float32_t threshold = TARGET_DETECT_SCALE * noise;
+
+        td->noise[bin] = noise;
+        threshold = (threshold > TARGET_DETECT_MIN_MAGNITUDE) ? threshold : TARGET_DETECT_MIN_MAGNITUDE;
+
+        if (magnitude > threshold)
+        {
+            if (!in_cluster)
+            {
+                in_cluster = true;
+                cluster.first_bin = bin;
+                cluster.magnitude = 0.0f;
+            }
+
+            cluster.last_bin = bin;
+            if (magnitude > cluster.magnitude)
+            {
+                cluster.range_bin = bin;
+                cluster.magnitude = magnitude;
+                cluster.snr = (noise > 0.0f) ? (magnitude / noise) : (magnitude / TARGET_DETECT_MIN_MAGNITUDE);
+            }
+        }
+        else if (in_cluster)
+        {
+            in_cluster = false;
+            cluster.distance = (float32_t)cluster.range_bin * profile->bin_length;
+            add_target(td, &cluster);
+        }
+        else
+        {
+            /* No target */
+        }
+    }
+
+    if (in_cluster)
+    {
+        cluster.distance = (float32_t)cluster.range_bin * profile->bin_length;
+        add_target(td, &cluster);
+    }
+
+    return &td->list;
+}
+
+/*******************************************************************************
+ * Function Name: target_detect_account
+ *******************************************************************************
+ * Summary:
+ *   Records the cycles the caller measured for one target_detect_process
+ *   call and prints the statistics periodically.
+ *
+ * Parameters:
+ *   td: detector state
+ *   cycles: measured cycles
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void target_detect_account(target_detect_t* td, uint32_t cycles)
+{
+    target_detect_stats_t* stats = &td->stats;
+
+    ++stats->frames;
+    stats->last_cycles = cycles;
+    stats->total_cycles += cycles;
+    if (cycles > stats->max_cycles)
+    {
+        stats->max_cycles = cycles;
+    }
+
+    if ((stats->frames % TARGET_DETECT_STATS_PRINT_INTERVAL) == 0u)
+    {
+        printf("[INFO] target detection %s bins %" PRIu32 "..%" PRIu32 ": avg %" PRIu32 " max %" PRIu32
+               " cycles per frame, %" PRIu32 " targets dropped\n",
+               (td->method == TARGET_DETECT_OS_CFAR) ? "OS-CFAR" : "CA-CFAR", td->min_bin, td->max_bin,
+               (uint32_t)(stats->total_cycles / stats->frames), stats->max_cycles, stats->dropped_targets);
+    }
+}
+
+/* [] END OF FILE */
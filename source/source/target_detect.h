@@ -0,0 +1,122 @@
+/******************************************************************************
+ * File Name:   target_detect.h
+ *
+ * Description: This file contains the function prototypes and constants used
+ *   in target_detect.c.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#pragma once
+
+/* Header file from system */
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Header file for library */
+#include "arm_math.h"
+
+/* Header file for local task */
+#include "range_fft.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Set to 0 to disable the multi target detection, requires RANGE_FFT_ENABLED */
+#define TARGET_DETECT_ENABLED               (1)
+
+/* Size of the target list of a frame */
+#define TARGET_DETECT_MAX_TARGETS           (4u)
+
+/* Cells left out on each side of the cell under test */
+#define TARGET_DETECT_GUARD_CELLS           (1u)
+
+/* Cells used on each side to estimate the noise level */
+#define TARGET_DETECT_TRAINING_CELLS        (6u)
+
+/* Threshold factor over the noise level */
+#define TARGET_DETECT_SCALE                 (4.0f)
+
+/* Magnitude below which no target is reported whatever the noise level */
+#define TARGET_DETECT_MIN_MAGNITUDE         (0.05f)
+
+/* Rank of the noise cell used by OS-CFAR, in 1/4 of the training cells */
+#define TARGET_DETECT_OS_RANK_QUARTERS      (3u)
+
+/* Statistics are printed every time this many frames have been processed */
+#define TARGET_DETECT_STATS_PRINT_INTERVAL  (2000u)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef enum
+{
+    TARGET_DETECT_CA_CFAR = 0,          /* cell averaging */
+    TARGET_DETECT_OS_CFAR               /* ordered statistic, robust to close targets */
+} target_detect_method_t;
+
+typedef struct
+{
+    uint32_t range_bin;                 /* peak of the cluster */
+    uint32_t first_bin;
+    uint32_t last_bin;
+    float32_t magnitude;                /* at the peak */
+    float32_t snr;                      /* peak magnitude over the noise level */
+    float32_t distance;                 /* meters */
+    float32_t azimuth;                  /* degrees, set by angle_estimate_process */
+    float32_t elevation;                /* degrees, set by angle_estimate_process */
+} target_t;
+
+typedef struct
+{
+    uint32_t count;
+    target_t targets[TARGET_DETECT_MAX_TARGETS];  /* sorted by range */
+    uint32_t frame_count;
+} target_list_t;
+
+typedef struct
+{
+    uint32_t frames;
+    uint32_t last_cycles;
+    uint32_t max_cycles;
+    uint64_t total_cycles;
+    uint32_t dropped_targets;           /* clusters beyond TARGET_DETECT_MAX_TARGETS */
+} target_detect_stats_t;
+
+typedef struct
+{
+    target_detect_method_t method;
+    uint32_t min_bin;
+    uint32_t max_bin;
+    float32_t noise[RANGE_FFT_MAX_SIZE / 2u];
+    target_list_t list;
+    target_detect_stats_t stats;
+} target_detect_t;
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+void target_detect_init(target_detect_t* td, target_detect_method_t method);
+void target_detect_set_range(target_detect_t* td, uint32_t min_bin, uint32_t max_bin);
+target_list_t* target_detect_process(target_detect_t* td, const range_profile_t* profile);
+void target_detect_account(target_detect_t* td, uint32_t cycles);
+
+/* [] END OF FILE */
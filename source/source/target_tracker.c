@@ -0,0 +1,323 @@
+/*****************************************************************************
+ * File name: target_tracker.c
+ *
+ * Description: This file contains a fixed capacity alpha-beta tracker over
+ * the targets detected in every frame. Detections are refined below the
+ * range bin resolution by parabolic interpolation of the range profile and
+ * associated to the predicted tracks by nearest neighbour within a gate.
+ * Tracks are confirmed after a number of hits, deleted after a timeout and
+ * keep their id for their lifetime. The cost per frame is bounded by the
+ * number of tracks and targets, nothing is allocated.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <string.h>
+
+/* Header file for local task */
+#include "target_tracker.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Marks a track or detection that has not been associated */
+#define NOT_ASSOCIATED                      (0xFFu)
+
+/*******************************************************************************
+ * Function Name: remove_track
+ *******************************************************************************
+ * Summary:
+ *   Removes a track, the last track takes its slot.
+ *
+ * Parameters:
+ *   tracker: tracker state
+ *   index: slot of the track
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void remove_track(target_tracker_t* tracker, uint32_t index)
+{
+    --tracker->count;
+    tracker->tracks[index] = tracker->tracks[tracker->count];
+}
+
+/*******************************************************************************
+ * Function Name: birth_track
+ *******************************************************************************
+ * Summary:
+ *   Starts a tentative track at a detection if there is a free slot.
+ *
+ * Parameters:
+ *   tracker: tracker state
+ *   distance: distance of the detection
+ *   time_ms: time of the frame
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void birth_track(target_tracker_t* tracker, float32_t distance, uint32_t time_ms)
+{
+    target_track_t* track;
+
+    if (tracker->count == TARGET_TRACKER_MAX_TRACKS)
+    {
+        return;
+    }
+
+    track = &tracker->tracks[tracker->count++];
+    track->id = tracker->next_id++;
+    if (tracker->next_id == 0u)
+    {
+        tracker->next_id = 1u;
+    }
+    track->confirmed = false;
+    track->hits = 1u;
+    track->last_update_ms = time_ms;
+    track->distance = distance;
+    track->velocity = 0.0f;
+}
+
+/*******************************************************************************
+ * Function Name: target_tracker_init
+ *******************************************************************************
+ * Summary:
+ *   Initializes the tracker without tracks.
+ *
+ * Parameters:
+ *   tracker: tracker state
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void target_tracker_init(target_tracker_t* tracker)
+{
+    memset(tracker, 0, sizeof(*tracker));
+    tracker->next_id = 1u;
+}
+
+/*******************************************************************************
+ * Function Name: target_tracker_interpolate
+ *******************************************************************************
+ * Summary:
+ *   Refines the distance of a peak by fitting a parabola through the peak bin
+ *   and its neighbours.
+ *
+ * Parameters:
+ *   profile: range profile
+ *   range_bin: peak bin
+ *
+ * Return:
+ *   distance in meters
+ ******************************************************************************/
+float32_t target_tracker_interpolate(const range_profile_t* profile, uint32_t range_bin)
+{
+    float32_t offset = 0.0f;
+
+    if ((range_bin > 0u) && ((range_bin + 1u) < profile->num_bins))
+    {
+        float32_t left = profile->magnitude[range_bin - 1u];
+        float32_t peak = profile->magnitude[range_bin];
+        float32_t right = profile->magnitude[range_bin + 1u];
+        float32_t curvature = left - (2.0f * peak) + right;
+
+        /* Only a local maximum has a negative curvature */
+        if (curvature < 0.0f)
+        {
+            offset = (0.5f * (left - right)) / curvature;
+            offset = (offset > 0.5f) ? 0.5f : ((offset < -0.5f) ? -0.5f : offset);
+        }
+    }
+
+    return ((float32_t)range_bin + offset) * profile->bin_length;
+}
+
+/*******************************************************************************
+ * Function Name: target_tracker_update
+ *******************************************************************************
+ * Summary:
+ *   Predicts the tracks to the time of the frame, associates the detections
+ *   by nearest neighbour within TARGET_TRACKER_GATE_M, updates the associated
+ *   tracks, starts tracks at the remaining detections and deletes the tracks
+ *   that timed out.
+ *
+ * Parameters:
+ *   tracker: tracker state
+ *   list: targets detected in the frame
+ *   profile: range profile of the frame
+ *   time_ms: time of the frame
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void target_tracker_update(target_tracker_t* tracker, const target_list_t* list,
+                           const range_profile_t* profile, uint32_t time_ms)
+{
+    float32_t measured[TARGET_DETECT_MAX_TARGETS];
+    uint8_t track_of[TARGET_DETECT_MAX_TARGETS];
+    uint8_t target_of[TARGET_TRACKER_MAX_TRACKS];
+    float32_t dt = 0.0f;
+    uint32_t num_targets = (list->count < TARGET_DETECT_MAX_TARGETS) ? list->count : TARGET_DETECT_MAX_TARGETS;
+
+    if (tracker->time_valid)
+    {
+        dt = (float32_t)(time_ms - tracker->last_time_ms) / 1000.0f;
+    }
+    tracker->last_time_ms = time_ms;
+    tracker->time_valid = true;
+
+    for (uint32_t t = 0; t < tracker->count; ++t)
+    {
+        tracker->tracks[t].distance += tracker->tracks[t].velocity * dt;
+        target_of[t] = NOT_ASSOCIATED;
+    }
+
+    for (uint32_t m = 0; m < num_targets; ++m)
+    {
+        measured[m] = target_tracker_interpolate(profile, list->targets[m].range_bin);
+        track_of[m] = NOT_ASSOCIATED;
+    }
+
+    /* Greedy nearest neighbour, closest pairs first */
+    for (;;)
+    {
+        float32_t best = TARGET_TRACKER_GATE_M;
+        uint32_t best_track = NOT_ASSOCIATED;
+        uint32_t best_target = NOT_ASSOCIATED;
+
+        for (uint32_t t = 0; t < tracker->count; ++t)
+        {
+            if (target_of[t] != NOT_ASSOCIATED)
+            {
+                continue;
+            }
+
+            for (uint32_t m = 0; m < num_targets; ++m)
+            {
+                float32_t residual = fabsf(measured[m] - tracker->tracks[t].distance);
+
+                if ((track_of[m] == NOT_ASSOCIATED) && (residual <= best))
+                {
+                    best = residual;
+                    best_track = t;
+                    best_target = m;
+                }
+            }
+        }
+
+        if (best_track == NOT_ASSOCIATED)
+        {
+            break;
+        }
+
+        target_of[best_track] = (uint8_t)best_target;
+        track_of[best_target] = (uint8_t)best_track;
+    }
+
+    for (uint32_t t = 0; t < tracker->count; ++t)
+    {
+        target_track_t* track = &tracker->tracks[t];
+
+        if (target_of[t] != NOT_ASSOCIATED)
+        {
+            float32_t residual = measured[target_of[t]] - track->distance;
+
+            track->distance += TARGET_TRACKER_ALPHA * residual;
+            if (dt > 0.0f)
+            {
+                track->velocity += (TARGET_TRACKER_BETA / dt) * residual;
+            }
+            track->last_update_ms = time_ms;
+            if (++track->hits >= TARGET_TRACKER_CONFIRM_HITS)
+            {
+                track->confirmed = true;
+            }
+        }
+        else if (!track->confirmed)
+        {
+            /* A tentative track needs consecutive hits */
+            track->hits = 0;
+        }
+        else
+        {
+            /* Coasting on the prediction */
+        }
+    }
+
+    /* Deletion moves the last track into the slot, walk backwards */
+    for (uint32_t t = tracker->count; t > 0u; --t)
+    {
+        const target_track_t* track = &tracker->tracks[t - 1u];
+        uint32_t timeout_ms = track->confirmed ? TARGET_TRACKER_CONFIRMED_TIMEOUT_MS :
+                                                 TARGET_TRACKER_TENTATIVE_TIMEOUT_MS;
+
+        if ((time_ms - track->last_update_ms) > timeout_ms)
+        {
+            remove_track(tracker, t - 1u);
+        }
+    }
+
+    for (uint32_t m = 0; m < num_targets; ++m)
+    {
+        if (track_of[m] == NOT_ASSOCIATED)
+        {
+            birth_track(tracker, measured[m], time_ms);
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: target_tracker_get_confirmed
+ *******************************************************************************
+ * Summary:
+ *   Copies the confirmed tracks for telemetry.
+ *
+ * Parameters:
+ *   tracker: tracker state
+ *   reports: output tracks
+ *   max_reports: size of reports
+ *
+ * Return:
+ *   number of tracks copied
+ ******************************************************************************/
+uint32_t target_tracker_get_confirmed(const target_tracker_t* tracker, target_track_report_t* reports,
+                                      uint32_t max_reports)
+{
+    uint32_t count = 0;
+
+    for (uint32_t t = 0; (t < tracker->count) && (count < max_reports); ++t)
+    {
+        const target_track_t* track = &tracker->tracks[t];
+
+        if (track->confirmed)
+        {
+            reports[count].id = track->id;
+            reports[count].distance = track->distance;
+            reports[count].velocity = track->velocity;
+            ++count;
+        }
+    }
+
+    return count;
+}
+
+/* [] END OF FILE */
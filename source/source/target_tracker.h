@@ -0,0 +1,107 @@
+/******************************************************************************
+ * File Name:   target_tracker.h
+ *
+ * Description: This file contains the function prototypes and constants used
+ *   in target_tracker.c.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#pragma once
+
+/* Header file from system */
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Header file for library */
+#include "arm_math.h"
+
+/* Header file for local task */
+#include "range_fft.h"
+#include "target_detect.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Set to 0 to disable tracking, requires TARGET_DETECT_ENABLED */
+#define TARGET_TRACKER_ENABLED              (1)
+
+/* Number of tracks kept at the same time */
+#define TARGET_TRACKER_MAX_TRACKS           (4u)
+
+/* Alpha-beta filter gains */
+#define TARGET_TRACKER_ALPHA                (0.3f)
+#define TARGET_TRACKER_BETA                 (0.05f)
+
+/* Largest distance between prediction and detection to be associated */
+#define TARGET_TRACKER_GATE_M               (0.5f)
+
+/* Consecutive associated frames before a track is confirmed */
+#define TARGET_TRACKER_CONFIRM_HITS         (5u)
+
+/* Time without association before a track is deleted */
+#define TARGET_TRACKER_TENTATIVE_TIMEOUT_MS (100u)
+#define TARGET_TRACKER_CONFIRMED_TIMEOUT_MS (2000u)
+
+/* Default interval of the track telemetry */
+#define TARGET_TRACKER_REPORT_INTERVAL_MS   (1000u)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef struct
+{
+    uint16_t id;                        /* stable while the track lives, never 0 */
+    bool confirmed;
+    uint32_t hits;
+    uint32_t last_update_ms;
+    float32_t distance;                 /* meters */
+    float32_t velocity;                 /* meters per second, positive moving away */
+} target_track_t;
+
+/* Track as reported in telemetry */
+typedef struct
+{
+    uint16_t id;
+    float distance;
+    float velocity;
+} target_track_report_t;
+
+typedef struct
+{
+    target_track_t tracks[TARGET_TRACKER_MAX_TRACKS];
+    uint32_t count;
+    uint16_t next_id;
+    uint32_t last_time_ms;
+    bool time_valid;
+} target_tracker_t;
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+void target_tracker_init(target_tracker_t* tracker);
+float32_t target_tracker_interpolate(const range_profile_t* profile, uint32_t range_bin);
+void target_tracker_update(target_tracker_t* tracker, const target_list_t* list,
+                           const range_profile_t* profile, uint32_t time_ms);
+uint32_t target_tracker_get_confirmed(const target_tracker_t* tracker, target_track_report_t* reports,
+                                      uint32_t max_reports);
+
+/* [] END OF FILE */
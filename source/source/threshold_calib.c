@@ -0,0 +1,312 @@
+/*****************************************************************************
+ * File name: threshold_calib.c
+ *
+ * Description: This file contains the automatic threshold calibration. While
+ * the room is known to be empty, the macro and micro metrics of the presence
+ * library are collected for a learning window. A P-square estimator keeps
+ * the quantile at the target false alarm rate of each metric with five
+ * markers, i.e. in constant memory whatever the window length. The
+ * thresholds are proposed with a margin over these quantiles.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Header file for local task */
+#include "threshold_calib.h"
+
+/*******************************************************************************
+ * Function Name: p2_quantile_init
+ *******************************************************************************
+ * Summary:
+ *   Initializes a quantile estimate without samples.
+ *
+ * Parameters:
+ *   estimator: estimator state
+ *   p: quantile, 0 < p < 1
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void p2_quantile_init(p2_quantile_t* estimator, float32_t p)
+{
+    memset(estimator, 0, sizeof(*estimator));
+    estimator->p = p;
+    estimator->increment[0] = 0.0f;
+    estimator->increment[1] = p / 2.0f;
+    estimator->increment[2] = p;
+    estimator->increment[3] = (1.0f + p) / 2.0f;
+    estimator->increment[4] = 1.0f;
+}
+
+/*******************************************************************************
+ * Function Name: p2_quantile_add
+ *******************************************************************************
+ * Summary:
+ *   Adds a sample. The first five samples are kept sorted as marker heights,
+ *   afterwards the markers are moved towards their desired positions with a
+ *   piecewise parabolic, or else linear, height adjustment.
+ *
+ * Parameters:
+ *   estimator: estimator state
+ *   value: new sample
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void p2_quantile_add(p2_quantile_t* estimator, float32_t value)
+{
+    float32_t* q = estimator->height;
+    int32_t* n = estimator->position;
+    uint32_t k;
+
+    if (estimator->count < 5u)
+    {
+        uint32_t i = estimator->count++;
+
+        /* Insertion into the sorted start */
+        while ((i > 0u) && (q[i - 1u] > value))
+        {
+            q[i] = q[i - 1u];
+            --i;
+        }
+        q[i] = value;
+
+        for (i = 0; i < 5u; ++i)
+        {
+            n[i] = (int32_t)i;
+        }
+        return;
+    }
+
+    ++estimator->count;
+
+    if (value < q[0])
+    {
+        q[0] = value;
+        k = 0;
+    }
+    else if (value >= q[4])
+    {
+        q[4] = value;
+        k = 3;
+    }
+    else
+    {
+        k = 0;
+        while (value >= q[k + 1u])
+        {
+            ++k;
+        }
+    }
+
+    for (uint32_t i = k + 1u; i < 5u; ++i)
+    {
+        ++n[i];
+    }
+    for (uint32_t i = 1; i < 4u; ++i)
+    {
+        /* Desired position from the count, summing the increments drifts in
+         * float32 by tens of positions over a long window
+         */
+        float32_t d = (estimator->increment[i] * (float32_t)(estimator->count - 1u)) - (float32_t)n[i];
+
+        if (((d >= 1.0f) && ((n[i + 1u] - n[i]) > 1)) || ((d <= -1.0f) && ((n[i - 1u] - n[i]) < -1)))
+        {
+            int32_t s = (d > 0.0f) ? 1 : -1;
+            float32_t sf = (float32_t)s;
+            float32_t parabolic = q[i] + ((sf / (float32_t)(n[i + 1u] - n[i - 1u])) *
+                                  ((((float32_t)(n[i] - n[i - 1u]) + sf) * (q[i + 1u] - q[i]) / (float32_t)(n[i + 1u] - n[i])) +
+                                   (((float32_t)(n[i + 1u] - n[i]) - sf) * (q[i] - q[i - 1u]) / (float32_t)(n[i] - n[i - 1u]))));
+
+            if ((q[i - 1u] < parabolic) && (parabolic < q[i + 1u]))
+            {
+                q[i] = parabolic;
+            }
+            else
+            {
+                uint32_t j = (s > 0) ? (i + 1u) : (i - 1u);
+
+                q[i] += sf * (q[j] - q[i]) / (float32_t)(n[j] - n[i]);
+            }
+            n[i] += s;
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: p2_quantile_get
+ *******************************************************************************
+ * Summary:
+ *   Returns the current quantile estimate.
+ *
+ * Parameters:
+ *   estimator: estimator state
+ *
+ * Return:
+ *   quantile, 0 without samples
+ ******************************************************************************/
+float32_t p2_quantile_get(const p2_quantile_t* estimator)
+{
+    if (estimator->count == 0u)
+    {
+        return 0.0f;
+    }
+
+    if (estimator->count < 5u)
+    {
+        /* The heights are the sorted samples */
+        return estimator->height[(uint32_t)(estimator->p * (float32_t)(estimator->count - 1u) + 0.5f)];
+    }
+
+    return estimator->height[2];
+}
+
+/*******************************************************************************
+ * Function Name: threshold_calib_init
+ *******************************************************************************
+ * Summary:
+ *   Initializes the calibration idle.
+ *
+ * Parameters:
+ *   tc: calibration state
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void threshold_calib_init(threshold_calib_t* tc)
+{
+    memset(tc, 0, sizeof(*tc));
+    tc->state = THRESHOLD_CALIB_IDLE;
+}
+
+/*******************************************************************************
+ * Function Name: threshold_calib_start
+ *******************************************************************************
+ * Summary:
+ *   Starts a learning window, a running one is restarted. The window starts
+ *   with the next update.
+ *
+ * Parameters:
+ *   tc: calibration state
+ *   duration_ms: learning window, 0 for the default
+ *   far: false alarm rate per frame, 0 for the default
+ *   apply: configure the thresholds at the end instead of proposing them
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void threshold_calib_start(threshold_calib_t* tc, uint32_t duration_ms, float32_t far, bool apply)
+{
+    tc->far = ((far > 0.0f) && (far < 1.0f)) ? far : THRESHOLD_CALIB_DEFAULT_FAR;
+    tc->duration_ms = (duration_ms > 0u) ? duration_ms : THRESHOLD_CALIB_DEFAULT_DURATION_MS;
+    tc->apply = apply;
+    tc->started = false;
+    tc->state = THRESHOLD_CALIB_LEARNING;
+    p2_quantile_init(&tc->macro, 1.0f - tc->far);
+    p2_quantile_init(&tc->micro, 1.0f - tc->far);
+}
+
+/*******************************************************************************
+ * Function Name: threshold_calib_learning
+ *******************************************************************************
+ * Summary:
+ *   Tells if a learning window is running.
+ *
+ * Parameters:
+ *   tc: calibration state
+ *
+ * Return:
+ *   true while learning
+ ******************************************************************************/
+bool threshold_calib_learning(const threshold_calib_t* tc)
+{
+    return (tc->state == THRESHOLD_CALIB_LEARNING);
+}
+
+/*******************************************************************************
+ * Function Name: threshold_calib_update
+ *******************************************************************************
+ * Summary:
+ *   Adds the metrics of a frame and ends the learning window when its
+ *   duration has elapsed. The window fails if it collected fewer than
+ *   THRESHOLD_CALIB_SAMPLES_PER_ALARM samples per expected false alarm.
+ *
+ * Parameters:
+ *   tc: calibration state
+ *   macro: macro metric of the frame
+ *   micro: micro metric of the frame
+ *   time_ms: time of the frame
+ *
+ * Return:
+ *   true if the window ended with this frame, see tc->state
+ ******************************************************************************/
+bool threshold_calib_update(threshold_calib_t* tc, float32_t macro, float32_t micro, uint32_t time_ms)
+{
+    uint32_t min_samples;
+
+    if (tc->state != THRESHOLD_CALIB_LEARNING)
+    {
+        return false;
+    }
+
+    if (!tc->started)
+    {
+        tc->started = true;
+        tc->start_ms = time_ms;
+    }
+
+    if ((time_ms - tc->start_ms) >= THRESHOLD_CALIB_SETTLE_MS)
+    {
+        p2_quantile_add(&tc->macro, macro);
+        p2_quantile_add(&tc->micro, micro);
+    }
+
+    if ((time_ms - tc->start_ms) < (THRESHOLD_CALIB_SETTLE_MS + tc->duration_ms))
+    {
+        return false;
+    }
+
+    min_samples = (uint32_t)((float32_t)THRESHOLD_CALIB_SAMPLES_PER_ALARM / tc->far);
+    tc->macro_threshold = THRESHOLD_CALIB_MARGIN * p2_quantile_get(&tc->macro);
+    tc->micro_threshold = THRESHOLD_CALIB_MARGIN * p2_quantile_get(&tc->micro);
+
+    if ((tc->macro.count < min_samples) || (tc->macro_threshold <= 0.0f) || (tc->micro_threshold <= 0.0f))
+    {
+        tc->state = THRESHOLD_CALIB_FAILED;
+        printf("[WARN] threshold calibration failed, %" PRIu32 " samples of %" PRIu32 " needed\n",
+               tc->macro.count, min_samples);
+    }
+    else
+    {
+        tc->state = tc->apply ? THRESHOLD_CALIB_APPLIED : THRESHOLD_CALIB_PROPOSED;
+        printf("[INFO] threshold calibration at false alarm rate %.4f: macro %.3f micro %.3f from %" PRIu32 " samples\n",
+               tc->far, tc->macro_threshold, tc->micro_threshold, tc->macro.count);
+    }
+
+    return true;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,109 @@
+/******************************************************************************
+ * File Name:   threshold_calib.h
+ *
+ * Description: This file contains the function prototypes and constants used
+ *   in threshold_calib.c.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+
+#pragma once
+
+/* Header file from system */
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Header file for library */
+#include "arm_math.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Set to 0 to remove the threshold calibration */
+#define THRESHOLD_CALIB_ENABLED             (1)
+
+/* Learning window used if none is configured */
+#define THRESHOLD_CALIB_DEFAULT_DURATION_MS (60000u)
+
+/* False alarm rate per frame used if none is configured */
+#define THRESHOLD_CALIB_DEFAULT_FAR         (0.001f)
+
+/* Time after the start before the metrics are collected, the library
+ * needs its macro compare interval and micro FFT window to be filled
+ */
+#define THRESHOLD_CALIB_SETTLE_MS           (2000u)
+
+/* Samples needed per expected false alarm for a valid result */
+#define THRESHOLD_CALIB_SAMPLES_PER_ALARM   (5u)
+
+/* Factor over the noise quantile */
+#define THRESHOLD_CALIB_MARGIN              (1.2f)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef enum
+{
+    THRESHOLD_CALIB_IDLE = 0,
+    THRESHOLD_CALIB_LEARNING,
+    THRESHOLD_CALIB_PROPOSED,           /* result reported only */
+    THRESHOLD_CALIB_APPLIED,            /* result reported and configured */
+    THRESHOLD_CALIB_FAILED              /* too few samples in the window */
+} threshold_calib_state_t;
+
+/* P-square streaming estimate of one quantile, five markers */
+typedef struct
+{
+    float32_t p;
+    uint32_t count;
+    float32_t height[5];
+    int32_t position[5];
+    float32_t increment[5];             /* of the desired positions per sample */
+} p2_quantile_t;
+
+typedef struct
+{
+    threshold_calib_state_t state;
+    bool apply;
+    bool started;                       /* start_ms is valid */
+    uint32_t start_ms;
+    uint32_t duration_ms;
+    float32_t far;
+    p2_quantile_t macro;
+    p2_quantile_t micro;
+    float32_t macro_threshold;          /* result */
+    float32_t micro_threshold;          /* result */
+} threshold_calib_t;
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+void p2_quantile_init(p2_quantile_t* estimator, float32_t p);
+void p2_quantile_add(p2_quantile_t* estimator, float32_t value);
+float32_t p2_quantile_get(const p2_quantile_t* estimator);
+
+void threshold_calib_init(threshold_calib_t* tc);
+void threshold_calib_start(threshold_calib_t* tc, uint32_t duration_ms, float32_t far, bool apply);
+bool threshold_calib_learning(const threshold_calib_t* tc);
+bool threshold_calib_update(threshold_calib_t* tc, float32_t macro, float32_t micro, uint32_t time_ms);
+
+/* [] END OF FILE */
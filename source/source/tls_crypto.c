@@ -0,0 +1,431 @@
+/*****************************************************************************
+ * File name: tls_crypto.c
+ *
+ * Description: This file contains the checks and measurements of the
+ * crypto used by the TLS session to the broker. With TLS_CRYPTO_HW the
+ * MBEDTLS_*_ALT implementations run AES, SHA-256 and the ECDSA signatures on
+ * the PSoC 6 crypto block, otherwise the software of mbed TLS runs. The same
+ * mbed TLS self tests and ECDSA test vector check both, the benchmark
+ * measures the record throughput and the key operations of a handshake, and
+ * every connect to the broker is timed.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Header file for library */
+#include "mbedtls/aes.h"
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/ecdh.h"
+#include "mbedtls/ecdsa.h"
+#include "mbedtls/ecp.h"
+#include "mbedtls/entropy.h"
+#include "mbedtls/gcm.h"
+#include "mbedtls/sha256.h"
+
+/* Header file for local task */
+#include "cycle_counter.h"
+#include "tls_crypto.h"
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static tls_crypto_connect_stats_t connect_stats;
+
+#if (TLS_CRYPTO_SELF_TEST != 0) || (TLS_CRYPTO_BENCHMARK != 0)
+/* Too large for the stack of the MQTT task */
+static mbedtls_entropy_context entropy;
+static mbedtls_ctr_drbg_context drbg;
+#endif
+
+#if (TLS_CRYPTO_SELF_TEST != 0)
+typedef struct
+{
+    const char* name;
+    int (*run)(int verbose);
+} self_test_t;
+
+/* Algorithms of the ALT implementations and the GCM records built on AES */
+static const self_test_t self_tests[] =
+{
+    { "AES", mbedtls_aes_self_test },
+    { "GCM", mbedtls_gcm_self_test },
+    { "SHA-256", mbedtls_sha256_self_test },
+    { "ECP", mbedtls_ecp_self_test },
+};
+
+/* RFC 6979 A.2.5: P-256 key and the SHA-256 signature of "sample" */
+static const char kat_message[] = "sample";
+
+static const uint8_t kat_d[32] =
+{
+    0xC9, 0xAF, 0xA9, 0xD8, 0x45, 0xBA, 0x75, 0x16, 0x6B, 0x5C, 0x21, 0x57, 0x67, 0xB1, 0xD6, 0x93,
+    0x4E, 0x50, 0xC3, 0xDB, 0x36, 0xE8, 0x9B, 0x12, 0x7B, 0x8A, 0x62, 0x2B, 0x12, 0x0F, 0x67, 0x21
+};
+
+static const uint8_t kat_qx[32] =
+{
+    0x60, 0xFE, 0xD4, 0xBA, 0x25, 0x5A, 0x9D, 0x31, 0xC9, 0x61, 0xEB, 0x74, 0xC6, 0x35, 0x6D, 0x68,
+    0xC0, 0x49, 0xB8, 0x92, 0x3B, 0x61, 0xFA, 0x6C, 0xE6, 0x69, 0x62, 0x2E, 0x60, 0xF2, 0x9F, 0xB6
+};
+
+static const uint8_t kat_qy[32] =
+{
+    0x79, 0x03, 0xFE, 0x10, 0x08, 0xB8, 0xBC, 0x99, 0xA4, 0x1A, 0xE9, 0xE9, 0x56, 0x28, 0xBC, 0x64,
+    0xF2, 0xF1, 0xB2, 0x0C, 0x2D, 0x7E, 0x9F, 0x51, 0x77, 0xA3, 0xC2, 0x94, 0xD4, 0x46, 0x22, 0x99
+};
+
+static const uint8_t kat_r[32] =
+{
+    0xEF, 0xD4, 0x8B, 0x2A, 0xAC, 0xB6, 0xA8, 0xFD, 0x11, 0x40, 0xDD, 0x9C, 0xD4, 0x5E, 0x81, 0xD6,
+    0x9D, 0x2C, 0x87, 0x7B, 0x56, 0xAA, 0xF9, 0x91, 0xC3, 0x4D, 0x0E, 0xA8, 0x4E, 0xAF, 0x37, 0x16
+};
+
+static const uint8_t kat_s[32] =
+{
+    0xF7, 0xCB, 0x1C, 0x94, 0x2D, 0x65, 0x7C, 0x41, 0xD4, 0x36, 0xC7, 0xA1, 0xB6, 0xE2, 0x9F, 0x65,
+    0xF3, 0xE9, 0x00, 0xDB, 0xB9, 0xAF, 0xF4, 0x06, 0x4D, 0xC4, 0xAB, 0x2F, 0x84, 0x3A, 0xCD, 0xA8
+};
+#endif
+
+#if (TLS_CRYPTO_SELF_TEST != 0) || (TLS_CRYPTO_BENCHMARK != 0)
+/*******************************************************************************
+ * Function Name: random_init
+ *******************************************************************************
+ * Summary:
+ *   Seeds the random generator of the ECDSA signatures from the entropy
+ *   source of mbed TLS, the TRNG.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   true if the generator was seeded
+ ******************************************************************************/
+static bool random_init(void)
+{
+    static const char personalization[] = "tls_crypto";
+
+    mbedtls_entropy_init(&entropy);
+    mbedtls_ctr_drbg_init(&drbg);
+
+    return mbedtls_ctr_drbg_seed(&drbg, mbedtls_entropy_func, &entropy, (const unsigned char*)personalization,
+                                 sizeof(personalization) - 1u) == 0;
+}
+
+/*******************************************************************************
+ * Function Name: random_free
+ *******************************************************************************
+ * Summary:
+ *   Frees the random generator.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void random_free(void)
+{
+    mbedtls_ctr_drbg_free(&drbg);
+    mbedtls_entropy_free(&entropy);
+}
+#endif
+
+#if (TLS_CRYPTO_SELF_TEST != 0)
+/*******************************************************************************
+ * Function Name: ecdsa_self_test
+ *******************************************************************************
+ * Summary:
+ *   mbed TLS has no ECDSA self test. Verifies the test vector, checks that a
+ *   modified hash is rejected and that a new signature of the test key is
+ *   verified.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   true if all checks passed
+ ******************************************************************************/
+static bool ecdsa_self_test(void)
+{
+    mbedtls_ecp_group grp;
+    mbedtls_ecp_point q;
+    mbedtls_mpi d;
+    mbedtls_mpi r;
+    mbedtls_mpi s;
+    uint8_t hash[32];
+    bool result;
+
+    mbedtls_ecp_group_init(&grp);
+    mbedtls_ecp_point_init(&q);
+    mbedtls_mpi_init(&d);
+    mbedtls_mpi_init(&r);
+    mbedtls_mpi_init(&s);
+
+    result = (mbedtls_ecp_group_load(&grp, MBEDTLS_ECP_DP_SECP256R1) == 0) &&
+             (mbedtls_mpi_read_binary(&d, kat_d, sizeof(kat_d)) == 0) &&
+             (mbedtls_mpi_read_binary(&q.X, kat_qx, sizeof(kat_qx)) == 0) &&
+             (mbedtls_mpi_read_binary(&q.Y, kat_qy, sizeof(kat_qy)) == 0) &&
+             (mbedtls_mpi_lset(&q.Z, 1) == 0) &&
+             (mbedtls_mpi_read_binary(&r, kat_r, sizeof(kat_r)) == 0) &&
+             (mbedtls_mpi_read_binary(&s, kat_s, sizeof(kat_s)) == 0) &&
+             (mbedtls_sha256_ret((const unsigned char*)kat_message, sizeof(kat_message) - 1u, hash, 0) == 0) &&
+             (mbedtls_ecdsa_verify(&grp, hash, sizeof(hash), &q, &r, &s) == 0);
+
+    if (result)
+    {
+        hash[0] ^= 1u;
+        result = (mbedtls_ecdsa_verify(&grp, hash, sizeof(hash), &q, &r, &s) != 0);
+        hash[0] ^= 1u;
+    }
+
+    /* The signature is random, the verification checked above tells if it is valid */
+    result = result && random_init() &&
+             (mbedtls_ecdsa_sign(&grp, &r, &s, &d, hash, sizeof(hash), mbedtls_ctr_drbg_random, &drbg) == 0) &&
+             (mbedtls_ecdsa_verify(&grp, hash, sizeof(hash), &q, &r, &s) == 0);
+    random_free();
+
+    mbedtls_mpi_free(&s);
+    mbedtls_mpi_free(&r);
+    mbedtls_mpi_free(&d);
+    mbedtls_ecp_point_free(&q);
+    mbedtls_ecp_group_free(&grp);
+
+    return result;
+}
+#endif
+
+/*******************************************************************************
+ * Function Name: tls_crypto_self_test
+ *******************************************************************************
+ * Summary:
+ *   Runs the mbed TLS self tests of AES, GCM, SHA-256 and ECP and the ECDSA
+ *   test vector with TLS_CRYPTO_SELF_TEST, on the hardware or the software
+ *   implementations. Does nothing otherwise.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   false if a test failed
+ ******************************************************************************/
+bool tls_crypto_self_test(void)
+{
+#if (TLS_CRYPTO_SELF_TEST != 0)
+    bool result = true;
+
+    for (uint32_t i = 0; i < (sizeof(self_tests) / sizeof(self_tests[0])); ++i)
+    {
+        if (self_tests[i].run(0) != 0)
+        {
+            printf("[WARN] tls crypto: %s self test failed\n", self_tests[i].name);
+            result = false;
+        }
+    }
+
+    if (!ecdsa_self_test())
+    {
+        printf("[WARN] tls crypto: ECDSA self test failed\n");
+        result = false;
+    }
+
+    printf("[INFO] tls crypto: %s self tests %s\n", TLS_CRYPTO_BACKEND_NAME, result ? "passed" : "failed");
+
+    return result;
+#else
+    return true;
+#endif
+}
+
+/*******************************************************************************
+ * Function Name: tls_crypto_benchmark
+ *******************************************************************************
+ * Summary:
+ *   Measures with TLS_CRYPTO_BENCHMARK the throughput of the AES-128-GCM
+ *   records and of SHA-256, and the ECDSA P-256 signature and verification
+ *   and the ECDH P-256 key exchange of a handshake, and prints them. Does
+ *   nothing otherwise. Run it while the other tasks are idle.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void tls_crypto_benchmark(void)
+{
+#if (TLS_CRYPTO_BENCHMARK != 0)
+    static uint8_t record[TLS_CRYPTO_BENCH_RECORD_SIZE];
+    static uint8_t encrypted[TLS_CRYPTO_BENCH_RECORD_SIZE];
+    const uint32_t bytes = TLS_CRYPTO_BENCH_RECORD_SIZE * TLS_CRYPTO_BENCH_RECORDS;
+    uint8_t key[16];
+    uint8_t iv[12];
+    uint8_t header[13];
+    uint8_t tag[16];
+    uint8_t hash[32];
+    mbedtls_gcm_context gcm;
+    mbedtls_ecdsa_context ecdsa;
+    mbedtls_ecp_point q;
+    mbedtls_mpi d;
+    mbedtls_mpi z;
+    mbedtls_mpi r;
+    mbedtls_mpi s;
+    uint32_t gcm_us;
+    uint32_t sha_us;
+    uint32_t sign_cycles = 0;
+    uint32_t verify_cycles = 0;
+    uint32_t ecdh_cycles = 0;
+    uint32_t start;
+    int ret = 0;
+
+    cycle_counter_init();
+
+    if (!random_init())
+    {
+        printf("[WARN] tls crypto: random generator failed, no benchmark\n");
+        random_free();
+        return;
+    }
+
+    mbedtls_gcm_init(&gcm);
+    mbedtls_ecdsa_init(&ecdsa);
+    mbedtls_ecp_point_init(&q);
+    mbedtls_mpi_init(&d);
+    mbedtls_mpi_init(&z);
+    mbedtls_mpi_init(&r);
+    mbedtls_mpi_init(&s);
+
+    ret |= mbedtls_ctr_drbg_random(&drbg, record, sizeof(record));
+    ret |= mbedtls_ctr_drbg_random(&drbg, key, sizeof(key));
+    ret |= mbedtls_ctr_drbg_random(&drbg, iv, sizeof(iv));
+    memset(header, 0, sizeof(header));
+
+    /* Record layer: one AES-128-GCM encryption per record, as TLS 1.2 does */
+    ret |= mbedtls_gcm_setkey(&gcm, MBEDTLS_CIPHER_ID_AES, key, 128);
+    start = cycle_counter_get();
+    for (uint32_t i = 0; i < TLS_CRYPTO_BENCH_RECORDS; ++i)
+    {
+        iv[sizeof(iv) - 1u] = (uint8_t)i;
+        ret |= mbedtls_gcm_crypt_and_tag(&gcm, MBEDTLS_GCM_ENCRYPT, sizeof(record), iv, sizeof(iv), header,
+                                         sizeof(header), record, encrypted, sizeof(tag), tag);
+    }
+    gcm_us = cycle_counter_to_us(cycle_counter_elapsed(start));
+
+    /* Handshake transcript, HMAC and PRF */
+    start = cycle_counter_get();
+    for (uint32_t i = 0; i < TLS_CRYPTO_BENCH_RECORDS; ++i)
+    {
+        ret |= mbedtls_sha256_ret(record, sizeof(record), hash, 0);
+    }
+    sha_us = cycle_counter_to_us(cycle_counter_elapsed(start));
+
+    /* Handshake: a signature of the client, the verification of the server
+     * key exchange and the ECDHE key exchange
+     */
+    ret |= mbedtls_ecdsa_genkey(&ecdsa, MBEDTLS_ECP_DP_SECP256R1, mbedtls_ctr_drbg_random, &drbg);
+    for (uint32_t i = 0; i < TLS_CRYPTO_BENCH_KEY_OPS; ++i)
+    {
+        start = cycle_counter_get();
+        ret |= mbedtls_ecdsa_sign(&ecdsa.grp, &r, &s, &ecdsa.d, hash, sizeof(hash), mbedtls_ctr_drbg_random, &drbg);
+        sign_cycles += cycle_counter_elapsed(start);
+
+        start = cycle_counter_get();
+        ret |= mbedtls_ecdsa_verify(&ecdsa.grp, hash, sizeof(hash), &ecdsa.Q, &r, &s);
+        verify_cycles += cycle_counter_elapsed(start);
+
+        start = cycle_counter_get();
+        ret |= mbedtls_ecdh_gen_public(&ecdsa.grp, &d, &q, mbedtls_ctr_drbg_random, &drbg);
+        ret |= mbedtls_ecdh_compute_shared(&ecdsa.grp, &z, &ecdsa.Q, &d, mbedtls_ctr_drbg_random, &drbg);
+        ecdh_cycles += cycle_counter_elapsed(start);
+    }
+
+    if (ret != 0)
+    {
+        printf("[WARN] tls crypto: benchmark failed\n");
+    }
+    else
+    {
+        printf("[INFO] tls crypto %s: AES-128-GCM %" PRIu32 " kB/s, SHA-256 %" PRIu32 " kB/s (%" PRIu32
+               " records of %" PRIu32 " bytes)\n", TLS_CRYPTO_BACKEND_NAME,
+               (gcm_us > 0u) ? (uint32_t)(((uint64_t)bytes * 1000u) / gcm_us) : 0u,
+               (sha_us > 0u) ? (uint32_t)(((uint64_t)bytes * 1000u) / sha_us) : 0u,
+               TLS_CRYPTO_BENCH_RECORDS, TLS_CRYPTO_BENCH_RECORD_SIZE);
+        printf("[INFO] tls crypto %s: ECDSA P-256 sign %" PRIu32 " us, verify %" PRIu32 " us, ECDH P-256 %" PRIu32
+               " us\n", TLS_CRYPTO_BACKEND_NAME, cycle_counter_to_us(sign_cycles) / TLS_CRYPTO_BENCH_KEY_OPS,
+               cycle_counter_to_us(verify_cycles) / TLS_CRYPTO_BENCH_KEY_OPS,
+               cycle_counter_to_us(ecdh_cycles) / TLS_CRYPTO_BENCH_KEY_OPS);
+    }
+
+    mbedtls_mpi_free(&s);
+    mbedtls_mpi_free(&r);
+    mbedtls_mpi_free(&z);
+    mbedtls_mpi_free(&d);
+    mbedtls_ecp_point_free(&q);
+    mbedtls_ecdsa_free(&ecdsa);
+    mbedtls_gcm_free(&gcm);
+    random_free();
+#endif
+}
+
+/*******************************************************************************
+ * Function Name: tls_crypto_account_connect
+ *******************************************************************************
+ * Summary:
+ *   Records the time the caller measured for one cy_mqtt_connect call and
+ *   prints the statistics of the connects. Most of the time of a connect is
+ *   the TLS handshake.
+ *
+ * Parameters:
+ *   elapsed_ms: measured time
+ *   success: the connect succeeded
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void tls_crypto_account_connect(uint32_t elapsed_ms, bool success)
+{
+    tls_crypto_connect_stats_t* stats = &connect_stats;
+
+    if (!success)
+    {
+        ++stats->failures;
+        printf("[INFO] tls: connect failed after %" PRIu32 " ms\n", elapsed_ms);
+        return;
+    }
+
+    ++stats->connects;
+    stats->total_ms += elapsed_ms;
+    if (elapsed_ms > stats->max_ms)
+    {
+        stats->max_ms = elapsed_ms;
+    }
+
+    printf("[INFO] tls: connect %" PRIu32 " took %" PRIu32 " ms, avg %" PRIu32 " max %" PRIu32 " ms, %" PRIu32
+           " failed, %s crypto\n", stats->connects, elapsed_ms, (uint32_t)(stats->total_ms / stats->connects),
+           stats->max_ms, stats->failures, TLS_CRYPTO_BACKEND_NAME);
+}
+
+/* [] END OF FILE */
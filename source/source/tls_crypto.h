@@ -0,0 +1,88 @@
+/******************************************************************************
+ * File Name:   tls_crypto.h
+ *
+ * Description: This file contains the function prototypes and constants used
+ *   in tls_crypto.c.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+
+#pragma once
+
+/* Header file from system */
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Header file for library, with TLS_CRYPTO_HW and TLS_CRYPTO_SELF_TEST of
+ * mbedtls_user_config.h
+ */
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Set to 1 to measure the throughput and key operations of the TLS crypto at
+ * boot, before the Wi-Fi connection
+ */
+#ifndef TLS_CRYPTO_BENCHMARK
+#define TLS_CRYPTO_BENCHMARK                (0)
+#endif
+
+/* Payload of one benchmark record, a full telemetry batch */
+#define TLS_CRYPTO_BENCH_RECORD_SIZE        (1024u)
+
+/* Records encrypted and hashed by the benchmark */
+#define TLS_CRYPTO_BENCH_RECORDS            (64u)
+
+/* Repetitions of the key operations of the benchmark */
+#define TLS_CRYPTO_BENCH_KEY_OPS            (4u)
+
+#if (TLS_CRYPTO_HW != 0)
+#define TLS_CRYPTO_BACKEND_NAME             "hardware"
+#else
+#define TLS_CRYPTO_BACKEND_NAME             "software"
+#endif
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+/* cy_mqtt_connect calls: TCP connect, TLS handshake and MQTT CONNECT */
+typedef struct
+{
+    uint32_t connects;
+    uint32_t failures;
+    uint64_t total_ms;
+    uint32_t max_ms;
+} tls_crypto_connect_stats_t;
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+bool tls_crypto_self_test(void);
+void tls_crypto_benchmark(void);
+void tls_crypto_account_connect(uint32_t elapsed_ms, bool success);
+
+/* [] END OF FILE */
@@ -0,0 +1,304 @@
+/*****************************************************************************
+ * File name: warm_start.c
+ *
+ * Description: This file contains the snapshot of the detection state that
+ * lets the detection start warm after a controlled reboot. The snapshot is a
+ * fixed size, versioned blob with the static clutter estimate of the range
+ * processing and the last reported presence state. It is written on
+ * controlled shutdown, restored once at the next boot if it is recent and
+ * was learned with the same configuration, and invalidated afterwards.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Header file for local task */
+#include "warm_start.h"
+
+/* Header file for library, after config_store.h that selects the backend */
+#if (CONFIG_STORE_BACKEND_FILE == 0)
+#include "cyhal.h"
+#endif
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+#if (CONFIG_STORE_BACKEND_FILE == 0)
+/* Placed in the work flash by the linker scripts, next to the config store */
+CY_SECTION(".cy_em_eeprom") CY_ALIGN(CONFIG_STORE_FLASH_PAGE_SIZE)
+static const uint8_t flash_pages[WARM_START_PAGES][CONFIG_STORE_FLASH_PAGE_SIZE] = {{0}};
+
+static cyhal_flash_t flash_obj;
+
+/* cyhal_flash_write takes a whole page */
+static uint32_t flash_page[CONFIG_STORE_FLASH_PAGE_SIZE / sizeof(uint32_t)];
+#endif
+
+static bool storage_open = false;
+
+#if (CONFIG_STORE_BACKEND_FILE != 0)
+/*******************************************************************************
+ * Function Name: storage_read
+ *******************************************************************************
+ * Summary:
+ *   Reads the snapshot file.
+ *
+ * Parameters:
+ *   snapshot: destination
+ *
+ * Return:
+ *   true if a whole snapshot was read
+ ******************************************************************************/
+static bool storage_read(warm_start_snapshot_t* snapshot)
+{
+    FILE* file = fopen(WARM_START_FILE_PATH, "rb");
+    bool result;
+
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    result = (fread(snapshot, 1, sizeof(*snapshot), file) == sizeof(*snapshot));
+    fclose(file);
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: storage_write
+ *******************************************************************************
+ * Summary:
+ *   Writes the snapshot file.
+ *
+ * Parameters:
+ *   snapshot: source
+ *
+ * Return:
+ *   true if the snapshot was written
+ ******************************************************************************/
+static bool storage_write(const warm_start_snapshot_t* snapshot)
+{
+    FILE* file = fopen(WARM_START_FILE_PATH, "wb");
+    bool result;
+
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    result = (fwrite(snapshot, 1, sizeof(*snapshot), file) == sizeof(*snapshot)) && (fflush(file) == 0);
+    fclose(file);
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: storage_invalidate
+ *******************************************************************************
+ * Summary:
+ *   Removes the snapshot file.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void storage_invalidate(void)
+{
+    (void)remove(WARM_START_FILE_PATH);
+}
+#else
+/*******************************************************************************
+ * Function Name: storage_read
+ *******************************************************************************
+ * Summary:
+ *   Reads the snapshot from the work flash.
+ *
+ * Parameters:
+ *   snapshot: destination
+ *
+ * Return:
+ *   true if a whole snapshot was read
+ ******************************************************************************/
+static bool storage_read(warm_start_snapshot_t* snapshot)
+{
+    return cyhal_flash_read(&flash_obj, (uint32_t)(uintptr_t)&flash_pages[0][0], (uint8_t*)snapshot,
+                            sizeof(*snapshot)) == CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: storage_write
+ *******************************************************************************
+ * Summary:
+ *   Erases and programs the pages of the snapshot, one page at a time.
+ *
+ * Parameters:
+ *   snapshot: source
+ *
+ * Return:
+ *   true if the snapshot was written
+ ******************************************************************************/
+static bool storage_write(const warm_start_snapshot_t* snapshot)
+{
+    const uint8_t* bytes = (const uint8_t*)snapshot;
+    uint32_t remaining = sizeof(*snapshot);
+
+    for (uint32_t page = 0; remaining > 0u; ++page)
+    {
+        uint32_t size = (remaining < CONFIG_STORE_FLASH_PAGE_SIZE) ? remaining : CONFIG_STORE_FLASH_PAGE_SIZE;
+
+        memset(flash_page, 0, sizeof(flash_page));
+        memcpy(flash_page, &bytes[page * CONFIG_STORE_FLASH_PAGE_SIZE], size);
+        if (cyhal_flash_write(&flash_obj, (uint32_t)(uintptr_t)&flash_pages[page][0], flash_page) != CY_RSLT_SUCCESS)
+        {
+            return false;
+        }
+        remaining -= size;
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: storage_invalidate
+ *******************************************************************************
+ * Summary:
+ *   Erases the first page of the snapshot, which holds the header.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void storage_invalidate(void)
+{
+    (void)cyhal_flash_erase(&flash_obj, (uint32_t)(uintptr_t)&flash_pages[0][0]);
+}
+#endif
+
+/*******************************************************************************
+ * Function Name: warm_start_init
+ *******************************************************************************
+ * Summary:
+ *   Opens the storage of the snapshot.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   true if the storage can be used
+ ******************************************************************************/
+bool warm_start_init(void)
+{
+#if (CONFIG_STORE_BACKEND_FILE == 0)
+    storage_open = (sizeof(warm_start_snapshot_t) <= sizeof(flash_pages)) &&
+                   (cyhal_flash_init(&flash_obj) == CY_RSLT_SUCCESS);
+#else
+    storage_open = true;
+#endif
+
+    return storage_open;
+}
+
+/*******************************************************************************
+ * Function Name: warm_start_save
+ *******************************************************************************
+ * Summary:
+ *   Completes the header of a snapshot filled in by the caller and writes it.
+ *   The size is fixed, so is the time taken.
+ *
+ * Parameters:
+ *   snapshot: snapshot, the header and CRC are set here
+ *   time_s: RTC time
+ *
+ * Return:
+ *   true if the snapshot was written
+ ******************************************************************************/
+bool warm_start_save(warm_start_snapshot_t* snapshot, uint32_t time_s)
+{
+    if (!storage_open)
+    {
+        return false;
+    }
+
+    snapshot->magic = WARM_START_MAGIC;
+    snapshot->version = WARM_START_VERSION;
+    snapshot->size = (uint16_t)sizeof(*snapshot);
+    snapshot->saved_s = time_s;
+    snapshot->crc = config_store_crc32(snapshot, offsetof(warm_start_snapshot_t, crc));
+
+    return storage_write(snapshot);
+}
+
+/*******************************************************************************
+ * Function Name: warm_start_load
+ *******************************************************************************
+ * Summary:
+ *   Reads the snapshot and checks its header, CRC and age. A snapshot is
+ *   only used once: it is invalidated whether it can be used or not, so a
+ *   later reset without controlled shutdown starts cold. The caller checks
+ *   that the snapshot was learned with the configuration in use.
+ *
+ * Parameters:
+ *   snapshot: destination
+ *   time_s: RTC time
+ *
+ * Return:
+ *   true if the snapshot can be restored
+ ******************************************************************************/
+bool warm_start_load(warm_start_snapshot_t* snapshot, uint32_t time_s)
+{
+    bool valid;
+
+    if (!storage_open || !storage_read(snapshot))
+    {
+        return false;
+    }
+
+    valid = (snapshot->magic == WARM_START_MAGIC) &&
+            (snapshot->version == WARM_START_VERSION) &&
+            (snapshot->size == sizeof(*snapshot)) &&
+            (snapshot->crc == config_store_crc32(snapshot, offsetof(warm_start_snapshot_t, crc))) &&
+            (snapshot->clutter_bins <= (RANGE_FFT_MAX_SIZE / 2u));
+
+    if (snapshot->magic == WARM_START_MAGIC)
+    {
+        storage_invalidate();
+    }
+
+    if (valid && ((time_s < snapshot->saved_s) || ((time_s - snapshot->saved_s) > WARM_START_MAX_AGE_S)))
+    {
+        printf("[WARN] warm start: snapshot of %" PRIu32 " s at %" PRIu32 " s is stale\n", snapshot->saved_s, time_s);
+        valid = false;
+    }
+
+    return valid;
+}
+
+/* [] END OF FILE */
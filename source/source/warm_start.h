@@ -0,0 +1,93 @@
+/******************************************************************************
+ * File Name:   warm_start.h
+ *
+ * Description: This file contains the function prototypes and constants used
+ *   in warm_start.c.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#pragma once
+
+/* Header file from system */
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Header file for library */
+#include "arm_math.h"
+
+/* Header file for local task */
+#include "config_store.h"
+#include "range_fft.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Set to 0 to always start the detection cold */
+#define WARM_START_ENABLED                  (1)
+
+/* File of the snapshot when CONFIG_STORE_BACKEND_FILE is set */
+#ifndef WARM_START_FILE_PATH
+#define WARM_START_FILE_PATH                "radar_snapshot.bin"
+#endif
+
+/* Layout of warm_start_snapshot_t, snapshots of another version are ignored */
+#define WARM_START_VERSION                  (1u)
+#define WARM_START_MAGIC                    (0x54534D57u)   /* "WMST" */
+
+/* Work flash pages holding the snapshot */
+#define WARM_START_PAGES                    (2u)
+
+/* Oldest snapshot restored, counted on the RTC that keeps running through a
+ * reset but not through a power loss
+ */
+#define WARM_START_MAX_AGE_S                (300u)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef struct
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;                      /* of the snapshot */
+    uint32_t saved_s;                   /* RTC time of the snapshot */
+
+    /* Configuration the state was learned with */
+    int32_t num_samples_per_chirp;
+    int32_t min_range_bin;
+    int32_t max_range_bin;
+
+    uint32_t presence_state;            /* last reported xensiv_radar_presence_state_t */
+    uint32_t clutter_bins;              /* complex bins in clutter, 0 without estimate */
+    float32_t clutter[RANGE_FFT_MAX_SIZE];
+
+    uint32_t crc;                       /* CRC-32 of all previous bytes */
+} warm_start_snapshot_t;
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+bool warm_start_init(void);
+bool warm_start_save(warm_start_snapshot_t* snapshot, uint32_t time_s);
+bool warm_start_load(warm_start_snapshot_t* snapshot, uint32_t time_s);
+
+/* [] END OF FILE */
@@ -0,0 +1,473 @@
+/*****************************************************************************
+ * File name: zone_engine.c
+ *
+ * Description: This file contains the presence zones. Every zone is a range
+ * window with its own macro and micro thresholds, validity times and
+ * presence state machine. The motion metrics are computed once per frame
+ * from the shared range profile over the bins covered by the enabled zones:
+ * the macro metric compares the spectrum with a reference taken every
+ * ZONE_ENGINE_COMPARE_INTERVAL_MS and the micro metric smooths the clutter
+ * free magnitude. A zone only takes the peak of both metrics over its bins,
+ * so adding zones costs little compared to the shared computation.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Header file for local task */
+#include "zone_engine.h"
+
+/*******************************************************************************
+ * Function Name: zone_peak
+ *******************************************************************************
+ * Summary:
+ *   Finds the largest value of a metric over the bins of a zone.
+ *
+ * Parameters:
+ *   metric: metric per range bin
+ *   zone: zone state
+ *   range_bin: bin of the peak
+ *
+ * Return:
+ *   peak value
+ ******************************************************************************/
+static float32_t zone_peak(const float32_t* metric, const zone_state_t* zone, uint32_t* range_bin)
+{
+    float32_t peak = metric[zone->min_bin];
+
+    *range_bin = zone->min_bin;
+    for (uint32_t bin = zone->min_bin + 1u; bin <= zone->max_bin; ++bin)
+    {
+        if (metric[bin] > peak)
+        {
+            peak = metric[bin];
+            *range_bin = bin;
+        }
+    }
+
+    return peak;
+}
+
+/*******************************************************************************
+ * Function Name: update_coverage
+ *******************************************************************************
+ * Summary:
+ *   Computes the bins covered by the enabled zones. The metrics of newly
+ *   covered bins are not valid yet, so the reference is taken again.
+ *
+ * Parameters:
+ *   ze: engine state
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void update_coverage(zone_engine_t* ze)
+{
+    ze->any_enabled = false;
+    ze->min_bin = RANGE_FFT_MAX_SIZE / 2u;
+    ze->max_bin = 0;
+
+    for (uint32_t z = 0; z < ZONE_ENGINE_MAX_ZONES; ++z)
+    {
+        const zone_state_t* zone = &ze->zones[z];
+
+        if (zone->enabled)
+        {
+            ze->any_enabled = true;
+            ze->min_bin = (zone->min_bin < ze->min_bin) ? zone->min_bin : ze->min_bin;
+            ze->max_bin = (zone->max_bin > ze->max_bin) ? zone->max_bin : ze->max_bin;
+        }
+    }
+
+    ze->reference_valid = false;
+    memset(ze->macro, 0, sizeof(ze->macro));
+    memset(ze->micro, 0, sizeof(ze->micro));
+}
+
+/*******************************************************************************
+ * Function Name: zone_engine_init
+ *******************************************************************************
+ * Summary:
+ *   Initializes the engine with all zones disabled.
+ *
+ * Parameters:
+ *   ze: engine state
+ *   bin_length: meters per range bin
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void zone_engine_init(zone_engine_t* ze, float32_t bin_length)
+{
+    memset(ze, 0, sizeof(*ze));
+    ze->bin_length = bin_length;
+
+    for (uint32_t z = 0; z < ZONE_ENGINE_MAX_ZONES; ++z)
+    {
+        zone_engine_default_config(&ze->zones[z].config);
+        ze->zones[z].state = XENSIV_RADAR_PRESENCE_STATE_ABSENCE;
+    }
+    update_coverage(ze);
+}
+
+/*******************************************************************************
+ * Function Name: zone_engine_default_config
+ *******************************************************************************
+ * Summary:
+ *   Fills a disabled zone with the default thresholds and validity times.
+ *
+ * Parameters:
+ *   config: zone configuration
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void zone_engine_default_config(zone_config_t* config)
+{
+    config->min_range = 0.0f;
+    config->max_range = 0.0f;
+    config->macro_threshold = ZONE_ENGINE_DEFAULT_MACRO_THRESHOLD;
+    config->micro_threshold = ZONE_ENGINE_DEFAULT_MICRO_THRESHOLD;
+    config->macro_validity_ms = ZONE_ENGINE_DEFAULT_MACRO_VALIDITY_MS;
+    config->micro_validity_ms = ZONE_ENGINE_DEFAULT_MICRO_VALIDITY_MS;
+}
+
+/*******************************************************************************
+ * Function Name: zone_engine_set_field
+ *******************************************************************************
+ * Summary:
+ *   Sets one field of a zone configuration, validity times in ms.
+ *
+ * Parameters:
+ *   config: zone configuration
+ *   field: field to set
+ *   value: new value
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void zone_engine_set_field(zone_config_t* config, zone_field_t field, float value)
+{
+    switch (field)
+    {
+        case ZONE_FIELD_MIN_RANGE:
+            config->min_range = value;
+            break;
+        case ZONE_FIELD_MAX_RANGE:
+            config->max_range = value;
+            break;
+        case ZONE_FIELD_MACRO_THRESHOLD:
+            config->macro_threshold = value;
+            break;
+        case ZONE_FIELD_MICRO_THRESHOLD:
+            config->micro_threshold = value;
+            break;
+        case ZONE_FIELD_MACRO_VALIDITY:
+            config->macro_validity_ms = (uint32_t)value;
+            break;
+        case ZONE_FIELD_MICRO_VALIDITY:
+            config->micro_validity_ms = (uint32_t)value;
+            break;
+        default:
+            break;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: zone_engine_get_field
+ *******************************************************************************
+ * Summary:
+ *   Reads one field of a zone configuration, validity times in ms.
+ *
+ * Parameters:
+ *   config: zone configuration
+ *   field: field to read
+ *
+ * Return:
+ *   value of the field
+ ******************************************************************************/
+float zone_engine_get_field(const zone_config_t* config, zone_field_t field)
+{
+    switch (field)
+    {
+        case ZONE_FIELD_MIN_RANGE:
+            return config->min_range;
+        case ZONE_FIELD_MAX_RANGE:
+            return config->max_range;
+        case ZONE_FIELD_MACRO_THRESHOLD:
+            return config->macro_threshold;
+        case ZONE_FIELD_MICRO_THRESHOLD:
+            return config->micro_threshold;
+        case ZONE_FIELD_MACRO_VALIDITY:
+            return (float)config->macro_validity_ms;
+        case ZONE_FIELD_MICRO_VALIDITY:
+            return (float)config->micro_validity_ms;
+        default:
+            return 0.0f;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: zone_engine_configure
+ *******************************************************************************
+ * Summary:
+ *   Applies the configuration of a zone and restarts its state machine. A
+ *   zone that was present reports its absence with the next update.
+ *
+ * Parameters:
+ *   ze: engine state
+ *   zone_id: index of the zone
+ *   config: zone configuration, disabled if max_range is not above min_range
+ *
+ * Return:
+ *   true if the zone id is valid
+ ******************************************************************************/
+bool zone_engine_configure(zone_engine_t* ze, uint32_t zone_id, const zone_config_t* config)
+{
+    zone_state_t* zone;
+    uint32_t last_bin = (RANGE_FFT_MAX_SIZE / 2u) - 1u;
+
+    if (zone_id >= ZONE_ENGINE_MAX_ZONES)
+    {
+        return false;
+    }
+
+    zone = &ze->zones[zone_id];
+    zone->config = *config;
+    zone->enabled = (config->min_range >= 0.0f) && (config->max_range > config->min_range) &&
+                    (ze->bin_length > 0.0f);
+
+    if (zone->enabled)
+    {
+        /* The DC bin does not carry motion */
+        zone->min_bin = (uint32_t)(config->min_range / ze->bin_length);
+        zone->min_bin = (zone->min_bin > 0u) ? zone->min_bin : 1u;
+        zone->max_bin = (uint32_t)(config->max_range / ze->bin_length);
+        zone->max_bin = (zone->max_bin < last_bin) ? zone->max_bin : last_bin;
+        zone->enabled = (zone->max_bin >= zone->min_bin);
+    }
+
+    if (zone->state != XENSIV_RADAR_PRESENCE_STATE_ABSENCE)
+    {
+        zone->reset = true;
+    }
+    zone->state = XENSIV_RADAR_PRESENCE_STATE_ABSENCE;
+    update_coverage(ze);
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: set_reference
+ *******************************************************************************
+ * Summary:
+ *   Copies the complex spectrum into the reference on the float32 scale.
+ *
+ * Parameters:
+ *   reference: destination, re/im pairs
+ *   spectrum: complex spectrum, re/im pairs
+ *   num_bins: number of complex bins
+ *   sample_scale: scale of the spectrum samples, see range_profile_t
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void set_reference(float32_t* reference, const range_sample_t* spectrum, uint32_t num_bins,
+                          float32_t sample_scale)
+{
+    for (uint32_t i = 0; i < (2u * num_bins); ++i)
+    {
+        reference[i] = (float32_t)spectrum[i] * sample_scale;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: zone_engine_update
+ *******************************************************************************
+ * Summary:
+ *   Computes the shared macro and micro metrics of the frame and runs the
+ *   state machine of every enabled zone:
+ *   absence -> macro presence on macro motion,
+ *   macro presence -> micro presence without macro motion for the macro
+ *   validity if micro motion was seen within the micro validity, otherwise
+ *   absence,
+ *   micro presence -> macro presence on macro motion, absence without micro
+ *   motion for the micro validity.
+ *
+ * Parameters:
+ *   ze: engine state
+ *   profile: range profile of the frame
+ *   time_ms: time of the frame
+ *   events: state changes of the zones
+ *
+ * Return:
+ *   number of events
+ ******************************************************************************/
+uint32_t zone_engine_update(zone_engine_t* ze, const range_profile_t* profile, uint32_t time_ms,
+                            zone_event_t events[ZONE_ENGINE_MAX_ZONES])
+{
+    uint32_t count = 0;
+
+    if (ze->any_enabled && (ze->min_bin < profile->num_bins))
+    {
+        uint32_t max_bin = (ze->max_bin < profile->num_bins) ? ze->max_bin : (profile->num_bins - 1u);
+        const range_sample_t* spectrum = &profile->spectrum[2u * ze->min_bin];
+        float32_t* reference = &ze->reference[2u * ze->min_bin];
+        uint32_t num_bins = max_bin - ze->min_bin + 1u;
+
+        if (!ze->reference_valid)
+        {
+            set_reference(reference, spectrum, num_bins, profile->sample_scale);
+            ze->reference_valid = true;
+            ze->reference_ms = time_ms;
+        }
+
+        for (uint32_t i = 0; i < num_bins; ++i)
+        {
+            uint32_t bin = ze->min_bin + i;
+            float32_t re = ((float32_t)spectrum[2u * i] * profile->sample_scale) - reference[2u * i];
+            float32_t im = ((float32_t)spectrum[(2u * i) + 1u] * profile->sample_scale) - reference[(2u * i) + 1u];
+
+            arm_sqrt_f32((re * re) + (im * im), &ze->macro[bin]);
+            ze->micro[bin] += ZONE_ENGINE_MICRO_ALPHA * (profile->magnitude[bin] - ze->micro[bin]);
+        }
+
+        if ((time_ms - ze->reference_ms) >= ZONE_ENGINE_COMPARE_INTERVAL_MS)
+        {
+            set_reference(reference, spectrum, num_bins, profile->sample_scale);
+            ze->reference_ms = time_ms;
+        }
+    }
+
+    for (uint32_t z = 0; z < ZONE_ENGINE_MAX_ZONES; ++z)
+    {
+        zone_state_t* zone = &ze->zones[z];
+        xensiv_radar_presence_state_t state = zone->state;
+        uint32_t range_bin;
+
+        if (zone->reset)
+        {
+            /* One event per zone and frame, the new configuration runs from the next frame */
+            zone->reset = false;
+            events[count].zone_id = (uint8_t)z;
+            events[count].state = XENSIV_RADAR_PRESENCE_STATE_ABSENCE;
+            events[count].range_bin = zone->range_bin;
+            events[count].timestamp = time_ms;
+            ++count;
+            continue;
+        }
+
+        if (!zone->enabled || (zone->max_bin >= profile->num_bins))
+        {
+            continue;
+        }
+
+        if (zone_peak(ze->micro, zone, &range_bin) > zone->config.micro_threshold)
+        {
+            zone->last_micro_ms = time_ms;
+            zone->range_bin = range_bin;
+        }
+
+        if (zone_peak(ze->macro, zone, &range_bin) > zone->config.macro_threshold)
+        {
+            zone->last_macro_ms = time_ms;
+            zone->range_bin = range_bin;
+            state = XENSIV_RADAR_PRESENCE_STATE_MACRO_PRESENCE;
+        }
+        else if ((state == XENSIV_RADAR_PRESENCE_STATE_MACRO_PRESENCE) &&
+                 ((time_ms - zone->last_macro_ms) > zone->config.macro_validity_ms))
+        {
+            state = ((time_ms - zone->last_micro_ms) <= zone->config.micro_validity_ms) ?
+                    XENSIV_RADAR_PRESENCE_STATE_MICRO_PRESENCE : XENSIV_RADAR_PRESENCE_STATE_ABSENCE;
+        }
+        else if ((state == XENSIV_RADAR_PRESENCE_STATE_MICRO_PRESENCE) &&
+                 ((time_ms - zone->last_micro_ms) > zone->config.micro_validity_ms))
+        {
+            state = XENSIV_RADAR_PRESENCE_STATE_ABSENCE;
+        }
+        else
+        {
+            /* No change */
+        }
+
+        if (state != zone->state)
+        {
+            zone->state = state;
+            events[count].zone_id = (uint8_t)z;
+            events[count].state = state;
+            events[count].range_bin = zone->range_bin;
+            events[count].timestamp = time_ms;
+            ++count;
+        }
+    }
+
+    ze->stats.events += count;
+
+    return count;
+}
+
+/*******************************************************************************
+ * Function Name: zone_engine_account
+ *******************************************************************************
+ * Summary:
+ *   Records the cycles the caller measured for one zone_engine_update call
+ *   and prints the statistics periodically.
+ *
+ * Parameters:
+ *   ze: engine state
+ *   cycles: measured cycles
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void zone_engine_account(zone_engine_t* ze, uint32_t cycles)
+{
+    zone_engine_stats_t* stats = &ze->stats;
+
+    ++stats->frames;
+    stats->last_cycles = cycles;
+    stats->total_cycles += cycles;
+    if (cycles > stats->max_cycles)
+    {
+        stats->max_cycles = cycles;
+    }
+
+    if ((stats->frames % ZONE_ENGINE_STATS_PRINT_INTERVAL) == 0u)
+    {
+        uint32_t enabled = 0;
+
+        for (uint32_t z = 0; z < ZONE_ENGINE_MAX_ZONES; ++z)
+        {
+            enabled += ze->zones[z].enabled ? 1u : 0u;
+        }
+
+        printf("[INFO] presence zones %" PRIu32 " bins %" PRIu32 "..%" PRIu32 ": avg %" PRIu32 " max %" PRIu32
+               " cycles per frame, %" PRIu32 " events\n",
+               enabled, ze->min_bin, ze->max_bin, (uint32_t)(stats->total_cycles / stats->frames),
+               stats->max_cycles, stats->events);
+    }
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,155 @@
+/******************************************************************************
+ * File Name:   zone_engine.h
+ *
+ * Description: This file contains the function prototypes and constants used
+ *   in zone_engine.c.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+
+#pragma once
+
+/* Header file from system */
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Header file for library */
+#include "arm_math.h"
+#include "xensiv_radar_presence.h"
+
+/* Header file for local task */
+#include "range_fft.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Set to 0 to disable the presence zones, requires RANGE_FFT_ENABLED */
+#define ZONE_ENGINE_ENABLED                 (1)
+
+/* Zones evaluated on every frame */
+#define ZONE_ENGINE_MAX_ZONES               (4u)
+
+/* Interval between the reference spectrum and the compared frames */
+#define ZONE_ENGINE_COMPARE_INTERVAL_MS     (250u)
+
+/* Update weight of the micro motion level per frame */
+#define ZONE_ENGINE_MICRO_ALPHA             (0.05f)
+
+/* Defaults of a zone, thresholds in range profile magnitude. Starting point
+ * for the profile of register_list, to be tuned on recordings.
+ */
+#define ZONE_ENGINE_DEFAULT_MACRO_THRESHOLD (0.1f)
+#define ZONE_ENGINE_DEFAULT_MICRO_THRESHOLD (0.02f)
+#define ZONE_ENGINE_DEFAULT_MACRO_VALIDITY_MS (1000u)
+#define ZONE_ENGINE_DEFAULT_MICRO_VALIDITY_MS (4000u)
+
+/* Statistics are printed every time this many frames have been processed */
+#define ZONE_ENGINE_STATS_PRINT_INTERVAL    (2000u)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+/* Configurable fields of a zone, in the order of zone_config_t */
+typedef enum
+{
+    ZONE_FIELD_MIN_RANGE = 0,
+    ZONE_FIELD_MAX_RANGE,
+    ZONE_FIELD_MACRO_THRESHOLD,
+    ZONE_FIELD_MICRO_THRESHOLD,
+    ZONE_FIELD_MACRO_VALIDITY,
+    ZONE_FIELD_MICRO_VALIDITY,
+    ZONE_FIELD_COUNT
+} zone_field_t;
+
+/* A zone is disabled while max_range is not above min_range */
+typedef struct
+{
+    float min_range;                    /* meters */
+    float max_range;                    /* meters */
+    float macro_threshold;
+    float micro_threshold;
+    uint32_t macro_validity_ms;
+    uint32_t micro_validity_ms;
+} zone_config_t;
+
+typedef struct
+{
+    zone_config_t config;
+    bool enabled;
+    uint32_t min_bin;
+    uint32_t max_bin;
+    xensiv_radar_presence_state_t state;
+    bool reset;                         /* reconfigured while present, the absence is still to be reported */
+    uint32_t last_macro_ms;
+    uint32_t last_micro_ms;
+    uint32_t range_bin;                 /* of the last motion */
+} zone_state_t;
+
+typedef struct
+{
+    uint8_t zone_id;
+    xensiv_radar_presence_state_t state;
+    uint32_t range_bin;
+    uint32_t timestamp;
+} zone_event_t;
+
+typedef struct
+{
+    uint32_t frames;
+    uint32_t last_cycles;
+    uint32_t max_cycles;
+    uint64_t total_cycles;
+    uint32_t events;
+} zone_engine_stats_t;
+
+typedef struct
+{
+    zone_state_t zones[ZONE_ENGINE_MAX_ZONES];
+    float32_t bin_length;
+
+    /* Bins covered by the enabled zones, the shared metrics are computed once for them */
+    uint32_t min_bin;
+    uint32_t max_bin;
+    bool any_enabled;
+
+    float32_t reference[RANGE_FFT_MAX_SIZE];  /* complex spectrum, refreshed every ZONE_ENGINE_COMPARE_INTERVAL_MS */
+    bool reference_valid;
+    uint32_t reference_ms;
+    float32_t macro[RANGE_FFT_MAX_SIZE / 2u];
+    float32_t micro[RANGE_FFT_MAX_SIZE / 2u];
+
+    zone_engine_stats_t stats;
+} zone_engine_t;
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+void zone_engine_init(zone_engine_t* ze, float32_t bin_length);
+void zone_engine_default_config(zone_config_t* config);
+void zone_engine_set_field(zone_config_t* config, zone_field_t field, float value);
+float zone_engine_get_field(const zone_config_t* config, zone_field_t field);
+bool zone_engine_configure(zone_engine_t* ze, uint32_t zone_id, const zone_config_t* config);
+uint32_t zone_engine_update(zone_engine_t* ze, const range_profile_t* profile, uint32_t time_ms,
+                            zone_event_t events[ZONE_ENGINE_MAX_ZONES]);
+void zone_engine_account(zone_engine_t* ze, uint32_t cycles);
+
+/* [] END OF FILE */
@@ -0,0 +1,107 @@
+/*****************************************************************************
+ * File name: zone_occupancy.c
+ *
+ * Description: This file contains the occupancy of zones in front of the
+ * sensor, e.g. two desks seen by one sensor. A zone is occupied while
+ * targets fall into its azimuth and distance interval and is released
+ * ZONE_OCCUPANCY_HOLD_MS after the last one.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <string.h>
+
+/* Header file for local task */
+#include "zone_occupancy.h"
+
+/*******************************************************************************
+ * Function Name: zone_occupancy_init
+ *******************************************************************************
+ * Summary:
+ *   Initializes the occupancy with all zones free.
+ *
+ * Parameters:
+ *   zo: occupancy state
+ *   zones: zone table, must outlive zo
+ *   num_zones: entries of the table, at most ZONE_OCCUPANCY_MAX_ZONES are used
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void zone_occupancy_init(zone_occupancy_t* zo, const zone_t* zones, uint32_t num_zones)
+{
+    memset(zo, 0, sizeof(*zo));
+    zo->zones = zones;
+    zo->num_zones = (num_zones < ZONE_OCCUPANCY_MAX_ZONES) ? num_zones : ZONE_OCCUPANCY_MAX_ZONES;
+}
+
+/*******************************************************************************
+ * Function Name: zone_occupancy_update
+ *******************************************************************************
+ * Summary:
+ *   Updates the occupancy with the targets of a frame.
+ *
+ * Parameters:
+ *   zo: occupancy state
+ *   list: targets of the frame with their angles
+ *   time_ms: time of the frame
+ *
+ * Return:
+ *   true if a zone became occupied or free
+ ******************************************************************************/
+bool zone_occupancy_update(zone_occupancy_t* zo, const target_list_t* list, uint32_t time_ms)
+{
+    uint32_t occupied = 0;
+
+    for (uint32_t z = 0; z < zo->num_zones; ++z)
+    {
+        const zone_t* zone = &zo->zones[z];
+
+        for (uint32_t i = 0; i < list->count; ++i)
+        {
+            const target_t* target = &list->targets[i];
+
+            if ((target->azimuth >= zone->min_azimuth) && (target->azimuth <= zone->max_azimuth) &&
+                (target->distance >= zone->min_distance) && (target->distance <= zone->max_distance))
+            {
+                zo->last_hit_ms[z] = time_ms;
+                occupied |= (1u << z);
+                break;
+            }
+        }
+
+        if (((zo->occupied & (1u << z)) != 0u) && ((time_ms - zo->last_hit_ms[z]) < ZONE_OCCUPANCY_HOLD_MS))
+        {
+            occupied |= (1u << z);
+        }
+    }
+
+    if (occupied == zo->occupied)
+    {
+        return false;
+    }
+
+    zo->occupied = occupied;
+    return true;
+}
+
+/* [] END OF FILE */
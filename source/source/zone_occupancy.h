@@ -0,0 +1,77 @@
+/******************************************************************************
+ * File Name:   zone_occupancy.h
+ *
+ * Description: This file contains the function prototypes and constants used
+ *   in zone_occupancy.c.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+
+#pragma once
+
+/* Header file from system */
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Header file for library */
+#include "arm_math.h"
+
+/* Header file for local task */
+#include "target_detect.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Zones that can be observed at the same time, one bit each in the mask */
+#define ZONE_OCCUPANCY_MAX_ZONES            (4u)
+
+/* Time a zone stays occupied after its last target */
+#define ZONE_OCCUPANCY_HOLD_MS              (3000u)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+/* Region in front of the sensor, angles in degrees, distances in meters */
+typedef struct
+{
+    const char* name;
+    float32_t min_azimuth;
+    float32_t max_azimuth;
+    float32_t min_distance;
+    float32_t max_distance;
+} zone_t;
+
+typedef struct
+{
+    const zone_t* zones;
+    uint32_t num_zones;
+    uint32_t last_hit_ms[ZONE_OCCUPANCY_MAX_ZONES];
+    uint32_t occupied;                  /* bit i set while zone i is occupied */
+} zone_occupancy_t;
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+void zone_occupancy_init(zone_occupancy_t* zo, const zone_t* zones, uint32_t num_zones);
+bool zone_occupancy_update(zone_occupancy_t* zo, const target_list_t* list, uint32_t time_ms);
+
+/* [] END OF FILE */
@@ -0,0 +1,61 @@
+/******************************************************************************
+ * File Name:   FreeRTOS.h
+ *
+ * Description: Host stand-in of the FreeRTOS kernel for the host tested
+ *   modules that use tasks and queues. Every task is a POSIX thread, a tick
+ *   is 1 ms of the monotonic clock, and a critical section holds one global
+ *   recursive mutex. See freertos_host.c.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#pragma once
+
+/* Header file from system */
+#include <stdint.h>
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define pdFALSE                             (0)
+#define pdTRUE                              (1)
+#define pdPASS                              (pdTRUE)
+#define pdFAIL                              (pdFALSE)
+
+#define portMAX_DELAY                       ((TickType_t)0xffffffffu)
+#define portTICK_PERIOD_MS                  ((TickType_t)1u)
+#define pdMS_TO_TICKS(ms)                   ((TickType_t)(ms))
+
+#define taskENTER_CRITICAL()                host_enter_critical()
+#define taskEXIT_CRITICAL()                 host_exit_critical()
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t TickType_t;
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+void host_enter_critical(void);
+void host_exit_critical(void);
@@ -0,0 +1,135 @@
+/******************************************************************************
+ * File Name:   arm_math.h
+ *
+ * Description: Host stand-in of the CMSIS-DSP interface, with the types and
+ *   kernels used by the host tested modules. The kernels are implemented in
+ *   arm_math_host.c; the fixed point ones model the formats, rounding and
+ *   saturation of the library, not its exact bits.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#pragma once
+
+/* Header file from system */
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#ifndef PI
+#define PI                                  (3.14159265358979f)
+#endif
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef float float32_t;
+typedef double float64_t;
+typedef int8_t q7_t;
+typedef int16_t q15_t;
+typedef int32_t q31_t;
+typedef int64_t q63_t;
+
+typedef enum
+{
+    ARM_MATH_SUCCESS = 0,
+    ARM_MATH_ARGUMENT_ERROR = -1
+} arm_status;
+
+typedef struct
+{
+    uint16_t fftLen;
+} arm_cfft_instance_f32;
+
+typedef struct
+{
+    arm_cfft_instance_f32 Sint;
+    uint16_t fftLenRFFT;
+} arm_rfft_fast_instance_f32;
+
+typedef struct
+{
+    uint32_t fftLenReal;
+} arm_rfft_instance_q15;
+
+typedef struct
+{
+    uint32_t fftLenReal;
+} arm_rfft_instance_q31;
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+/* Saturating additions of the Cortex-M4 DSP extension */
+static inline q31_t __QADD(q31_t a, q31_t b)
+{
+    q63_t sum = (q63_t)a + b;
+
+    return (sum > INT32_MAX) ? INT32_MAX : ((sum < INT32_MIN) ? INT32_MIN : (q31_t)sum);
+}
+
+static inline q31_t __QSUB(q31_t a, q31_t b)
+{
+    q63_t difference = (q63_t)a - b;
+
+    return (difference > INT32_MAX) ? INT32_MAX : ((difference < INT32_MIN) ? INT32_MIN : (q31_t)difference);
+}
+
+void arm_fill_f32(float32_t value, float32_t* dst, uint32_t block_size);
+void arm_add_f32(const float32_t* src_a, const float32_t* src_b, float32_t* dst, uint32_t block_size);
+void arm_scale_f32(const float32_t* src, float32_t scale, float32_t* dst, uint32_t block_size);
+void arm_q15_to_float(const q15_t* src, float32_t* dst, uint32_t block_size);
+void arm_copy_f32(const float32_t* src, float32_t* dst, uint32_t block_size);
+void arm_sub_f32(const float32_t* src_a, const float32_t* src_b, float32_t* dst, uint32_t block_size);
+void arm_mult_f32(const float32_t* src_a, const float32_t* src_b, float32_t* dst, uint32_t block_size);
+void arm_offset_f32(const float32_t* src, float32_t offset, float32_t* dst, uint32_t block_size);
+void arm_mean_f32(const float32_t* src, uint32_t block_size, float32_t* result);
+void arm_cmplx_mag_f32(const float32_t* src, float32_t* dst, uint32_t num_samples);
+float32_t arm_cos_f32(float32_t x);
+float32_t arm_sin_f32(float32_t x);
+arm_status arm_sqrt_f32(float32_t in, float32_t* out);
+arm_status arm_rfft_fast_init_f32(arm_rfft_fast_instance_f32* instance, uint16_t fft_len);
+arm_status arm_rfft_fast_init_32_f32(arm_rfft_fast_instance_f32* instance);
+arm_status arm_rfft_fast_init_64_f32(arm_rfft_fast_instance_f32* instance);
+arm_status arm_rfft_fast_init_128_f32(arm_rfft_fast_instance_f32* instance);
+void arm_rfft_fast_f32(const arm_rfft_fast_instance_f32* instance, float32_t* src, float32_t* dst, uint8_t ifft_flag);
+void arm_float_to_q15(const float32_t* src, q15_t* dst, uint32_t block_size);
+void arm_float_to_q31(const float32_t* src, q31_t* dst, uint32_t block_size);
+void arm_q31_to_float(const q31_t* src, float32_t* dst, uint32_t block_size);
+void arm_mean_q15(const q15_t* src, uint32_t block_size, q15_t* result);
+void arm_mean_q31(const q31_t* src, uint32_t block_size, q31_t* result);
+void arm_offset_q15(const q15_t* src, q15_t offset, q15_t* dst, uint32_t block_size);
+void arm_offset_q31(const q31_t* src, q31_t offset, q31_t* dst, uint32_t block_size);
+void arm_mult_q15(const q15_t* src_a, const q15_t* src_b, q15_t* dst, uint32_t block_size);
+void arm_mult_q31(const q31_t* src_a, const q31_t* src_b, q31_t* dst, uint32_t block_size);
+void arm_cmplx_mag_q15(const q15_t* src, q15_t* dst, uint32_t num_samples);
+void arm_cmplx_mag_q31(const q31_t* src, q31_t* dst, uint32_t num_samples);
+arm_status arm_rfft_init_q15(arm_rfft_instance_q15* instance, uint32_t fft_len_real, uint32_t ifft_flag,
+                             uint32_t bit_reverse_flag);
+arm_status arm_rfft_init_q31(arm_rfft_instance_q31* instance, uint32_t fft_len_real, uint32_t ifft_flag,
+                             uint32_t bit_reverse_flag);
+void arm_rfft_q15(const arm_rfft_instance_q15* instance, q15_t* src, q15_t* dst);
+void arm_rfft_q31(const arm_rfft_instance_q31* instance, q31_t* src, q31_t* dst);
+
+/* [] END OF FILE */
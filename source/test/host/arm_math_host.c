@@ -0,0 +1,459 @@
+/*****************************************************************************
+ * File name: arm_math_host.c
+ *
+ * Description: Host stand-ins of the CMSIS-DSP kernels used by the host
+ * tested modules. The element wise kernels compute every element like the
+ * CMSIS-DSP C code, so single precision results are bit identical. The
+ * transforms are DFTs in double precision in the output format of CMSIS-DSP,
+ * they match the library within the rounding of its float32 FFT.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <math.h>
+#include <string.h>
+
+/* Header file for library */
+#include "arm_math.h"
+
+void arm_fill_f32(float32_t value, float32_t* dst, uint32_t block_size)
+{
+    while (block_size-- > 0u)
+    {
+        *dst++ = value;
+    }
+}
+
+void arm_add_f32(const float32_t* src_a, const float32_t* src_b, float32_t* dst, uint32_t block_size)
+{
+    while (block_size-- > 0u)
+    {
+        *dst++ = *src_a++ + *src_b++;
+    }
+}
+
+void arm_scale_f32(const float32_t* src, float32_t scale, float32_t* dst, uint32_t block_size)
+{
+    while (block_size-- > 0u)
+    {
+        *dst++ = *src++ * scale;
+    }
+}
+
+void arm_q15_to_float(const q15_t* src, float32_t* dst, uint32_t block_size)
+{
+    while (block_size-- > 0u)
+    {
+        *dst++ = ((float32_t)*src++ / 32768.0f);
+    }
+}
+
+void arm_copy_f32(const float32_t* src, float32_t* dst, uint32_t block_size)
+{
+    memmove(dst, src, block_size * sizeof(float32_t));
+}
+
+void arm_sub_f32(const float32_t* src_a, const float32_t* src_b, float32_t* dst, uint32_t block_size)
+{
+    while (block_size-- > 0u)
+    {
+        *dst++ = *src_a++ - *src_b++;
+    }
+}
+
+void arm_mult_f32(const float32_t* src_a, const float32_t* src_b, float32_t* dst, uint32_t block_size)
+{
+    while (block_size-- > 0u)
+    {
+        *dst++ = *src_a++ * *src_b++;
+    }
+}
+
+void arm_offset_f32(const float32_t* src, float32_t offset, float32_t* dst, uint32_t block_size)
+{
+    while (block_size-- > 0u)
+    {
+        *dst++ = *src++ + offset;
+    }
+}
+
+void arm_mean_f32(const float32_t* src, uint32_t block_size, float32_t* result)
+{
+    float32_t sum = 0.0f;
+
+    for (uint32_t i = 0; i < block_size; ++i)
+    {
+        sum += src[i];
+    }
+    *result = sum / (float32_t)block_size;
+}
+
+void arm_cmplx_mag_f32(const float32_t* src, float32_t* dst, uint32_t num_samples)
+{
+    for (uint32_t i = 0; i < num_samples; ++i)
+    {
+        dst[i] = sqrtf((src[2u * i] * src[2u * i]) + (src[(2u * i) + 1u] * src[(2u * i) + 1u]));
+    }
+}
+
+float32_t arm_cos_f32(float32_t x)
+{
+    return cosf(x);
+}
+
+float32_t arm_sin_f32(float32_t x)
+{
+    return sinf(x);
+}
+
+arm_status arm_sqrt_f32(float32_t in, float32_t* out)
+{
+    if (in < 0.0f)
+    {
+        *out = 0.0f;
+        return ARM_MATH_ARGUMENT_ERROR;
+    }
+    *out = sqrtf(in);
+    return ARM_MATH_SUCCESS;
+}
+
+arm_status arm_rfft_fast_init_f32(arm_rfft_fast_instance_f32* instance, uint16_t fft_len)
+{
+    /* The library links the tables of 32 to 4096 points */
+    if ((fft_len < 32u) || (fft_len > 4096u) || ((fft_len & (fft_len - 1u)) != 0u))
+    {
+        return ARM_MATH_ARGUMENT_ERROR;
+    }
+    instance->fftLenRFFT = fft_len;
+    instance->Sint.fftLen = fft_len / 2u;
+    return ARM_MATH_SUCCESS;
+}
+
+arm_status arm_rfft_fast_init_32_f32(arm_rfft_fast_instance_f32* instance)
+{
+    return arm_rfft_fast_init_f32(instance, 32u);
+}
+
+arm_status arm_rfft_fast_init_64_f32(arm_rfft_fast_instance_f32* instance)
+{
+    return arm_rfft_fast_init_f32(instance, 64u);
+}
+
+arm_status arm_rfft_fast_init_128_f32(arm_rfft_fast_instance_f32* instance)
+{
+    return arm_rfft_fast_init_f32(instance, 128u);
+}
+
+/* Bins 0 to N / 2 - 1 as re/im pairs, the real Nyquist bin in place of the
+ * imaginary part of the DC bin
+ */
+void arm_rfft_fast_f32(const arm_rfft_fast_instance_f32* instance, float32_t* src, float32_t* dst, uint8_t ifft_flag)
+{
+    uint32_t n = instance->fftLenRFFT;
+    float64_t nyquist = 0.0;
+
+    (void)ifft_flag;
+    for (uint32_t k = 0; k < (n / 2u); ++k)
+    {
+        float64_t re = 0.0;
+        float64_t im = 0.0;
+
+        for (uint32_t t = 0; t < n; ++t)
+        {
+            float64_t phase = (2.0 * M_PI * (float64_t)((k * t) % n)) / (float64_t)n;
+
+            re += (float64_t)src[t] * cos(phase);
+            im -= (float64_t)src[t] * sin(phase);
+        }
+        dst[2u * k] = (float32_t)re;
+        dst[(2u * k) + 1u] = (float32_t)im;
+    }
+    for (uint32_t t = 0; t < n; ++t)
+    {
+        nyquist += ((t & 1u) != 0u) ? -(float64_t)src[t] : (float64_t)src[t];
+    }
+    dst[1] = (float32_t)nyquist;
+}
+
+/* Largest real FFT of the fixed point model */
+#define RFFT_Q_MAX_SIZE                     (4096u)
+
+/* Sums of Q31 products need more than 64 bits */
+typedef __int128 wide_t;
+
+/* Saturates a value to the fixed point format with frac_bits fractional bits */
+static int64_t saturate(int64_t value, uint32_t frac_bits)
+{
+    int64_t max = ((int64_t)1 << frac_bits) - 1;
+
+    return (value > max) ? max : ((value < (-max - 1)) ? (-max - 1) : value);
+}
+
+static int64_t float_to_fixed(float64_t value, uint32_t frac_bits)
+{
+    return saturate((int64_t)llround(value * (float64_t)((int64_t)1 << frac_bits)), frac_bits);
+}
+
+void arm_float_to_q15(const float32_t* src, q15_t* dst, uint32_t block_size)
+{
+    while (block_size-- > 0u)
+    {
+        *dst++ = (q15_t)float_to_fixed(*src++, 15u);
+    }
+}
+
+void arm_float_to_q31(const float32_t* src, q31_t* dst, uint32_t block_size)
+{
+    while (block_size-- > 0u)
+    {
+        *dst++ = (q31_t)float_to_fixed(*src++, 31u);
+    }
+}
+
+void arm_q31_to_float(const q31_t* src, float32_t* dst, uint32_t block_size)
+{
+    while (block_size-- > 0u)
+    {
+        *dst++ = (float32_t)((float64_t)*src++ / 2147483648.0);
+    }
+}
+
+void arm_mean_q15(const q15_t* src, uint32_t block_size, q15_t* result)
+{
+    int32_t sum = 0;
+
+    for (uint32_t i = 0; i < block_size; ++i)
+    {
+        sum += src[i];
+    }
+    *result = (q15_t)(sum / (int32_t)block_size);
+}
+
+void arm_mean_q31(const q31_t* src, uint32_t block_size, q31_t* result)
+{
+    int64_t sum = 0;
+
+    for (uint32_t i = 0; i < block_size; ++i)
+    {
+        sum += src[i];
+    }
+    *result = (q31_t)(sum / (int64_t)block_size);
+}
+
+void arm_offset_q15(const q15_t* src, q15_t offset, q15_t* dst, uint32_t block_size)
+{
+    while (block_size-- > 0u)
+    {
+        *dst++ = (q15_t)saturate((int64_t)*src++ + offset, 15u);
+    }
+}
+
+void arm_offset_q31(const q31_t* src, q31_t offset, q31_t* dst, uint32_t block_size)
+{
+    while (block_size-- > 0u)
+    {
+        *dst++ = (q31_t)saturate((int64_t)*src++ + offset, 31u);
+    }
+}
+
+void arm_mult_q15(const q15_t* src_a, const q15_t* src_b, q15_t* dst, uint32_t block_size)
+{
+    while (block_size-- > 0u)
+    {
+        *dst++ = (q15_t)saturate(((int64_t)*src_a++ * *src_b++) >> 15, 15u);
+    }
+}
+
+/* The library keeps the high word of the product and shifts it up by one */
+void arm_mult_q31(const q31_t* src_a, const q31_t* src_b, q31_t* dst, uint32_t block_size)
+{
+    while (block_size-- > 0u)
+    {
+        *dst++ = (q31_t)saturate((((int64_t)*src_a++ * *src_b++) >> 32) << 1, 31u);
+    }
+}
+
+/* 1.15 in, 2.14 out: the magnitude is halved */
+void arm_cmplx_mag_q15(const q15_t* src, q15_t* dst, uint32_t num_samples)
+{
+    for (uint32_t i = 0; i < num_samples; ++i)
+    {
+        int64_t power = ((int64_t)src[2u * i] * src[2u * i]) + ((int64_t)src[(2u * i) + 1u] * src[(2u * i) + 1u]);
+
+        dst[i] = (q15_t)saturate((int64_t)floor(sqrt((float64_t)power) / 2.0), 15u);
+    }
+}
+
+/* 1.31 in, 2.30 out: the magnitude is halved */
+void arm_cmplx_mag_q31(const q31_t* src, q31_t* dst, uint32_t num_samples)
+{
+    for (uint32_t i = 0; i < num_samples; ++i)
+    {
+        float64_t re = (float64_t)src[2u * i];
+        float64_t im = (float64_t)src[(2u * i) + 1u];
+
+        dst[i] = (q31_t)saturate((int64_t)floor(sqrt((re * re) + (im * im)) / 2.0), 31u);
+    }
+}
+
+static arm_status rfft_init_q(uint32_t* fft_len, uint32_t fft_len_real, uint32_t ifft_flag)
+{
+    if ((fft_len_real < 32u) || (fft_len_real > RFFT_Q_MAX_SIZE) || ((fft_len_real & (fft_len_real - 1u)) != 0u) ||
+        (ifft_flag != 0u))
+    {
+        return ARM_MATH_ARGUMENT_ERROR;
+    }
+    *fft_len = fft_len_real;
+    return ARM_MATH_SUCCESS;
+}
+
+arm_status arm_rfft_init_q15(arm_rfft_instance_q15* instance, uint32_t fft_len_real, uint32_t ifft_flag,
+                             uint32_t bit_reverse_flag)
+{
+    (void)bit_reverse_flag;
+    return rfft_init_q(&instance->fftLenReal, fft_len_real, ifft_flag);
+}
+
+arm_status arm_rfft_init_q31(arm_rfft_instance_q31* instance, uint32_t fft_len_real, uint32_t ifft_flag,
+                             uint32_t bit_reverse_flag)
+{
+    (void)bit_reverse_flag;
+    return rfft_init_q(&instance->fftLenReal, fft_len_real, ifft_flag);
+}
+
+/* Real FFT in the structure of the library: a complex FFT of n / 2 points on
+ * the even and odd samples with a truncating halving in every stage, then the
+ * split into the real spectrum with twiddles in the sample format and one
+ * more halving. The output is scaled down by n and holds all n complex bins,
+ * as documented for arm_rfft_q15 and arm_rfft_q31 (e.g. 1.15 in and 8.8 out
+ * at 128 points). The rounding of the butterflies differs from the radix 4
+ * stages of the library, the error is of the same order.
+ */
+static void rfft_q(uint32_t n, const int64_t* src, int64_t* dst, uint32_t frac_bits)
+{
+    static int64_t re[RFFT_Q_MAX_SIZE / 2u];
+    static int64_t im[RFFT_Q_MAX_SIZE / 2u];
+    uint32_t half = n / 2u;
+    float64_t one = (float64_t)((int64_t)1 << frac_bits);
+
+    /* Bit reversed order of z[m] = x[2m] + j x[2m + 1] */
+    for (uint32_t m = 0, r = 0; m < half; ++m)
+    {
+        re[r] = src[2u * m];
+        im[r] = src[(2u * m) + 1u];
+        for (uint32_t bit = half >> 1; bit > 0u; bit >>= 1)
+        {
+            r ^= bit;
+            if ((r & bit) != 0u)
+            {
+                break;
+            }
+        }
+    }
+
+    for (uint32_t len = 2u; len <= half; len <<= 1)
+    {
+        for (uint32_t start = 0; start < half; start += len)
+        {
+            for (uint32_t k = 0; k < (len / 2u); ++k)
+            {
+                float64_t phase = (2.0 * M_PI * (float64_t)k) / (float64_t)len;
+                int64_t w_re = saturate(llround(cos(phase) * one), frac_bits);
+                int64_t w_im = saturate(llround(-sin(phase) * one), frac_bits);
+                uint32_t a = start + k;
+                uint32_t b = a + (len / 2u);
+                int64_t t_re = (int64_t)((((wide_t)re[b] * w_re) - ((wide_t)im[b] * w_im)) >> frac_bits);
+                int64_t t_im = (int64_t)((((wide_t)re[b] * w_im) + ((wide_t)im[b] * w_re)) >> frac_bits);
+
+                re[b] = (re[a] - t_re) >> 1;
+                im[b] = (im[a] - t_im) >> 1;
+                re[a] = (re[a] + t_re) >> 1;
+                im[a] = (im[a] + t_im) >> 1;
+            }
+        }
+    }
+
+    /* X[k] = A[k] Z[k] + B[k] conj(Z[n / 2 - k]), A = (1 - j W^k) / 2, B = (1 + j W^k) / 2 */
+    for (uint32_t k = 0; k < half; ++k)
+    {
+        float64_t phase = (2.0 * M_PI * (float64_t)k) / (float64_t)n;
+        int64_t a_re = float_to_fixed(0.5 * (1.0 - sin(phase)), frac_bits);
+        int64_t a_im = float_to_fixed(-0.5 * cos(phase), frac_bits);
+        int64_t b_re = float_to_fixed(0.5 * (1.0 + sin(phase)), frac_bits);
+        int64_t b_im = float_to_fixed(0.5 * cos(phase), frac_bits);
+        uint32_t mirror = (k == 0u) ? 0u : (half - k);
+        wide_t z_re = re[k];
+        wide_t z_im = im[k];
+        wide_t c_re = re[mirror];
+        wide_t c_im = -im[mirror];
+
+        dst[2u * k] = saturate((int64_t)(((z_re * a_re) - (z_im * a_im) + (c_re * b_re) - (c_im * b_im)) >>
+                                         (frac_bits + 1u)), frac_bits);
+        dst[(2u * k) + 1u] = saturate((int64_t)(((z_re * a_im) + (z_im * a_re) + (c_re * b_im) + (c_im * b_re)) >>
+                                                (frac_bits + 1u)), frac_bits);
+    }
+
+    /* Nyquist bin, then the conjugate symmetric upper half */
+    dst[n] = (re[0] - im[0]) >> 1;
+    dst[n + 1u] = 0;
+    for (uint32_t k = 1; k < half; ++k)
+    {
+        dst[2u * (n - k)] = dst[2u * k];
+        dst[(2u * (n - k)) + 1u] = saturate(-dst[(2u * k) + 1u], frac_bits);
+    }
+}
+
+void arm_rfft_q15(const arm_rfft_instance_q15* instance, q15_t* src, q15_t* dst)
+{
+    static int64_t in[RFFT_Q_MAX_SIZE];
+    static int64_t out[2u * RFFT_Q_MAX_SIZE];
+    uint32_t n = instance->fftLenReal;
+
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        in[i] = src[i];
+    }
+    rfft_q(n, in, out, 15u);
+    for (uint32_t i = 0; i < (2u * n); ++i)
+    {
+        dst[i] = (q15_t)out[i];
+    }
+}
+
+void arm_rfft_q31(const arm_rfft_instance_q31* instance, q31_t* src, q31_t* dst)
+{
+    static int64_t in[RFFT_Q_MAX_SIZE];
+    static int64_t out[2u * RFFT_Q_MAX_SIZE];
+    uint32_t n = instance->fftLenReal;
+
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        in[i] = src[i];
+    }
+    rfft_q(n, in, out, 31u);
+    for (uint32_t i = 0; i < (2u * n); ++i)
+    {
+        dst[i] = (q31_t)out[i];
+    }
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,423 @@
+/*****************************************************************************
+ * File name: freertos_host.c
+ *
+ * Description: Host stand-ins of the FreeRTOS tasks, task notifications and
+ * queues used by the host tested modules. Every task is a POSIX thread, and
+ * the threads run in parallel rather than by priority, so a module has to be
+ * correct without relying on the priorities of its tasks. The queues and
+ * notifications share one mutex and one condition variable, every change
+ * wakes all waiting threads, which check their condition again.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Header file includes */
+#include "FreeRTOS.h"
+#include "queue.h"
+#include "task.h"
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+struct host_task
+{
+    pthread_t thread;
+    TaskFunction_t function;
+    void* parameters;
+    uint32_t notifications;
+};
+
+struct host_queue
+{
+    uint8_t* items;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+};
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static pthread_once_t kernel_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t critical_mutex;
+static pthread_mutex_t kernel_mutex;
+static pthread_cond_t kernel_cond;
+static struct timespec start_time;
+
+/* Task of the calling thread, created on demand for the main thread */
+static __thread struct host_task* current_task = NULL;
+
+/*******************************************************************************
+ * Function Name: kernel_init
+ *******************************************************************************
+ * Summary:
+ *   Creates the mutexes and the condition variable on the first use and
+ *   starts the tick count.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void kernel_init(void)
+{
+    pthread_mutexattr_t mutex_attr;
+    pthread_condattr_t cond_attr;
+
+    pthread_mutexattr_init(&mutex_attr);
+    pthread_mutexattr_settype(&mutex_attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&critical_mutex, &mutex_attr);
+    pthread_mutex_init(&kernel_mutex, NULL);
+
+    pthread_condattr_init(&cond_attr);
+    pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&kernel_cond, &cond_attr);
+
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+}
+
+/*******************************************************************************
+ * Function Name: unlock_kernel
+ *******************************************************************************
+ * Summary:
+ *   Releases the kernel mutex when a task is deleted while it waits.
+ *
+ * Parameters:
+ *   arg: unused
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void unlock_kernel(void* arg)
+{
+    (void)arg;
+    pthread_mutex_unlock(&kernel_mutex);
+}
+
+/*******************************************************************************
+ * Function Name: wait_kernel
+ *******************************************************************************
+ * Summary:
+ *   Waits with the kernel mutex held for a change of a queue or of a
+ *   notification, or until the deadline.
+ *
+ * Parameters:
+ *   ticks: timeout from the start of the wait, portMAX_DELAY waits forever
+ *   deadline: end of the wait, computed by the caller from ticks
+ *
+ * Return:
+ *   false once the deadline has passed
+ ******************************************************************************/
+static bool wait_kernel(TickType_t ticks, const struct timespec* deadline)
+{
+    volatile int result;
+
+    pthread_cleanup_push(unlock_kernel, NULL);
+    if (ticks == portMAX_DELAY)
+    {
+        result = pthread_cond_wait(&kernel_cond, &kernel_mutex);
+    }
+    else
+    {
+        result = pthread_cond_timedwait(&kernel_cond, &kernel_mutex, deadline);
+    }
+    pthread_cleanup_pop(0);
+
+    return (result == 0);
+}
+
+/*******************************************************************************
+ * Function Name: deadline_after
+ *******************************************************************************
+ * Summary:
+ *   Returns the monotonic time ticks ms from now.
+ *
+ * Parameters:
+ *   ticks: timeout
+ *
+ * Return:
+ *   deadline
+ ******************************************************************************/
+static struct timespec deadline_after(TickType_t ticks)
+{
+    struct timespec deadline;
+
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += (time_t)(ticks / 1000u);
+    deadline.tv_nsec += (long)(ticks % 1000u) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L)
+    {
+        ++deadline.tv_sec;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    return deadline;
+}
+
+/*******************************************************************************
+ * Function Name: task_entry
+ *******************************************************************************
+ * Summary:
+ *   Thread of a task: runs the function of the task.
+ *
+ * Parameters:
+ *   arg: task
+ *
+ * Return:
+ *   NULL
+ ******************************************************************************/
+static void* task_entry(void* arg)
+{
+    current_task = (struct host_task*)arg;
+    current_task->function(current_task->parameters);
+
+    return NULL;
+}
+
+void host_enter_critical(void)
+{
+    pthread_once(&kernel_once, kernel_init);
+    pthread_mutex_lock(&critical_mutex);
+}
+
+void host_exit_critical(void)
+{
+    pthread_mutex_unlock(&critical_mutex);
+}
+
+BaseType_t xTaskCreate(TaskFunction_t function, const char* name, uint32_t stack_depth, void* parameters,
+                       UBaseType_t priority, TaskHandle_t* handle)
+{
+    struct host_task* task = calloc(1, sizeof(*task));
+
+    (void)name;
+    (void)stack_depth;
+    (void)priority;
+
+    pthread_once(&kernel_once, kernel_init);
+    if (task == NULL)
+    {
+        return pdFAIL;
+    }
+
+    task->function = function;
+    task->parameters = parameters;
+
+    /* The handle is valid before the task runs, as on FreeRTOS */
+    if (handle != NULL)
+    {
+        *handle = task;
+    }
+    if (pthread_create(&task->thread, NULL, task_entry, task) != 0)
+    {
+        if (handle != NULL)
+        {
+            *handle = NULL;
+        }
+        free(task);
+        return pdFAIL;
+    }
+
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    if ((task == NULL) || (task == current_task))
+    {
+        pthread_exit(NULL);
+    }
+
+    pthread_cancel(task->thread);
+    pthread_join(task->thread, NULL);
+    free(task);
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    struct timespec delay = { (time_t)(ticks / 1000u), (long)(ticks % 1000u) * 1000000L };
+
+    while (nanosleep(&delay, &delay) != 0)
+    {
+    }
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    struct timespec now;
+
+    pthread_once(&kernel_once, kernel_init);
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (TickType_t)(((now.tv_sec - start_time.tv_sec) * 1000) + ((now.tv_nsec - start_time.tv_nsec) / 1000000L));
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    pthread_once(&kernel_once, kernel_init);
+    pthread_mutex_lock(&kernel_mutex);
+    ++task->notifications;
+    pthread_cond_broadcast(&kernel_cond);
+    pthread_mutex_unlock(&kernel_mutex);
+
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks)
+{
+    struct timespec deadline = deadline_after(ticks);
+    uint32_t value;
+
+    pthread_once(&kernel_once, kernel_init);
+    if (current_task == NULL)
+    {
+        current_task = calloc(1, sizeof(*current_task));
+        current_task->thread = pthread_self();
+    }
+
+    pthread_mutex_lock(&kernel_mutex);
+    while ((current_task->notifications == 0u) && (ticks > 0u) && wait_kernel(ticks, &deadline))
+    {
+    }
+    value = current_task->notifications;
+    if (value > 0u)
+    {
+        current_task->notifications = (clear_on_exit != pdFALSE) ? 0u : (value - 1u);
+    }
+    pthread_mutex_unlock(&kernel_mutex);
+
+    return value;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    struct host_queue* queue = calloc(1, sizeof(*queue));
+
+    pthread_once(&kernel_once, kernel_init);
+    if (queue == NULL)
+    {
+        return NULL;
+    }
+
+    queue->items = calloc(length, item_size);
+    if (queue->items == NULL)
+    {
+        free(queue);
+        return NULL;
+    }
+    queue->length = length;
+    queue->item_size = item_size;
+
+    return queue;
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t queue, const void* item, TickType_t ticks)
+{
+    struct timespec deadline = deadline_after(ticks);
+    BaseType_t result = pdFALSE;
+
+    pthread_mutex_lock(&kernel_mutex);
+    while ((queue->count == queue->length) && (ticks > 0u) && wait_kernel(ticks, &deadline))
+    {
+    }
+    if (queue->count < queue->length)
+    {
+        memcpy(&queue->items[((queue->head + queue->count) % queue->length) * queue->item_size], item,
+               queue->item_size);
+        ++queue->count;
+        pthread_cond_broadcast(&kernel_cond);
+        result = pdTRUE;
+    }
+    pthread_mutex_unlock(&kernel_mutex);
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: queue_get
+ *******************************************************************************
+ * Summary:
+ *   Copies the oldest item of a queue, waiting for one up to ticks, and
+ *   removes it unless peeked.
+ *
+ * Parameters:
+ *   queue: queue
+ *   item: destination
+ *   ticks: timeout
+ *   remove: false to peek
+ *
+ * Return:
+ *   pdTRUE if an item was copied
+ ******************************************************************************/
+static BaseType_t queue_get(QueueHandle_t queue, void* item, TickType_t ticks, bool remove)
+{
+    struct timespec deadline = deadline_after(ticks);
+    BaseType_t result = pdFALSE;
+
+    pthread_mutex_lock(&kernel_mutex);
+    while ((queue->count == 0u) && (ticks > 0u) && wait_kernel(ticks, &deadline))
+    {
+    }
+    if (queue->count > 0u)
+    {
+        memcpy(item, &queue->items[queue->head * queue->item_size], queue->item_size);
+        if (remove)
+        {
+            queue->head = (queue->head + 1u) % queue->length;
+            --queue->count;
+            pthread_cond_broadcast(&kernel_cond);
+        }
+        result = pdTRUE;
+    }
+    pthread_mutex_unlock(&kernel_mutex);
+
+    return result;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticks)
+{
+    return queue_get(queue, item, ticks, true);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t queue, void* item, TickType_t ticks)
+{
+    return queue_get(queue, item, ticks, false);
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+    UBaseType_t count;
+
+    pthread_mutex_lock(&kernel_mutex);
+    count = queue->count;
+    pthread_mutex_unlock(&kernel_mutex);
+
+    return count;
+}
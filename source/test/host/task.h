@@ -0,0 +1,49 @@
+/******************************************************************************
+ * File Name:   task.h
+ *
+ * Description: Host stand-in of the FreeRTOS task interface used by the host
+ *   tested modules, see FreeRTOS.h. The priority and the stack size of a task
+ *   are ignored.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#pragma once
+
+/* Header file includes */
+#include "FreeRTOS.h"
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef struct host_task* TaskHandle_t;
+typedef void (*TaskFunction_t)(void* parameters);
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+BaseType_t xTaskCreate(TaskFunction_t function, const char* name, uint32_t stack_depth, void* parameters,
+                       UBaseType_t priority, TaskHandle_t* handle);
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount(void);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks);
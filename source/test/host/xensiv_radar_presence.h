@@ -0,0 +1,100 @@
+/******************************************************************************
+ * File Name:   xensiv_radar_presence.h
+ *
+ * Description: Host stand-in of the interface of the xensiv-radar-presence
+ *   library, with the types and functions used by the host tested modules.
+ *   The tests provide the functions they need.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#pragma once
+
+/* Header file from system */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Header file for library */
+#include "arm_math.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define XENSIV_RADAR_PRESENCE_OK            (0)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef enum
+{
+    XENSIV_RADAR_PRESENCE_MODE_MACRO_ONLY = 0,
+    XENSIV_RADAR_PRESENCE_MODE_MICRO_ONLY,
+    XENSIV_RADAR_PRESENCE_MODE_MICRO_IF_MACRO,
+    XENSIV_RADAR_PRESENCE_MODE_MICRO_AND_MACRO
+} xensiv_radar_presence_mode_t;
+
+typedef enum
+{
+    XENSIV_RADAR_PRESENCE_STATE_MACRO_PRESENCE = 0,
+    XENSIV_RADAR_PRESENCE_STATE_MICRO_PRESENCE,
+    XENSIV_RADAR_PRESENCE_STATE_ABSENCE
+} xensiv_radar_presence_state_t;
+
+typedef struct
+{
+    float32_t bandwidth;
+    int32_t num_samples_per_chirp;
+    bool micro_fft_decimation_enabled;
+    int32_t micro_fft_size;
+    float32_t macro_threshold;
+    float32_t micro_threshold;
+    int32_t min_range_bin;
+    int32_t max_range_bin;
+    int32_t macro_compare_interval_ms;
+    int32_t macro_movement_validity_ms;
+    int32_t micro_movement_validity_ms;
+    int32_t macro_movement_confirmations;
+    int32_t macro_trigger_range;
+    xensiv_radar_presence_mode_t mode;
+    bool macro_fft_bandpass_filter_enabled;
+    int32_t micro_movement_compare_idx;
+} xensiv_radar_presence_config_t;
+
+typedef struct
+{
+    uint32_t timestamp;
+    xensiv_radar_presence_state_t state;
+    int32_t range_bin;
+} xensiv_radar_presence_event_t;
+
+typedef struct xensiv_radar_presence_context* xensiv_radar_presence_handle_t;
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+int32_t xensiv_radar_presence_get_config(xensiv_radar_presence_handle_t handle,
+                                         xensiv_radar_presence_config_t* config);
+int32_t xensiv_radar_presence_set_config(xensiv_radar_presence_handle_t handle,
+                                         const xensiv_radar_presence_config_t* config);
+void xensiv_radar_presence_reset(xensiv_radar_presence_handle_t handle);
+
+/* [] END OF FILE */
@@ -0,0 +1,504 @@
+/*****************************************************************************
+ * File name: test_adaptive_rate.c
+ *
+ * Description: Replays an occupancy trace through adaptive_rate.c, once with
+ * the slow scan and once held at full rate, and quantifies the frames saved
+ * and the detection latency added by the slow scan. The presence library is
+ * replaced by a model with the timing of its macro and micro detection: a
+ * macro presence needs motion over one macro compare interval, a presence is
+ * kept for the validity times, and a reset drops what has been detected.
+ * A mode forced like by the threshold calibration must not lose a user mode
+ * set meanwhile.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Header file for local task */
+#include "adaptive_rate.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Frame period of register_list */
+#define FULL_FRAME_PERIOD_MS                (5u)
+
+#define NUM_VISITS                          (sizeof(trace) / sizeof(trace[0]))
+
+/* A person walks for this long after entering and before leaving */
+#define WALK_MS                             (6000u)
+
+/* While seated, a short movement of MOVE_MS every MOVE_INTERVAL_MS */
+#define MOVE_INTERVAL_MS                    (90000u)
+#define MOVE_MS                             (1500u)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+/* One visit of the trace, times in s */
+typedef struct
+{
+    uint32_t enter_s;
+    uint32_t leave_s;
+} visit_t;
+
+typedef struct
+{
+    uint32_t frames;
+    uint32_t reported_ms[2][16];        /* presence and absence reported per visit */
+    uint32_t reported_count[2][16];
+    uint32_t spurious;                  /* absence during a visit, presence in an empty room */
+    bool present;                       /* last reported state */
+    adaptive_rate_stats_t stats;
+} replay_result_t;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+/* Occupancy of a meeting room over four hours */
+static const visit_t trace[] =
+{
+    { 1200, 3000 },
+    { 3600, 3660 },
+    { 5400, 9000 },
+    { 9180, 9300 },
+    { 11000, 11005 },
+    { 12600, 14000 },
+};
+
+static const xensiv_radar_presence_config_t default_config =
+{
+    .micro_fft_decimation_enabled = false,
+    .micro_fft_size = 128,
+    .min_range_bin = 1,
+    .max_range_bin = 5,
+    .macro_compare_interval_ms = 250,
+    .macro_movement_validity_ms = 1000,
+    .micro_movement_validity_ms = 4000,
+    .mode = XENSIV_RADAR_PRESENCE_MODE_MICRO_IF_MACRO,
+};
+
+/* Model of the presence library */
+static xensiv_radar_presence_config_t model_config;
+static xensiv_radar_presence_state_t model_state;
+static uint32_t model_reset_ms;
+static bool model_motion_run;
+static uint32_t model_motion_start_ms;
+static bool model_macro_seen;
+static uint32_t model_last_macro_ms;
+static uint32_t model_micro_frames;
+static uint32_t model_last_micro_ms;
+static uint32_t model_time_ms;
+
+static replay_result_t* result;
+
+/*******************************************************************************
+ * Function Name: xensiv_radar_presence_get_config
+ *******************************************************************************
+ * Summary:
+ *   Presence library model, returns the configuration.
+ ******************************************************************************/
+int32_t xensiv_radar_presence_get_config(xensiv_radar_presence_handle_t handle,
+                                         xensiv_radar_presence_config_t* config)
+{
+    (void)handle;
+    *config = model_config;
+    return XENSIV_RADAR_PRESENCE_OK;
+}
+
+/*******************************************************************************
+ * Function Name: xensiv_radar_presence_set_config
+ *******************************************************************************
+ * Summary:
+ *   Presence library model, takes a configuration.
+ ******************************************************************************/
+int32_t xensiv_radar_presence_set_config(xensiv_radar_presence_handle_t handle,
+                                         const xensiv_radar_presence_config_t* config)
+{
+    (void)handle;
+    model_config = *config;
+    return XENSIV_RADAR_PRESENCE_OK;
+}
+
+/*******************************************************************************
+ * Function Name: xensiv_radar_presence_reset
+ *******************************************************************************
+ * Summary:
+ *   Presence library model, drops everything detected so far.
+ ******************************************************************************/
+void xensiv_radar_presence_reset(xensiv_radar_presence_handle_t handle)
+{
+    (void)handle;
+    model_state = XENSIV_RADAR_PRESENCE_STATE_ABSENCE;
+    model_reset_ms = model_time_ms;
+    model_motion_run = false;
+    model_macro_seen = false;
+    model_micro_frames = 0;
+}
+
+/*******************************************************************************
+ * Function Name: visit_at
+ *******************************************************************************
+ * Summary:
+ *   Returns the visit of the trace at a time, -1 if the room is empty.
+ ******************************************************************************/
+static int32_t visit_at(uint32_t time_ms)
+{
+    for (uint32_t i = 0; i < NUM_VISITS; ++i)
+    {
+        if ((time_ms >= (trace[i].enter_s * 1000u)) && (time_ms < (trace[i].leave_s * 1000u)))
+        {
+            return (int32_t)i;
+        }
+    }
+    return -1;
+}
+
+/*******************************************************************************
+ * Function Name: motion_at
+ *******************************************************************************
+ * Summary:
+ *   Returns true if the person of a visit moves at a time: while walking in
+ *   and out and during the short movements while seated.
+ ******************************************************************************/
+static bool motion_at(int32_t visit, uint32_t time_ms)
+{
+    uint32_t enter_ms = trace[visit].enter_s * 1000u;
+    uint32_t leave_ms = trace[visit].leave_s * 1000u;
+
+    return ((time_ms - enter_ms) < WALK_MS) || ((leave_ms - time_ms) <= WALK_MS) ||
+           (((time_ms - enter_ms) % MOVE_INTERVAL_MS) < MOVE_MS);
+}
+
+/*******************************************************************************
+ * Function Name: report
+ *******************************************************************************
+ * Summary:
+ *   Passes an event through the duplicate filter like presence_detection_cb
+ *   and records the reported presence and absence per visit. An absence
+ *   during a visit or a new presence while the room is empty is spurious; a
+ *   change between macro and micro presence is not recorded.
+ ******************************************************************************/
+static void report(const xensiv_radar_presence_event_t* event)
+{
+    if (!adaptive_rate_filter_event(event))
+    {
+        return;
+    }
+
+    bool absence = (event->state == XENSIV_RADAR_PRESENCE_STATE_ABSENCE);
+    int32_t visit = visit_at(event->timestamp);
+    bool was_present = result->present;
+
+    result->present = !absence;
+    if (absence)
+    {
+        /* Absence of the last visit left */
+        for (uint32_t i = 0; (visit < 0) && (i < NUM_VISITS); ++i)
+        {
+            if ((event->timestamp >= (trace[i].leave_s * 1000u)) &&
+                ((i + 1u == NUM_VISITS) || (event->timestamp < (trace[i + 1u].enter_s * 1000u))))
+            {
+                visit = (int32_t)i;
+                if (result->reported_count[1][i]++ == 0u)
+                {
+                    result->reported_ms[1][i] = event->timestamp;
+                }
+                return;
+            }
+        }
+        ++result->spurious;
+    }
+    else if (was_present)
+    {
+        /* Macro to micro presence or back */
+    }
+    else if (visit >= 0)
+    {
+        if (result->reported_count[0][visit]++ == 0u)
+        {
+            result->reported_ms[0][visit] = event->timestamp;
+        }
+    }
+    else
+    {
+        ++result->spurious;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: model_process_frame
+ *******************************************************************************
+ * Summary:
+ *   Presence library model, processes a frame and reports a state change.
+ *   A macro presence needs motion over one macro compare interval since the
+ *   motion started and since the last reset. A still person is detected as a
+ *   micro presence after micro_fft_size frames in the modes with micro
+ *   detection, in the micro if macro mode only after a macro presence.
+ ******************************************************************************/
+static void model_process_frame(uint32_t time_ms, bool present, bool motion)
+{
+    xensiv_radar_presence_state_t state = XENSIV_RADAR_PRESENCE_STATE_ABSENCE;
+    bool micro_mode = (model_config.mode != XENSIV_RADAR_PRESENCE_MODE_MACRO_ONLY);
+
+    model_time_ms = time_ms;
+
+    if (!motion)
+    {
+        model_motion_run = false;
+    }
+    else if (!model_motion_run)
+    {
+        model_motion_run = true;
+        model_motion_start_ms = time_ms;
+    }
+    else
+    {
+        /* Motion goes on */
+    }
+
+    uint32_t run_start_ms = ((int32_t)(model_motion_start_ms - model_reset_ms) > 0) ? model_motion_start_ms : model_reset_ms;
+    if (model_motion_run && ((time_ms - run_start_ms) >= (uint32_t)model_config.macro_compare_interval_ms))
+    {
+        model_macro_seen = true;
+        model_last_macro_ms = time_ms;
+    }
+
+    model_micro_frames = (present && micro_mode) ? (model_micro_frames + 1u) : 0u;
+    if ((model_micro_frames >= (uint32_t)model_config.micro_fft_size) &&
+        ((model_config.mode != XENSIV_RADAR_PRESENCE_MODE_MICRO_IF_MACRO) || model_macro_seen))
+    {
+        model_last_micro_ms = time_ms;
+    }
+
+    if (model_macro_seen && ((time_ms - model_last_macro_ms) < (uint32_t)model_config.macro_movement_validity_ms))
+    {
+        state = XENSIV_RADAR_PRESENCE_STATE_MACRO_PRESENCE;
+    }
+    else if (micro_mode && model_macro_seen &&
+             ((time_ms - model_last_micro_ms) < (uint32_t)model_config.micro_movement_validity_ms))
+    {
+        state = XENSIV_RADAR_PRESENCE_STATE_MICRO_PRESENCE;
+    }
+    else
+    {
+        model_macro_seen = false;
+    }
+
+    if (state != model_state)
+    {
+        xensiv_radar_presence_event_t event = { .timestamp = time_ms, .state = state, .range_bin = 2 };
+
+        model_state = state;
+        report(&event);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: replay
+ *******************************************************************************
+ * Summary:
+ *   Replays the trace frame by frame at the frame period of the active
+ *   profile, the motion of the trace stands for the targets of the range
+ *   profile.
+ *
+ * Parameters:
+ *   slow_scan: false to hold the full rate profile
+ *   replay_result: frames, reported events and statistics of the replay
+ ******************************************************************************/
+static void replay(bool slow_scan, replay_result_t* replay_result)
+{
+    uint32_t end_ms = (trace[NUM_VISITS - 1u].leave_s + 600u) * 1000u;
+    xensiv_radar_presence_event_t synthesized_event;
+
+    memset(replay_result, 0, sizeof(*replay_result));
+    result = replay_result;
+    model_config = default_config;
+    model_time_ms = 0;
+    xensiv_radar_presence_reset(NULL);
+
+    adaptive_rate_init(NULL, FULL_FRAME_PERIOD_MS);
+    adaptive_rate_hold_full(NULL, !slow_scan);
+
+    for (uint32_t time_ms = 1; time_ms < end_ms; time_ms += adaptive_rate_get_frame_period_ms())
+    {
+        int32_t visit = visit_at(time_ms);
+        bool motion = (visit >= 0) && motion_at(visit, time_ms);
+
+        model_process_frame(time_ms, visit >= 0, motion);
+        if (adaptive_rate_update(NULL, time_ms, motion, &synthesized_event))
+        {
+            report(&synthesized_event);
+        }
+        ++replay_result->frames;
+    }
+
+    adaptive_rate_get_stats(&replay_result->stats);
+}
+
+/*******************************************************************************
+ * Function Name: check_forced_mode
+ *******************************************************************************
+ * Summary:
+ *   Forces the micro and macro mode like the threshold calibration, changes
+ *   the user mode meanwhile like a shadow update and checks that the library
+ *   runs the forced mode, that the user configuration keeps the new user mode
+ *   and that the release applies it.
+ *
+ * Return:
+ *   number of failed checks
+ ******************************************************************************/
+static uint32_t check_forced_mode(void)
+{
+    xensiv_radar_presence_config_t config;
+    uint32_t failures = 0;
+
+    model_config = default_config;
+    adaptive_rate_init(NULL, FULL_FRAME_PERIOD_MS);
+    adaptive_rate_hold_full(NULL, true);
+    adaptive_rate_force_mode(NULL, true, XENSIV_RADAR_PRESENCE_MODE_MICRO_AND_MACRO);
+    failures += (model_config.mode != XENSIV_RADAR_PRESENCE_MODE_MICRO_AND_MACRO) ? 1u : 0u;
+
+    (void)adaptive_rate_get_config(NULL, &config);
+    failures += (config.mode != default_config.mode) ? 1u : 0u;
+    config.mode = XENSIV_RADAR_PRESENCE_MODE_MACRO_ONLY;
+    config.macro_threshold = 2.0f;
+    (void)adaptive_rate_set_config(NULL, &config);
+    failures += (model_config.mode != XENSIV_RADAR_PRESENCE_MODE_MICRO_AND_MACRO) ? 1u : 0u;
+
+    adaptive_rate_force_mode(NULL, false, XENSIV_RADAR_PRESENCE_MODE_MICRO_AND_MACRO);
+    adaptive_rate_hold_full(NULL, false);
+    failures += ((model_config.mode != XENSIV_RADAR_PRESENCE_MODE_MACRO_ONLY) ||
+                 (model_config.macro_threshold != 2.0f)) ? 1u : 0u;
+
+    printf("forced mode: user mode changed while forced %s\n", (failures == 0u) ? "applied on release" : "lost [FAIL]");
+    return failures;
+}
+
+int main(void)
+{
+    static replay_result_t full;
+    static replay_result_t adaptive;
+    uint32_t failures = 0;
+    uint32_t slow_wakeups = 0;
+    int32_t added_max_ms = INT32_MIN;
+    int32_t added_total_ms = 0;
+
+    replay(false, &full);
+    replay(true, &adaptive);
+
+    printf("visit  enter s  leave s  presence +ms full/slow scan  absence +ms full/slow scan\n");
+    for (uint32_t i = 0; i < NUM_VISITS; ++i)
+    {
+        int32_t full_ms = (int32_t)(full.reported_ms[0][i] - (trace[i].enter_s * 1000u));
+        int32_t adaptive_ms = (int32_t)(adaptive.reported_ms[0][i] - (trace[i].enter_s * 1000u));
+        int32_t added_ms = adaptive_ms - full_ms;
+
+        printf("%5" PRIu32 "  %7" PRIu32 "  %7" PRIu32 "  %9" PRIi32 " / %-9" PRIi32 "       %9" PRIi32 " / %" PRIi32 "\n",
+               i, trace[i].enter_s, trace[i].leave_s, full_ms, adaptive_ms,
+               (int32_t)(full.reported_ms[1][i] - (trace[i].leave_s * 1000u)),
+               (int32_t)(adaptive.reported_ms[1][i] - (trace[i].leave_s * 1000u)));
+
+        for (uint32_t kind = 0; kind < 2u; ++kind)
+        {
+            if ((full.reported_count[kind][i] != 1u) || (adaptive.reported_count[kind][i] != 1u))
+            {
+                printf("[FAIL] visit %" PRIu32 ": %s reported %" PRIu32 " times at full rate, %" PRIu32 " times with slow scan\n",
+                       i, (kind == 0u) ? "presence" : "absence", full.reported_count[kind][i], adaptive.reported_count[kind][i]);
+                ++failures;
+            }
+        }
+
+        added_total_ms += added_ms;
+        if (added_ms > added_max_ms)
+        {
+            added_max_ms = added_ms;
+        }
+        if (i == 0u || ((trace[i].enter_s - trace[i - 1u].leave_s) * 1000u) > ADAPTIVE_RATE_ABSENCE_DWELL_MS + 10000u)
+        {
+            ++slow_wakeups;
+        }
+    }
+
+    uint32_t saved_permille = ((full.frames - adaptive.frames) * 1000u) / full.frames;
+    uint64_t empty_ms = (uint64_t)trace[0].enter_s * 1000u;
+
+    /* Slow scan starts ADAPTIVE_RATE_ABSENCE_DWELL_MS after the absence */
+    for (uint32_t i = 0; i < NUM_VISITS; ++i)
+    {
+        uint32_t gap_ms = ((i + 1u < NUM_VISITS) ? trace[i + 1u].enter_s : (trace[i].leave_s + 600u)) * 1000u -
+                          trace[i].leave_s * 1000u;
+        uint32_t absence_ms = ADAPTIVE_RATE_ABSENCE_DWELL_MS + (uint32_t)default_config.micro_movement_validity_ms;
+
+        empty_ms += (gap_ms > absence_ms) ? (gap_ms - absence_ms) : 0u;
+    }
+    uint32_t ideal_permille = (uint32_t)((empty_ms * (ADAPTIVE_RATE_SLOW_FRAME_PERIOD_MS - FULL_FRAME_PERIOD_MS) * 1000u) /
+                                         ((uint64_t)full.frames * FULL_FRAME_PERIOD_MS * ADAPTIVE_RATE_SLOW_FRAME_PERIOD_MS));
+
+    printf("frames: full rate %" PRIu32 ", slow scan %" PRIu32 " (full %" PRIu32 " + slow %" PRIu32 "), "
+           "%" PRIu32 ".%" PRIu32 " %% saved of %" PRIu32 ".%" PRIu32 " %% in the empty room\n",
+           full.frames, adaptive.frames, adaptive.stats.frames[ADAPTIVE_RATE_PROFILE_FULL],
+           adaptive.stats.frames[ADAPTIVE_RATE_PROFILE_SLOW], saved_permille / 10u, saved_permille % 10u,
+           ideal_permille / 10u, ideal_permille % 10u);
+    printf("added presence latency: avg %" PRIi32 " max %" PRIi32 " ms\n", added_total_ms / (int32_t)NUM_VISITS, added_max_ms);
+    printf("wake ups: %" PRIu32 ", motion to confirmed full rate presence avg %" PRIu32 " max %" PRIu32 " ms, "
+           "%" PRIu32 " absences synthesized\n",
+           adaptive.stats.wakeups, (adaptive.stats.wakeups > 0u) ? (adaptive.stats.wake_latency_ms_total / adaptive.stats.wakeups) : 0u,
+           adaptive.stats.wake_latency_ms_max, adaptive.stats.synthesized_absences);
+
+    if ((full.spurious != 0u) || (adaptive.spurious != 0u))
+    {
+        printf("[FAIL] spurious state changes: %" PRIu32 " at full rate, %" PRIu32 " with slow scan\n",
+               full.spurious, adaptive.spurious);
+        ++failures;
+    }
+    /* Every frame of the empty room after the dwell time runs at the slow rate */
+    if ((saved_permille + 5u) < ideal_permille)
+    {
+        printf("[FAIL] slow scan saves less than the empty room allows\n");
+        ++failures;
+    }
+    /* Slow scan detects within one more frame over its longer compare interval */
+    if (added_max_ms > (int32_t)(2u * ADAPTIVE_RATE_SLOW_FRAME_PERIOD_MS))
+    {
+        printf("[FAIL] slow scan adds more than %" PRIu32 " ms of latency\n", 2u * ADAPTIVE_RATE_SLOW_FRAME_PERIOD_MS);
+        ++failures;
+    }
+    /* The wake up has to detect the presence again at full rate */
+    if ((adaptive.stats.wakeups != slow_wakeups) ||
+        (adaptive.stats.wake_latency_ms_max < (uint32_t)default_config.macro_compare_interval_ms))
+    {
+        printf("[FAIL] %" PRIu32 " wake ups expected, with at least %" PRIi32 " ms of latency\n",
+               slow_wakeups, default_config.macro_compare_interval_ms);
+        ++failures;
+    }
+
+    failures += check_forced_mode();
+
+    printf("%s\n", (failures == 0u) ? "[PASS] test_adaptive_rate" : "[FAIL] test_adaptive_rate");
+    return (failures == 0u) ? 0 : 1;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,449 @@
+/*****************************************************************************
+ * File name: test_config_store.c
+ *
+ * Description: Runs config_store.c, built with the file backend, against
+ * the file backend and against a backend in memory that can fail writes.
+ * The test checks that a record survives a reload, that a corrupt record or
+ * one of another version is ignored in favour of the previous one, that the
+ * newest record is found across the round robin slots also after the slots
+ * and the sequence number wrapped, that a burst of changes costs one write,
+ * that writes are spaced by CONFIG_STORE_MIN_INTERVAL_MS, and that a failed
+ * write is repeated in the next slot.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Header file for local task */
+#include "config_store.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#if (CONFIG_STORE_BACKEND_FILE == 0)
+#error "test_config_store is built with CONFIG_STORE_BACKEND_FILE=1"
+#endif
+
+/* Changes of the burst, each one within CONFIG_STORE_COALESCE_MS of the last */
+#define BURST_CHANGES                       (6u)
+#define BURST_SPACING_MS                    (2000u)
+
+#define CHECK(condition, ...)               do { if (!(condition)) { printf("[FAIL] " __VA_ARGS__); \
+                                                 printf("\n"); ++failures; } } while (0)
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+/* Slots of the memory backend, one flash page each */
+static uint8_t memory_slots[CONFIG_STORE_SLOTS][CONFIG_STORE_FLASH_PAGE_SIZE];
+static uint32_t memory_writes[CONFIG_STORE_SLOTS];
+
+/* Writes of the memory backend that fail from now on */
+static uint32_t failing_writes;
+
+static uint32_t failures;
+
+/*******************************************************************************
+ * Function Name: memory_open, memory_read, memory_write
+ *******************************************************************************
+ * Summary:
+ *   Backend in memory, a write fails while failing_writes is not 0 and then
+ *   leaves the slot unchanged.
+ ******************************************************************************/
+static uint32_t memory_open(void)
+{
+    return CONFIG_STORE_SLOTS;
+}
+
+static bool memory_read(uint32_t slot, void* data, uint32_t size)
+{
+    memcpy(data, memory_slots[slot], size);
+    return true;
+}
+
+static bool memory_write(uint32_t slot, const void* data, uint32_t size)
+{
+    if (failing_writes > 0u)
+    {
+        --failing_writes;
+        return false;
+    }
+
+    memset(memory_slots[slot], 0, CONFIG_STORE_FLASH_PAGE_SIZE);
+    memcpy(memory_slots[slot], data, size);
+    ++memory_writes[slot];
+    return true;
+}
+
+static const config_store_backend_t memory_backend =
+{
+    .open = memory_open,
+    .read = memory_read,
+    .write = memory_write
+};
+
+/*******************************************************************************
+ * Function Name: reset_memory
+ *******************************************************************************
+ * Summary:
+ *   Erases the slots of the memory backend.
+ ******************************************************************************/
+static void reset_memory(void)
+{
+    memset(memory_slots, 0xFF, sizeof(memory_slots));
+    memset(memory_writes, 0, sizeof(memory_writes));
+    failing_writes = 0;
+}
+
+/*******************************************************************************
+ * Function Name: make_config
+ *******************************************************************************
+ * Summary:
+ *   Returns a configuration that differs in the macro threshold and the
+ *   maximum range bin for every value of n.
+ ******************************************************************************/
+static xensiv_radar_presence_config_t make_config(uint32_t n)
+{
+    xensiv_radar_presence_config_t config;
+
+    /* Zeroed padding, the configurations are compared with memcmp */
+    memset(&config, 0, sizeof(config));
+    config.bandwidth = 460.0f;
+    config.num_samples_per_chirp = 128;
+    config.micro_fft_size = 128;
+    config.macro_threshold = 1.0f + ((float32_t)n * 0.25f);
+    config.micro_threshold = 25.0f;
+    config.min_range_bin = 1;
+    config.max_range_bin = 5 + (int32_t)(n % 16u);
+    config.macro_compare_interval_ms = 250;
+    config.macro_movement_validity_ms = 1000;
+    config.micro_movement_validity_ms = 4000;
+    config.macro_trigger_range = 1;
+    config.mode = XENSIV_RADAR_PRESENCE_MODE_MICRO_IF_MACRO;
+    config.micro_movement_compare_idx = 5;
+
+    return config;
+}
+
+/*******************************************************************************
+ * Function Name: put_record
+ *******************************************************************************
+ * Summary:
+ *   Writes a valid record of a configuration and sequence to a slot of the
+ *   memory backend, as an earlier firmware would have.
+ ******************************************************************************/
+static void put_record(uint32_t slot, uint32_t sequence, uint32_t n)
+{
+    config_store_record_t record;
+
+    memset(&record, 0, sizeof(record));
+    record.magic = CONFIG_STORE_MAGIC;
+    record.version = CONFIG_STORE_VERSION;
+    record.size = (uint16_t)sizeof(record);
+    record.sequence = sequence;
+    record.config = make_config(n);
+    record.crc = config_store_crc32(&record, offsetof(config_store_record_t, crc));
+
+    memcpy(memory_slots[slot], &record, sizeof(record));
+}
+
+/*******************************************************************************
+ * Function Name: load_memory
+ *******************************************************************************
+ * Summary:
+ *   Loads a fresh store from the memory backend, as at boot.
+ *
+ * Return:
+ *   true if the configuration of n was loaded with sequence and next_slot
+ ******************************************************************************/
+static bool load_memory(uint32_t n, uint32_t sequence, uint32_t next_slot)
+{
+    config_store_t store;
+    xensiv_radar_presence_config_t config;
+    xensiv_radar_presence_config_t expected = make_config(n);
+
+    memset(&config, 0, sizeof(config));
+    config_store_init(&store, &memory_backend);
+
+    return config_store_load(&store, &config) && (memcmp(&config, &expected, sizeof(config)) == 0) &&
+           (store.sequence == sequence) && (store.next_slot == next_slot);
+}
+
+/*******************************************************************************
+ * Function Name: test_file_backend
+ *******************************************************************************
+ * Summary:
+ *   Writes two records to the file, reloads them, then corrupts the newer
+ *   one: the store falls back to the older record.
+ ******************************************************************************/
+static void test_file_backend(void)
+{
+    config_store_t store;
+    xensiv_radar_presence_config_t config;
+    xensiv_radar_presence_config_t first = make_config(1);
+    xensiv_radar_presence_config_t second = make_config(2);
+    FILE* file;
+    uint8_t byte;
+
+    (void)remove(CONFIG_STORE_FILE_PATH);
+    config_store_init(&store, CONFIG_STORE_BACKEND);
+    CHECK(store.num_slots == CONFIG_STORE_SLOTS, "file backend has %" PRIu32 " slots", store.num_slots);
+    CHECK(!config_store_load(&store, &config), "empty file loaded a configuration");
+
+    config_store_save(&store, &first, 0);
+    CHECK(config_store_flush(&store, 0), "first record not written to the file");
+    config_store_save(&store, &second, 0);
+    CHECK(config_store_flush(&store, 0), "second record not written to the file");
+
+    config_store_init(&store, CONFIG_STORE_BACKEND);
+    CHECK(config_store_load(&store, &config) && (memcmp(&config, &second, sizeof(config)) == 0) &&
+          (store.sequence == 2u) && (store.next_slot == 2u),
+          "file reload: sequence %" PRIu32 " next slot %" PRIu32 ", expected the second record", store.sequence,
+          store.next_slot);
+
+    /* Flip one bit of the threshold of the second record, in slot 1 */
+    file = fopen(CONFIG_STORE_FILE_PATH, "r+b");
+    CHECK(file != NULL, "file %s not found", CONFIG_STORE_FILE_PATH);
+    if (file != NULL)
+    {
+        long offset = (long)(CONFIG_STORE_FLASH_PAGE_SIZE + offsetof(config_store_record_t, config) +
+                             offsetof(xensiv_radar_presence_config_t, macro_threshold));
+
+        (void)fseek(file, offset, SEEK_SET);
+        byte = (uint8_t)fgetc(file);
+        (void)fseek(file, offset, SEEK_SET);
+        (void)fputc(byte ^ 0x01u, file);
+        fclose(file);
+    }
+
+    config_store_init(&store, CONFIG_STORE_BACKEND);
+    CHECK(config_store_load(&store, &config) && (memcmp(&config, &first, sizeof(config)) == 0) &&
+          (store.sequence == 1u) && (store.next_slot == 1u),
+          "corrupt file record: sequence %" PRIu32 " loaded, expected the first record", store.sequence);
+
+    (void)remove(CONFIG_STORE_FILE_PATH);
+}
+
+/*******************************************************************************
+ * Function Name: test_rejected_records
+ *******************************************************************************
+ * Summary:
+ *   Newer records with a wrong CRC, version, size or magic number are
+ *   ignored in favour of the valid one.
+ ******************************************************************************/
+static void test_rejected_records(void)
+{
+    config_store_record_t* record;
+
+    reset_memory();
+    put_record(0, 10, 10);
+
+    put_record(1, 11, 11);
+    record = (config_store_record_t*)memory_slots[1];
+    record->crc ^= 1u;
+
+    put_record(2, 12, 12);
+    record = (config_store_record_t*)memory_slots[2];
+    record->version = CONFIG_STORE_VERSION + 1u;
+    record->crc = config_store_crc32(record, offsetof(config_store_record_t, crc));
+
+    put_record(3, 13, 13);
+    record = (config_store_record_t*)memory_slots[3];
+    record->size = (uint16_t)(sizeof(*record) - 4u);
+    record->crc = config_store_crc32(record, offsetof(config_store_record_t, crc));
+
+    put_record(4, 14, 14);
+    record = (config_store_record_t*)memory_slots[4];
+    record->magic = ~CONFIG_STORE_MAGIC;
+    record->crc = config_store_crc32(record, offsetof(config_store_record_t, crc));
+
+    CHECK(load_memory(10, 10, 1), "a record with a wrong CRC, version, size or magic number was loaded");
+}
+
+/*******************************************************************************
+ * Function Name: test_newest_record
+ *******************************************************************************
+ * Summary:
+ *   Writes more records than slots and checks that the newest one is loaded
+ *   after the slots wrapped, then crafts slots around the wrap of the
+ *   sequence number.
+ ******************************************************************************/
+static void test_newest_record(void)
+{
+    const uint32_t num_writes = CONFIG_STORE_SLOTS + 3u;
+    config_store_t store;
+    xensiv_radar_presence_config_t config;
+
+    reset_memory();
+    config_store_init(&store, &memory_backend);
+    for (uint32_t n = 1; n <= num_writes; ++n)
+    {
+        config = make_config(n);
+        config_store_save(&store, &config, 0);
+        (void)config_store_flush(&store, 0);
+    }
+    CHECK((memory_writes[0] == 2u) && (memory_writes[3] == 1u), "round robin: %" PRIu32 " writes to slot 0 and %"
+          PRIu32 " to slot 3, expected 2 and 1", memory_writes[0], memory_writes[3]);
+    CHECK(load_memory(num_writes, num_writes, num_writes % CONFIG_STORE_SLOTS),
+          "after the slots wrapped the newest record was not loaded");
+
+    /* Sequence 0xFFFFFFFC to 0x3 in slots 4 to 3, the newest in slot 3 */
+    reset_memory();
+    for (uint32_t i = 0; i < CONFIG_STORE_SLOTS; ++i)
+    {
+        put_record((4u + i) % CONFIG_STORE_SLOTS, 0xFFFFFFFCu + i, i);
+    }
+    CHECK(load_memory(CONFIG_STORE_SLOTS - 1u, 3u, 4u), "after the sequence wrapped the newest record was not loaded");
+
+    config_store_init(&store, &memory_backend);
+    (void)config_store_load(&store, &config);
+    config = make_config(100);
+    config_store_save(&store, &config, 0);
+    (void)config_store_flush(&store, 0);
+    CHECK(load_memory(100, 4u, 5u), "the write after the wrap did not continue the sequence in slot 4");
+}
+
+/*******************************************************************************
+ * Function Name: test_coalescing
+ *******************************************************************************
+ * Summary:
+ *   A burst of changes is written once, after it was stable for
+ *   CONFIG_STORE_COALESCE_MS; a change that is undone is not written; the
+ *   next write waits for CONFIG_STORE_MIN_INTERVAL_MS.
+ ******************************************************************************/
+static void test_coalescing(void)
+{
+    config_store_t store;
+    xensiv_radar_presence_config_t config;
+    uint32_t time_ms = 0;
+    uint32_t write_ms;
+
+    reset_memory();
+    config_store_init(&store, &memory_backend);
+
+    for (uint32_t n = 1; n <= BURST_CHANGES; ++n)
+    {
+        config = make_config(n);
+        config_store_save(&store, &config, time_ms);
+        /* The same configuration again is not a change */
+        config_store_save(&store, &config, time_ms);
+        CHECK(!config_store_poll(&store, time_ms), "written during the burst at %" PRIu32 " ms", time_ms);
+        time_ms += BURST_SPACING_MS;
+    }
+    time_ms -= BURST_SPACING_MS;
+
+    CHECK(!config_store_poll(&store, time_ms + CONFIG_STORE_COALESCE_MS - 1u),
+          "written before the burst was stable for %u ms", CONFIG_STORE_COALESCE_MS);
+    write_ms = time_ms + CONFIG_STORE_COALESCE_MS;
+    CHECK(config_store_poll(&store, write_ms), "burst not written once stable");
+    CHECK((store.stats.writes == 1u) && (store.stats.coalesced == (BURST_CHANGES - 1u)),
+          "burst of %u changes: %" PRIu32 " writes, %" PRIu32 " coalesced", BURST_CHANGES, store.stats.writes,
+          store.stats.coalesced);
+    printf("burst of %u changes every %u ms: %" PRIu32 " write, %" PRIu32 " coalesced changes\n", BURST_CHANGES,
+           BURST_SPACING_MS, store.stats.writes, store.stats.coalesced);
+    CHECK(load_memory(BURST_CHANGES, 1u, 1u), "the last change of the burst was not stored");
+
+    /* A change undone before it was written */
+    config = make_config(50);
+    config_store_save(&store, &config, write_ms + 1000u);
+    config = make_config(BURST_CHANGES);
+    config_store_save(&store, &config, write_ms + 2000u);
+    CHECK(!config_store_pending(&store) && (store.stats.coalesced == BURST_CHANGES),
+          "an undone change is still pending");
+
+    /* The next change is stable after 10 s but waits for the interval */
+    config = make_config(51);
+    config_store_save(&store, &config, write_ms + 3000u);
+    CHECK(!config_store_poll(&store, write_ms + CONFIG_STORE_MIN_INTERVAL_MS - 1u),
+          "written %u ms after the previous write", CONFIG_STORE_MIN_INTERVAL_MS - 1u);
+    CHECK(config_store_poll(&store, write_ms + CONFIG_STORE_MIN_INTERVAL_MS),
+          "not written %u ms after the previous write", CONFIG_STORE_MIN_INTERVAL_MS);
+    CHECK(store.stats.writes == 2u, "%" PRIu32 " writes, expected 2", store.stats.writes);
+
+    /* A flush, e.g. before a reboot, does not wait */
+    config = make_config(52);
+    config_store_save(&store, &config, write_ms + CONFIG_STORE_MIN_INTERVAL_MS + 1u);
+    CHECK(config_store_flush(&store, write_ms + CONFIG_STORE_MIN_INTERVAL_MS + 1u), "flush did not write");
+    CHECK(!config_store_flush(&store, write_ms + CONFIG_STORE_MIN_INTERVAL_MS + 2u),
+          "flush without a pending change wrote");
+}
+
+/*******************************************************************************
+ * Function Name: test_failed_write
+ *******************************************************************************
+ * Summary:
+ *   A failed write keeps the change pending and leaves the slot as it was;
+ *   the next flush writes the same sequence to the next slot.
+ ******************************************************************************/
+static void test_failed_write(void)
+{
+    config_store_t store;
+    xensiv_radar_presence_config_t config;
+
+    reset_memory();
+    put_record(0, 7, 7);
+    config_store_init(&store, &memory_backend);
+    (void)config_store_load(&store, &config);
+
+    config = make_config(8);
+    config_store_save(&store, &config, 0);
+    failing_writes = 1;
+    CHECK(!config_store_flush(&store, 0), "the failing write succeeded");
+    CHECK(config_store_pending(&store) && (store.stats.failures == 1u) && (store.next_slot == 2u) &&
+          (memory_writes[1] == 0u), "after a failed write: pending %d, %" PRIu32 " failures, next slot %" PRIu32,
+          config_store_pending(&store), store.stats.failures, store.next_slot);
+    CHECK(load_memory(7, 7, 1), "a failed write changed the stored record");
+
+    CHECK(config_store_flush(&store, 0), "the write after a failure did not succeed");
+    CHECK((memory_writes[2] == 1u) && !config_store_pending(&store), "the write after a failure missed slot 2");
+    CHECK(load_memory(8, 8, 3), "the write after a failure did not store sequence 8 in slot 2");
+}
+
+/*******************************************************************************
+ * Function Name: main
+ *******************************************************************************
+ * Summary:
+ *   Runs the scenarios.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   0 if all checks pass
+ ******************************************************************************/
+int main(void)
+{
+    test_file_backend();
+    test_rejected_records();
+    test_newest_record();
+    test_coalescing();
+    test_failed_write();
+
+    printf("%s\n", (failures == 0u) ? "[PASS] test_config_store" : "[FAIL] test_config_store");
+    return (failures == 0u) ? 0 : 1;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,239 @@
+/*****************************************************************************
+ * File name: test_frame_preprocess.c
+ *
+ * Description: Feeds the same FIFO data to frame_preprocess.c chirp by chirp,
+ * as the streaming mode reads it, and as a whole frame, and compares the
+ * converted frames and average chirps bit for bit with each other and with a
+ * reference of the whole frame processing that radar_task did before the
+ * streaming mode. Built for float32 and, with RANGE_FFT_FIXED_POINT, for the
+ * Q15 and Q31 average chirps.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Header file for local task */
+#include "frame_preprocess.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define MAX_SAMPLES                         (128u * 3u * 16u)
+#define MAX_CHIRP                           (128u * 3u)
+#define NUM_FRAMES                          (20u)
+#define NUM_SHAPES                          (sizeof(shapes) / sizeof(shapes[0]))
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef struct
+{
+    uint32_t samples_per_chirp;
+    uint32_t num_antennas;
+    uint32_t num_chirps;
+} shape_t;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+/* Profile of register_list, multi chirp, 3 RX and other antenna counts,
+ * an odd chirp length takes the tail of the 3 RX kernel
+ */
+static const shape_t shapes[] =
+{
+    { 128, 1,  1 },
+    {  64, 1, 16 },
+    { 128, 3,  1 },
+    {  64, 3,  8 },
+    {  63, 3,  4 },
+    {  32, 2, 16 },
+};
+
+static uint16_t raw[MAX_SAMPLES];
+static float32_t frame_stream[MAX_SAMPLES];
+static float32_t frame_whole[MAX_SAMPLES];
+static float32_t frame_ref[MAX_SAMPLES];
+static range_sample_t avg_stream[MAX_CHIRP];
+static range_sample_t avg_whole[MAX_CHIRP];
+static range_sample_t avg_ref[MAX_CHIRP];
+static q15_t scratch_stream[MAX_CHIRP];
+static q15_t scratch_whole[MAX_CHIRP];
+
+static uint32_t rand_state = 1;
+
+/*******************************************************************************
+ * Function Name: next_sample
+ *******************************************************************************
+ * Summary:
+ *   Returns a pseudo random 12 bit sample, every 64th one at full scale or
+ *   zero to exercise the sums of the average chirp.
+ ******************************************************************************/
+static uint16_t next_sample(void)
+{
+    rand_state = (rand_state * 1103515245u) + 12345u;
+
+    switch ((rand_state >> 16) & 63u)
+    {
+        case 0:
+            return 4095u;
+        case 1:
+            return 0u;
+        default:
+            return (uint16_t)((rand_state >> 8) & 0xFFFu);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: reference_frame
+ *******************************************************************************
+ * Summary:
+ *   Whole frame processing of radar_task before the streaming mode, extended
+ *   to one plane per antenna: every sample divided by the ADC full scale,
+ *   the chirps summed in order and scaled by 1 / num_chirps. The fixed point
+ *   average sums the raw samples shifted right by sum_shift and scales the
+ *   sum to the sample format.
+ ******************************************************************************/
+static void reference_frame(const shape_t* shape, uint32_t sum_shift)
+{
+    uint32_t plane_len = shape->num_chirps * shape->samples_per_chirp;
+
+    for (uint32_t chirp = 0; chirp < shape->num_chirps; ++chirp)
+    {
+        for (uint32_t sample = 0; sample < shape->samples_per_chirp; ++sample)
+        {
+            for (uint32_t antenna = 0; antenna < shape->num_antennas; ++antenna)
+            {
+                uint32_t index = (((chirp * shape->samples_per_chirp) + sample) * shape->num_antennas) + antenna;
+
+                frame_ref[(antenna * plane_len) + (chirp * shape->samples_per_chirp) + sample] =
+                    (float32_t)raw[index] / 4096.0f;
+            }
+        }
+    }
+
+    for (uint32_t antenna = 0; antenna < shape->num_antennas; ++antenna)
+    {
+        for (uint32_t sample = 0; sample < shape->samples_per_chirp; ++sample)
+        {
+#if (RANGE_FFT_FIXED_POINT != 0)
+            uint64_t sum = 0;
+
+            for (uint32_t chirp = 0; chirp < shape->num_chirps; ++chirp)
+            {
+                uint32_t index = (((chirp * shape->samples_per_chirp) + sample) * shape->num_antennas) + antenna;
+
+                sum += (uint64_t)(raw[index] >> sum_shift);
+            }
+            sum <<= ((uint32_t)RANGE_FFT_FIXED_POINT - 12u + sum_shift);
+            avg_ref[(antenna * shape->samples_per_chirp) + sample] = (range_sample_t)(sum / shape->num_chirps);
+#else
+            float32_t sum = 0.0f;
+
+            (void)sum_shift;
+            for (uint32_t chirp = 0; chirp < shape->num_chirps; ++chirp)
+            {
+                sum += frame_ref[(antenna * plane_len) + (chirp * shape->samples_per_chirp) + sample];
+            }
+            avg_ref[(antenna * shape->samples_per_chirp) + sample] = sum * (1.0f / (float32_t)shape->num_chirps);
+#endif
+        }
+    }
+}
+
+int main(void)
+{
+    uint32_t failures = 0;
+    uint32_t frames = 0;
+
+    for (uint32_t i = 0; i < NUM_SHAPES; ++i)
+    {
+        const shape_t* shape = &shapes[i];
+        frame_preprocess_t stream;
+        frame_preprocess_t whole;
+        uint32_t chunk_len = shape->samples_per_chirp * shape->num_antennas;
+        uint32_t frame_len = chunk_len * shape->num_chirps;
+        q15_t* scratch = (shape->num_antennas > 1u) ? scratch_stream : NULL;
+
+        frame_preprocess_init(&stream, frame_stream, avg_stream, scratch, shape->samples_per_chirp,
+                              shape->num_antennas, shape->num_chirps);
+        frame_preprocess_init(&whole, frame_whole, avg_whole, (scratch != NULL) ? scratch_whole : NULL,
+                              shape->samples_per_chirp, shape->num_antennas, shape->num_chirps);
+
+        for (uint32_t f = 0; f < NUM_FRAMES; ++f)
+        {
+            bool complete = false;
+
+            for (uint32_t sample = 0; sample < frame_len; ++sample)
+            {
+                raw[sample] = next_sample();
+            }
+
+            /* Every fourth frame a partial frame is dropped first, as after a
+             * failed FIFO read in the streaming mode
+             */
+            frame_preprocess_start(&stream);
+            if (((f % 4u) == 3u) && (shape->num_chirps > 1u))
+            {
+                (void)frame_preprocess_add_chunk(&stream, &raw[chunk_len]);
+                frame_preprocess_start(&stream);
+            }
+            for (uint32_t chirp = 0; chirp < shape->num_chirps; ++chirp)
+            {
+                complete = frame_preprocess_add_chunk(&stream, &raw[chunk_len * chirp]);
+                if (complete != (chirp == (shape->num_chirps - 1u)))
+                {
+                    printf("[FAIL] shape %" PRIu32 " frame %" PRIu32 ": completed after chirp %" PRIu32 "\n", i, f, chirp);
+                    ++failures;
+                }
+            }
+
+            frame_preprocess_whole(&whole, raw);
+            reference_frame(shape, stream.sum_shift);
+            ++frames;
+
+            if ((memcmp(frame_stream, frame_whole, frame_len * sizeof(float32_t)) != 0) ||
+                (memcmp(avg_stream, avg_whole, chunk_len * sizeof(range_sample_t)) != 0))
+            {
+                printf("[FAIL] shape %" PRIu32 " frame %" PRIu32 ": chunked and whole frame differ\n", i, f);
+                ++failures;
+            }
+            if ((memcmp(frame_whole, frame_ref, frame_len * sizeof(float32_t)) != 0) ||
+                (memcmp(avg_whole, avg_ref, chunk_len * sizeof(range_sample_t)) != 0))
+            {
+                printf("[FAIL] shape %" PRIu32 " frame %" PRIu32 ": whole frame and reference differ\n", i, f);
+                ++failures;
+            }
+        }
+
+        printf("%3" PRIu32 " samples x %" PRIu32 " RX x %2" PRIu32 " chirps, sum shift %" PRIu32 ": %" PRIu32 " frames compared\n",
+               shape->samples_per_chirp, shape->num_antennas, shape->num_chirps, stream.sum_shift, NUM_FRAMES);
+    }
+
+    printf("%s (%s, %" PRIu32 " frames)\n", (failures == 0u) ? "[PASS] test_frame_preprocess" : "[FAIL] test_frame_preprocess",
+           (RANGE_FFT_FIXED_POINT == 15) ? "Q15" : ((RANGE_FFT_FIXED_POINT == 31) ? "Q31" : "float32"), frames);
+    return (failures == 0u) ? 0 : 1;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,292 @@
+/*****************************************************************************
+ * File name: test_frame_ring.c
+ *
+ * Description: Runs the frame ring between two threads, the producer thread
+ * standing in for the acquisition of the CM0+ core and the main thread for
+ * the radar task of the CM4. frame_ring.c is built for the host, so the
+ * indices are ordered by the fallback of FRAME_RING_BARRIER. The producer
+ * waits for every frame, then writes it block by block into the reserved
+ * slot. While the ring is full it drops frames in some phases and waits for
+ * a free slot in others; the consumer sleeps now and then to fill the ring,
+ * and stops, flushes and restarts the acquisition once. The test checks that every
+ * frame arrives once, in order and intact, and that every missing frame is
+ * accounted as dropped by the producer or flushed by the consumer.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <inttypes.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <unistd.h>
+
+/* Header file for local task */
+#include "frame_ring.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define NUM_FRAMES                          (200000u)
+#define SAMPLES_PER_IRQ                     (64u)
+#define SAMPLES_PER_FRAME                   (256u)
+
+/* The producer waits for a free slot in odd phases and drops in even ones */
+#define PHASE_FRAMES_LOG2                   (12u)
+
+/* The consumer keeps up with the producer, but sleeps for several frames
+ * after every STALL_FRAMES frames
+ */
+#define STALL_FRAMES                        (1000u)
+#define STALL_US                            (500u)
+
+#define SAMPLE(sequence, index)             ((uint16_t)(((sequence) * 31u) + (index)))
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef struct
+{
+    uint32_t published;
+    uint32_t dropped;
+    uint32_t full;                      /* failed reservations */
+    int done;
+} producer_t;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static frame_ring_t ring;
+static uint16_t samples[FRAME_RING_SLOTS * SAMPLES_PER_FRAME];
+static producer_t producer;
+
+/*******************************************************************************
+ * Function Name: producer_thread
+ *******************************************************************************
+ * Summary:
+ *   Acquisition loop of acquisition_cm0p_run without the sensor: attaches to
+ *   the ring, follows the run request and publishes NUM_FRAMES frames or
+ *   drops them.
+ *
+ * Parameters:
+ *   arg: unused
+ *
+ * Return:
+ *   NULL
+ ******************************************************************************/
+static void* producer_thread(void* arg)
+{
+    uint32_t sequence = 0;
+
+    (void)arg;
+
+    while (!frame_ring_valid(&ring))
+    {
+        sched_yield();
+    }
+
+    while (sequence < NUM_FRAMES)
+    {
+        frame_ring_header_t header = {0};
+        uint16_t* frame;
+        uint32_t block;
+
+        if (!frame_ring_running(&ring))
+        {
+            sched_yield();
+            continue;
+        }
+
+        /* Waits for the FIFO interrupt */
+        sched_yield();
+
+        ++sequence;
+        frame = frame_ring_reserve(&ring);
+        while ((frame == NULL) && (((sequence >> PHASE_FRAMES_LOG2) & 1u) != 0u))
+        {
+            ++producer.full;
+            sched_yield();
+            frame = frame_ring_reserve(&ring);
+        }
+        if (frame == NULL)
+        {
+            ++producer.full;
+            ++producer.dropped;
+            continue;
+        }
+
+        /* One FIFO block after the other, as read from the sensor */
+        for (block = 0; block < SAMPLES_PER_FRAME; block += SAMPLES_PER_IRQ)
+        {
+            for (uint32_t i = block; i < (block + SAMPLES_PER_IRQ); ++i)
+            {
+                frame[i] = SAMPLE(sequence, i);
+            }
+        }
+
+        header.sequence = sequence;
+        header.stamp_us = sequence * 10u;
+        header.num_samples = SAMPLES_PER_FRAME;
+        header.stats.dropped_frames = producer.dropped;
+        frame_ring_publish(&ring, &header);
+        ++producer.published;
+    }
+
+    __atomic_store_n(&producer.done, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+/*******************************************************************************
+ * Function Name: main
+ *******************************************************************************
+ * Summary:
+ *   Consumes the frames of the producer thread and checks their order,
+ *   contents and accounting.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   0 if all checks pass
+ ******************************************************************************/
+int main(void)
+{
+    const frame_ring_setup_t setup =
+    {
+        .samples_per_irq = SAMPLES_PER_IRQ,
+        .samples_per_frame = SAMPLES_PER_FRAME,
+    };
+    pthread_t thread;
+    uint32_t received = 0;
+    uint32_t last = 0;
+    uint32_t flushed = 0;
+    uint32_t order_errors = 0;
+    uint32_t data_errors = 0;
+    uint32_t accounting_errors = 0;
+    uint32_t failures = 0;
+    bool restarted = false;
+
+    if (pthread_create(&thread, NULL, producer_thread, NULL) != 0)
+    {
+        printf("[FAIL] test_frame_ring: no producer thread\n");
+        return 1;
+    }
+
+    frame_ring_init(&ring, &setup, samples);
+    frame_ring_set_running(&ring, true);
+
+    for (;;)
+    {
+        frame_ring_header_t header;
+        const uint16_t* frame = frame_ring_peek(&ring, &header);
+
+        if (frame == NULL)
+        {
+            if (__atomic_load_n(&producer.done, __ATOMIC_ACQUIRE) && (frame_ring_peek(&ring, &header) == NULL))
+            {
+                break;
+            }
+            sched_yield();
+            continue;
+        }
+
+        if (header.sequence <= last)
+        {
+            ++order_errors;
+        }
+        if (header.num_samples != SAMPLES_PER_FRAME || header.stamp_us != (header.sequence * 10u))
+        {
+            ++data_errors;
+        }
+        for (uint32_t i = 0; i < SAMPLES_PER_FRAME; ++i)
+        {
+            if (frame[i] != SAMPLE(header.sequence, i))
+            {
+                ++data_errors;
+                break;
+            }
+        }
+
+        /* Every frame not received was dropped by the producer or flushed */
+        ++received;
+        if ((header.sequence - received) != (header.stats.dropped_frames + flushed))
+        {
+            ++accounting_errors;
+        }
+        last = header.sequence;
+
+        if ((received % STALL_FRAMES) == 0u)
+        {
+            usleep(STALL_US);
+        }
+
+        frame_ring_release(&ring);
+
+        /* Stop and restart the acquisition as slow scan does, with a full ring */
+        if (!restarted && (last >= (NUM_FRAMES / 2u)))
+        {
+            restarted = true;
+            while ((ring.head - ring.tail) < FRAME_RING_SLOTS)
+            {
+                sched_yield();
+            }
+            frame_ring_set_running(&ring, false);
+            usleep(1000);
+            flushed += frame_ring_flush(&ring);
+            frame_ring_set_running(&ring, true);
+        }
+    }
+
+    pthread_join(thread, NULL);
+
+    printf("%" PRIu32 " frames: %" PRIu32 " received, %" PRIu32 " dropped, %" PRIu32 " flushed, "
+           "%" PRIu32 " overruns\n",
+           NUM_FRAMES, received, producer.dropped, flushed, ring.overruns);
+
+    if ((order_errors + data_errors + accounting_errors) != 0u)
+    {
+        printf("[FAIL] %" PRIu32 " frames out of order, %" PRIu32 " corrupted, %" PRIu32 " not accounted\n",
+               order_errors, data_errors, accounting_errors);
+        ++failures;
+    }
+    if ((received + producer.dropped + flushed) != NUM_FRAMES)
+    {
+        printf("[FAIL] %" PRIu32 " of %" PRIu32 " frames accounted\n",
+               received + producer.dropped + flushed, NUM_FRAMES);
+        ++failures;
+    }
+    if (ring.overruns != producer.full)
+    {
+        printf("[FAIL] %" PRIu32 " overruns counted for %" PRIu32 " full reservations\n", ring.overruns, producer.full);
+        ++failures;
+    }
+    if ((producer.dropped == 0u) || (flushed == 0u))
+    {
+        printf("[FAIL] the ring did not fill, nothing dropped or flushed\n");
+        ++failures;
+    }
+
+    printf("%s\n", (failures == 0u) ? "[PASS] test_frame_ring" : "[FAIL] test_frame_ring");
+    return (failures == 0u) ? 0 : 1;
+}
+
+/* [] END OF FILE */
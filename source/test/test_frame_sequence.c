@@ -0,0 +1,249 @@
+/*****************************************************************************
+ * File name: test_frame_sequence.c
+ *
+ * Description: Feeds frame_sequence.c with the FRAME_CNT values, FIFO
+ * backlogs and interrupt timestamps of a sensor. The test checks that the
+ * 12 bit counter wraps without a loss, that frames lost while a backlog
+ * waits in the FIFO are counted once, that the sequence continues and the
+ * produced and consumed frames start over after an overflow and its
+ * restart, that interrupts beyond FRAME_SEQUENCE_STAMP_DEPTH keep the newest
+ * stamps, and that the ms time base follows the wrap of the 32 bit timer.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <inttypes.h>
+#include <stdio.h>
+
+/* Header file for local task */
+#include "frame_sequence.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Frames of the wrap scenario, more than two turns of the 12 bit counter */
+#define WRAP_FRAMES                         (3u * (FRAME_SEQUENCE_COUNTER_MASK + 1u) + 100u)
+
+#define FRAME_PERIOD_US                     (5000u)
+
+#define CHECK(condition, ...)               do { if (!(condition)) { printf("[FAIL] " __VA_ARGS__); \
+                                                 printf("\n"); ++failures; } } while (0)
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static uint32_t failures;
+
+/*******************************************************************************
+ * Function Name: test_counter_wrap
+ *******************************************************************************
+ * Summary:
+ *   Reads every frame in time over several wraps of FRAME_CNT, then loses
+ *   frames across a wrap.
+ ******************************************************************************/
+static void test_counter_wrap(void)
+{
+    frame_sequence_t seq;
+    uint32_t counter = 0;
+    uint32_t number = 0;
+
+    frame_sequence_init(&seq, 0, 0);
+    for (uint32_t i = 1; i <= WRAP_FRAMES; ++i)
+    {
+        /* FRAME_CNT counts the frame started after the one read */
+        counter = (i + 1u) & FRAME_SEQUENCE_COUNTER_MASK;
+        number = frame_sequence_frame(&seq, counter, 0, false, 100);
+    }
+    CHECK((number == WRAP_FRAMES) && (seq.stats.dropped_frames == 0u) && (seq.stats.frames == WRAP_FRAMES),
+          "%u frames over the counter wrap: sequence %" PRIu32 ", %" PRIu32 " dropped", WRAP_FRAMES, number,
+          seq.stats.dropped_frames);
+
+    /* Three frames lost while the counter wraps */
+    while (((counter + 4u) & FRAME_SEQUENCE_COUNTER_MASK) > 2u)
+    {
+        counter = (counter + 1u) & FRAME_SEQUENCE_COUNTER_MASK;
+        number = frame_sequence_frame(&seq, counter, 0, false, 100);
+    }
+    counter = (counter + 4u) & FRAME_SEQUENCE_COUNTER_MASK;
+    CHECK(frame_sequence_frame(&seq, counter, 0, false, 100) == (number + 4u),
+          "three frames lost across the counter wrap: sequence %" PRIu32 ", expected %" PRIu32, seq.sequence,
+          number + 4u);
+    CHECK(seq.stats.dropped_frames == 3u, "%" PRIu32 " frames dropped across the counter wrap, expected 3",
+          seq.stats.dropped_frames);
+}
+
+/*******************************************************************************
+ * Function Name: test_backlog
+ *******************************************************************************
+ * Summary:
+ *   Frames waiting in the FIFO are not losses; only the frames the counter
+ *   advanced beyond the backlog and the frame in progress are.
+ ******************************************************************************/
+static void test_backlog(void)
+{
+    frame_sequence_t seq;
+    uint32_t number;
+
+    frame_sequence_init(&seq, 0, 0);
+    (void)frame_sequence_frame(&seq, 2, 0, false, 100);
+
+    /* Frames 2 to 4 wait in the FIFO, frame 5 is in progress */
+    number = frame_sequence_frame(&seq, 5, 2, true, 900);
+    number = frame_sequence_frame(&seq, 5, 1, true, 600);
+    number = frame_sequence_frame(&seq, 5, 0, false, 300);
+    CHECK((number == 4u) && (seq.stats.dropped_frames == 0u) && (seq.stats.late_frames == 2u),
+          "backlog of 2 frames: sequence %" PRIu32 ", %" PRIu32 " dropped, %" PRIu32 " late, expected 4, 0, 2",
+          number, seq.stats.dropped_frames, seq.stats.late_frames);
+    CHECK(seq.stats.max_latency_us == 900u, "max latency %" PRIu32 " us, expected 900", seq.stats.max_latency_us);
+
+    /* The counter advanced by 6 but only 2 frames wait: frames 5 to 7 are lost */
+    number = frame_sequence_frame(&seq, 11, 2, true, 100);
+    CHECK((number == 8u) && (seq.stats.dropped_frames == 3u),
+          "loss behind a backlog: sequence %" PRIu32 ", %" PRIu32 " dropped, expected 8 and 3", number,
+          seq.stats.dropped_frames);
+
+    /* The backlog is read afterwards without further losses */
+    number = frame_sequence_frame(&seq, 11, 1, true, 100);
+    number = frame_sequence_frame(&seq, 11, 0, false, 100);
+    CHECK((number == 10u) && (seq.stats.dropped_frames == 3u),
+          "after the loss: sequence %" PRIu32 ", %" PRIu32 " dropped, expected 10 and 3", number,
+          seq.stats.dropped_frames);
+}
+
+/*******************************************************************************
+ * Function Name: test_overflow_restart
+ *******************************************************************************
+ * Summary:
+ *   A FIFO overflow drops the frames not read, the restart of the frames
+ *   resets the sensor counter, and the sequence continues.
+ ******************************************************************************/
+static void test_overflow_restart(void)
+{
+    frame_sequence_t seq;
+    uint32_t number = 0;
+    uint32_t lost;
+    uint32_t stamp_us;
+
+    frame_sequence_init(&seq, 0, 0);
+    for (uint32_t i = 1; i <= 20u; ++i)
+    {
+        number = frame_sequence_frame(&seq, i + 1u, 0, false, 100);
+    }
+
+    /* Overflow after frames 21 to 26 started */
+    frame_sequence_irq(&seq, 1000);
+    lost = frame_sequence_drop(&seq, 26, true);
+    CHECK((lost == 6u) && (seq.sequence == (number + 6u)) && (seq.stats.fifo_overflows == 1u),
+          "overflow: %" PRIu32 " lost, sequence %" PRIu32 ", expected 6 and %" PRIu32, lost, seq.sequence,
+          number + 6u);
+
+    frame_sequence_restart(&seq);
+    CHECK((seq.produced == 0u) && (seq.consumed == 0u) && (seq.last_counter == 0u),
+          "restart: produced %" PRIu32 " consumed %" PRIu32 ", expected 0", seq.produced, seq.consumed);
+    CHECK(!frame_sequence_next_stamp(&seq, &stamp_us), "a stamp of before the restart is still pending");
+
+    /* The sensor counts from 0 again */
+    number = frame_sequence_frame(&seq, 2, 0, false, 100);
+    CHECK((number == 27u) && (seq.stats.dropped_frames == 6u),
+          "after the restart: sequence %" PRIu32 ", %" PRIu32 " dropped, expected 27 and 6", number,
+          seq.stats.dropped_frames);
+    number = frame_sequence_frame(&seq, 3, 0, false, 100);
+    CHECK((number == 28u) && (seq.stats.dropped_frames == 6u),
+          "second frame after the restart: sequence %" PRIu32 ", expected 28", number);
+}
+
+/*******************************************************************************
+ * Function Name: test_stamps
+ *******************************************************************************
+ * Summary:
+ *   Interrupts beyond FRAME_SEQUENCE_STAMP_DEPTH overwrite the oldest
+ *   stamps; the ms time follows the 32 bit timer across its wrap.
+ ******************************************************************************/
+static void test_stamps(void)
+{
+    const uint32_t start_us = 0xFFFFFFFFu - (3u * FRAME_PERIOD_US);
+    const uint32_t num_irqs = FRAME_SEQUENCE_STAMP_DEPTH + 5u;
+    frame_sequence_t seq;
+    uint32_t stamp_us;
+    uint32_t taken = 0;
+    uint32_t first_us = 0;
+    uint32_t time_ms = 0;
+    bool ordered = true;
+
+    frame_sequence_init(&seq, 1000, start_us);
+    for (uint32_t i = 1; i <= num_irqs; ++i)
+    {
+        frame_sequence_irq(&seq, start_us + (i * FRAME_PERIOD_US));
+    }
+
+    while (frame_sequence_next_stamp(&seq, &stamp_us))
+    {
+        if ((taken > 0u) && (stamp_us != (first_us + (taken * FRAME_PERIOD_US))))
+        {
+            ordered = false;
+        }
+        if (taken == 0u)
+        {
+            first_us = stamp_us;
+        }
+        time_ms = frame_sequence_time_ms(&seq, stamp_us);
+        ++taken;
+    }
+
+    CHECK(taken == FRAME_SEQUENCE_STAMP_DEPTH, "%" PRIu32 " of %" PRIu32 " stamps taken, expected %u", taken,
+          num_irqs, FRAME_SEQUENCE_STAMP_DEPTH);
+    CHECK(ordered && (first_us == (start_us + ((num_irqs - FRAME_SEQUENCE_STAMP_DEPTH + 1u) * FRAME_PERIOD_US))),
+          "the stamps taken are not the newest %u in order", FRAME_SEQUENCE_STAMP_DEPTH);
+    CHECK(time_ms == (1000u + ((num_irqs * FRAME_PERIOD_US) / 1000u)),
+          "time across the timer wrap: %" PRIu32 " ms, expected %" PRIu32, time_ms,
+          1000u + ((num_irqs * FRAME_PERIOD_US) / 1000u));
+
+    /* One interrupt after the task caught up */
+    frame_sequence_irq(&seq, start_us + ((num_irqs + 1u) * FRAME_PERIOD_US));
+    CHECK(frame_sequence_next_stamp(&seq, &stamp_us) && !frame_sequence_next_stamp(&seq, &stamp_us),
+          "one interrupt did not give one stamp");
+}
+
+/*******************************************************************************
+ * Function Name: main
+ *******************************************************************************
+ * Summary:
+ *   Runs the scenarios.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   0 if all checks pass
+ ******************************************************************************/
+int main(void)
+{
+    test_counter_wrap();
+    test_backlog();
+    test_overflow_restart();
+    test_stamps();
+
+    printf("%s\n", (failures == 0u) ? "[PASS] test_frame_sequence" : "[FAIL] test_frame_sequence");
+    return (failures == 0u) ? 0 : 1;
+}
+
+/* [] END OF FILE */
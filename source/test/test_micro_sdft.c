@@ -0,0 +1,368 @@
+/*****************************************************************************
+ * File name: test_micro_sdft.c
+ *
+ * Description: Checks the sliding DFT of micro_sdft.c against a full DFT of
+ * the slow time history in double precision. Golden tones give the exact
+ * Doppler magnitude, a long run with noise bounds the error of the recursive
+ * update between resyncs, and the micro motion decision is checked on a
+ * static and a moving range bin.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Header file for local task */
+#include "micro_sdft.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define NUM_RANGE_BINS                      (64u)
+#define MIN_RANGE_BIN                       (1)
+#define MAX_RANGE_BIN                       (5)
+#define SLOW_TIME_LEN                       (128u)
+#define NUM_DOPPLER                         (5u)
+
+/* Frames of the long run, several resync periods */
+#define LONG_RUN_FRAMES                     (5u * MICRO_SDFT_RESYNC_FRAMES)
+
+/* Error of a Doppler bin relative to the full scale of the golden tones,
+ * and for the long run relative to the norm of the observed Doppler bins of
+ * the range bin. In the long run the float32 update drifts until the next
+ * resync, the more the larger the static part: 1e-3 with clutter 20 times
+ * the micro motion.
+ */
+#define GOLDEN_TOLERANCE                    (1.0e-5)
+#define DRIFT_TOLERANCE                     (2.0e-3)
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static micro_sdft_t sdft;
+static float32_t spectrum[2u * NUM_RANGE_BINS];
+static range_profile_t profile;
+
+/* Slow time history of every observed range bin kept by the test */
+static float64_t history[MAX_RANGE_BIN - MIN_RANGE_BIN + 1][SLOW_TIME_LEN][2];
+static uint32_t history_frames;
+static uint32_t rand_state = 7;
+static uint32_t failures;
+
+/*******************************************************************************
+ * Function Name: noise
+ *******************************************************************************
+ * Summary:
+ *   Returns pseudo random noise in [-0.5, 0.5).
+ ******************************************************************************/
+static float64_t noise(void)
+{
+    rand_state = (rand_state * 1103515245u) + 12345u;
+    return ((float64_t)((rand_state >> 8) & 0xFFFFu) / 65536.0) - 0.5;
+}
+
+/*******************************************************************************
+ * Function Name: push_frame
+ *******************************************************************************
+ * Summary:
+ *   Writes the observed range bins into the profile and the test history and
+ *   runs the analyzer on the profile.
+ ******************************************************************************/
+static void push_frame(float64_t (*sample)(uint32_t bin, uint32_t frame, float64_t* im))
+{
+    for (uint32_t bin = 0; bin < (uint32_t)(MAX_RANGE_BIN - MIN_RANGE_BIN + 1); ++bin)
+    {
+        float64_t im;
+        float64_t re = sample(bin, history_frames, &im);
+        uint32_t range_bin = (uint32_t)MIN_RANGE_BIN + bin;
+
+        spectrum[2u * range_bin] = (float32_t)re;
+        spectrum[(2u * range_bin) + 1u] = (float32_t)im;
+        history[bin][history_frames % SLOW_TIME_LEN][0] = (float64_t)spectrum[2u * range_bin];
+        history[bin][history_frames % SLOW_TIME_LEN][1] = (float64_t)spectrum[(2u * range_bin) + 1u];
+    }
+    ++history_frames;
+    micro_sdft_update(&sdft, &profile);
+}
+
+/*******************************************************************************
+ * Function Name: dft_error
+ *******************************************************************************
+ * Summary:
+ *   Compares the Doppler bins of a range bin with a full DFT of the last
+ *   SLOW_TIME_LEN samples, the oldest sample at time 0 like the sliding DFT.
+ *
+ * Return:
+ *   largest error of a Doppler bin, norm of all DFT Doppler bins in norm
+ ******************************************************************************/
+static float64_t dft_error(uint32_t bin, float64_t* doppler_magnitude, float64_t* dft_norm)
+{
+    float64_t error = 0.0;
+    float64_t norm = 0.0;
+
+    for (uint32_t entry = 0; entry < (2u * NUM_DOPPLER); ++entry)
+    {
+        int32_t k = (entry < NUM_DOPPLER) ? (int32_t)(entry + 1u) : -(int32_t)(entry - NUM_DOPPLER + 1u);
+        float64_t re = 0.0;
+        float64_t im = 0.0;
+
+        for (uint32_t m = 0; m < SLOW_TIME_LEN; ++m)
+        {
+            const float64_t* x = history[bin][(history_frames + m) % SLOW_TIME_LEN];
+            float64_t phase = (-2.0 * M_PI * (float64_t)k * (float64_t)m) / (float64_t)SLOW_TIME_LEN;
+
+            re += (x[0] * cos(phase)) - (x[1] * sin(phase));
+            im += (x[0] * sin(phase)) + (x[1] * cos(phase));
+        }
+
+        if (doppler_magnitude != NULL)
+        {
+            doppler_magnitude[entry] = hypot(sdft.dft[bin][entry][0], sdft.dft[bin][entry][1]);
+        }
+        error = fmax(error, hypot((float64_t)sdft.dft[bin][entry][0] - re, (float64_t)sdft.dft[bin][entry][1] - im));
+        norm += (re * re) + (im * im);
+    }
+
+    *dft_norm = sqrt(norm);
+    return error;
+}
+
+/*******************************************************************************
+ * Function Name: start
+ *******************************************************************************
+ * Summary:
+ *   Configures the analyzer like the presence library with micro_fft_size 128
+ *   and Doppler bins 1 to 5 on range bins 1 to 5.
+ ******************************************************************************/
+static void start(void)
+{
+    xensiv_radar_presence_config_t config;
+
+    memset(&config, 0, sizeof(config));
+    config.min_range_bin = MIN_RANGE_BIN;
+    config.max_range_bin = MAX_RANGE_BIN;
+    config.micro_fft_size = (int32_t)SLOW_TIME_LEN;
+    config.micro_movement_compare_idx = (int32_t)NUM_DOPPLER;
+    config.micro_movement_validity_ms = 4000;
+    config.mode = XENSIV_RADAR_PRESENCE_MODE_MICRO_IF_MACRO;
+
+    micro_sdft_init(&sdft, &config);
+    memset(spectrum, 0, sizeof(spectrum));
+    memset(history, 0, sizeof(history));
+    history_frames = 0;
+    profile.spectrum = spectrum;
+    profile.num_bins = NUM_RANGE_BINS;
+    profile.sample_scale = 1.0f;
+}
+
+/* Range bin 0 is static, bin 1 has a tone on Doppler bin 3 of amplitude 0.5
+ * and bin 2 one on Doppler bin -2 of amplitude 0.25, the others are empty
+ */
+static float64_t golden_sample(uint32_t bin, uint32_t frame, float64_t* im)
+{
+    float64_t phase = 0.7 + ((2.0 * M_PI * (float64_t)frame) / (float64_t)SLOW_TIME_LEN);
+
+    switch (bin)
+    {
+        case 0:
+            *im = -0.3;
+            return 1.2;
+        case 1:
+            *im = 0.5 * sin(3.0 * phase);
+            return 0.5 * cos(3.0 * phase);
+        case 2:
+            *im = 0.25 * sin(-2.0 * phase);
+            return 0.25 * cos(-2.0 * phase);
+        default:
+            *im = 0.0;
+            return 0.0;
+    }
+}
+
+/* Static clutter and noise on every bin, micro motion of a breathing person
+ * with a slow phase modulation on bin 3
+ */
+static float64_t noisy_sample(uint32_t bin, uint32_t frame, float64_t* im)
+{
+    float64_t re = 2.0 + (0.01 * noise());
+
+    *im = -1.0 + (0.01 * noise());
+    if (bin == 3u)
+    {
+        float64_t phase = 0.8 * sin((2.0 * M_PI * (float64_t)frame) / 40.0);
+
+        re += 0.1 * cos(phase);
+        *im += 0.1 * sin(phase);
+    }
+    return re;
+}
+
+/*******************************************************************************
+ * Function Name: test_golden
+ *******************************************************************************
+ * Summary:
+ *   Golden tones: after a full window a tone of amplitude a on Doppler bin k
+ *   has the magnitude a * len on bin k and 0 on the others, the static range
+ *   bin has no Doppler content.
+ ******************************************************************************/
+static void test_golden(void)
+{
+    /* Expected magnitudes of Doppler bins 1..5, -1..-5 per range bin */
+    static const float64_t golden[3][2u * NUM_DOPPLER] =
+    {
+        { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+        { 0, 0, 0.5 * SLOW_TIME_LEN, 0, 0, 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0, 0, 0.25 * SLOW_TIME_LEN, 0, 0, 0 },
+    };
+    float64_t worst = 0.0;
+    int32_t range_bin = -1;
+
+    start();
+    for (uint32_t frame = 0; frame < (3u * SLOW_TIME_LEN); ++frame)
+    {
+        push_frame(golden_sample);
+    }
+
+    for (uint32_t bin = 0; bin < 3u; ++bin)
+    {
+        float64_t magnitude[2u * NUM_DOPPLER];
+        float64_t norm;
+
+        worst = fmax(worst, dft_error(bin, magnitude, &norm) / SLOW_TIME_LEN);
+        for (uint32_t entry = 0; entry < (2u * NUM_DOPPLER); ++entry)
+        {
+            if (fabs(magnitude[entry] - golden[bin][entry]) > (GOLDEN_TOLERANCE * SLOW_TIME_LEN))
+            {
+                printf("[FAIL] golden range bin %" PRIu32 " Doppler entry %" PRIu32 ": %.6f expected %.6f\n",
+                       bin, entry, magnitude[entry], golden[bin][entry]);
+                ++failures;
+            }
+        }
+    }
+
+    if (!micro_sdft_motion(&sdft, &range_bin) || (range_bin != (MIN_RANGE_BIN + 1)))
+    {
+        printf("[FAIL] golden: micro motion on range bin %" PRId32 ", expected %d\n", range_bin, MIN_RANGE_BIN + 1);
+        ++failures;
+    }
+    if (!(worst <= GOLDEN_TOLERANCE))
+    {
+        printf("[FAIL] golden: error %.2e above %.1e\n", worst, GOLDEN_TOLERANCE);
+        ++failures;
+    }
+    printf("golden tones: largest error against the DFT %.1e, micro motion on range bin %" PRId32 "\n", worst,
+           range_bin);
+}
+
+/*******************************************************************************
+ * Function Name: test_long_run
+ *******************************************************************************
+ * Summary:
+ *   Compares every range bin with the full DFT on every frame of a long run
+ *   with noise, over several resync periods.
+ ******************************************************************************/
+static void test_long_run(void)
+{
+    float64_t worst = 0.0;
+    uint32_t worst_frame = 0;
+    int32_t range_bin = -1;
+
+    start();
+    for (uint32_t frame = 0; frame < LONG_RUN_FRAMES; ++frame)
+    {
+        push_frame(noisy_sample);
+        if (frame < SLOW_TIME_LEN)
+        {
+            continue;
+        }
+
+        for (uint32_t bin = 0; bin < (uint32_t)(MAX_RANGE_BIN - MIN_RANGE_BIN + 1); ++bin)
+        {
+            float64_t norm;
+            float64_t error = dft_error(bin, NULL, &norm);
+
+            error /= fmax(norm, 1.0e-12);
+
+            if (error > worst)
+            {
+                worst = error;
+                worst_frame = frame;
+            }
+        }
+    }
+
+    if (!(worst <= DRIFT_TOLERANCE))
+    {
+        printf("[FAIL] long run: error %.2e at frame %" PRIu32 " above %.1e\n", worst, worst_frame, DRIFT_TOLERANCE);
+        ++failures;
+    }
+    if (!micro_sdft_motion(&sdft, &range_bin) || (range_bin != (MIN_RANGE_BIN + 3)))
+    {
+        printf("[FAIL] long run: micro motion on range bin %" PRId32 ", expected %d\n", range_bin, MIN_RANGE_BIN + 3);
+        ++failures;
+    }
+    printf("%" PRIu32 " frames with noise: largest error against the DFT %.1e at frame %" PRIu32
+           ", %" PRIu32 " resyncs, largest drift %.1e\n",
+           LONG_RUN_FRAMES, worst, worst_frame, sdft.stats.resyncs, sdft.stats.max_drift);
+}
+
+/*******************************************************************************
+ * Function Name: test_static
+ *******************************************************************************
+ * Summary:
+ *   Static clutter with noise and no micro motion is not reported.
+ ******************************************************************************/
+static float64_t static_sample(uint32_t bin, uint32_t frame, float64_t* im)
+{
+    (void)frame;
+    *im = -1.0 + (0.001 * noise());
+    return 2.0 + (0.001 * noise()) + (0.1 * (float64_t)bin);
+}
+
+static void test_static(void)
+{
+    start();
+    for (uint32_t frame = 0; frame < (2u * SLOW_TIME_LEN); ++frame)
+    {
+        push_frame(static_sample);
+    }
+    if (micro_sdft_motion(&sdft, NULL))
+    {
+        printf("[FAIL] static scene reported as micro motion\n");
+        ++failures;
+    }
+}
+
+int main(void)
+{
+    test_golden();
+    test_long_run();
+    test_static();
+
+    printf("%s\n", (failures == 0u) ? "[PASS] test_micro_sdft" : "[FAIL] test_micro_sdft");
+    return (failures == 0u) ? 0 : 1;
+}
+
+/* [] END OF FILE */
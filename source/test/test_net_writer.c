@@ -0,0 +1,628 @@
+/*****************************************************************************
+ * File name: test_net_writer.c
+ *
+ * Description: Characterizes net_writer.c against a broker stand-in with the
+ * FreeRTOS stand-ins of host/, so the writer task and its publish workers run
+ * as threads. The stand-in keeps every publish for the round trip of the
+ * broker until its PUBACK; while it is stalled a publish waits until the
+ * broker resumes or fails after the timeout of the MQTT library. The test
+ * measures the events per second and the latency at every window from 1 to
+ * MQTT_STATE_ARRAY_MAX_COUNT, the latency and drops of each lane with a slow
+ * broker at the default window, and the failures and the recovery after an
+ * unresponsive broker. It is built with NET_WRITER_WINDOW set to
+ * MQTT_STATE_ARRAY_MAX_COUNT. It checks that the publisher
+ * never waits, that every accepted message completes exactly once, and that
+ * every publish carries exactly one message as it was handed over.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* Header file includes */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Header file for local task */
+#include "net_writer.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Messages offered per scenario at most */
+#define MAX_MESSAGES                        (512u)
+
+/* Events as serialized by the publisher and telemetry of a report */
+#define EVENT_SIZE                          (64u)
+#define TELEMETRY_SIZE                      (256u)
+
+/* Window scenario: events offered as fast as the writer accepts them, at
+ * every window up to the publishes the MQTT library tracks at once
+ */
+#define WINDOW_MESSAGES                     (100u)
+#define WINDOW_RTT_MS                       (20u)
+#define MAX_WINDOW                          (MQTT_STATE_ARRAY_MAX_COUNT)
+
+/* Window of the firmware, used by the other scenarios */
+#define DEFAULT_WINDOW                      (4u)
+
+/* Share of the ideal events per second, window / round trip, each window
+ * reaches at least
+ */
+#define MIN_WINDOW_PERCENT                  (70u)
+
+/* Slow broker scenario: events every 100 ms and telemetry every 10 ms */
+#define SLOW_RTT_MS                         (100u)
+#define SLOW_DURATION_MS                    (1500u)
+#define SLOW_EVENT_PERIOD_MS                (100u)
+#define SLOW_TELEMETRY_PERIOD_MS            (10u)
+
+/* Unresponsive broker scenario: the broker stalls for STALL_MS, a publish
+ * fails after BROKER_TIMEOUT_MS like the publish of the MQTT library
+ */
+#define STALL_RTT_MS                        (20u)
+#define STALL_MS                            (1500u)
+#define BROKER_TIMEOUT_MS                   (500u)
+
+/* A hand over that takes longer, half the shortest round trip of the
+ * broker, waited for the network
+ */
+#define MAX_HAND_OVER_US                    (10000u)
+
+/* Time for the writer to complete all messages after a scenario */
+#define DRAIN_TIMEOUT_MS                    (10000u)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef struct
+{
+    uint32_t lane;
+    uint32_t n;                         /* number in the scenario */
+    bool accepted;
+    uint32_t completions;
+    bool success;
+    uint32_t latency_ms;
+} message_t;
+
+typedef struct
+{
+    uint32_t offered;
+    uint32_t accepted;
+    uint32_t completed;
+    uint32_t failed;
+    uint32_t max_latency_ms;
+    uint64_t total_latency_ms;
+} lane_result_t;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static pthread_mutex_t test_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t broker_cond = PTHREAD_COND_INITIALIZER;
+
+static char topic[] = "test/telemetry";
+static message_t messages[MAX_MESSAGES];
+static uint32_t num_messages;
+static lane_result_t lanes[NET_WRITER_LANES];
+
+/* Broker stand-in */
+static uint32_t broker_rtt_ms;
+static bool broker_stalled;
+static uint32_t publishes;
+static uint32_t payload_errors;
+static uint32_t order_errors;
+static uint32_t last_n[NET_WRITER_LANES];
+static uint32_t completion_errors;
+static uint32_t max_hand_over_us;
+
+/*******************************************************************************
+ * Function Name: now_us
+ *******************************************************************************
+ * Summary:
+ *   Returns the monotonic time in us.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   time in us
+ ******************************************************************************/
+static uint64_t now_us(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000u) + ((uint64_t)now.tv_nsec / 1000u);
+}
+
+/*******************************************************************************
+ * Function Name: serialize
+ *******************************************************************************
+ * Summary:
+ *   Serializes message n of a lane like the publisher, one JSON object padded
+ *   to its size and terminated by a NUL.
+ *
+ * Parameters:
+ *   buffer: destination of EVENT_SIZE or TELEMETRY_SIZE bytes
+ *   lane: lane of the message
+ *   n: number of the message
+ *
+ * Return:
+ *   length with the NUL
+ ******************************************************************************/
+static uint32_t serialize(char* buffer, uint32_t lane, uint32_t n)
+{
+    uint32_t size = (lane == NET_WRITER_LANE_LATENCY) ? EVENT_SIZE : TELEMETRY_SIZE;
+    int length = snprintf(buffer, size, "{\"lane\":%" PRIu32 ",\"n\":%" PRIu32 ",\"pad\":\"", lane, n);
+
+    memset(&buffer[length], 'x', size - (uint32_t)length - 3u);
+    buffer[size - 3u] = '"';
+    buffer[size - 2u] = '}';
+    buffer[size - 1u] = '\0';
+
+    return size;
+}
+
+/*******************************************************************************
+ * Function Name: broker_publish
+ *******************************************************************************
+ * Summary:
+ *   Publish of the broker stand-in, called by the publish workers. Checks
+ *   that the payload is one message as handed over and returns with the
+ *   PUBACK after the round trip, or fails after BROKER_TIMEOUT_MS while the
+ *   broker is stalled.
+ *
+ * Parameters:
+ *   message: payload
+ *   length: payload length
+ *   mqtt_topic: topic
+ *
+ * Return:
+ *   SUBS_SUCCESS with the PUBACK
+ ******************************************************************************/
+static subs_rslt_t broker_publish(char* message, int length, char* mqtt_topic)
+{
+    char expected[TELEMETRY_SIZE];
+    uint32_t lane = NET_WRITER_LANES;
+    uint32_t n = 0;
+    struct timespec deadline;
+    bool acked = true;
+
+    pthread_mutex_lock(&test_mutex);
+    ++publishes;
+    if ((mqtt_topic != topic) ||
+        (sscanf(message, "{\"lane\":%" SCNu32 ",\"n\":%" SCNu32 ",", &lane, &n) != 2) ||
+        (lane >= NET_WRITER_LANES) || ((uint32_t)length != serialize(expected, lane, n)) ||
+        (memcmp(message, expected, (size_t)length) != 0))
+    {
+        ++payload_errors;
+    }
+    else
+    {
+        /* Publishes start in the order of the hand over, checked at window 1 */
+        if ((n <= last_n[lane]) && (last_n[lane] != UINT32_MAX))
+        {
+            ++order_errors;
+        }
+        last_n[lane] = n;
+    }
+
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_nsec += (long)BROKER_TIMEOUT_MS * 1000000L;
+    deadline.tv_sec += deadline.tv_nsec / 1000000000L;
+    deadline.tv_nsec %= 1000000000L;
+    while (broker_stalled && acked)
+    {
+        acked = (pthread_cond_timedwait(&broker_cond, &test_mutex, &deadline) == 0);
+    }
+    pthread_mutex_unlock(&test_mutex);
+
+    if (!acked)
+    {
+        return SUBS_FAILURE;
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(broker_rtt_ms));
+    return SUBS_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: message_done
+ *******************************************************************************
+ * Summary:
+ *   Completion callback of the writer.
+ *
+ * Parameters:
+ *   id: message id
+ *   success: the message was published
+ *   latency_ms: latency of the message
+ *   arg: message_t of the message
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void message_done(uint32_t id, bool success, uint32_t latency_ms, void* arg)
+{
+    message_t* message = (message_t*)arg;
+    lane_result_t* lane = &lanes[message->lane];
+
+    (void)id;
+
+    pthread_mutex_lock(&test_mutex);
+    ++message->completions;
+    message->success = success;
+    message->latency_ms = latency_ms;
+
+    ++lane->completed;
+    if (!success)
+    {
+        ++lane->failed;
+    }
+    lane->total_latency_ms += latency_ms;
+    if (latency_ms > lane->max_latency_ms)
+    {
+        lane->max_latency_ms = latency_ms;
+    }
+    pthread_mutex_unlock(&test_mutex);
+}
+
+/*******************************************************************************
+ * Function Name: start_scenario
+ *******************************************************************************
+ * Summary:
+ *   Resets the results and sets the broker round trip.
+ *
+ * Parameters:
+ *   rtt_ms: round trip of the broker until the PUBACK
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void start_scenario(uint32_t rtt_ms)
+{
+    pthread_mutex_lock(&test_mutex);
+    broker_rtt_ms = rtt_ms;
+    broker_stalled = false;
+    num_messages = 0;
+    publishes = 0;
+    last_n[NET_WRITER_LANE_LATENCY] = UINT32_MAX;
+    last_n[NET_WRITER_LANE_BULK] = UINT32_MAX;
+    memset(lanes, 0, sizeof(lanes));
+    memset(messages, 0, sizeof(messages));
+    pthread_mutex_unlock(&test_mutex);
+}
+
+/*******************************************************************************
+ * Function Name: offer
+ *******************************************************************************
+ * Summary:
+ *   Hands a message over to the writer like the publisher, measuring how
+ *   long the hand over takes.
+ *
+ * Parameters:
+ *   lane: lane of the message
+ *
+ * Return:
+ *   true if the writer accepted the message
+ ******************************************************************************/
+static bool offer(net_writer_lane_t lane)
+{
+    char buffer[TELEMETRY_SIZE];
+    message_t* message;
+    uint32_t length;
+    uint64_t start_us;
+    uint32_t hand_over_us;
+    uint32_t id;
+
+    pthread_mutex_lock(&test_mutex);
+    if (num_messages == MAX_MESSAGES)
+    {
+        pthread_mutex_unlock(&test_mutex);
+        return false;
+    }
+    message = &messages[num_messages];
+    message->lane = lane;
+    message->n = num_messages++;
+    ++lanes[lane].offered;
+    pthread_mutex_unlock(&test_mutex);
+
+    length = serialize(buffer, lane, message->n);
+    start_us = now_us();
+    id = net_writer_publish(topic, buffer, length, lane, message_done, message);
+    hand_over_us = (uint32_t)(now_us() - start_us);
+
+    pthread_mutex_lock(&test_mutex);
+    if (hand_over_us > max_hand_over_us)
+    {
+        max_hand_over_us = hand_over_us;
+    }
+    if (id != 0u)
+    {
+        message->accepted = true;
+        ++lanes[lane].accepted;
+    }
+    pthread_mutex_unlock(&test_mutex);
+
+    return (id != 0u);
+}
+
+/*******************************************************************************
+ * Function Name: drain
+ *******************************************************************************
+ * Summary:
+ *   Waits until every accepted message has completed, then counts the
+ *   messages that did not complete exactly once, or dropped ones that did.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   false if the writer did not complete them within DRAIN_TIMEOUT_MS
+ ******************************************************************************/
+static bool drain(void)
+{
+    uint32_t start_ms = xTaskGetTickCount();
+
+    for (;;)
+    {
+        bool done;
+
+        pthread_mutex_lock(&test_mutex);
+        done = ((lanes[0].completed == lanes[0].accepted) && (lanes[1].completed == lanes[1].accepted));
+        if (done)
+        {
+            for (uint32_t i = 0; i < num_messages; ++i)
+            {
+                if (messages[i].completions != (messages[i].accepted ? 1u : 0u))
+                {
+                    ++completion_errors;
+                }
+            }
+        }
+        pthread_mutex_unlock(&test_mutex);
+
+        if (done)
+        {
+            return true;
+        }
+        if ((xTaskGetTickCount() - start_ms) > DRAIN_TIMEOUT_MS)
+        {
+            return false;
+        }
+        vTaskDelay(1);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: print_lane
+ *******************************************************************************
+ * Summary:
+ *   Prints the results of a lane.
+ *
+ * Parameters:
+ *   name: name of the lane
+ *   lane: results
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void print_lane(const char* name, const lane_result_t* lane)
+{
+    printf("  %-9s %4" PRIu32 " offered %4" PRIu32 " dropped %4" PRIu32 " failed, latency avg %5" PRIu32
+           " max %5" PRIu32 " ms\n",
+           name, lane->offered, lane->offered - lane->accepted, lane->failed,
+           (lane->completed > 0u) ? (uint32_t)(lane->total_latency_ms / lane->completed) : 0u,
+           lane->max_latency_ms);
+}
+
+/*******************************************************************************
+ * Function Name: run_window
+ *******************************************************************************
+ * Summary:
+ *   Offers WINDOW_MESSAGES events as fast as the writer accepts them and
+ *   measures the events per second.
+ *
+ * Parameters:
+ *   window: publishes in flight at most
+ *
+ * Return:
+ *   events per second
+ ******************************************************************************/
+static uint32_t run_window(uint32_t window)
+{
+    uint32_t start_ms;
+    uint32_t elapsed_ms;
+    uint32_t rate;
+
+    (void)net_writer_init(broker_publish, window);
+    start_scenario(WINDOW_RTT_MS);
+    start_ms = xTaskGetTickCount();
+
+    for (uint32_t i = 0; i < WINDOW_MESSAGES; ++i)
+    {
+        /* Offered again until accepted, this scenario measures the throughput,
+         * so a refused message is not counted and its record is reused
+         */
+        while (!offer(NET_WRITER_LANE_LATENCY))
+        {
+            pthread_mutex_lock(&test_mutex);
+            --lanes[NET_WRITER_LANE_LATENCY].offered;
+            --num_messages;
+            pthread_mutex_unlock(&test_mutex);
+            vTaskDelay(1);
+        }
+    }
+    (void)drain();
+
+    elapsed_ms = xTaskGetTickCount() - start_ms;
+    rate = (WINDOW_MESSAGES * 1000u) / ((elapsed_ms > 0u) ? elapsed_ms : 1u);
+    printf("  window %2" PRIu32 ": %4" PRIu32 " events/s, latency avg %4" PRIu32 " max %4" PRIu32 " ms\n", window,
+           rate, (uint32_t)(lanes[NET_WRITER_LANE_LATENCY].total_latency_ms / WINDOW_MESSAGES),
+           lanes[NET_WRITER_LANE_LATENCY].max_latency_ms);
+
+    return rate;
+}
+
+/*******************************************************************************
+ * Function Name: main
+ *******************************************************************************
+ * Summary:
+ *   Runs the writer task and the scenarios and checks the results.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   0 if all checks pass
+ ******************************************************************************/
+int main(void)
+{
+    uint32_t failures = 0;
+    uint32_t rates[MAX_WINDOW + 1u];
+    uint32_t start_ms;
+    uint32_t recovery_ms;
+    lane_result_t slow[NET_WRITER_LANES];
+
+    if (pdPASS != xTaskCreate(net_writer_task, "Network writer", NET_WRITER_TASK_STACK_SIZE, NULL,
+                              NET_WRITER_TASK_PRIORITY, &net_writer_task_handle))
+    {
+        printf("[FAIL] test_net_writer: no writer task\n");
+        return 1;
+    }
+
+    /* Window: the round trips of up to the window of publishes overlap */
+    printf("%u events of %u bytes as fast as accepted, broker round trip %u ms:\n", WINDOW_MESSAGES, EVENT_SIZE,
+           WINDOW_RTT_MS);
+    for (uint32_t window = 1; window <= MAX_WINDOW; ++window)
+    {
+        rates[window] = run_window(window);
+        if ((window == 1u) && (order_errors != 0u))
+        {
+            printf("[FAIL] %" PRIu32 " publishes started out of order at window 1\n", order_errors);
+            ++failures;
+        }
+        if ((rates[window] * 100u * WINDOW_RTT_MS) < (window * 1000u * MIN_WINDOW_PERCENT))
+        {
+            printf("[FAIL] window %" PRIu32 " publishes %" PRIu32 " events/s, less than %u %% of %" PRIu32 "\n",
+                   window, rates[window], MIN_WINDOW_PERCENT, (window * 1000u) / WINDOW_RTT_MS);
+            ++failures;
+        }
+    }
+    (void)net_writer_init(broker_publish, DEFAULT_WINDOW);
+
+    /* Slow broker: the bulk lane overflows, the events keep their lane */
+    start_scenario(SLOW_RTT_MS);
+    start_ms = xTaskGetTickCount();
+    for (uint32_t t = 0; t < SLOW_DURATION_MS; t += SLOW_TELEMETRY_PERIOD_MS)
+    {
+        if ((t % SLOW_EVENT_PERIOD_MS) == 0u)
+        {
+            (void)offer(NET_WRITER_LANE_LATENCY);
+        }
+        (void)offer(NET_WRITER_LANE_BULK);
+        while ((xTaskGetTickCount() - start_ms) < (t + SLOW_TELEMETRY_PERIOD_MS))
+        {
+            vTaskDelay(1);
+        }
+    }
+    if (!drain())
+    {
+        printf("[FAIL] the writer did not complete the messages of the slow broker\n");
+        ++failures;
+    }
+    memcpy(slow, lanes, sizeof(slow));
+    printf("slow broker, round trip %u ms, window 4, events every %u ms, telemetry every %u ms:\n",
+           SLOW_RTT_MS, SLOW_EVENT_PERIOD_MS, SLOW_TELEMETRY_PERIOD_MS);
+    print_lane("latency", &slow[NET_WRITER_LANE_LATENCY]);
+    print_lane("bulk", &slow[NET_WRITER_LANE_BULK]);
+    if ((slow[NET_WRITER_LANE_LATENCY].accepted != slow[NET_WRITER_LANE_LATENCY].offered) ||
+        (slow[NET_WRITER_LANE_BULK].accepted == slow[NET_WRITER_LANE_BULK].offered))
+    {
+        printf("[FAIL] events dropped or no telemetry dropped with the slow broker\n");
+        ++failures;
+    }
+    if (slow[NET_WRITER_LANE_LATENCY].max_latency_ms > (4u * SLOW_RTT_MS))
+    {
+        printf("[FAIL] events waited up to %" PRIu32 " ms behind the telemetry\n",
+               slow[NET_WRITER_LANE_LATENCY].max_latency_ms);
+        ++failures;
+    }
+
+    /* Unresponsive broker: publishes time out and are retried */
+    start_scenario(STALL_RTT_MS);
+    pthread_mutex_lock(&test_mutex);
+    broker_stalled = true;
+    pthread_mutex_unlock(&test_mutex);
+    start_ms = xTaskGetTickCount();
+    for (uint32_t t = 0; t < STALL_MS; t += SLOW_TELEMETRY_PERIOD_MS)
+    {
+        if ((t % SLOW_EVENT_PERIOD_MS) == 0u)
+        {
+            (void)offer(NET_WRITER_LANE_LATENCY);
+        }
+        (void)offer(NET_WRITER_LANE_BULK);
+        while ((xTaskGetTickCount() - start_ms) < (t + SLOW_TELEMETRY_PERIOD_MS))
+        {
+            vTaskDelay(1);
+        }
+    }
+    pthread_mutex_lock(&test_mutex);
+    broker_stalled = false;
+    pthread_cond_broadcast(&broker_cond);
+    pthread_mutex_unlock(&test_mutex);
+    start_ms = xTaskGetTickCount();
+    if (!drain())
+    {
+        printf("[FAIL] the writer did not recover from the unresponsive broker\n");
+        ++failures;
+    }
+    recovery_ms = xTaskGetTickCount() - start_ms;
+    printf("broker stalled for %u ms, publish timeout %u ms, then round trip %u ms: all completed %" PRIu32
+           " ms after the broker resumed\n", STALL_MS, BROKER_TIMEOUT_MS, STALL_RTT_MS, recovery_ms);
+    print_lane("latency", &lanes[NET_WRITER_LANE_LATENCY]);
+    print_lane("bulk", &lanes[NET_WRITER_LANE_BULK]);
+
+    printf("hand over max %" PRIu32 " us, %" PRIu32 " publishes in the last scenario\n", max_hand_over_us,
+           publishes);
+    if (max_hand_over_us > MAX_HAND_OVER_US)
+    {
+        printf("[FAIL] a hand over took %" PRIu32 " us, the publisher waited for the network\n",
+               max_hand_over_us);
+        ++failures;
+    }
+    if ((payload_errors + completion_errors) != 0u)
+    {
+        printf("[FAIL] %" PRIu32 " publishes not carrying one message as handed over, %" PRIu32
+               " messages not completed once\n", payload_errors, completion_errors);
+        ++failures;
+    }
+
+    printf("%s\n", (failures == 0u) ? "[PASS] test_net_writer" : "[FAIL] test_net_writer");
+    return (failures == 0u) ? 0 : 1;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,323 @@
+/*****************************************************************************
+ * File name: test_overload_governor.c
+ *
+ * Description: Simulates the frame loop of radar_task with the overload
+ * governor on a virtual clock. Frames arrive every frame period into a FIFO
+ * of a few frames, and every frame takes the processing time of a cost model
+ * of the degradation level plus an injected delay. The test checks that the
+ * governor degrades and restores one step at a time with its hysteresis,
+ * reports every step change, ignores short spikes and keeps the FIFO from
+ * overflowing where a loop without governor loses frames.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Header file for local task */
+#include "overload_governor.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define FRAME_PERIOD_US                     (5000u)
+
+/* Frames the sensor FIFO holds before it overflows */
+#define FIFO_FRAMES                         (3u)
+
+/* Cost model of one frame: the conversion and averaging of every frame, also
+ * of a skipped one, the macro detection and the micro FFTs of the library
+ */
+#define PREPROCESS_US                       (600u)
+#define MACRO_US                            (500u)
+#define MICRO_US                            (900u)
+
+#define NUM_PHASES                          (sizeof(phases) / sizeof(phases[0]))
+#define MAX_STEPS                           (16u)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+/* Delay injected into every processed frame from a start time on */
+typedef struct
+{
+    uint32_t start_ms;
+    uint32_t delay_us;
+    const char* name;
+} phase_t;
+
+typedef struct
+{
+    uint32_t time_ms;
+    overload_level_t old_level;
+    overload_level_t new_level;
+    uint32_t load_permille;
+} step_t;
+
+typedef struct
+{
+    uint32_t frames;
+    uint32_t processed;
+    uint32_t skipped;
+    uint32_t lost;                      /* frames lost by FIFO overflows */
+    uint32_t overflows;
+    uint32_t max_backlog;
+    uint32_t num_steps;
+    step_t steps[MAX_STEPS];
+    overload_level_t level_at_phase_end[8];
+} sim_result_t;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static const phase_t phases[] =
+{
+    {     0,    0, "nominal" },
+    {  2000, 3000, "heavy" },           /* 5 ms per frame at full fidelity */
+    {  6000, 7600, "overload" },        /* 9.6 ms, fits two frame periods only with the
+                                         * shrunk micro FFT */
+    { 10000, 3000, "heavy" },
+    { 16000,    0, "nominal" },
+    { 40000,    0, "end" },
+};
+
+/* Spikes of two frames over budget, too short to degrade */
+static const uint32_t spike_ms[] = { 500, 1000, 1500, 1700, 1900 };
+
+static uint32_t sim_time_ms;
+
+/*******************************************************************************
+ * Function Name: on_level_change
+ *******************************************************************************
+ * Summary:
+ *   Governor callback, records the step changes.
+ ******************************************************************************/
+static void on_level_change(overload_level_t old_level, overload_level_t new_level,
+                            uint32_t load_permille, void* data)
+{
+    sim_result_t* result = (sim_result_t*)data;
+
+    if (result->num_steps < MAX_STEPS)
+    {
+        step_t* step = &result->steps[result->num_steps];
+
+        step->time_ms = sim_time_ms;
+        step->old_level = old_level;
+        step->new_level = new_level;
+        step->load_permille = load_permille;
+    }
+    ++result->num_steps;
+}
+
+/*******************************************************************************
+ * Function Name: processing_us
+ *******************************************************************************
+ * Summary:
+ *   Cost model of a processed frame at a level: micro_fft_decimation_enabled
+ *   halves the micro FFTs and the shrunk micro_fft_size halves them again.
+ ******************************************************************************/
+static uint32_t processing_us(overload_level_t level, uint32_t time_ms)
+{
+    xensiv_radar_presence_config_t config = { .micro_fft_size = 128, .micro_fft_decimation_enabled = false };
+    uint32_t micro_us = MICRO_US;
+    uint32_t delay_us = 0;
+
+    overload_governor_apply_config(level, &config);
+    if (config.micro_fft_decimation_enabled)
+    {
+        micro_us /= 2u;
+    }
+    micro_us = (micro_us * (uint32_t)config.micro_fft_size) / 128u;
+
+    for (uint32_t i = 0; i < NUM_PHASES; ++i)
+    {
+        if (time_ms >= phases[i].start_ms)
+        {
+            delay_us = phases[i].delay_us;
+        }
+    }
+    for (uint32_t i = 0; i < (sizeof(spike_ms) / sizeof(spike_ms[0])); ++i)
+    {
+        if ((time_ms >= spike_ms[i]) && (time_ms < (spike_ms[i] + (2u * FRAME_PERIOD_US / 1000u))))
+        {
+            delay_us += 4000u;
+        }
+    }
+
+    return PREPROCESS_US + MACRO_US + micro_us + delay_us;
+}
+
+/*******************************************************************************
+ * Function Name: simulate
+ *******************************************************************************
+ * Summary:
+ *   Runs the frame loop on a virtual clock. The loop reads the oldest frame
+ *   of the FIFO, or waits for the next one; frames that do not fit into the
+ *   FIFO are lost, like after an overflow and its recovery.
+ *
+ * Parameters:
+ *   governed: false to process every frame at full fidelity
+ *   result: frames, losses and step changes of the run
+ ******************************************************************************/
+static void simulate(bool governed, sim_result_t* result)
+{
+    overload_governor_t governor;
+    uint64_t now_us = 0;
+    uint32_t next_frame = 0;
+    uint32_t phase = 1;
+    uint64_t end_us = (uint64_t)phases[NUM_PHASES - 1u].start_ms * 1000u;
+
+    memset(result, 0, sizeof(*result));
+    overload_governor_init(&governor, FRAME_PERIOD_US, on_level_change, result);
+
+    while (now_us < end_us)
+    {
+        uint64_t arrival_us = (uint64_t)next_frame * FRAME_PERIOD_US;
+        uint32_t arrived;
+
+        if (now_us < arrival_us)
+        {
+            now_us = arrival_us;
+        }
+        sim_time_ms = (uint32_t)(now_us / 1000u);
+
+        while ((phase < NUM_PHASES) && (sim_time_ms >= phases[phase].start_ms))
+        {
+            result->level_at_phase_end[phase - 1u] = governor.level;
+            ++phase;
+        }
+
+        /* Frames in the FIFO, the oldest ones are lost once it is full */
+        arrived = (uint32_t)(now_us / FRAME_PERIOD_US) + 1u;
+        if ((arrived - next_frame) > result->max_backlog)
+        {
+            result->max_backlog = arrived - next_frame;
+        }
+        if ((arrived - next_frame) > FIFO_FRAMES)
+        {
+            ++result->overflows;
+            result->lost += arrived - next_frame - 1u;
+            next_frame = arrived - 1u;
+        }
+        ++next_frame;
+        ++result->frames;
+
+        if (governed && overload_governor_skip_frame(&governor))
+        {
+            ++result->skipped;
+            now_us += PREPROCESS_US;
+            continue;
+        }
+
+        uint32_t spent_us = processing_us(governed ? governor.level : OVERLOAD_LEVEL_NONE, sim_time_ms);
+
+        ++result->processed;
+        now_us += spent_us;
+        if (governed)
+        {
+            (void)overload_governor_report(&governor, spent_us);
+        }
+    }
+}
+
+int main(void)
+{
+    static sim_result_t free_run;
+    static sim_result_t governed;
+    uint32_t failures = 0;
+    static const char* level_names[] = { "none", "skip alternate", "micro decimation", "micro FFT shrink" };
+
+    simulate(false, &free_run);
+    simulate(true, &governed);
+
+    printf("without governor: %" PRIu32 " frames, %" PRIu32 " lost in %" PRIu32 " FIFO overflows\n",
+           free_run.frames + free_run.lost, free_run.lost, free_run.overflows);
+    printf("with governor: %" PRIu32 " frames, %" PRIu32 " processed, %" PRIu32 " skipped, %" PRIu32 " lost, "
+           "largest backlog %" PRIu32 " frames\n",
+           governed.frames + governed.lost, governed.processed, governed.skipped, governed.lost, governed.max_backlog);
+    for (uint32_t i = 0; (i < governed.num_steps) && (i < MAX_STEPS); ++i)
+    {
+        printf("  %6" PRIu32 " ms  %-16s -> %-16s load %4" PRIu32 " permille\n", governed.steps[i].time_ms,
+               level_names[governed.steps[i].old_level], level_names[governed.steps[i].new_level],
+               governed.steps[i].load_permille);
+    }
+
+    /* Expected: down to the shrunk micro FFT under overload, one step back
+     * while heavy and the rest once the load is nominal again
+     */
+    static const overload_level_t expected[] =
+    {
+        OVERLOAD_LEVEL_SKIP_ALTERNATE, OVERLOAD_LEVEL_MICRO_DECIMATION, OVERLOAD_LEVEL_MICRO_FFT_SHRINK,
+        OVERLOAD_LEVEL_MICRO_DECIMATION, OVERLOAD_LEVEL_SKIP_ALTERNATE, OVERLOAD_LEVEL_NONE
+    };
+    static const overload_level_t expected_at_phase_end[] =
+    {
+        OVERLOAD_LEVEL_NONE, OVERLOAD_LEVEL_SKIP_ALTERNATE, OVERLOAD_LEVEL_MICRO_FFT_SHRINK,
+        OVERLOAD_LEVEL_MICRO_DECIMATION, OVERLOAD_LEVEL_NONE
+    };
+
+    if (governed.num_steps != (sizeof(expected) / sizeof(expected[0])))
+    {
+        printf("[FAIL] %" PRIu32 " step changes instead of %u\n", governed.num_steps,
+               (unsigned)(sizeof(expected) / sizeof(expected[0])));
+        ++failures;
+    }
+    for (uint32_t i = 0; (i < governed.num_steps) && (i < (sizeof(expected) / sizeof(expected[0]))); ++i)
+    {
+        int32_t step = (int32_t)governed.steps[i].new_level - (int32_t)governed.steps[i].old_level;
+
+        if ((governed.steps[i].new_level != expected[i]) || ((step != 1) && (step != -1)))
+        {
+            printf("[FAIL] step change %" PRIu32 " to %s\n", i, level_names[governed.steps[i].new_level]);
+            ++failures;
+        }
+        /* Hysteresis: a restore needs OVERLOAD_GOVERNOR_RESTORE_FRAMES processed frames */
+        if ((i > 0u) && (step < 0) &&
+            ((governed.steps[i].time_ms - governed.steps[i - 1u].time_ms) <
+             ((OVERLOAD_GOVERNOR_RESTORE_FRAMES * FRAME_PERIOD_US) / 1000u)))
+        {
+            printf("[FAIL] step change %" PRIu32 " restored too early\n", i);
+            ++failures;
+        }
+    }
+    for (uint32_t i = 0; i < (NUM_PHASES - 1u); ++i)
+    {
+        if (governed.level_at_phase_end[i] != expected_at_phase_end[i])
+        {
+            printf("[FAIL] %s phase %" PRIu32 " ends at %s\n", phases[i].name, i,
+                   level_names[governed.level_at_phase_end[i]]);
+            ++failures;
+        }
+    }
+    if ((governed.lost != 0u) || (free_run.lost == 0u))
+    {
+        printf("[FAIL] frames lost: %" PRIu32 " with governor, %" PRIu32 " without\n", governed.lost, free_run.lost);
+        ++failures;
+    }
+
+    printf("%s\n", (failures == 0u) ? "[PASS] test_overload_governor" : "[FAIL] test_overload_governor");
+    return (failures == 0u) ? 0 : 1;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,268 @@
+/*****************************************************************************
+ * File name: test_range_fft.c
+ *
+ * Description: Golden vector tests of the range FFT front end. Tones on and
+ * between range bins go through range_fft_process and the magnitudes are
+ * compared with the coherent gain of the window, with a golden range profile
+ * of two targets computed in double precision, and with the decay of the
+ * static clutter removal.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Header file for local task */
+#include "range_fft.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Tolerance of a magnitude, relative to the golden value plus a floor
+ * relative to the peak for the bins in the window sidelobes
+ */
+#define RELATIVE_TOLERANCE                  (1.0e-3f)
+#define FLOOR_TOLERANCE                     (1.0e-5f)
+
+/* The 4 term Blackman-Harris window has sidelobes below -92 dB, the
+ * symmetric window of range_fft reaches -76 dB at 32 points. Bins four bins
+ * away from a tone must be below -70 dB of the peak.
+ */
+#define SIDELOBE_BINS                       (4u)
+#define SIDELOBE_LEVEL                      (3.0e-4f)
+
+#define GOLDEN_SIZE                         (64u)
+#define CLUTTER_FRAMES                      (50u)
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+/* Magnitude of 0.5 + 0.2 cos(2 pi 5 n / 64 + 0.3) + 0.05 cos(2 pi 12.5 n / 64
+ * + 1.1) after the clutter estimate was set to zero, i.e. (1 - alpha) times
+ * the magnitude of the windowed spectrum, computed in double precision from
+ * the float32 chirp
+ */
+static const float32_t golden_two_targets[GOLDEN_SIZE / 2u] =
+{
+    4.018407e-02f, 2.743099e-02f, 1.125816e-01f, 1.316411e+00f,
+    4.364422e+00f, 6.336067e+00f, 4.364434e+00f, 1.317147e+00f,
+    1.209744e-01f, 3.995819e-03f, 1.212998e-01f, 6.728595e-01f,
+    1.444601e+00f, 1.444682e+00f, 6.727880e-01f, 1.213476e-01f,
+    3.861401e-03f, 7.675859e-05f, 4.086452e-05f, 3.495714e-05f,
+    3.142272e-05f, 2.605726e-05f, 2.104128e-05f, 1.727317e-05f,
+    1.403025e-05f, 1.207373e-05f, 9.848708e-06f, 8.317296e-06f,
+    7.181872e-06f, 5.478197e-06f, 4.928719e-06f, 3.897307e-06f,
+};
+
+static range_fft_t rf;
+static float32_t chirp[RANGE_FFT_MAX_SIZE];
+static float32_t zero_clutter[RANGE_FFT_MAX_SIZE];
+static float32_t clutter[RANGE_FFT_MAX_SIZE];
+static uint32_t failures;
+
+/*******************************************************************************
+ * Function Name: make_tone
+ *******************************************************************************
+ * Summary:
+ *   Fills the chirp with an offset tone of a whole or fractional bin.
+ ******************************************************************************/
+static void make_tone(uint32_t size, float32_t bin, float32_t amplitude, float32_t phase)
+{
+    for (uint32_t n = 0; n < size; ++n)
+    {
+        chirp[n] = (float32_t)(0.5 + (amplitude * cos(((2.0 * M_PI * bin * n) / size) + phase)));
+    }
+}
+
+/*******************************************************************************
+ * Function Name: check
+ *******************************************************************************
+ * Summary:
+ *   Counts and prints a failed condition.
+ ******************************************************************************/
+static void check(bool condition, const char* what, uint32_t size, float32_t value, float32_t expected)
+{
+    if (!condition)
+    {
+        printf("[FAIL] %" PRIu32 " points: %s %.6e expected %.6e\n", size, what, value, expected);
+        ++failures;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: test_tones
+ *******************************************************************************
+ * Summary:
+ *   A tone of amplitude A on bin k has the magnitude (1 - alpha) A N / 2 with
+ *   the unity coherent gain window after a zero clutter estimate, and all
+ *   bins SIDELOBE_BINS or more away are in the sidelobes.
+ ******************************************************************************/
+static void test_tones(uint32_t size)
+{
+    static const uint32_t bins[] = { 4, 9, 17, 27, 45, 60 };
+    float32_t worst_error = 0.0f;
+    float32_t worst_sidelobe = 0.0f;
+
+    for (uint32_t i = 0; i < (sizeof(bins) / sizeof(bins[0])); ++i)
+    {
+        uint32_t bin = bins[i];
+        const range_profile_t* profile;
+        float32_t expected = (1.0f - RANGE_FFT_CLUTTER_ALPHA) * 0.25f * (float32_t)size / 2.0f;
+
+        if ((bin < SIDELOBE_BINS) || (bin > ((size / 2u) - SIDELOBE_BINS)))
+        {
+            continue;
+        }
+
+        make_tone(size, (float32_t)bin, 0.25f, 0.1f * (float32_t)i);
+        (void)range_fft_set_clutter(&rf, zero_clutter, size / 2u);
+        profile = range_fft_process(&rf, chirp);
+
+        check(fabsf(profile->magnitude[bin] - expected) <= (RELATIVE_TOLERANCE * expected),
+              "tone peak", size, profile->magnitude[bin], expected);
+        worst_error = fmaxf(worst_error, fabsf(profile->magnitude[bin] - expected) / expected);
+
+        for (uint32_t j = 0; j < profile->num_bins; ++j)
+        {
+            uint32_t distance = (j > bin) ? (j - bin) : (bin - j);
+
+            if ((distance >= SIDELOBE_BINS) && ((j + bin) >= SIDELOBE_BINS))
+            {
+                check(profile->magnitude[j] <= (SIDELOBE_LEVEL * expected), "sidelobe", size,
+                      profile->magnitude[j], SIDELOBE_LEVEL * expected);
+                worst_sidelobe = fmaxf(worst_sidelobe, profile->magnitude[j] / expected);
+            }
+        }
+    }
+
+    printf("%3" PRIu32 " points: tone peak error %.1e, highest sidelobe %.1f dB\n", size, worst_error,
+           20.0f * log10f(fmaxf(worst_sidelobe, 1.0e-12f)));
+}
+
+/*******************************************************************************
+ * Function Name: test_golden
+ *******************************************************************************
+ * Summary:
+ *   Compares the profile of two targets, one between two bins, with the
+ *   golden profile.
+ ******************************************************************************/
+static void test_golden(void)
+{
+    const range_profile_t* profile;
+    float32_t worst = 0.0f;
+
+    (void)range_fft_init(&rf, GOLDEN_SIZE, 0.05f);
+    for (uint32_t n = 0; n < GOLDEN_SIZE; ++n)
+    {
+        chirp[n] = (float32_t)(0.5 + (0.2 * cos(((2.0 * M_PI * 5.0 * n) / GOLDEN_SIZE) + 0.3)) +
+                               (0.05 * cos(((2.0 * M_PI * 12.5 * n) / GOLDEN_SIZE) + 1.1)));
+    }
+    (void)range_fft_set_clutter(&rf, zero_clutter, GOLDEN_SIZE / 2u);
+    profile = range_fft_process(&rf, chirp);
+
+    for (uint32_t j = 0; j < (GOLDEN_SIZE / 2u); ++j)
+    {
+        float32_t error = fabsf(profile->magnitude[j] - golden_two_targets[j]);
+
+        check(error <= ((RELATIVE_TOLERANCE * golden_two_targets[j]) + (FLOOR_TOLERANCE * golden_two_targets[5])),
+              "golden bin", GOLDEN_SIZE, profile->magnitude[j], golden_two_targets[j]);
+        worst = fmaxf(worst, error / golden_two_targets[5]);
+    }
+    printf(" 64 points: two targets, largest error %.1e of the peak\n", worst);
+}
+
+/*******************************************************************************
+ * Function Name: test_clutter
+ *******************************************************************************
+ * Summary:
+ *   The first frame becomes the clutter estimate and its profile is zero. A
+ *   static scene learned from zero then leaves (1 - alpha)^m of the spectrum
+ *   after m frames. The estimate survives a get/set round trip.
+ ******************************************************************************/
+static void test_clutter(uint32_t size)
+{
+    const range_profile_t* profile;
+    float32_t peak = 0.25f * (float32_t)size / 2.0f;
+    float32_t expected = peak;
+
+    (void)range_fft_init(&rf, size, 0.05f);
+    make_tone(size, 7.0f, 0.25f, 0.0f);
+    profile = range_fft_process(&rf, chirp);
+    for (uint32_t j = 0; j < profile->num_bins; ++j)
+    {
+        check(profile->magnitude[j] == 0.0f, "first frame", size, profile->magnitude[j], 0.0f);
+    }
+
+    (void)range_fft_set_clutter(&rf, zero_clutter, size / 2u);
+    for (uint32_t m = 1; m <= CLUTTER_FRAMES; ++m)
+    {
+        profile = range_fft_process(&rf, chirp);
+        expected *= 1.0f - RANGE_FFT_CLUTTER_ALPHA;
+        check(fabsf(profile->magnitude[7] - expected) <= ((RELATIVE_TOLERANCE * expected) + (FLOOR_TOLERANCE * peak)),
+              "clutter decay", size, profile->magnitude[7], expected);
+    }
+
+    check(range_fft_get_clutter(&rf, clutter) == (size / 2u), "clutter bins", size,
+          (float32_t)range_fft_get_clutter(&rf, clutter), (float32_t)(size / 2u));
+    (void)range_fft_init(&rf, size, 0.05f);
+    check(range_fft_set_clutter(&rf, clutter, size / 2u), "clutter restore", size, 0.0f, 1.0f);
+    profile = range_fft_process(&rf, chirp);
+    expected *= 1.0f - RANGE_FFT_CLUTTER_ALPHA;
+    check(fabsf(profile->magnitude[7] - expected) <= ((RELATIVE_TOLERANCE * expected) + (FLOOR_TOLERANCE * peak)),
+          "restored clutter", size, profile->magnitude[7], expected);
+    check(!range_fft_set_clutter(&rf, clutter, size / 4u), "clutter size check", size, 1.0f, 0.0f);
+
+    printf("%3" PRIu32 " points: clutter after %" PRIu32 " frames %.4f of the peak, expected %.4f\n", size,
+           CLUTTER_FRAMES + 1u, profile->magnitude[7] / peak, expected / peak);
+}
+
+int main(void)
+{
+    static const uint32_t sizes[] = { 32, 64, 128 };
+
+    for (uint32_t i = 0; i < (sizeof(sizes) / sizeof(sizes[0])); ++i)
+    {
+        if (range_fft_init(&rf, sizes[i], 0.05f) != 0)
+        {
+            printf("[FAIL] %" PRIu32 " points: init\n", sizes[i]);
+            ++failures;
+            continue;
+        }
+        test_tones(sizes[i]);
+        test_clutter(sizes[i]);
+    }
+    test_golden();
+
+    if (range_fft_init(&rf, 2u * RANGE_FFT_MAX_SIZE, 0.05f) == 0)
+    {
+        printf("[FAIL] init accepted %" PRIu32 " points\n", 2u * RANGE_FFT_MAX_SIZE);
+        ++failures;
+    }
+
+    printf("%s\n", (failures == 0u) ? "[PASS] test_range_fft" : "[FAIL] test_range_fft");
+    return (failures == 0u) ? 0 : 1;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,341 @@
+/*****************************************************************************
+ * File name: test_range_fft_fixed_point.c
+ *
+ * Description: Equivalence test of the Q15 and Q31 range processing with the
+ * float32 processing. Noisy chirps of a static reflector and of a moving
+ * target go through range_fft_process built with RANGE_FFT_FIXED_POINT, and
+ * the clutter free magnitude, the peak bin of the target and the clutter
+ * estimate are compared with the float32 processing computed in double
+ * precision. The fixed point kernels are the models of host/, so the bounds
+ * hold for the rounding of the model, see arm_math_host.c.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Header file for local task */
+#include "range_fft.h"
+
+#if (RANGE_FFT_FIXED_POINT == 0)
+#error "Build with RANGE_FFT_FIXED_POINT=15 or 31"
+#endif
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define FRAMES                              (3000u)
+
+/* The target moves through the scene in these frames */
+#define TARGET_FIRST_FRAME                  (500u)
+#define TARGET_LAST_FRAME                   (2500u)
+
+/* The peak of the target is compared once the residual of the first frame
+ * has decayed below the target
+ */
+#define PEAK_FIRST_FRAME                    (TARGET_FIRST_FRAME + 100u)
+
+/* Error bounds in LSB of the spectrum samples, profile.sample_scale on the
+ * float32 scale. Q15 is limited by the rounding of the spectrum. The Q31
+ * clutter estimate truncates alpha times the change every frame, a bias of
+ * up to 1 / alpha LSB.
+ */
+#if (RANGE_FFT_FIXED_POINT == 15)
+#define MAGNITUDE_TOLERANCE_LSB             (6.0)
+#define RMS_TOLERANCE_LSB                   (1.5)
+#define CLUTTER_TOLERANCE_LSB               (6.0)
+#define PEAK_BIN_TOLERANCE                  (1u)
+#else
+#define MAGNITUDE_TOLERANCE_LSB             (2.0 / RANGE_FFT_CLUTTER_ALPHA)
+#define RMS_TOLERANCE_LSB                   (1.0 / RANGE_FFT_CLUTTER_ALPHA)
+#define CLUTTER_TOLERANCE_LSB               (2.0 / RANGE_FFT_CLUTTER_ALPHA)
+#define PEAK_BIN_TOLERANCE                  (0u)
+#endif
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+/* float32 processing in double precision */
+typedef struct
+{
+    uint32_t size;
+    float64_t window[RANGE_FFT_MAX_SIZE];
+    float64_t clutter[RANGE_FFT_MAX_SIZE];
+    float64_t magnitude[RANGE_FFT_MAX_SIZE / 2u];
+    bool clutter_valid;
+} reference_t;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static range_fft_t rf;
+static reference_t reference;
+static range_sample_t chirp[RANGE_FFT_MAX_SIZE];
+static float32_t clutter[RANGE_FFT_MAX_SIZE];
+static uint32_t random_state = 1u;
+static uint32_t failures;
+
+/*******************************************************************************
+ * Function Name: gauss
+ *******************************************************************************
+ * Summary:
+ *   Normal distributed noise of a fixed sequence, independent of the C
+ *   library.
+ ******************************************************************************/
+static float64_t gauss(void)
+{
+    float64_t u;
+    float64_t v;
+
+    random_state = (random_state * 1664525u) + 1013904223u;
+    u = ((float64_t)(random_state >> 8) + 1.0) / 16777217.0;
+    random_state = (random_state * 1664525u) + 1013904223u;
+    v = ((float64_t)(random_state >> 8) + 1.0) / 16777217.0;
+
+    return sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * v);
+}
+
+/*******************************************************************************
+ * Function Name: reference_init
+ *******************************************************************************
+ * Summary:
+ *   Blackman-Harris window of unity coherent gain, as range_fft_init.
+ ******************************************************************************/
+static void reference_init(reference_t* ref, uint32_t size)
+{
+    float64_t sum = 0.0;
+
+    memset(ref, 0, sizeof(*ref));
+    ref->size = size;
+    for (uint32_t n = 0; n < size; ++n)
+    {
+        float64_t phase = (2.0 * M_PI * (float64_t)n) / (float64_t)(size - 1u);
+
+        ref->window[n] = 0.35875 - (0.48829 * cos(phase)) + (0.14128 * cos(2.0 * phase)) -
+                         (0.01168 * cos(3.0 * phase));
+        sum += ref->window[n];
+    }
+    for (uint32_t n = 0; n < size; ++n)
+    {
+        ref->window[n] *= (float64_t)size / sum;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: reference_process
+ *******************************************************************************
+ * Summary:
+ *   Mean removal, window, DFT, clutter removal and magnitude of the float32
+ *   variant of range_fft_process, on samples scaled to 1.
+ ******************************************************************************/
+static void reference_process(reference_t* ref, const float64_t* samples)
+{
+    float64_t input[RANGE_FFT_MAX_SIZE];
+    float64_t spectrum[RANGE_FFT_MAX_SIZE] = {0};
+    float64_t mean = 0.0;
+    uint32_t size = ref->size;
+
+    for (uint32_t n = 0; n < size; ++n)
+    {
+        mean += samples[n];
+    }
+    mean /= (float64_t)size;
+    for (uint32_t n = 0; n < size; ++n)
+    {
+        input[n] = (samples[n] - mean) * ref->window[n];
+    }
+
+    for (uint32_t k = 0; k < (size / 2u); ++k)
+    {
+        spectrum[2u * k] = 0.0;
+        spectrum[(2u * k) + 1u] = 0.0;
+        for (uint32_t n = 0; n < size; ++n)
+        {
+            float64_t phase = (2.0 * M_PI * (float64_t)((k * n) % size)) / (float64_t)size;
+
+            spectrum[2u * k] += input[n] * cos(phase);
+            spectrum[(2u * k) + 1u] -= input[n] * sin(phase);
+        }
+    }
+    spectrum[1] = 0.0;
+
+    if (!ref->clutter_valid)
+    {
+        memcpy(ref->clutter, spectrum, size * sizeof(float64_t));
+        ref->clutter_valid = true;
+    }
+    for (uint32_t i = 0; i < size; ++i)
+    {
+        ref->clutter[i] += (float64_t)RANGE_FFT_CLUTTER_ALPHA * (spectrum[i] - ref->clutter[i]);
+    }
+    for (uint32_t k = 0; k < (size / 2u); ++k)
+    {
+        ref->magnitude[k] = hypot(spectrum[2u * k] - ref->clutter[2u * k],
+                                  spectrum[(2u * k) + 1u] - ref->clutter[(2u * k) + 1u]);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: peak_bin
+ *******************************************************************************
+ * Summary:
+ *   Bin of the largest magnitude above the DC bin.
+ ******************************************************************************/
+static uint32_t peak_bin(const float32_t* magnitude, const float64_t* reference_magnitude, uint32_t num_bins)
+{
+    uint32_t peak = 1u;
+
+    for (uint32_t k = 2; k < num_bins; ++k)
+    {
+        if (((magnitude != NULL) && (magnitude[k] > magnitude[peak])) ||
+            ((magnitude == NULL) && (reference_magnitude[k] > reference_magnitude[peak])))
+        {
+            peak = k;
+        }
+    }
+    return peak;
+}
+
+/*******************************************************************************
+ * Function Name: test_scene
+ *******************************************************************************
+ * Summary:
+ *   A static reflector of 300 LSB on bin 10.3, a target of 40 LSB moving
+ *   around bin size / 5 and 3 LSB of noise on the 12 bit samples, one chirp
+ *   per frame as the average chirp of frame_preprocess.
+ ******************************************************************************/
+static void test_scene(uint32_t size)
+{
+    float64_t samples[RANGE_FFT_MAX_SIZE];
+    const range_profile_t* profile = NULL;
+    float64_t worst = 0.0;
+    float64_t square_sum = 0.0;
+    float64_t clutter_error = 0.0;
+    float64_t clutter_peak = 0.0;
+    float64_t lsb;
+    float64_t rms;
+    uint32_t worst_bin_offset = 0;
+    uint32_t num_bins = size / 2u;
+
+    if (range_fft_init(&rf, size, 0.05f) != 0)
+    {
+        printf("[FAIL] %" PRIu32 " points: init\n", size);
+        ++failures;
+        return;
+    }
+    reference_init(&reference, size);
+
+    for (uint32_t frame = 0; frame < FRAMES; ++frame)
+    {
+        for (uint32_t n = 0; n < size; ++n)
+        {
+            float64_t value = 2048.0 + (300.0 * cos(((2.0 * M_PI * 10.3 * n) / size) + 0.4)) + (3.0 * gauss());
+            int64_t raw;
+
+            if ((frame >= TARGET_FIRST_FRAME) && (frame <= TARGET_LAST_FRAME))
+            {
+                float64_t bin = ((float64_t)size / 5.0) + (0.3 * sin((float64_t)frame * 0.05));
+
+                value += 40.0 * cos(((2.0 * M_PI * bin * n) / size) + ((float64_t)frame * 0.7));
+            }
+            raw = llround(fmin(4095.0, fmax(0.0, value)));
+
+            /* frame_preprocess shifts the 12 bit samples to the sample format */
+            chirp[n] = (range_sample_t)(raw << ((uint32_t)RANGE_FFT_FIXED_POINT - 12u));
+            samples[n] = (float64_t)raw / 4096.0;
+        }
+
+        profile = range_fft_process(&rf, chirp);
+        reference_process(&reference, samples);
+
+        for (uint32_t k = 0; k < num_bins; ++k)
+        {
+            float64_t error = fabs((float64_t)profile->magnitude[k] - reference.magnitude[k]);
+
+            worst = fmax(worst, error);
+            square_sum += error * error;
+        }
+
+        if ((frame >= PEAK_FIRST_FRAME) && (frame <= TARGET_LAST_FRAME))
+        {
+            uint32_t peak = peak_bin(profile->magnitude, NULL, num_bins);
+            uint32_t expected = peak_bin(NULL, reference.magnitude, num_bins);
+            uint32_t offset = (peak > expected) ? (peak - expected) : (expected - peak);
+
+            worst_bin_offset = (offset > worst_bin_offset) ? offset : worst_bin_offset;
+        }
+    }
+
+    /* The clutter estimate on the float32 scale, e.g. for a warm start */
+    if (range_fft_get_clutter(&rf, clutter) != num_bins)
+    {
+        printf("[FAIL] %" PRIu32 " points: no clutter estimate\n", size);
+        ++failures;
+    }
+    for (uint32_t i = 0; i < size; ++i)
+    {
+        clutter_error = fmax(clutter_error, fabs((float64_t)clutter[i] - reference.clutter[i]));
+        clutter_peak = fmax(clutter_peak, fabs(reference.clutter[i]));
+    }
+
+    lsb = (float64_t)profile->sample_scale;
+    rms = sqrt(square_sum / (float64_t)(FRAMES * num_bins));
+    printf("%3" PRIu32 " points: magnitude error max %.1f rms %.1f LSB, target peak within %" PRIu32
+           " bins, clutter error %.1f LSB, 1 LSB = %.1e of a clutter peak of %.2f\n", size, worst / lsb, rms / lsb,
+           worst_bin_offset, clutter_error / lsb, lsb / clutter_peak, clutter_peak);
+
+    if ((worst > (MAGNITUDE_TOLERANCE_LSB * lsb)) || (rms > (RMS_TOLERANCE_LSB * lsb)))
+    {
+        printf("[FAIL] %" PRIu32 " points: magnitude error above %.1f LSB max, %.1f LSB rms\n", size,
+               MAGNITUDE_TOLERANCE_LSB, RMS_TOLERANCE_LSB);
+        ++failures;
+    }
+    if (worst_bin_offset > PEAK_BIN_TOLERANCE)
+    {
+        printf("[FAIL] %" PRIu32 " points: target peak off by %" PRIu32 " bins\n", size, worst_bin_offset);
+        ++failures;
+    }
+    if (clutter_error > (CLUTTER_TOLERANCE_LSB * lsb))
+    {
+        printf("[FAIL] %" PRIu32 " points: clutter error above %.1f LSB\n", size, CLUTTER_TOLERANCE_LSB);
+        ++failures;
+    }
+}
+
+int main(void)
+{
+    static const uint32_t sizes[] = { 32, 64, 128 };
+
+    for (uint32_t i = 0; i < (sizeof(sizes) / sizeof(sizes[0])); ++i)
+    {
+        test_scene(sizes[i]);
+    }
+
+    printf("%s (%s)\n", (failures == 0u) ? "[PASS] test_range_fft_fixed_point" : "[FAIL] test_range_fft_fixed_point",
+           (RANGE_FFT_FIXED_POINT == 15) ? "Q15" : "Q31");
+    return (failures == 0u) ? 0 : 1;
+}
+
+/* [] END OF FILE */
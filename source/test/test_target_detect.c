@@ -0,0 +1,253 @@
+/*****************************************************************************
+ * File name: test_target_detect.c
+ *
+ * Description: Golden vector tests of the CA-CFAR and OS-CFAR detection of
+ * target_detect.c. Synthetic range profiles with single, close, extended and
+ * too many targets are compared with their expected target lists, and two
+ * targets synthesized in the chirp go through range_fft before detection.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Header file for local task */
+#include "range_fft.h"
+#include "target_detect.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define NUM_BINS                            (64u)
+#define BIN_LENGTH                          (0.05f)
+#define NOISE_FLOOR                         (0.02f)
+#define MAX_PEAKS                           (8u)
+#define NUM_CASES                           (sizeof(cases) / sizeof(cases[0]))
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef struct
+{
+    uint32_t bin;
+    float32_t magnitude;
+} peak_t;
+
+/* Expected target: peak, first and last bin of the cluster */
+typedef struct
+{
+    uint32_t range_bin;
+    uint32_t first_bin;
+    uint32_t last_bin;
+} golden_target_t;
+
+typedef struct
+{
+    const char* name;
+    peak_t peaks[MAX_PEAKS];
+    uint32_t num_peaks;
+    golden_target_t golden[2][TARGET_DETECT_MAX_TARGETS];   /* CA-CFAR, OS-CFAR */
+    uint32_t num_golden[2];
+    uint32_t dropped;
+} test_case_t;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+/* Profiles on a noise floor with a ripple of +-25 %, searched from bin 1 to 40 */
+static const test_case_t cases[] =
+{
+    {
+        "single target", { { 12, 0.5f } }, 1,
+        { { { 12, 12, 12 } }, { { 12, 12, 12 } } }, { 1, 1 }, 0
+    },
+    {
+        /* The strong target is in the training cells of the weak one, CA-CFAR
+         * raises the threshold over it, OS-CFAR ranks it out
+         */
+        "close targets", { { 10, 1.0f }, { 14, 0.12f } }, 2,
+        { { { 10, 10, 10 } }, { { 10, 10, 10 }, { 14, 14, 14 } } }, { 1, 2 }, 0
+    },
+    {
+        "extended target", { { 20, 0.3f }, { 21, 0.6f }, { 22, 0.35f } }, 3,
+        { { { 21, 20, 22 } }, { { 21, 20, 22 } } }, { 1, 1 }, 0
+    },
+    {
+        /* Five targets out of each other's training cells, the weakest is
+         * dropped and the list stays in range order
+         */
+        "too many targets",
+        { { 1, 0.4f }, { 9, 0.15f }, { 17, 0.5f }, { 25, 0.6f }, { 33, 0.7f } }, 5,
+        { { { 1, 1, 1 }, { 17, 17, 17 }, { 25, 25, 25 }, { 33, 33, 33 } },
+          { { 1, 1, 1 }, { 17, 17, 17 }, { 25, 25, 25 }, { 33, 33, 33 } } }, { 4, 4 }, 1
+    },
+    {
+        /* The target beyond the searched range is in the training cells of
+         * bin 40 and masks it for CA-CFAR
+         */
+        "edges of the range", { { 1, 0.3f }, { 40, 0.3f }, { 45, 0.9f } }, 3,
+        { { { 1, 1, 1 } }, { { 1, 1, 1 }, { 40, 40, 40 } } }, { 1, 2 }, 0
+    },
+    {
+        /* Four times the floor but below TARGET_DETECT_MIN_MAGNITUDE */
+        "below minimum magnitude", { { 25, 0.045f } }, 1,
+        { { { 0 } }, { { 0 } } }, { 0, 0 }, 0
+    },
+};
+
+static float32_t magnitude[NUM_BINS];
+static uint32_t failures;
+
+/*******************************************************************************
+ * Function Name: check_list
+ *******************************************************************************
+ * Summary:
+ *   Compares a target list with the golden targets.
+ ******************************************************************************/
+static void check_list(const char* name, target_detect_method_t method, const target_list_t* list,
+                       const golden_target_t* golden, uint32_t num_golden)
+{
+    const char* method_name = (method == TARGET_DETECT_OS_CFAR) ? "OS-CFAR" : "CA-CFAR";
+    bool match = (list->count == num_golden);
+
+    for (uint32_t i = 0; match && (i < num_golden); ++i)
+    {
+        const target_t* target = &list->targets[i];
+
+        match = (target->range_bin == golden[i].range_bin) && (target->first_bin == golden[i].first_bin) &&
+                (target->last_bin == golden[i].last_bin) &&
+                (fabsf(target->distance - ((float32_t)target->range_bin * BIN_LENGTH)) < 1.0e-6f) &&
+                (target->snr > TARGET_DETECT_SCALE);
+    }
+
+    printf("%-24s %s:", name, method_name);
+    for (uint32_t i = 0; i < list->count; ++i)
+    {
+        printf(" [bin %" PRIu32 " %" PRIu32 "-%" PRIu32 " snr %.1f]", list->targets[i].range_bin,
+               list->targets[i].first_bin, list->targets[i].last_bin, list->targets[i].snr);
+    }
+    printf("%s\n", match ? "" : "  <- [FAIL]");
+    if (!match)
+    {
+        ++failures;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: test_profiles
+ *******************************************************************************
+ * Summary:
+ *   Runs both methods on every synthetic profile.
+ ******************************************************************************/
+static void test_profiles(void)
+{
+    static target_detect_t td;
+    range_profile_t profile;
+
+    memset(&profile, 0, sizeof(profile));
+    profile.magnitude = magnitude;
+    profile.num_bins = NUM_BINS;
+    profile.bin_length = BIN_LENGTH;
+
+    for (uint32_t i = 0; i < NUM_CASES; ++i)
+    {
+        const test_case_t* test_case = &cases[i];
+
+        for (uint32_t bin = 0; bin < NUM_BINS; ++bin)
+        {
+            magnitude[bin] = NOISE_FLOOR * (1.0f + (0.25f * sinf(1.7f * (float32_t)bin)));
+        }
+        for (uint32_t peak = 0; peak < test_case->num_peaks; ++peak)
+        {
+            magnitude[test_case->peaks[peak].bin] = test_case->peaks[peak].magnitude;
+        }
+
+        for (uint32_t method = 0; method < 2u; ++method)
+        {
+            const target_list_t* list;
+
+            target_detect_init(&td, (target_detect_method_t)method);
+            target_detect_set_range(&td, 0, 40);
+            list = target_detect_process(&td, &profile);
+            check_list(test_case->name, (target_detect_method_t)method, list, test_case->golden[method],
+                       test_case->num_golden[method]);
+
+            if (td.stats.dropped_targets != test_case->dropped)
+            {
+                printf("[FAIL] %s: %" PRIu32 " targets dropped, expected %" PRIu32 "\n", test_case->name,
+                       td.stats.dropped_targets, test_case->dropped);
+                ++failures;
+            }
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: test_chirp
+ *******************************************************************************
+ * Summary:
+ *   Two targets as beat tones of a 128 sample chirp on range bins 8 and 20,
+ *   through the range FFT with a zero clutter estimate. Both methods must
+ *   report one cluster per target with its peak on the target bin; the
+ *   clusters span the three bins of the main lobe over the threshold.
+ ******************************************************************************/
+static void test_chirp(void)
+{
+    static range_fft_t rf;
+    static target_detect_t td;
+    static float32_t chirp[RANGE_FFT_MAX_SIZE];
+    static const float32_t zero_clutter[RANGE_FFT_MAX_SIZE];
+    static const golden_target_t golden[] = { { 8, 7, 9 }, { 20, 19, 21 } };
+
+    (void)range_fft_init(&rf, 128u, BIN_LENGTH);
+    for (uint32_t n = 0; n < 128u; ++n)
+    {
+        chirp[n] = (float32_t)(0.5 + (0.02 * cos((2.0 * M_PI * 8.0 * n) / 128.0)) +
+                               (0.008 * cos(((2.0 * M_PI * 20.0 * n) / 128.0) + 1.0)));
+    }
+
+    for (uint32_t method = 0; method < 2u; ++method)
+    {
+        const range_profile_t* profile;
+
+        (void)range_fft_set_clutter(&rf, zero_clutter, 64u);
+        profile = range_fft_process(&rf, chirp);
+        target_detect_init(&td, (target_detect_method_t)method);
+        target_detect_set_range(&td, 1, 40);
+        check_list("chirp with two targets", (target_detect_method_t)method, target_detect_process(&td, profile),
+                   golden, 2u);
+    }
+}
+
+int main(void)
+{
+    test_profiles();
+    test_chirp();
+
+    printf("%s\n", (failures == 0u) ? "[PASS] test_target_detect" : "[FAIL] test_target_detect");
+    return (failures == 0u) ? 0 : 1;
+}
+
+/* [] END OF FILE */
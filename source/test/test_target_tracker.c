@@ -0,0 +1,347 @@
+/*****************************************************************************
+ * File name: test_target_tracker.c
+ *
+ * Description: Feeds target_tracker.c with synthetic range profiles of
+ * targets moving at constant speed, their peaks shaped like the main lobe of
+ * a windowed FFT, and with the detections of target_detect.c for their peak
+ * bins. The test checks the sub-bin interpolation of a peak, the convergence
+ * of the distance and the velocity of a track, that the id of a track stays
+ * the same while its target is missed for a few frames, that a track dies
+ * after TARGET_TRACKER_CONFIRMED_TIMEOUT_MS without detection, and that
+ * further targets get no track while TARGET_TRACKER_MAX_TRACKS live.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Header file for local task */
+#include "target_tracker.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define NUM_BINS                            (64u)
+#define BIN_LENGTH_M                        (0.1f)
+#define FRAME_PERIOD_MS                     (50u)
+
+/* Width of the main lobe of a peak, in bins */
+#define LOBE_SIGMA_BINS                     (0.8f)
+
+/* Target of the moving scenario */
+#define START_M                             (1.0f)
+#define SPEED_M_S                           (0.5f)
+#define MOVING_FRAMES                       (80u)
+
+/* Frames of the moving scenario after which the track must have converged */
+#define SETTLE_FRAMES                       (40u)
+#define MAX_DISTANCE_ERROR_M                (0.02f)
+#define MAX_VELOCITY_ERROR_M_S              (0.05f)
+
+/* Frames the target is missed, shorter than TARGET_TRACKER_CONFIRMED_TIMEOUT_MS */
+#define MISSED_FRAMES                       (10u)
+
+#define CHECK(condition, ...)               do { if (!(condition)) { printf("[FAIL] " __VA_ARGS__); \
+                                                 printf("\n"); ++failures; } } while (0)
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static float32_t magnitude[NUM_BINS];
+static range_profile_t profile = { .magnitude = magnitude, .num_bins = NUM_BINS, .bin_length = BIN_LENGTH_M };
+static target_list_t list;
+
+static uint32_t failures;
+
+/*******************************************************************************
+ * Function Name: make_frame
+ *******************************************************************************
+ * Summary:
+ *   Builds the range profile of targets at the given distances, a Gaussian
+ *   main lobe per target, and the detection list of their peak bins.
+ *
+ * Parameters:
+ *   distances: meters, sorted
+ *   count: number of targets, at most TARGET_DETECT_MAX_TARGETS
+ ******************************************************************************/
+static void make_frame(const float32_t* distances, uint32_t count)
+{
+    memset(magnitude, 0, sizeof(magnitude));
+    memset(&list, 0, sizeof(list));
+
+    for (uint32_t m = 0; m < count; ++m)
+    {
+        float32_t position = distances[m] / BIN_LENGTH_M;
+
+        for (uint32_t k = 0; k < NUM_BINS; ++k)
+        {
+            float32_t x = ((float32_t)k - position) / LOBE_SIGMA_BINS;
+
+            magnitude[k] += 100.0f * expf(-0.5f * x * x);
+        }
+
+        list.targets[m].range_bin = (uint32_t)lroundf(position);
+        list.targets[m].distance = (float32_t)list.targets[m].range_bin * BIN_LENGTH_M;
+    }
+    list.count = count;
+}
+
+/*******************************************************************************
+ * Function Name: find_track
+ *******************************************************************************
+ * Summary:
+ *   Returns the track with an id, NULL if there is none.
+ ******************************************************************************/
+static const target_track_t* find_track(const target_tracker_t* tracker, uint16_t id)
+{
+    for (uint32_t t = 0; t < tracker->count; ++t)
+    {
+        if (tracker->tracks[t].id == id)
+        {
+            return &tracker->tracks[t];
+        }
+    }
+
+    return NULL;
+}
+
+/*******************************************************************************
+ * Function Name: test_interpolation
+ *******************************************************************************
+ * Summary:
+ *   The parabola through the peak bin and its neighbours recovers the
+ *   position of a peak between two bins.
+ ******************************************************************************/
+static void test_interpolation(void)
+{
+    const float32_t positions[] = { 12.0f, 12.2f, 12.45f, 12.7f, 30.9f };
+    float32_t max_error = 0.0f;
+
+    for (uint32_t i = 0; i < (sizeof(positions) / sizeof(positions[0])); ++i)
+    {
+        float32_t distance = positions[i] * BIN_LENGTH_M;
+        float32_t error;
+
+        make_frame(&distance, 1);
+        error = fabsf(target_tracker_interpolate(&profile, list.targets[0].range_bin) - distance);
+        max_error = (error > max_error) ? error : max_error;
+    }
+    /* The parabola is biased on a Gaussian lobe, the peak bin alone is off by up to 0.5 bin */
+    CHECK(max_error < (0.1f * BIN_LENGTH_M), "sub-bin interpolation error %.4f m, more than 0.1 bin",
+          (double)max_error);
+
+    /* Without both neighbours the bin itself */
+    make_frame((const float32_t[]){ 0.02f }, 1);
+    CHECK(target_tracker_interpolate(&profile, 0) == 0.0f, "a peak in bin 0 was interpolated");
+
+    printf("sub-bin interpolation of a main lobe of %.1f bins: max error %.2f mm\n", (double)LOBE_SIGMA_BINS,
+           (double)(max_error * 1000.0f));
+}
+
+/*******************************************************************************
+ * Function Name: test_moving_target
+ *******************************************************************************
+ * Summary:
+ *   A target moving away at constant speed gets one confirmed track, whose
+ *   distance and velocity converge, whose id survives missed frames and
+ *   which dies after the confirmed timeout.
+ ******************************************************************************/
+static void test_moving_target(void)
+{
+    target_tracker_t tracker;
+    target_track_report_t reports[TARGET_TRACKER_MAX_TRACKS];
+    float32_t max_distance_error = 0.0f;
+    float32_t max_velocity_error = 0.0f;
+    uint32_t confirmed_frame = 0;
+    uint32_t time_ms = 0;
+    uint32_t last_seen_ms;
+    uint32_t frame;
+    uint16_t id = 0;
+    bool same_id = true;
+
+    target_tracker_init(&tracker);
+    for (frame = 0; frame < MOVING_FRAMES; ++frame)
+    {
+        float32_t truth = START_M + ((SPEED_M_S * (float32_t)time_ms) / 1000.0f);
+        const target_track_t* track;
+
+        make_frame(&truth, 1);
+        target_tracker_update(&tracker, &list, &profile, time_ms);
+
+        if (frame == 0u)
+        {
+            id = tracker.tracks[0].id;
+        }
+        track = find_track(&tracker, id);
+        if ((track == NULL) || (tracker.count != 1u))
+        {
+            same_id = false;
+        }
+        else
+        {
+            if (track->confirmed && (confirmed_frame == 0u))
+            {
+                confirmed_frame = frame + 1u;
+            }
+            if (frame >= SETTLE_FRAMES)
+            {
+                float32_t distance_error = fabsf(track->distance - truth);
+                float32_t velocity_error = fabsf(track->velocity - SPEED_M_S);
+
+                max_distance_error = (distance_error > max_distance_error) ? distance_error : max_distance_error;
+                max_velocity_error = (velocity_error > max_velocity_error) ? velocity_error : max_velocity_error;
+            }
+        }
+        time_ms += FRAME_PERIOD_MS;
+    }
+
+    CHECK(same_id, "the target did not keep one track");
+    CHECK(confirmed_frame == TARGET_TRACKER_CONFIRM_HITS, "confirmed at frame %" PRIu32 ", expected %u",
+          confirmed_frame, TARGET_TRACKER_CONFIRM_HITS);
+    CHECK(max_distance_error < MAX_DISTANCE_ERROR_M, "distance error %.3f m after convergence",
+          (double)max_distance_error);
+    CHECK(max_velocity_error < MAX_VELOCITY_ERROR_M_S, "velocity error %.3f m/s after convergence",
+          (double)max_velocity_error);
+    printf("target at %.1f m/s, frames every %u ms: confirmed after %" PRIu32 " frames, after %u frames "
+           "distance error %.1f mm, velocity error %.1f mm/s\n", (double)SPEED_M_S, FRAME_PERIOD_MS, confirmed_frame,
+           SETTLE_FRAMES, (double)(max_distance_error * 1000.0f), (double)(max_velocity_error * 1000.0f));
+
+    /* Missed for a few frames, the track coasts and keeps its id */
+    make_frame(NULL, 0);
+    for (uint32_t i = 0; i < MISSED_FRAMES; ++i)
+    {
+        target_tracker_update(&tracker, &list, &profile, time_ms);
+        time_ms += FRAME_PERIOD_MS;
+    }
+    for (uint32_t i = 0; i < 5u; ++i)
+    {
+        float32_t truth = START_M + ((SPEED_M_S * (float32_t)time_ms) / 1000.0f);
+
+        make_frame(&truth, 1);
+        target_tracker_update(&tracker, &list, &profile, time_ms);
+        time_ms += FRAME_PERIOD_MS;
+    }
+    CHECK((tracker.count == 1u) && (target_tracker_get_confirmed(&tracker, reports, TARGET_TRACKER_MAX_TRACKS) == 1u) &&
+          (reports[0].id == id), "after %u missed frames the target did not keep track %u", MISSED_FRAMES, id);
+
+    /* Gone: the track lives for the confirmed timeout, then dies */
+    last_seen_ms = time_ms - FRAME_PERIOD_MS;
+    make_frame(NULL, 0);
+    while ((time_ms - last_seen_ms) <= TARGET_TRACKER_CONFIRMED_TIMEOUT_MS)
+    {
+        target_tracker_update(&tracker, &list, &profile, time_ms);
+        if (tracker.count != 1u)
+        {
+            break;
+        }
+        time_ms += FRAME_PERIOD_MS;
+    }
+    CHECK((time_ms - last_seen_ms) > TARGET_TRACKER_CONFIRMED_TIMEOUT_MS,
+          "the track died %" PRIu32 " ms after its last detection", time_ms - last_seen_ms);
+    target_tracker_update(&tracker, &list, &profile, time_ms);
+    CHECK(tracker.count == 0u, "the track lives %" PRIu32 " ms after its last detection", time_ms - last_seen_ms);
+}
+
+/*******************************************************************************
+ * Function Name: test_capacity
+ *******************************************************************************
+ * Summary:
+ *   While TARGET_TRACKER_MAX_TRACKS tracks live a new target gets no track
+ *   and the tracks keep their ids; it gets one once a track died.
+ ******************************************************************************/
+static void test_capacity(void)
+{
+    const float32_t first[TARGET_DETECT_MAX_TARGETS] = { 0.8f, 1.8f, 2.8f, 3.8f };
+    const float32_t second[TARGET_DETECT_MAX_TARGETS] = { 0.8f, 1.8f, 2.8f, 5.0f };
+    target_tracker_t tracker;
+    uint16_t ids[TARGET_TRACKER_MAX_TRACKS];
+    uint32_t time_ms = 0;
+    bool kept = true;
+    bool refused = true;
+
+    target_tracker_init(&tracker);
+    for (uint32_t frame = 0; frame < TARGET_TRACKER_CONFIRM_HITS; ++frame)
+    {
+        make_frame(first, TARGET_DETECT_MAX_TARGETS);
+        target_tracker_update(&tracker, &list, &profile, time_ms);
+        time_ms += FRAME_PERIOD_MS;
+    }
+    for (uint32_t t = 0; t < TARGET_TRACKER_MAX_TRACKS; ++t)
+    {
+        ids[t] = tracker.tracks[t].id;
+    }
+
+    /* The target at 3.8 m leaves, one at 5 m comes while its track coasts */
+    while ((time_ms - (TARGET_TRACKER_CONFIRM_HITS - 1u) * FRAME_PERIOD_MS) <= TARGET_TRACKER_CONFIRMED_TIMEOUT_MS)
+    {
+        make_frame(second, TARGET_DETECT_MAX_TARGETS);
+        target_tracker_update(&tracker, &list, &profile, time_ms);
+        for (uint32_t t = 0; t < TARGET_TRACKER_MAX_TRACKS; ++t)
+        {
+            if ((tracker.count != TARGET_TRACKER_MAX_TRACKS) || (find_track(&tracker, ids[t]) == NULL))
+            {
+                kept = false;
+            }
+            if ((t < tracker.count) && (fabsf(tracker.tracks[t].distance - 5.0f) < TARGET_TRACKER_GATE_M))
+            {
+                refused = false;
+            }
+        }
+        time_ms += FRAME_PERIOD_MS;
+    }
+    CHECK(kept, "the %u tracks did not keep their ids while a further target came", TARGET_TRACKER_MAX_TRACKS);
+    CHECK(refused, "a further target got a track while %u tracks lived", TARGET_TRACKER_MAX_TRACKS);
+
+    /* In the next update the coasting track dies and the further target starts a track */
+    make_frame(second, TARGET_DETECT_MAX_TARGETS);
+    target_tracker_update(&tracker, &list, &profile, time_ms);
+    CHECK((tracker.count == TARGET_TRACKER_MAX_TRACKS) && (find_track(&tracker, ids[3]) == NULL) &&
+          (find_track(&tracker, TARGET_TRACKER_MAX_TRACKS + 1u) != NULL),
+          "after the coasting track died the further target got no track %u", TARGET_TRACKER_MAX_TRACKS + 1u);
+}
+
+/*******************************************************************************
+ * Function Name: main
+ *******************************************************************************
+ * Summary:
+ *   Runs the scenarios.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   0 if all checks pass
+ ******************************************************************************/
+int main(void)
+{
+    test_interpolation();
+    test_moving_target();
+    test_capacity();
+
+    printf("%s\n", (failures == 0u) ? "[PASS] test_target_tracker" : "[FAIL] test_target_tracker");
+    return (failures == 0u) ? 0 : 1;
+}
+
+/* [] END OF FILE */
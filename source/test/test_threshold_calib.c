@@ -0,0 +1,331 @@
+/*****************************************************************************
+ * File name: test_threshold_calib.c
+ *
+ * Description: Measures the P-square quantile estimate of threshold_calib.c
+ * against the exact quantile of the same samples, for noise shaped like the
+ * peak metrics of an empty room, at the quantiles the calibration uses, and
+ * runs the calibration state machine on synthetic metrics. The test checks
+ * the estimate at 1 - 0.001 and 1 - 0.01 over long and short windows, the
+ * transitions from idle to learning and to proposed, applied or failed, the
+ * settling time, the defaults of the window and of the false alarm rate,
+ * and the failure with fewer than THRESHOLD_CALIB_SAMPLES_PER_ALARM samples
+ * per expected false alarm.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Header file for local task */
+#include "threshold_calib.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Samples of a long window, 60 s at 1 kHz or 50 min at 20 Hz */
+#define LONG_SAMPLES                        (60000u)
+
+/* Runs per case, each with other samples */
+#define NUM_RUNS                            (5u)
+
+/* Largest error of the estimate against the exact quantile of the samples */
+#define MAX_LONG_ERROR_PERCENT              (2.0f)
+#define MAX_MEDIAN_ERROR_PERCENT            (1.0f)
+
+#define FRAME_PERIOD_MS                     (50u)
+
+#define CHECK(condition, ...)               do { if (!(condition)) { printf("[FAIL] " __VA_ARGS__); \
+                                                 printf("\n"); ++failures; } } while (0)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef enum
+{
+    NOISE_EXPONENTIAL = 0,              /* power of complex Gaussian noise */
+    NOISE_RAYLEIGH,                     /* magnitude of complex Gaussian noise */
+    NOISE_HALF_NORMAL                   /* magnitude of real Gaussian noise */
+} noise_t;
+
+typedef struct
+{
+    noise_t noise;
+    const char* name;
+    float32_t p;
+    uint32_t samples;
+    float32_t max_error_percent;        /* 0 to report only */
+} quantile_case_t;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static const quantile_case_t cases[] =
+{
+    { NOISE_EXPONENTIAL, "exponential", 0.999f, LONG_SAMPLES, MAX_LONG_ERROR_PERCENT },
+    { NOISE_RAYLEIGH, "Rayleigh", 0.999f, LONG_SAMPLES, MAX_LONG_ERROR_PERCENT },
+    { NOISE_HALF_NORMAL, "half normal", 0.999f, LONG_SAMPLES, MAX_LONG_ERROR_PERCENT },
+    { NOISE_EXPONENTIAL, "exponential", 0.99f, LONG_SAMPLES, MAX_LONG_ERROR_PERCENT },
+    { NOISE_EXPONENTIAL, "exponential", 0.5f, LONG_SAMPLES, MAX_MEDIAN_ERROR_PERCENT },
+    /* Five samples per expected false alarm, the least the calibration accepts */
+    { NOISE_EXPONENTIAL, "exponential", 0.999f, 5000u, 0.0f },
+    { NOISE_EXPONENTIAL, "exponential", 0.99f, 500u, 0.0f },
+};
+
+static float32_t samples[LONG_SAMPLES];
+static uint64_t random_state = 88172645463325252ull;
+
+static uint32_t failures;
+
+/*******************************************************************************
+ * Function Name: uniform
+ *******************************************************************************
+ * Summary:
+ *   Returns a uniform random number in (0, 1), xorshift64.
+ ******************************************************************************/
+static double uniform(void)
+{
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 7;
+    random_state ^= random_state << 17;
+
+    return ((double)(random_state >> 11) + 0.5) / 9007199254740992.0;
+}
+
+/*******************************************************************************
+ * Function Name: noise
+ *******************************************************************************
+ * Summary:
+ *   Returns a sample of the noise with unit scale.
+ ******************************************************************************/
+static float32_t noise(noise_t type)
+{
+    double u = uniform();
+
+    switch (type)
+    {
+        case NOISE_EXPONENTIAL:
+            return (float32_t)(-log(u));
+        case NOISE_RAYLEIGH:
+            return (float32_t)sqrt(-2.0 * log(u));
+        default:
+            return (float32_t)fabs(sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * uniform()));
+    }
+}
+
+/*******************************************************************************
+ * Function Name: compare
+ *******************************************************************************
+ * Summary:
+ *   qsort order of the samples.
+ ******************************************************************************/
+static int compare(const void* a, const void* b)
+{
+    float32_t x = *(const float32_t*)a;
+    float32_t y = *(const float32_t*)b;
+
+    return (x > y) - (x < y);
+}
+
+/*******************************************************************************
+ * Function Name: test_quantiles
+ *******************************************************************************
+ * Summary:
+ *   Compares the estimate with the exact quantile of the same samples and
+ *   prints the largest error of every case.
+ ******************************************************************************/
+static void test_quantiles(void)
+{
+    p2_quantile_t estimator;
+
+    /* Fewer than five samples: the nearest of the sorted samples */
+    p2_quantile_init(&estimator, 0.75f);
+    CHECK(p2_quantile_get(&estimator) == 0.0f, "estimate without samples");
+    p2_quantile_add(&estimator, 3.0f);
+    p2_quantile_add(&estimator, 1.0f);
+    p2_quantile_add(&estimator, 2.0f);
+    CHECK(p2_quantile_get(&estimator) == 3.0f, "estimate of 3 samples %.2f, expected 3", (double)p2_quantile_get(&estimator));
+
+    printf("P-square estimate against the exact quantile of the samples, %u runs:\n", NUM_RUNS);
+    for (uint32_t c = 0; c < (sizeof(cases) / sizeof(cases[0])); ++c)
+    {
+        const quantile_case_t* test = &cases[c];
+        float32_t max_error = 0.0f;
+        float32_t sum_error = 0.0f;
+
+        for (uint32_t run = 0; run < NUM_RUNS; ++run)
+        {
+            float32_t exact;
+            float32_t error;
+
+            p2_quantile_init(&estimator, test->p);
+            for (uint32_t i = 0; i < test->samples; ++i)
+            {
+                samples[i] = noise(test->noise);
+                p2_quantile_add(&estimator, samples[i]);
+            }
+
+            qsort(samples, test->samples, sizeof(samples[0]), compare);
+            exact = samples[(uint32_t)((test->p * (float32_t)(test->samples - 1u)) + 0.5f)];
+            error = 100.0f * (p2_quantile_get(&estimator) - exact) / exact;
+            sum_error += error;
+            max_error = (fabsf(error) > fabsf(max_error)) ? error : max_error;
+        }
+
+        printf("  %-11s p %.3f, %5" PRIu32 " samples: error mean %+5.1f %%, largest %+5.1f %%\n", test->name,
+               (double)test->p, test->samples, (double)(sum_error / (float32_t)NUM_RUNS), (double)max_error);
+        CHECK((test->max_error_percent == 0.0f) || (fabsf(max_error) <= test->max_error_percent),
+              "%s p %.3f over %" PRIu32 " samples: error %+.1f %%, more than %.1f %%", test->name, (double)test->p,
+              test->samples, (double)max_error, (double)test->max_error_percent);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: run_window
+ *******************************************************************************
+ * Summary:
+ *   Feeds exponential noise every FRAME_PERIOD_MS from a start time until
+ *   the window ends or a time limit.
+ *
+ * Return:
+ *   time of the frame that ended the window, 0 if none did
+ ******************************************************************************/
+static uint32_t run_window(threshold_calib_t* tc, uint32_t start_ms, uint32_t limit_ms, uint32_t* ends)
+{
+    uint32_t end_ms = 0;
+
+    *ends = 0;
+    for (uint32_t t = 0; t <= limit_ms; t += FRAME_PERIOD_MS)
+    {
+        uint32_t time_ms = start_ms + t;
+
+        if ((t < THRESHOLD_CALIB_SETTLE_MS) && (tc->macro.count != 0u))
+        {
+            /* Samples during the settling time */
+            return 0;
+        }
+        if (threshold_calib_update(tc, noise(NOISE_EXPONENTIAL), 0.5f * noise(NOISE_RAYLEIGH), time_ms))
+        {
+            ++(*ends);
+            end_ms = (end_ms == 0u) ? t : end_ms;
+        }
+    }
+
+    return end_ms;
+}
+
+/*******************************************************************************
+ * Function Name: test_state_machine
+ *******************************************************************************
+ * Summary:
+ *   Runs the calibration from idle through learning to its results.
+ ******************************************************************************/
+static void test_state_machine(void)
+{
+    threshold_calib_t tc;
+    uint32_t end_ms;
+    uint32_t ends;
+    uint32_t samples_per_window = (30000u / FRAME_PERIOD_MS) + 1u;
+
+    threshold_calib_init(&tc);
+    CHECK((tc.state == THRESHOLD_CALIB_IDLE) && !threshold_calib_learning(&tc) &&
+          !threshold_calib_update(&tc, 1.0f, 1.0f, 0), "idle calibration learned");
+
+    /* Defaults, and a false alarm rate out of range */
+    threshold_calib_start(&tc, 0, 0.0f, false);
+    CHECK((tc.duration_ms == THRESHOLD_CALIB_DEFAULT_DURATION_MS) && (tc.far == THRESHOLD_CALIB_DEFAULT_FAR) &&
+          threshold_calib_learning(&tc), "defaults: %" PRIu32 " ms at %.4f", tc.duration_ms, (double)tc.far);
+    threshold_calib_start(&tc, 10000u, 1.5f, false);
+    CHECK(tc.far == THRESHOLD_CALIB_DEFAULT_FAR, "false alarm rate 1.5 accepted");
+
+    /* 30 s at 0.01: 601 samples, 500 needed, proposed; the window starts at the first update */
+    threshold_calib_start(&tc, 30000u, 0.01f, false);
+    end_ms = run_window(&tc, 0xFFFFF000u, THRESHOLD_CALIB_SETTLE_MS + 40000u, &ends);
+    CHECK((end_ms == (THRESHOLD_CALIB_SETTLE_MS + 30000u)) && (ends == 1u) && (tc.state == THRESHOLD_CALIB_PROPOSED),
+          "30 s window at 0.01 across the timer wrap: ended at %" PRIu32 " ms %" PRIu32 " times, state %d", end_ms,
+          ends, (int)tc.state);
+    CHECK(tc.macro.count == samples_per_window, "%" PRIu32 " samples, expected %" PRIu32 " after the settling time",
+          tc.macro.count, samples_per_window);
+    CHECK((tc.macro_threshold == (THRESHOLD_CALIB_MARGIN * p2_quantile_get(&tc.macro))) &&
+          (tc.micro_threshold == (THRESHOLD_CALIB_MARGIN * p2_quantile_get(&tc.micro))),
+          "the thresholds are not the margin times the estimates");
+    /* Exponential noise: 4.6 at 0.99, the window holds about 6 exceedances */
+    CHECK((tc.macro_threshold > (THRESHOLD_CALIB_MARGIN * 3.5f)) && (tc.macro_threshold < (THRESHOLD_CALIB_MARGIN * 6.0f)),
+          "macro threshold %.2f far from %.2f", (double)tc.macro_threshold, (double)(THRESHOLD_CALIB_MARGIN * 4.6f));
+    CHECK(!threshold_calib_update(&tc, 1.0f, 1.0f, 0) && (tc.state == THRESHOLD_CALIB_PROPOSED),
+          "a proposed calibration kept learning");
+
+    /* Applied */
+    threshold_calib_start(&tc, 30000u, 0.01f, true);
+    end_ms = run_window(&tc, 1000u, THRESHOLD_CALIB_SETTLE_MS + 30000u, &ends);
+    CHECK((ends == 1u) && (tc.state == THRESHOLD_CALIB_APPLIED), "apply: state %d", (int)tc.state);
+
+    /* Fewer than five samples per expected false alarm: 601 of 5000 at 0.001 */
+    threshold_calib_start(&tc, 30000u, 0.001f, true);
+    end_ms = run_window(&tc, 1000u, THRESHOLD_CALIB_SETTLE_MS + 30000u, &ends);
+    CHECK((ends == 1u) && (tc.state == THRESHOLD_CALIB_FAILED),
+          "%" PRIu32 " samples at 0.001: state %d, expected failed", tc.macro.count, (int)tc.state);
+
+    /* Enough samples but no noise: no threshold */
+    threshold_calib_start(&tc, 10000u, 0.1f, true);
+    for (uint32_t t = 0; t <= (THRESHOLD_CALIB_SETTLE_MS + 10000u); t += FRAME_PERIOD_MS)
+    {
+        (void)threshold_calib_update(&tc, 0.0f, 0.0f, t);
+    }
+    CHECK(tc.state == THRESHOLD_CALIB_FAILED, "all zero metrics: state %d, expected failed", (int)tc.state);
+
+    /* A restart while learning starts over */
+    threshold_calib_start(&tc, 30000u, 0.01f, false);
+    (void)run_window(&tc, 0, THRESHOLD_CALIB_SETTLE_MS + 10000u, &ends);
+    threshold_calib_start(&tc, 30000u, 0.01f, false);
+    CHECK((tc.macro.count == 0u) && !tc.started && threshold_calib_learning(&tc), "a restart kept %" PRIu32 " samples",
+          tc.macro.count);
+    end_ms = run_window(&tc, 50000u, THRESHOLD_CALIB_SETTLE_MS + 30000u, &ends);
+    CHECK((end_ms == (THRESHOLD_CALIB_SETTLE_MS + 30000u)) && (tc.state == THRESHOLD_CALIB_PROPOSED),
+          "the restarted window ended at %" PRIu32 " ms, state %d", end_ms, (int)tc.state);
+}
+
+/*******************************************************************************
+ * Function Name: main
+ *******************************************************************************
+ * Summary:
+ *   Runs the scenarios.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   0 if all checks pass
+ ******************************************************************************/
+int main(void)
+{
+    test_quantiles();
+    test_state_machine();
+
+    printf("%s\n", (failures == 0u) ? "[PASS] test_threshold_calib" : "[FAIL] test_threshold_calib");
+    return (failures == 0u) ? 0 : 1;
+}
+
+/* [] END OF FILE */
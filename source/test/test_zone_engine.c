@@ -0,0 +1,332 @@
+/*****************************************************************************
+ * File name: test_zone_engine.c
+ *
+ * Description: Feeds zone_engine.c with synthetic range profiles of a person
+ * walking through overlapping presence zones and then leaving them. Macro
+ * motion is a reflection whose phase turns from frame to frame, micro motion
+ * the magnitude left behind. The test checks the enter and leave events of
+ * every zone with its zone id, the validity timers of the macro and micro
+ * presence, that overlapping zones report the same motion each, that a zone
+ * reconfigured while present reports its absence once, and that zone ids
+ * beyond ZONE_ENGINE_MAX_ZONES are rejected.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Header file for local task */
+#include "zone_engine.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define NUM_BINS                            (64u)
+#define BIN_LENGTH_M                        (0.1f)
+#define FRAME_PERIOD_MS                     (50u)
+
+/* Validity times of the zones, shorter than the defaults to keep the test short */
+#define MACRO_VALIDITY_MS                   (500u)
+#define MICRO_VALIDITY_MS                   (1000u)
+#define MICRO_THRESHOLD                     (0.5f)
+
+/* Walk: in the overlap of zones 0 and 1, then in zone 1 only, then gone */
+#define OVERLAP_BIN                         (12u)
+#define ZONE_1_BIN                          (20u)
+#define OVERLAP_END_MS                      (1000u)
+#define WALK_END_MS                         (5000u)
+#define RECONFIGURE_MS                      (3000u)
+#define END_MS                              (9000u)
+
+/* Phase step of the moving reflection per frame */
+#define WALK_PHASE_STEP                     (1.0f)
+
+#define MAX_EVENTS                          (32u)
+
+#define CHECK(condition, ...)               do { if (!(condition)) { printf("[FAIL] " __VA_ARGS__); \
+                                                 printf("\n"); ++failures; } } while (0)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef struct
+{
+    zone_event_t event;
+    uint32_t last_macro_ms;             /* of the zone when the event was reported */
+    uint32_t last_micro_ms;
+} recorded_event_t;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static float32_t magnitude[NUM_BINS];
+static float32_t spectrum[2u * NUM_BINS];
+static range_profile_t profile =
+{
+    .magnitude = magnitude,
+    .spectrum = spectrum,
+    .residual = spectrum,
+    .sample_scale = 1.0f,
+    .num_bins = NUM_BINS,
+    .bin_length = BIN_LENGTH_M
+};
+
+static recorded_event_t recorded[MAX_EVENTS];
+static uint32_t num_recorded;
+
+static uint32_t failures;
+
+/*******************************************************************************
+ * Function Name: make_frame
+ *******************************************************************************
+ * Summary:
+ *   Builds the profile of a reflection with unit magnitude in a bin whose
+ *   phase turns with every frame, or an empty profile.
+ *
+ * Parameters:
+ *   bin: bin of the person, 0 for none
+ *   frame: frame number, sets the phase
+ ******************************************************************************/
+static void make_frame(uint32_t bin, uint32_t frame)
+{
+    memset(magnitude, 0, sizeof(magnitude));
+    memset(spectrum, 0, sizeof(spectrum));
+
+    if (bin > 0u)
+    {
+        float32_t phase = WALK_PHASE_STEP * (float32_t)frame;
+
+        spectrum[2u * bin] = cosf(phase);
+        spectrum[(2u * bin) + 1u] = sinf(phase);
+        magnitude[bin] = 1.0f;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: run_frame
+ *******************************************************************************
+ * Summary:
+ *   Updates the engine and records the events with the timers of their zone.
+ ******************************************************************************/
+static void run_frame(zone_engine_t* ze, uint32_t time_ms)
+{
+    zone_event_t events[ZONE_ENGINE_MAX_ZONES];
+    uint32_t count = zone_engine_update(ze, &profile, time_ms, events);
+
+    for (uint32_t e = 0; e < count; ++e)
+    {
+        if (num_recorded < MAX_EVENTS)
+        {
+            const zone_state_t* zone = &ze->zones[events[e].zone_id];
+
+            recorded[num_recorded].event = events[e];
+            recorded[num_recorded].last_macro_ms = zone->last_macro_ms;
+            recorded[num_recorded].last_micro_ms = zone->last_micro_ms;
+        }
+        ++num_recorded;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: find_event
+ *******************************************************************************
+ * Summary:
+ *   Returns the n-th recorded event of a zone, NULL if there is none.
+ ******************************************************************************/
+static const recorded_event_t* find_event(uint32_t zone_id, uint32_t n)
+{
+    for (uint32_t e = 0; (e < num_recorded) && (e < MAX_EVENTS); ++e)
+    {
+        if (recorded[e].event.zone_id == zone_id)
+        {
+            if (n == 0u)
+            {
+                return &recorded[e];
+            }
+            --n;
+        }
+    }
+
+    return NULL;
+}
+
+/*******************************************************************************
+ * Function Name: count_events
+ *******************************************************************************
+ * Summary:
+ *   Returns the number of recorded events of a zone.
+ ******************************************************************************/
+static uint32_t count_events(uint32_t zone_id)
+{
+    uint32_t count = 0;
+
+    while (find_event(zone_id, count) != NULL)
+    {
+        ++count;
+    }
+
+    return count;
+}
+
+/*******************************************************************************
+ * Function Name: check_event
+ *******************************************************************************
+ * Summary:
+ *   Checks the state of the n-th event of a zone.
+ ******************************************************************************/
+static const recorded_event_t* check_event(uint32_t zone_id, uint32_t n, xensiv_radar_presence_state_t state)
+{
+    const recorded_event_t* recorded_event = find_event(zone_id, n);
+
+    CHECK((recorded_event != NULL) && (recorded_event->event.state == state),
+          "event %" PRIu32 " of zone %" PRIu32 ": state %d, expected %d", n, zone_id,
+          (recorded_event != NULL) ? (int)recorded_event->event.state : -1, (int)state);
+
+    return ((recorded_event != NULL) && (recorded_event->event.state == state)) ? recorded_event : NULL;
+}
+
+/*******************************************************************************
+ * Function Name: make_zone
+ *******************************************************************************
+ * Summary:
+ *   Returns a zone over a range with the validity times of the test.
+ ******************************************************************************/
+static zone_config_t make_zone(float min_range, float max_range)
+{
+    zone_config_t config;
+
+    zone_engine_default_config(&config);
+    config.min_range = min_range;
+    config.max_range = max_range;
+    config.micro_threshold = MICRO_THRESHOLD;
+    config.macro_validity_ms = MACRO_VALIDITY_MS;
+    config.micro_validity_ms = MICRO_VALIDITY_MS;
+
+    return config;
+}
+
+/*******************************************************************************
+ * Function Name: main
+ *******************************************************************************
+ * Summary:
+ *   Configures three zones, two of them overlapping, walks a person through
+ *   them and checks the events.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   0 if all checks pass
+ ******************************************************************************/
+int main(void)
+{
+    static zone_engine_t ze;
+    zone_config_t zone_0 = make_zone(0.5f, 1.5f);
+    zone_config_t zone_1 = make_zone(1.0f, 2.5f);
+    zone_config_t zone_2 = make_zone(3.0f, 4.0f);
+    zone_config_t disabled = make_zone(2.0f, 2.0f);
+    const recorded_event_t* event;
+    uint32_t frame = 0;
+
+    zone_engine_init(&ze, BIN_LENGTH_M);
+
+    /* Zone ids beyond the last zone are rejected and change nothing */
+    CHECK(!zone_engine_configure(&ze, ZONE_ENGINE_MAX_ZONES, &zone_0) &&
+          !zone_engine_configure(&ze, 0xFFFFFFFFu, &zone_0) && !ze.any_enabled,
+          "zone id %u was accepted", ZONE_ENGINE_MAX_ZONES);
+    CHECK(zone_engine_configure(&ze, 0, &zone_0) && zone_engine_configure(&ze, 1, &zone_1) &&
+          zone_engine_configure(&ze, 2, &zone_2) && zone_engine_configure(&ze, 3, &disabled),
+          "a valid zone id was rejected");
+    CHECK(ze.zones[0].enabled && ze.zones[1].enabled && ze.zones[2].enabled && !ze.zones[3].enabled &&
+          (ze.zones[0].min_bin == 5u) && (ze.zones[1].max_bin == 25u) && (ze.min_bin == 5u) && (ze.max_bin == 40u),
+          "zone bins: zone 0 from %" PRIu32 ", zone 1 to %" PRIu32 ", covered %" PRIu32 "..%" PRIu32,
+          ze.zones[0].min_bin, ze.zones[1].max_bin, ze.min_bin, ze.max_bin);
+
+    for (uint32_t time_ms = 0; time_ms < END_MS; time_ms += FRAME_PERIOD_MS)
+    {
+        uint32_t bin = (time_ms < OVERLAP_END_MS) ? OVERLAP_BIN : ((time_ms < WALK_END_MS) ? ZONE_1_BIN : 0u);
+
+        /* Zone 1 reconfigured while the person is in it */
+        if (time_ms == RECONFIGURE_MS)
+        {
+            zone_1.macro_threshold *= 2.0f;
+            (void)zone_engine_configure(&ze, 1, &zone_1);
+        }
+
+        make_frame(bin, frame++);
+        run_frame(&ze, time_ms);
+    }
+
+    /* Zone 0: entered in the overlap, then micro presence while the motion fades, then absence */
+    CHECK(count_events(0) == 3u, "zone 0 reported %" PRIu32 " events, expected 3", count_events(0));
+    event = check_event(0, 0, XENSIV_RADAR_PRESENCE_STATE_MACRO_PRESENCE);
+    CHECK((event == NULL) || ((event->event.timestamp == FRAME_PERIOD_MS) && (event->event.range_bin == OVERLAP_BIN)),
+          "zone 0 entered at %" PRIu32 " ms in bin %" PRIu32 ", expected %u ms in bin %u",
+          (event != NULL) ? event->event.timestamp : 0u, (event != NULL) ? event->event.range_bin : 0u,
+          FRAME_PERIOD_MS, OVERLAP_BIN);
+    event = check_event(0, 1, XENSIV_RADAR_PRESENCE_STATE_MICRO_PRESENCE);
+    CHECK((event == NULL) || (((event->event.timestamp - event->last_macro_ms) > MACRO_VALIDITY_MS) &&
+                              ((event->event.timestamp - event->last_macro_ms) <= (MACRO_VALIDITY_MS + FRAME_PERIOD_MS))),
+          "zone 0 micro presence %" PRIu32 " ms after the last macro motion, validity %u ms",
+          (event != NULL) ? (event->event.timestamp - event->last_macro_ms) : 0u, MACRO_VALIDITY_MS);
+    event = check_event(0, 2, XENSIV_RADAR_PRESENCE_STATE_ABSENCE);
+    CHECK((event == NULL) || (((event->event.timestamp - event->last_micro_ms) > MICRO_VALIDITY_MS) &&
+                              ((event->event.timestamp - event->last_micro_ms) <= (MICRO_VALIDITY_MS + FRAME_PERIOD_MS))),
+          "zone 0 absence %" PRIu32 " ms after the last micro motion, validity %u ms",
+          (event != NULL) ? (event->event.timestamp - event->last_micro_ms) : 0u, MICRO_VALIDITY_MS);
+    if (event != NULL)
+    {
+        printf("zone 0: macro presence at %u ms, micro presence at %" PRIu32 " ms, absence at %" PRIu32 " ms\n",
+               FRAME_PERIOD_MS, find_event(0, 1)->event.timestamp, event->event.timestamp);
+    }
+
+    /* Zone 1: entered in the same frame as zone 0, reset by the reconfiguration, entered again, left */
+    CHECK(count_events(1) == 5u, "zone 1 reported %" PRIu32 " events, expected 5", count_events(1));
+    event = check_event(1, 0, XENSIV_RADAR_PRESENCE_STATE_MACRO_PRESENCE);
+    CHECK((event == NULL) || ((event->event.timestamp == FRAME_PERIOD_MS) && (event->event.range_bin == OVERLAP_BIN)),
+          "zone 1 did not enter with zone 0 in the overlap");
+    event = check_event(1, 1, XENSIV_RADAR_PRESENCE_STATE_ABSENCE);
+    CHECK((event == NULL) || (event->event.timestamp == RECONFIGURE_MS),
+          "zone 1 did not report its absence in the frame of the reconfiguration");
+    event = check_event(1, 2, XENSIV_RADAR_PRESENCE_STATE_MACRO_PRESENCE);
+    /* The frame of the reconfiguration takes the reference again, the next one compares */
+    CHECK((event == NULL) || ((event->event.timestamp == (RECONFIGURE_MS + FRAME_PERIOD_MS)) &&
+                              (event->event.range_bin == ZONE_1_BIN)),
+          "zone 1 did not enter again in bin %u the frame after the reconfiguration", ZONE_1_BIN);
+    (void)check_event(1, 3, XENSIV_RADAR_PRESENCE_STATE_MICRO_PRESENCE);
+    event = check_event(1, 4, XENSIV_RADAR_PRESENCE_STATE_ABSENCE);
+    CHECK((event == NULL) || (event->event.timestamp > WALK_END_MS), "zone 1 left before the person");
+
+    /* Zone 2 is not crossed, zone 3 is disabled */
+    CHECK((count_events(2) == 0u) && (count_events(3) == 0u), "zones 2 and 3 reported %" PRIu32 " and %" PRIu32
+          " events", count_events(2), count_events(3));
+    CHECK((num_recorded == ze.stats.events) && (num_recorded <= MAX_EVENTS),
+          "%" PRIu32 " events recorded, %" PRIu32 " counted", num_recorded, ze.stats.events);
+
+    printf("%s\n", (failures == 0u) ? "[PASS] test_zone_engine" : "[FAIL] test_zone_engine");
+    return (failures == 0u) ? 0 : 1;
+}
+
+/* [] END OF FILE */